@@ -0,0 +1,110 @@
+// ignore_for_file: avoid_print
+
+import 'dart:io';
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+/// Compares single-request latency of the worker and direct execution
+/// modes.
+///
+/// Each mode is started in turn on its own UDP port and measured with one
+/// request outstanding at a time:
+///
+/// * a metrics round trip, which reaches the stack and back without the
+///   network and so isolates the cost of the isolate hops;
+/// * with `BACNET_DEVICE=<id>@<ip>[:port]` set, a ReadProperty of the
+///   device's Object_Name, the latency a one-shot script sees.
+///
+/// ```sh
+/// BACNET_DEVICE=1234@192.168.1.50 \
+///   flutter test benchmark/execution_mode_benchmark.dart
+/// ```
+///
+/// Requires the native library on the loader path (e.g. LD_LIBRARY_PATH).
+void main() {
+  test('Worker vs direct single-request latency', () async {
+    final device = _parseDevice(Platform.environment['BACNET_DEVICE']);
+    var port = 47809;
+    for (final mode in BacnetExecutionMode.values) {
+      final client = BacnetClient(logger: const _SilentLogger());
+      final startup = Stopwatch()..start();
+      await client.start(port: port++, mode: mode);
+      print('${mode.name}: started in ${startup.elapsedMilliseconds} ms');
+
+      _report(
+        '  Metrics round trip',
+        await _measure(1000, () => client.getMetrics()),
+      );
+      if (device != null) {
+        await client.addDeviceBinding(device.id, device.ip, port: device.port);
+        _report(
+          '  ReadProperty',
+          await _measure(
+            200,
+            () => client.readProperty(
+              device.id,
+              BacnetObjectType.device,
+              device.id,
+              BacnetPropertyId.objectName,
+            ),
+          ),
+        );
+      }
+      client.shutdown();
+    }
+  }, timeout: Timeout.none);
+}
+
+({int id, String ip, int port})? _parseDevice(String? spec) {
+  if (spec == null || !spec.contains('@')) return null;
+  final [id, address] = spec.split('@');
+  final parts = address.split(':');
+  return (
+    id: int.parse(id),
+    ip: parts.first,
+    port: parts.length > 1 ? int.parse(parts[1]) : 47808,
+  );
+}
+
+/// Runs [request] [count] times in sequence after a short warm-up and
+/// returns the sorted latencies in microseconds.
+Future<List<int>> _measure(
+  int count,
+  Future<Object?> Function() request,
+) async {
+  for (var i = 0; i < 20; i++) {
+    await request();
+  }
+  final latencies = <int>[];
+  final clock = Stopwatch();
+  for (var i = 0; i < count; i++) {
+    clock
+      ..reset()
+      ..start();
+    await request();
+    latencies.add(clock.elapsedMicroseconds);
+  }
+  return latencies..sort();
+}
+
+void _report(String label, List<int> sorted) {
+  String at(double q) {
+    final us = sorted[((sorted.length - 1) * q).round()];
+    return '${(us / 1000).toStringAsFixed(3)} ms';
+  }
+
+  print('$label: p50 ${at(0.5)}, p99 ${at(0.99)}, max ${at(1)}');
+}
+
+class _SilentLogger implements BacnetLogger {
+  const _SilentLogger();
+
+  @override
+  void log(
+    BacnetLogLevel level,
+    String message, [
+    Object? error,
+    StackTrace? stackTrace,
+  ]) {}
+}
@@ -0,0 +1,103 @@
+// ignore_for_file: avoid_print
+
+import 'dart:io';
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+/// Compares read tail latency with and without hedging.
+///
+/// Reads the device's Object_Name [_reads] times, [_concurrency] at a time,
+/// first without hedging and then with the default [ReadHedgingPolicy],
+/// and prints the latency distribution of each run together with the
+/// hedger's own counters: hedges sent, hedges that won, and the p99 the
+/// same reads would have had without their hedges.
+///
+/// ```sh
+/// BACNET_DEVICE=1234@192.168.1.50 \
+///   flutter test benchmark/hedged_read_benchmark.dart
+/// ```
+///
+/// Hedging only helps with a tail to cut: run it against a device that
+/// drops or delays some requests, or add loss on the way, e.g.
+/// `tc qdisc add dev eth0 root netem loss 2% delay 5ms 40ms`.
+///
+/// Requires the native library on the loader path (e.g. LD_LIBRARY_PATH).
+void main() {
+  test('Hedged read tail latency', () async {
+    final device = Platform.environment['BACNET_DEVICE'];
+    if (device == null || !device.contains('@')) {
+      print('Set BACNET_DEVICE=<id>@<ip>[:port] to run this benchmark');
+      return;
+    }
+    final [id, address] = device.split('@');
+    final deviceId = int.parse(id);
+    final parts = address.split(':');
+
+    final client = BacnetClient(logger: const _SilentLogger());
+    try {
+      await client.start(port: 47809);
+      await client.addDeviceBinding(
+        deviceId,
+        parts.first,
+        port: parts.length > 1 ? int.parse(parts[1]) : 47808,
+      );
+
+      for (final policy in [null, const ReadHedgingPolicy()]) {
+        client.setReadHedging(policy);
+        print(policy == null ? 'Without hedging' : 'With $policy');
+        await _measure(client, deviceId);
+        if (policy != null) print('  ${(await client.getMetrics()).hedging}');
+      }
+      client.setReadHedging(null);
+    } finally {
+      client.shutdown();
+    }
+  }, timeout: Timeout.none);
+}
+
+const _reads = 5000;
+const _concurrency = 4;
+
+Future<void> _measure(BacnetClient client, int deviceId) async {
+  final samples = <int>[];
+  var failed = 0;
+  var next = 0;
+  Future<void> reader() async {
+    while (next < _reads) {
+      next++;
+      final watch = Stopwatch()..start();
+      try {
+        await client.readProperty(
+          deviceId,
+          BacnetObjectType.device,
+          deviceId,
+          BacnetPropertyId.objectName,
+        );
+        samples.add(watch.elapsedMicroseconds);
+      } on BacnetException {
+        failed++;
+      }
+    }
+  }
+
+  await Future.wait([for (var i = 0; i < _concurrency; i++) reader()]);
+  samples.sort();
+  String at(double q) => '${samples[((samples.length - 1) * q).round()]} us';
+  print(
+    '  p50 ${at(0.5)}, p99 ${at(0.99)}, p99.9 ${at(0.999)}, '
+    'max ${at(1)}, $failed failed',
+  );
+}
+
+class _SilentLogger implements BacnetLogger {
+  const _SilentLogger();
+
+  @override
+  void log(
+    BacnetLogLevel level,
+    String message, [
+    Object? error,
+    StackTrace? stackTrace,
+  ]) {}
+}
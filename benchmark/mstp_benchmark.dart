@@ -0,0 +1,228 @@
+// ignore_for_file: avoid_print
+
+import 'dart:ffi' as ffi;
+import 'dart:io';
+
+import 'package:bacnet_plugin/bacnet_plugin_bindings.g.dart';
+import 'package:bacnet_plugin/src/constants/object_types.dart';
+import 'package:bacnet_plugin/src/constants/property_ids.dart';
+import 'package:bacnet_plugin/src/native/worker/globals.dart';
+import 'package:bacnet_plugin/src/native/worker/hot_path_bindings.dart';
+import 'package:ffi/ffi.dart';
+
+/// Measures MS/TP throughput between two processes over a serial link.
+///
+/// Wire two RS-485 adapters back to back, or use a pseudo-terminal pair:
+///
+/// ```sh
+/// socat pty,raw,echo=0,link=/tmp/mstp0 pty,raw,echo=0,link=/tmp/mstp1 &
+/// dart run benchmark/mstp_benchmark.dart server /tmp/mstp0 115200 &
+/// dart run benchmark/mstp_benchmark.dart client /tmp/mstp1 115200
+/// ```
+///
+/// The client keeps a window of ReadProperty requests outstanding to the
+/// server (MAC 1, device 1001), first with one frame per token hold and
+/// then with 16, and prints frames and reads per second for each. A
+/// pseudo-terminal does not pace bytes at the line rate, so the client also
+/// prints what the measured frame mix allows on the wire at 76.8k and
+/// 115.2k baud.
+///
+/// Requires the native library built with MS/TP (`BACDL_MSTP`).
+void main(List<String> args) {
+  if (args.length < 2 || !const ['server', 'client'].contains(args[0])) {
+    print('usage: mstp_benchmark.dart server|client <serial port> [baud]');
+    exit(64);
+  }
+  final baud = args.length > 2 ? int.parse(args[2]) : 115200;
+
+  library = openBacnetLibrary();
+  bindings = BacnetBindings(library);
+  hotPath = HotPathBindings(library);
+
+  if (args[0] == 'server') {
+    runServer(args[1], baud);
+  } else {
+    runClient(args[1], baud);
+  }
+}
+
+late ffi.DynamicLibrary library;
+
+const _serverDevice = 1001;
+const _serverMac = 1;
+const _clientMac = 2;
+const _mstpMaxApdu = 480;
+const _window = 8;
+const _duration = Duration(seconds: 10);
+
+/// Approximate NPDU of the ReadProperty request sent: NPDU header (2),
+/// confirmed request header (4), object identifier (5), property (2).
+const _requestBytes = 13;
+
+final _src = calloc<BACNET_ADDRESS>();
+final _pdu = calloc<ffi.Uint8>(maxAPDU);
+final _tick = Stopwatch()..start();
+
+void runServer(String port, int baud) {
+  _open(port, baud, mac: _serverMac, maxInfoFrames: 16);
+  bindings
+    ..Device_Set_Object_Instance_Number(_serverDevice)
+    ..Device_Init(ffi.nullptr)
+    ..apdu_set_confirmed_handler(
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_READ_PROPERTY,
+      library.lookup<ffi.NativeFunction<confirmed_functionFunction>>(
+        'handler_read_property',
+      ),
+    );
+  print('Serving device $_serverDevice on $port at $baud baud');
+  while (true) {
+    _pump();
+  }
+}
+
+void runClient(String port, int baud) {
+  print('MS/TP ReadProperty throughput on $port at $baud baud');
+  for (final maxInfoFrames in const [1, 16]) {
+    _open(port, baud, mac: _clientMac, maxInfoFrames: maxInfoFrames);
+    _bindServer();
+    _report(maxInfoFrames, _measure());
+  }
+  hotPath.datalinkCleanup();
+}
+
+void _open(
+  String port,
+  int baud, {
+  required int mac,
+  required int maxInfoFrames,
+}) {
+  final portPtr = port.toNativeUtf8();
+  final ok = hotPath.mstpInit(portPtr.cast(), baud, mac, 3, maxInfoFrames);
+  calloc.free(portPtr);
+  if (!ok) {
+    print('Cannot open $port as MS/TP (library built without BACDL_MSTP?)');
+    exit(1);
+  }
+}
+
+void _bindServer() {
+  final addr = calloc<BACNET_ADDRESS>();
+  addr.ref
+    ..mac_len = 1
+    ..net = 0
+    ..len = 0;
+  addr.ref.mac[0] = _serverMac;
+  bindings.address_add(_serverDevice, _mstpMaxApdu, addr);
+  calloc.free(addr);
+}
+
+/// Receives and handles one PDU, if any, and advances the TSM timers.
+int _pump() {
+  final len = bindings.bacnet_plugin_safe_bip_receive(_src, _pdu, maxAPDU, 1);
+  if (len > 0) bindings.bacnet_plugin_safe_npdu_handler(_src, _pdu, len);
+  final elapsed = _tick.elapsedMilliseconds;
+  if (elapsed > 0) {
+    _tick.reset();
+    bindings.tsm_timer_milliseconds(elapsed);
+  }
+  return len;
+}
+
+typedef _Result = ({
+  int reads,
+  int failed,
+  int replyBytes,
+  Duration elapsed,
+  int transmitFrames,
+  int receiveFrames,
+  int transmitPdus,
+  int receivePdus,
+});
+
+_Result _measure() {
+  final stats = calloc<BacnetPluginMstpStats>();
+  hotPath.mstpStats(stats);
+  final txFrames = stats.ref.transmitFrames;
+  final rxFrames = stats.ref.receiveValidFrames;
+  final txPdus = stats.ref.transmitPdus;
+  final rxPdus = stats.ref.receivePdus;
+
+  final outstanding = <int>[];
+  var reads = 0;
+  var failed = 0;
+  var replyBytes = 0;
+  final clock = Stopwatch()..start();
+  while (clock.elapsed < _duration) {
+    while (outstanding.length < _window) {
+      final invokeId = hotPath.sendReadProperty(
+        _serverDevice,
+        BacnetObjectType.device,
+        _serverDevice,
+        BacnetPropertyId.objectName,
+        0xFFFFFFFF, // BACNET_ARRAY_ALL
+      );
+      if (invokeId == 0) break;
+      outstanding.add(invokeId);
+    }
+    final len = _pump();
+    if (len > 0) replyBytes += len;
+    outstanding.removeWhere((invokeId) {
+      if (bindings.tsm_invoke_id_failed(invokeId)) {
+        bindings.tsm_free_invoke_id(invokeId);
+        failed++;
+        return true;
+      }
+      if (!bindings.tsm_invoke_id_free(invokeId)) return false;
+      reads++;
+      return true;
+    });
+  }
+  clock.stop();
+
+  hotPath.mstpStats(stats);
+  final result = (
+    reads: reads,
+    failed: failed,
+    replyBytes: replyBytes,
+    elapsed: clock.elapsed,
+    transmitFrames: stats.ref.transmitFrames - txFrames,
+    receiveFrames: stats.ref.receiveValidFrames - rxFrames,
+    transmitPdus: stats.ref.transmitPdus - txPdus,
+    receivePdus: stats.ref.receivePdus - rxPdus,
+  );
+  calloc.free(stats);
+  return result;
+}
+
+void _report(int maxInfoFrames, _Result r) {
+  final seconds = r.elapsed.inMicroseconds / 1e6;
+  // Every frame on the bus is either sent or received by the client.
+  final frames = r.transmitFrames + r.receiveFrames;
+  print('max_info_frames $maxInfoFrames:');
+  print(
+    '  Measured:   ${(r.reads / seconds).toStringAsFixed(1)} reads/s, '
+    '${(frames / seconds).toStringAsFixed(1)} frames/s '
+    '(${r.failed} failed)',
+  );
+  if (r.reads == 0) return;
+
+  // Frame-time model of the same mix: data frames carry header (8) plus
+  // data and CRC (2); every frame is followed by a 40 bit-time turnaround.
+  final replyBytes = r.receivePdus == 0 ? 0 : r.replyBytes ~/ r.receivePdus;
+  final tokenFramesPerRead = 2 * (r.transmitFrames - r.transmitPdus) / r.reads;
+  final framesPerRead = 2 + tokenFramesPerRead;
+  for (final baud in const [76800, 115200]) {
+    double frame(int data) =>
+        ((8 + (data > 0 ? data + 2 : 0)) * 10 + 40) / baud;
+    final secondsPerRead =
+        frame(_requestBytes) +
+        frame(replyBytes) +
+        tokenFramesPerRead * frame(0);
+    print(
+      '  Wire @ ${(baud / 1000).toStringAsFixed(1)}k: '
+      '${(1 / secondsPerRead).toStringAsFixed(1)} reads/s, '
+      '${(framesPerRead / secondsPerRead).toStringAsFixed(1)} frames/s '
+      '(${tokenFramesPerRead.toStringAsFixed(2)} token frames per read)',
+    );
+  }
+}
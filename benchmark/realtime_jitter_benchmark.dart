@@ -0,0 +1,138 @@
+// ignore_for_file: avoid_print
+
+import 'dart:ffi' as ffi;
+import 'dart:io';
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:bacnet_plugin/src/native/worker/globals.dart';
+import 'package:bacnet_plugin/src/native/worker/hot_path_bindings.dart';
+import 'package:ffi/ffi.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+/// Compares latency jitter with and without the real-time profile.
+///
+/// Reads the device's Object_Name [_reads] times, one request at a time,
+/// first with default scheduling and then with a [RealtimeProfile], and
+/// prints the latency distribution of:
+///
+/// * request-to-send: from the `readProperty` call on the main isolate to
+///   the stack handing the request to the datalink;
+/// * receive-to-callback: from the datalink returning the reply to the
+///   `readProperty` future completing on the main isolate;
+/// * the whole round trip.
+///
+/// Timestamps come from the native monotonic clock, read from both
+/// isolates. Run against a device on a quiet network: other traffic moves
+/// the receive timestamp and such samples are discarded.
+///
+/// ```sh
+/// BACNET_DEVICE=1234@192.168.1.50 BACNET_CPU=3 \
+///   flutter test benchmark/realtime_jitter_benchmark.dart
+/// ```
+///
+/// `BACNET_CPU` picks the core to pin to (default: none). SCHED_FIFO and
+/// mlockall need privileges (e.g. `ulimit -r 99 -l unlimited`); the
+/// profile state is printed so unapplied settings are visible.
+///
+/// Requires the native library on the loader path (e.g. LD_LIBRARY_PATH).
+void main() {
+  test('Real-time profile jitter', () async {
+    final device = Platform.environment['BACNET_DEVICE'];
+    if (device == null || !device.contains('@')) {
+      print('Set BACNET_DEVICE=<id>@<ip>[:port] to run this benchmark');
+      return;
+    }
+    final [id, address] = device.split('@');
+    final deviceId = int.parse(id);
+    final parts = address.split(':');
+    final cpu = int.tryParse(Platform.environment['BACNET_CPU'] ?? '');
+
+    final native = HotPathBindings(openBacnetLibrary());
+    final stats = calloc<BacnetPluginRealtimeStats>();
+    final client = BacnetClient(logger: const _SilentLogger());
+    try {
+      await client.start(port: 47809);
+      await client.addDeviceBinding(
+        deviceId,
+        parts.first,
+        port: parts.length > 1 ? int.parse(parts[1]) : 47808,
+      );
+
+      for (final profile in [null, RealtimeProfile(cpu: cpu)]) {
+        await client.setRealtimeProfile(profile);
+        print(
+          profile == null
+              ? 'Default scheduling'
+              : (await client.getMetrics()).realtime,
+        );
+        await _measure(client, native, stats, deviceId);
+      }
+      await client.setRealtimeProfile(null);
+    } finally {
+      calloc.free(stats);
+      client.shutdown();
+    }
+  }, timeout: Timeout.none);
+}
+
+const _reads = 10000;
+const _warmUp = 200;
+
+Future<void> _measure(
+  BacnetClient client,
+  HotPathBindings native,
+  ffi.Pointer<BacnetPluginRealtimeStats> stats,
+  int deviceId,
+) async {
+  final toSend = <int>[];
+  final toCallback = <int>[];
+  final roundTrip = <int>[];
+  var discarded = 0;
+  for (var i = 0; i < _warmUp + _reads; i++) {
+    final start = native.monotonicUs();
+    await client.readProperty(
+      deviceId,
+      BacnetObjectType.device,
+      deviceId,
+      BacnetPropertyId.objectName,
+    );
+    final done = native.monotonicUs();
+    if (i < _warmUp) continue;
+    native.realtimeStats(stats);
+    final sent = stats.ref.lastSendUs;
+    final received = stats.ref.lastReceiveUs;
+    if (sent < start || received < sent || received > done) {
+      discarded++;
+      continue;
+    }
+    toSend.add(sent - start);
+    toCallback.add(done - received);
+    roundTrip.add(done - start);
+  }
+  _report('  request-to-send', toSend);
+  _report('  receive-to-callback', toCallback);
+  _report('  round trip', roundTrip);
+  if (discarded > 0) print('  $discarded samples discarded');
+}
+
+void _report(String label, List<int> samples) {
+  if (samples.isEmpty) return;
+  samples.sort();
+  String at(double q) => '${samples[((samples.length - 1) * q).round()]} us';
+  print(
+    '$label: p50 ${at(0.5)}, p99 ${at(0.99)}, p99.9 ${at(0.999)}, '
+    'max ${at(1)}',
+  );
+}
+
+class _SilentLogger implements BacnetLogger {
+  const _SilentLogger();
+
+  @override
+  void log(
+    BacnetLogLevel level,
+    String message, [
+    Object? error,
+    StackTrace? stackTrace,
+  ]) {}
+}
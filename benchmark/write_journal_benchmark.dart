@@ -0,0 +1,124 @@
+// ignore_for_file: avoid_print
+
+import 'dart:ffi' as ffi;
+import 'dart:io';
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:bacnet_plugin/src/native/worker/globals.dart';
+import 'package:bacnet_plugin/src/native/worker/hot_path_bindings.dart';
+import 'package:ffi/ffi.dart';
+
+/// Measures the native write journal at sustained write rates.
+///
+/// Appends WriteProperty-sized records (a Real present value) at each
+/// target rate for [_duration], paced like network arrivals, and reports
+/// the append latency the stack thread sees, the durability lag the
+/// committer adds, and the batching it achieved. The journal is then read
+/// back and checked.
+///
+/// ```sh
+/// dart run benchmark/write_journal_benchmark.dart [directory]
+/// ```
+///
+/// The directory defaults to the system temp directory; point it at the
+/// disk the gateway journals to, since fdatasync cost dominates.
+///
+/// Requires the native library on the loader path (e.g. LD_LIBRARY_PATH).
+void main(List<String> args) {
+  final dir = Directory(
+    args.isNotEmpty ? args.first : Directory.systemTemp.path,
+  ).createTempSync('bacnet_journal_');
+  hotPath = HotPathBindings(openBacnetLibrary());
+
+  try {
+    for (final rate in const [1000, 5000, 20000]) {
+      _run(dir, rate);
+    }
+  } finally {
+    dir.deleteSync(recursive: true);
+  }
+}
+
+const _duration = Duration(seconds: 5);
+const _commitInterval = Duration(milliseconds: 5);
+
+/// Application-tagged Real 21.5.
+const _value = [0x44, 0x41, 0xAC, 0x00, 0x00];
+
+void _run(Directory dir, int rate) {
+  final path = '${dir.path}/writes_$rate.journal';
+  final pathPtr = path.toNativeUtf8();
+  final value = calloc<ffi.Uint8>(_value.length);
+  final stats = calloc<BacnetPluginJournalStats>();
+  value.asTypedList(_value.length).setAll(0, _value);
+  try {
+    if (!hotPath.journalOpen(
+      pathPtr.cast(),
+      0,
+      0,
+      _commitInterval.inMilliseconds,
+      WriteJournalConfig.defaultBufferBytes,
+    )) {
+      print('Cannot open $path');
+      return;
+    }
+
+    final appends = <int>[];
+    final total = rate * _duration.inSeconds;
+    final interval = 1000000 / rate;
+    final clock = Stopwatch()..start();
+    final call = Stopwatch();
+    for (var i = 0; i < total; i++) {
+      // Busy-wait to the next arrival so bursts don't hide the pacing.
+      while (clock.elapsedMicroseconds < i * interval) {}
+      call
+        ..reset()
+        ..start();
+      hotPath.journalAppend(
+        WriteJournalKind.incomingWrite.code,
+        0,
+        4194303,
+        BacnetObjectType.analogValue,
+        i % 1000,
+        BacnetPropertyId.presentValue,
+        0xFFFFFFFF,
+        8,
+        value,
+        _value.length,
+      );
+      appends.add(call.elapsedMicroseconds);
+    }
+    final syncWatch = Stopwatch()..start();
+    hotPath.journalSync(5000);
+    final syncLag = syncWatch.elapsedMicroseconds;
+    hotPath
+      ..journalStats(stats)
+      ..journalClose();
+
+    final s = stats.ref;
+    appends.sort();
+    String at(double q) => '${appends[((appends.length - 1) * q).round()]} us';
+    print(
+      '$rate writes/s: append p50 ${at(0.5)}, p99.9 ${at(0.999)}, '
+      'max ${at(1)}',
+    );
+    print(
+      '  ${s.commits} commits, ${(s.records / s.commits).toStringAsFixed(1)} '
+      'records/commit (max ${s.maxBatchRecords}), '
+      'commit max ${s.maxCommitUs} us, final sync $syncLag us, '
+      'stalls ${s.stalls}, refused ${s.refused}, errors ${s.writeErrors}, '
+      'lost ${s.lostRecords}',
+    );
+
+    final journal = WriteJournalReader(File(path).readAsBytesSync());
+    print(
+      '  read back ${journal.records.length} of ${s.records} records, '
+      '${s.bytes + 8} bytes',
+    );
+  } finally {
+    calloc
+      ..free(stats)
+      ..free(value)
+      ..free(pathPtr);
+  }
+}
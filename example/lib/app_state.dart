@@ -8,6 +8,11 @@ class AppState extends ChangeNotifier {
   AppState() {
     // Enable logging to see what's happening
     _client = BacnetClient(logger: const DeveloperBacnetLogger());
+
+    // Load the native stack and bind the default port while the UI builds.
+    _client.prewarm().catchError((Object e) {
+      debugPrint('⚠️ Prewarm failed, start() will retry: $e');
+    });
   }
 
   late final BacnetClient _client;
@@ -45,7 +50,7 @@ class AppState extends ChangeNotifier {
 
       await _client.start(interface: interface, port: port);
       _isStarted = true;
-      debugPrint('✅ BACnet client started successfully!');
+      debugPrint('✅ BACnet client started: ${_client.startupTimings}');
       notifyListeners();
     } on Exception catch (e, stack) {
       debugPrint('❌ Failed to start BACnet client: $e');
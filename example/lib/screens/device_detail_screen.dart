@@ -18,7 +18,8 @@ class DeviceDetailScreen extends StatefulWidget {
 
 class _DeviceDetailScreenState extends State<DeviceDetailScreen> {
   DiscoveredDevice? _device;
-  List<BacnetObject>? _objects;
+  ObjectBrowser? _browser;
+  final Set<int> _loadingPages = {};
   bool _isLoading = false;
   String? _errorMessage;
 
@@ -49,8 +50,12 @@ class _DeviceDetailScreenState extends State<DeviceDetailScreen> {
     });
 
     try {
-      // Scan device objects
-      _objects = await appState.client.scanDevice(widget.deviceId);
+      // Only the first page is read up front; the rest load as they scroll
+      // into view.
+      final browser = ObjectBrowser(appState.client, widget.deviceId);
+      await browser.page(0);
+      _browser = browser;
+      _loadingPages.clear();
 
       setState(() {
         _isLoading = false;
@@ -153,13 +158,18 @@ class _DeviceDetailScreenState extends State<DeviceDetailScreen> {
       );
     }
 
-    return ListView(
+    final objectCount = _browser?.objectCount ?? 0;
+    return ListView.builder(
       padding: const EdgeInsets.all(16),
-      children: [
-        _buildDeviceInfo(),
-        const SizedBox(height: 24),
-        _buildObjectsList(),
-      ],
+      itemCount: objectCount == 0 ? 2 : objectCount + 2,
+      itemBuilder: (context, index) => switch (index) {
+        0 => Padding(
+          padding: const EdgeInsets.only(bottom: 24),
+          child: _buildDeviceInfo(),
+        ),
+        1 => _buildObjectsHeader(objectCount),
+        _ => _buildObjectTile(index - 2),
+      },
     );
   }
 
@@ -218,62 +228,75 @@ class _DeviceDetailScreenState extends State<DeviceDetailScreen> {
     );
   }
 
-  Widget _buildObjectsList() {
-    if (_objects == null || _objects!.isEmpty) {
+  Widget _buildObjectsHeader(int objectCount) {
+    if (objectCount == 0) {
       return const EmptyStateWidget(
         icon: Icons.inventory_2_outlined,
         title: 'No Objects',
         description: 'This device has no objects or they could not be loaded',
       );
     }
+    return Padding(
+      padding: const EdgeInsets.only(bottom: 8),
+      child: Text(
+        'Objects ($objectCount)',
+        style: Theme.of(context).textTheme.titleLarge,
+      ),
+    );
+  }
 
-    // Group objects by type
-    final groupedObjects = <int, List<BacnetObject>>{};
-    for (final obj in _objects!) {
-      groupedObjects.putIfAbsent(obj.type, () => []).add(obj);
+  Widget _buildObjectTile(int position) {
+    final browser = _browser!;
+    final pageIndex = position ~/ browser.pageSize;
+    final page = browser.cachedPage(pageIndex);
+    if (page == null) {
+      _loadPage(pageIndex);
+      return const ListTile(dense: true, title: Text('Loading…'));
     }
-
-    return Column(
-      crossAxisAlignment: CrossAxisAlignment.start,
-      children: [
-        Text(
-          'Objects (${_objects!.length})',
-          style: Theme.of(context).textTheme.titleLarge,
-        ),
-        const SizedBox(height: 8),
-        ...groupedObjects.entries.map((entry) {
-          final typeName = _getObjectTypeName(entry.key);
-          return Card(
-            margin: const EdgeInsets.only(bottom: 8),
-            child: ExpansionTile(
-              title: Text('$typeName (${entry.value.length})'),
-              children: entry.value.map((obj) {
-                return ListTile(
-                  dense: true,
-                  title: Text('Instance ${obj.instance}'),
-                  subtitle: Text('Type: ${obj.type}'),
-                  trailing: const Icon(Icons.chevron_right, size: 16),
-                  onTap: () {
-                    // Navigate to object monitor screen
-                    Navigator.push(
-                      context,
-                      MaterialPageRoute<void>(
-                        builder: (_) => ObjectMonitorScreen(
-                          deviceId: widget.deviceId,
-                          object: obj,
-                        ),
-                      ),
-                    );
-                  },
-                );
-              }).toList(),
-            ),
-          );
-        }),
-      ],
+    final item = page.objects[position % browser.pageSize];
+    final obj = item.object;
+    final value = item.presentValue;
+    return ListTile(
+      dense: true,
+      title: Text(item.name ?? 'Instance ${obj.instance}'),
+      subtitle: Text('${_getObjectTypeName(obj.type)} ${obj.instance}'),
+      trailing: Row(
+        mainAxisSize: MainAxisSize.min,
+        children: [
+          if (value != null)
+            Text(item.units == null ? '$value' : '$value (${item.units})'),
+          const Icon(Icons.chevron_right, size: 16),
+        ],
+      ),
+      onTap: () {
+        // Navigate to object monitor screen
+        Navigator.push(
+          context,
+          MaterialPageRoute<void>(
+            builder: (_) =>
+                ObjectMonitorScreen(deviceId: widget.deviceId, object: obj),
+          ),
+        );
+      },
     );
   }
 
+  void _loadPage(int pageIndex) {
+    final browser = _browser;
+    if (browser == null || !_loadingPages.add(pageIndex)) return;
+    browser
+        .page(pageIndex)
+        .then<void>(
+          (_) {
+            if (mounted) setState(() {});
+          },
+          onError: (Object e) {
+            debugPrint('Failed to load objects page $pageIndex: $e');
+          },
+        )
+        .whenComplete(() => _loadingPages.remove(pageIndex));
+  }
+
   String _getObjectTypeName(int type) {
     // Map common BACnet object types to readable names
     const typeNames = {
@@ -89,12 +89,16 @@ class _PropertyMonitorWidgetState extends State<PropertyMonitorWidget> {
             if (event.deviceId == widget.deviceId &&
                 event.objectType == widget.objectType &&
                 event.instance == widget.instance) {
-              if (mounted) {
+              if (!mounted) return;
+              if (event.propertyId == widget.propertyId &&
+                  event.value != null) {
                 setState(() {
+                  _currentValue = event.value;
                   _lastUpdate = DateTime.now();
                   _errorMessage = null;
                 });
-                // Trigger a manual read to get the latest value
+              } else {
+                // The notification did not carry this property; read it.
                 _readValue();
               }
             }
@@ -0,0 +1,130 @@
+// ignore_for_file: avoid_print
+import 'dart:ffi' as ffi;
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:bacnet_plugin/bacnet_plugin_bindings.g.dart';
+import 'package:bacnet_plugin/src/native/worker/globals.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:integration_test/integration_test.dart';
+
+const _deviceId = 123456;
+
+/// Requests sent; half ReadProperty, half ReadPropertyMultiple.
+const _requests = 50000;
+
+/// Requests in flight at once, well inside the TSM's invoke IDs.
+const _window = 16;
+
+/// Sites that hold buffers for the worker's lifetime.
+const _longLived = {'workerBuffers', 'bip_init', 'mstp_init'};
+
+/// Soaks the worker's request handlers against its own server.
+///
+/// The server's device is bound at 127.0.0.1, so requests leave through
+/// the socket and come back from an address the stack does not drop as
+/// its own. Every handler allocation must be freed once its request is
+/// answered.
+void main() {
+  IntegrationTestWidgetsFlutterBinding.ensureInitialized();
+
+  testWidgets(
+    'Native memory returns to zero after RP and RPM soak',
+    (WidgetTester tester) async {
+      final server = BacnetServer();
+      final client = BacnetClient();
+      const specs = [
+        BacnetReadAccessSpecification(
+          objectIdentifier: BacnetObject(
+            type: BacnetObjectType.analogValue,
+            instance: 1,
+          ),
+          properties: [
+            BacnetPropertyReference(
+              propertyIdentifier: BacnetPropertyId.presentValue,
+            ),
+            BacnetPropertyReference(
+              propertyIdentifier: BacnetPropertyId.objectName,
+            ),
+          ],
+        ),
+        BacnetReadAccessSpecification(
+          objectIdentifier: BacnetObject(
+            type: BacnetObjectType.device,
+            instance: _deviceId,
+          ),
+          properties: [
+            BacnetPropertyReference(
+              propertyIdentifier: BacnetPropertyId.objectName,
+            ),
+          ],
+        ),
+      ];
+
+      try {
+        await server.start();
+        await server.init(_deviceId, 'SoakDevice');
+        await server.addObject(BacnetObjectType.analogValue, 1);
+        await client.addDeviceBinding(_deviceId, '127.0.0.1');
+
+        // Fails here if loopback requests are not answered at all.
+        await client
+            .readProperty(
+              _deviceId,
+              BacnetObjectType.analogValue,
+              1,
+              BacnetPropertyId.presentValue,
+            )
+            .timeout(const Duration(seconds: 5));
+        final before = (await client.getMetrics()).nativeMemory;
+
+        final stopwatch = Stopwatch()..start();
+        for (var sent = 0; sent < _requests; sent += _window) {
+          await Future.wait([
+            for (var i = 0; i < _window ~/ 2; i++) ...[
+              client.readProperty(
+                _deviceId,
+                BacnetObjectType.analogValue,
+                1,
+                BacnetPropertyId.presentValue,
+              ),
+              client.readMultiple(_deviceId, specs),
+            ],
+          ]);
+        }
+        print(
+          'Soak: $_requests requests in ${stopwatch.elapsedMilliseconds} ms',
+        );
+
+        final after = (await client.getMetrics()).nativeMemory;
+        for (final MapEntry(key: site, value: stats) in after.entries) {
+          expect(
+            stats.liveAllocations,
+            equals(
+              _longLived.contains(site)
+                  ? before[site]?.liveAllocations ?? 0
+                  : 0,
+            ),
+            reason: 'live allocations at $site',
+          );
+        }
+
+        // One request's structures and PDU buffer at a time, however many
+        // were sent.
+        final rpm = after['handleReadPropMultiple']!;
+        expect(rpm.allocations, greaterThanOrEqualTo(6 * _requests ~/ 2));
+        expect(rpm.liveBytes, equals(0));
+        expect(
+          rpm.peakBytes,
+          equals(
+            2 * ffi.sizeOf<BACNET_READ_ACCESS_DATA>() +
+                3 * ffi.sizeOf<BACNET_PROPERTY_REFERENCE>() +
+                maxAPDU,
+          ),
+        );
+      } finally {
+        client.dispose();
+      }
+    },
+    timeout: const Timeout(Duration(minutes: 10)),
+  );
+}
@@ -0,0 +1,145 @@
+import 'dart:ffi' as ffi;
+import 'dart:io';
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:bacnet_plugin/bacnet_plugin_bindings.g.dart';
+import 'package:bacnet_plugin/src/native/worker/globals.dart';
+import 'package:bacnet_plugin/src/native/worker/hot_path_bindings.dart';
+import 'package:ffi/ffi.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:integration_test/integration_test.dart';
+
+/// Application-tagged Real 21.5.
+const _real = [0x44, 0x41, 0xAC, 0x00, 0x00];
+
+/// Application-tagged Enumerated 1 (active).
+const _active = [0x91, 0x01];
+
+const _null = [0x00];
+
+const _arrayAll = 0xFFFFFFFF;
+
+/// Round-trips commanded objects through the native image snapshot.
+///
+/// Drives the stack directly, without a worker or a socket.
+void main() {
+  IntegrationTestWidgetsFlutterBinding.ensureInitialized();
+  final nativeLibrary = openBacnetLibrary();
+
+  group('Server image', () {
+    late BacnetBindings native;
+    late HotPathBindings hot;
+    late Directory dir;
+
+    bool write(int type, int instance, List<int> value, int priority) {
+      final data = calloc<BACNET_WRITE_PROPERTY_DATA>();
+      try {
+        data.ref
+          ..object_typeAsInt = type
+          ..object_instance = instance
+          ..object_propertyAsInt = BacnetPropertyId.presentValue
+          ..array_index = _arrayAll
+          ..priority = priority
+          ..application_data_len = value.length;
+        for (var i = 0; i < value.length; i++) {
+          data.ref.application_data[i] = value[i];
+        }
+        return native.Device_Write_Property(data);
+      } finally {
+        calloc.free(data);
+      }
+    }
+
+    List<int> read(int type, int instance, int property, int index) {
+      final data = calloc<BACNET_READ_PROPERTY_DATA>();
+      final value = calloc<ffi.Uint8>(maxAPDU);
+      try {
+        data.ref
+          ..object_typeAsInt = type
+          ..object_instance = instance
+          ..object_propertyAsInt = property
+          ..array_index = index
+          ..application_data = value
+          ..application_data_len = maxAPDU;
+        final len = native.Device_Read_Property(data);
+        return len > 0 ? value.asTypedList(len).toList() : const [];
+      } finally {
+        calloc
+          ..free(value)
+          ..free(data);
+      }
+    }
+
+    List<int> slot(int type, int instance, int priority) =>
+        read(type, instance, BacnetPropertyId.priorityArray, priority);
+
+    int image(
+      int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<BacnetPluginImageStats>)
+      call,
+      String path,
+    ) {
+      final pathPtr = path.toNativeUtf8();
+      final stats = calloc<BacnetPluginImageStats>();
+      try {
+        return call(pathPtr.cast(), stats);
+      } finally {
+        calloc
+          ..free(stats)
+          ..free(pathPtr);
+      }
+    }
+
+    setUp(() {
+      native = BacnetBindings(nativeLibrary);
+      hot = HotPathBindings(nativeLibrary);
+      dir = Directory.systemTemp.createTempSync('bacnet_image_');
+
+      final name = 'Image test'.toNativeUtf8();
+      native
+        ..Device_Set_Object_Instance_Number(4194000)
+        ..Device_Object_Name_ANSI_Init(name.cast())
+        ..Device_Init(ffi.nullptr);
+      calloc.free(name);
+      hot
+        ..serverCovInit()
+        ..serverIAmInit();
+
+      final create = calloc<BACNET_CREATE_OBJECT_DATA>();
+      for (final type in [
+        BacnetObjectType.analogOutput,
+        BacnetObjectType.binaryOutput,
+      ]) {
+        create.ref
+          ..object_typeAsInt = type
+          ..object_instance = 1;
+        native.Device_Create_Object(create);
+      }
+      calloc.free(create);
+    });
+
+    tearDown(() => dir.deleteSync(recursive: true));
+
+    test('Restores commanded priority array slots', () {
+      const ao = BacnetObjectType.analogOutput;
+      const bo = BacnetObjectType.binaryOutput;
+      expect(write(ao, 1, _real, 8), isTrue);
+      expect(write(bo, 1, _active, 5), isTrue);
+
+      final path = '${dir.path}/server.img';
+      expect(image(hot.serverSnapshot, path), 0);
+
+      // Relinquish, so only the image can bring the commands back.
+      write(ao, 1, _null, 8);
+      write(bo, 1, _null, 5);
+      expect(slot(ao, 1, 8), _null);
+      expect(slot(bo, 1, 5), _null);
+
+      expect(image(hot.serverRestore, path), 0);
+      expect(slot(ao, 1, 8), _real);
+      expect(slot(bo, 1, 5), _active);
+      expect(slot(ao, 1, 16), _null);
+      expect(read(ao, 1, BacnetPropertyId.presentValue, _arrayAll), _real);
+      expect(read(bo, 1, BacnetPropertyId.presentValue, _arrayAll), _active);
+    });
+  });
+}
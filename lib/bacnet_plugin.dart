@@ -4,18 +4,32 @@ export 'src/client/bacnet_client.dart';
 export 'src/constants/error_codes.dart';
 export 'src/constants/object_types.dart';
 export 'src/constants/property_ids.dart';
+export 'src/core/admission_control.dart';
 export 'src/core/bacnet_config.dart';
 export 'src/core/logger.dart';
+export 'src/core/read_hedging.dart';
 export 'src/core/types.dart';
 // Models
+export 'src/models/bacnet_metrics.dart';
 export 'src/models/bacnet_object.dart';
 export 'src/models/device_metadata.dart';
 export 'src/models/discovered_device.dart';
 export 'src/models/internal/worker_message.dart';
+export 'src/models/packet_filter.dart';
+export 'src/models/priority_array.dart';
 export 'src/models/property_update.dart';
+export 'src/models/server_image.dart';
+export 'src/models/startup_timings.dart';
 export 'src/models/trend_log_data.dart';
 export 'src/models/wpm_models.dart';
+export 'src/models/write_journal.dart';
 export 'src/server/bacnet_server.dart';
 // Utilities
+export 'src/utilities/binding_refresher.dart';
 export 'src/utilities/device_scanner.dart';
+export 'src/utilities/inventory_job.dart';
+export 'src/utilities/object_browser.dart';
 export 'src/utilities/property_monitor.dart';
+export 'src/utilities/request_budget.dart';
+export 'src/utilities/scatter_gather.dart';
+export 'src/utilities/trend_log_backfill.dart';
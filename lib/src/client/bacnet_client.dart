@@ -4,12 +4,17 @@ import 'package:bacnet_plugin/bacnet_plugin.dart';
 
 import '../native/bacnet_system.dart';
 
+export '../core/admission_control.dart';
 export '../core/exceptions.dart';
 export '../core/logger.dart';
 export '../core/types.dart';
+export '../models/bacnet_metrics.dart';
 export '../models/bacnet_object.dart';
 export '../models/internal/worker_message.dart';
+export '../models/packet_filter.dart';
+export '../models/priority_array.dart';
 export '../models/rpm_models.dart';
+export '../models/startup_timings.dart';
 export '../models/trend_log_data.dart';
 export '../models/wpm_models.dart';
 
@@ -77,10 +82,100 @@ class BacnetClient {
   /// [interface] is the local network interface IP to bind to. If null,
   /// binds to all interfaces.
   /// [port] is the UDP port for BACnet/IP (default: 47808).
-  Future<void> start({String? interface, int port = 47808}) async {
-    await _system.start(interface: interface, port: port);
+  /// [mstp] runs the stack as an MS/TP master node on a serial port instead
+  /// of on BACnet/IP; [interface] and [port] are then ignored. Starting
+  /// fails if the native library was built without MS/TP.
+  /// [mode] set to [BacnetExecutionMode.direct] runs the stack on the
+  /// calling isolate instead of a worker, saving the two isolate hops per
+  /// request; use it for command-line tools, not on a UI isolate.
+  ///
+  /// Example:
+  /// ```dart
+  /// await client.start(
+  ///   mstp: const MstpConfig(serialPort: '/dev/ttyUSB0', baudRate: 76800),
+  /// );
+  /// ```
+  Future<void> start({
+    String? interface,
+    int port = 47808,
+    MstpConfig? mstp,
+    BacnetExecutionMode mode = BacnetExecutionMode.worker,
+  }) async {
+    await _system.start(
+      interface: interface,
+      port: port,
+      mstp: mstp,
+      mode: mode,
+    );
+  }
+
+  /// Spawns the worker isolate, loads the native library and binds the
+  /// socket ahead of [start].
+  ///
+  /// Call during app launch; a later [start] with the same [interface] and
+  /// [port] then completes without paying the startup cost.
+  Future<void> prewarm({
+    String? interface,
+    int port = 47808,
+    MstpConfig? mstp,
+    BacnetExecutionMode mode = BacnetExecutionMode.worker,
+  }) async {
+    await _system.prewarm(
+      interface: interface,
+      port: port,
+      mstp: mstp,
+      mode: mode,
+    );
+  }
+
+  /// Per-phase breakdown of the most recent worker startup.
+  ///
+  /// Null until the worker has started once.
+  BacnetStartupTimings? get startupTimings => _system.startupTimings;
+
+  /// Fetches a snapshot of the worker's runtime counters.
+  ///
+  /// Includes native memory held by the worker per allocation site, which
+  /// should stay flat under a steady request load.
+  Future<BacnetMetrics> getMetrics() async {
+    return _system.getMetrics();
+  }
+
+  /// Replaces the native receive pre-filter.
+  ///
+  /// Dropped packets never reach the stack's handlers or the worker
+  /// isolate; counts are reported in [BacnetMetrics.packetFilter]. Pass
+  /// [BacnetPacketFilter.allowAll] to remove every rule.
+  Future<void> setPacketFilter(BacnetPacketFilter filter) async {
+    await _system.send(SetPacketFilterRequest(filter));
   }
 
+  /// Applies a real-time profile to the thread that runs the stack, or
+  /// with null restores normal scheduling.
+  ///
+  /// See [RealtimeProfile] for what each setting does and needs; check
+  /// [BacnetMetrics.realtime] for what took effect. The profile is
+  /// reapplied if the worker restarts.
+  Future<void> setRealtimeProfile(RealtimeProfile? profile) async {
+    await _system.send(SetRealtimeProfileRequest(profile));
+  }
+
+  /// Hedges [readProperty] and [readMultiple] with [policy], or with null
+  /// stops hedging.
+  ///
+  /// A read that has not been answered after the device's usual p95 round
+  /// trip is sent once more and the first answer wins, within a per-device
+  /// and global budget; see [ReadHedger]. Only reads are hedged, since they
+  /// are safe to repeat. [BacnetMetrics.hedging] reports the tail latency
+  /// with and without the hedges.
+  ///
+  /// Example:
+  /// ```dart
+  /// client.setReadHedging(const ReadHedgingPolicy());
+  /// ```
+  void setReadHedging(ReadHedgingPolicy? policy) =>
+      _system.setReadHedging(policy);
+
   /// Sends a Who-Is broadcast to discover BACnet devices.
   ///
   /// [lowLimit] and [highLimit] optionally limit the device ID range.
@@ -91,6 +186,29 @@ class BacnetClient {
     await _system.send(WhoIsRequest(lowLimit: lowLimit, highLimit: highLimit));
   }
 
+  /// Sends a Who-Is with low = high = device ID, unicast to the cached
+  /// address of each of [deviceIds].
+  ///
+  /// Devices answer with an I-Am on [events] as usual. Unlike [sendWhoIs],
+  /// nothing is broadcast, so the rest of the network is not disturbed.
+  /// Returns the devices that have no cached address and were skipped. Use
+  /// [refreshBindings] to refresh many devices paced and in batches.
+  Future<List<int>> sendDirectedWhoIs(List<int> deviceIds) =>
+      _system.sendDirectedWhoIs(deviceIds);
+
+  /// Refreshes the bindings of known devices with directed Who-Is.
+  ///
+  /// A convenience for a one-off [BindingRefresher.refresh]; keep a
+  /// [BindingRefresher] to track unreachable devices across runs.
+  ///
+  /// Example:
+  /// ```dart
+  /// final report = await client.refreshBindings(knownDeviceIds);
+  /// print('Unreachable: ${report.missed}');
+  /// ```
+  Future<BindingRefreshReport> refreshBindings(Iterable<int> deviceIds) =>
+      BindingRefresher(this, missesBeforeUnreachable: 1).refresh(deviceIds);
+
   /// Reads a single property from a BACnet object.
   ///
   /// [deviceId] is the target device ID.
@@ -98,9 +216,13 @@ class BacnetClient {
   /// [instance] is the object instance number.
   /// [propertyId] is the property identifier (use [BacnetPropertyId] constants).
   /// [arrayIndex] is the optional array index for array properties (-1 for non-arrays).
+  /// [priority] is the admission class; pass
+  /// [BacnetRequestPriority.background] for polls and scans so they are shed
+  /// before interactive reads under overload.
   ///
   /// Returns the property value. Throws [BacnetTimeoutException] if no response
-  /// is received within the timeout period.
+  /// is received within the timeout period, or [BacnetOverloadException] if
+  /// a background read is shed.
   ///
   /// Example:
   /// ```dart
@@ -117,6 +239,7 @@ class BacnetClient {
     int instance,
     int propertyId, {
     int arrayIndex = -1,
+    BacnetRequestPriority priority = BacnetRequestPriority.interactive,
   }) async {
     return _system.sendReadProperty(
       deviceId,
@@ -124,6 +247,7 @@ class BacnetClient {
       instance,
       propertyId,
       arrayIndex: arrayIndex,
+      priority: priority,
     );
   }
 
@@ -135,7 +259,18 @@ class BacnetClient {
   /// [deviceId] is the target device ID.
   /// [specs] is a list of [BacnetReadAccessSpecification] defining what to read.
   ///
-  /// Returns a map of object identifiers to property maps.
+  /// Returns a map of object identifiers to property maps. A property
+  /// requested at several array indexes of one object maps to a
+  /// `Map<int, dynamic>` from array index to value.
+  ///
+  /// The special property identifiers [BacnetPropertyId.all],
+  /// [BacnetPropertyId.required] and [BacnetPropertyId.optional] are
+  /// supported; see [readObjectProperties]. If the device aborts the
+  /// request as too large (buffer overflow, segmentation not supported or
+  /// APDU too long) or rejects it with a buffer overflow, it is retried as
+  /// one request per object and the results are merged. Other failures,
+  /// including requests that could not be sent, are rethrown. [priority]
+  /// is the admission class, as in [readProperty].
   ///
   /// Example:
   /// ```dart
@@ -152,9 +287,150 @@ class BacnetClient {
   /// ```
   Future<Map<String, Map<int, dynamic>>> readMultiple(
     int deviceId,
-    List<BacnetReadAccessSpecification> specs,
-  ) async {
-    return _system.sendReadPropertyMultiple(deviceId, specs);
+    List<BacnetReadAccessSpecification> specs, {
+    BacnetRequestPriority priority = BacnetRequestPriority.interactive,
+  }) async {
+    try {
+      return await _system.sendReadPropertyMultiple(
+        deviceId,
+        specs,
+        priority: priority,
+      );
+    } on BacnetException catch (e) {
+      if (specs.length < 2 || !_isTooLarge(e)) rethrow;
+      log(
+        BacnetLogLevel.info,
+        'RPM to device $deviceId too large ($e), '
+        'splitting into ${specs.length} requests',
+      );
+      final results = <String, Map<int, dynamic>>{};
+      for (final spec in specs) {
+        results.addAll(
+          await readMultiple(deviceId, [spec], priority: priority),
+        );
+      }
+      return results;
+    }
+  }
+
+  static bool _isTooLarge(BacnetException e) => switch (e) {
+    BacnetAbortException(:final reason) =>
+      BacnetAbortReason.isResponseTooLarge(reason),
+    BacnetRejectException(:final reason) =>
+      reason == BacnetRejectReason.bufferOverflow,
+    _ => false,
+  };
+
+  /// Reads [points] spread over any number of devices and streams each
+  /// result as soon as its device answers.
+  ///
+  /// Points are grouped per device into ReadPropertyMultiple requests of up
+  /// to [maxPointsPerRequest] points, sent concurrently with at most
+  /// [perDevice] outstanding per device and, if given, within the shared
+  /// [budget] (32 outstanding requests otherwise). Each point yields one
+  /// [PointReading], carrying either its value or its own error; the stream
+  /// closes once every point is reported. Points still outstanding after
+  /// [deadline] are reported with a [BacnetTimeoutException].
+  ///
+  /// Example:
+  /// ```dart
+  /// final readings = client.readMany([
+  ///   for (final id in deviceIds) PointRef(id, BacnetObjectType.analogInput, 1),
+  /// ], deadline: const Duration(seconds: 5));
+  /// await for (final reading in readings) {
+  ///   if (reading.hasValue) print('${reading.point}: ${reading.value}');
+  /// }
+  /// ```
+  Stream<PointReading> readMany(
+    List<PointRef> points, {
+    Duration? deadline,
+    RequestBudget? budget,
+    int perDevice = 2,
+    int maxPointsPerRequest = 16,
+    BacnetRequestPriority priority = BacnetRequestPriority.interactive,
+  }) => ScatterGatherReader(
+    this,
+    budget: budget,
+    perDevice: perDevice,
+    maxPointsPerRequest: maxPointsPerRequest,
+    priority: priority,
+  ).read(points, deadline: deadline);
+
+  /// Reads a whole property set of each object with one RPM.
+  ///
+  /// [propertySet] is [BacnetPropertyId.all] (default),
+  /// [BacnetPropertyId.required] or [BacnetPropertyId.optional]. The device
+  /// expands it, so every property comes back without listing them. Large
+  /// responses are split per object as described in [readMultiple].
+  ///
+  /// Example:
+  /// ```dart
+  /// final props = await client.readObjectProperties(1234, [
+  ///   BacnetObject(type: BacnetObjectType.analogInput, instance: 1),
+  /// ]);
+  /// ```
+  Future<Map<String, Map<int, dynamic>>> readObjectProperties(
+    int deviceId,
+    List<BacnetObject> objects, {
+    int propertySet = BacnetPropertyId.all,
+  }) {
+    if (propertySet != BacnetPropertyId.all &&
+        propertySet != BacnetPropertyId.required &&
+        propertySet != BacnetPropertyId.optional) {
+      throw ArgumentError.value(
+        propertySet,
+        'propertySet',
+        'Must be ALL, REQUIRED or OPTIONAL',
+      );
+    }
+    return readMultiple(deviceId, [
+      for (final object in objects)
+        BacnetReadAccessSpecification(
+          objectIdentifier: object,
+          properties: [BacnetPropertyReference(propertyIdentifier: propertySet)],
+        ),
+    ]);
+  }
+
+  /// Reads the 16-slot `priority_array` and `relinquish_default` of many
+  /// commandable objects on one device.
+  ///
+  /// Objects are read [batchSize] at a time with one RPM per batch; a batch
+  /// the device reports as too large is retried per object. Each result
+  /// carries the active priority and the value currently in control, which
+  /// makes it easy to audit who is overriding an output.
+  ///
+  /// Example:
+  /// ```dart
+  /// final arrays = await client.readPriorityArrays(1234, [
+  ///   BacnetObject(type: BacnetObjectType.analogOutput, instance: 1),
+  ///   BacnetObject(type: BacnetObjectType.binaryOutput, instance: 3),
+  /// ]);
+  /// final overridden = arrays.where((a) => (a.activePriority ?? 17) < 8);
+  /// ```
+  Future<List<BacnetPriorityArray>> readPriorityArrays(
+    int deviceId,
+    List<BacnetObject> objects, {
+    int batchSize = 16,
+  }) async {
+    final results = <BacnetPriorityArray>[];
+    for (var i = 0; i < objects.length; i += batchSize) {
+      final batch = objects.sublist(
+        i,
+        i + batchSize > objects.length ? objects.length : i + batchSize,
+      );
+      try {
+        results.addAll(await _system.sendReadPriorityArrays(deviceId, batch));
+      } on BacnetException catch (e) {
+        if (batch.length < 2 || !_isTooLarge(e)) rethrow;
+        for (final object in batch) {
+          results.addAll(
+            await _system.sendReadPriorityArrays(deviceId, [object]),
+          );
+        }
+      }
+    }
+    return results;
   }
 
   /// Writes a value to a BACnet property.
@@ -167,6 +443,11 @@ class BacnetClient {
   /// [priority] is the write priority (1-16, default: 16).
   /// [tag] is the BACnet application tag for the value (default: 4 for real).
   ///
+  /// Completes when the device acknowledges the write. Throws a
+  /// [BacnetProtocolException] if the device answers with an Error PDU.
+  /// Throws a [BacnetRequestNotSentException] without sending if an open
+  /// write journal cannot record the write.
+  ///
   /// Example:
   /// ```dart
   /// await client.writeProperty(
@@ -187,16 +468,14 @@ class BacnetClient {
     int priority = 16,
     int tag = 4,
   }) async {
-    await _system.send(
-      WritePropertyRequest(
-        deviceId: deviceId,
-        objectType: objectType,
-        instance: instance,
-        propertyId: propertyId,
-        value: value,
-        priority: priority,
-        tag: tag,
-      ),
+    await _system.sendWriteProperty(
+      deviceId,
+      objectType,
+      instance,
+      propertyId,
+      value,
+      priority: priority,
+      tag: tag,
     );
   }
 
@@ -296,26 +575,79 @@ class BacnetClient {
   /// [objectType] is the object type to subscribe to.
   /// [instance] is the object instance number.
   /// [propId] is the property ID to monitor (default: 85 for Present Value).
+  /// [confirmed] asks the device for confirmed notifications, which it
+  /// retries until acknowledged.
+  /// [lifetime] is the subscription lifetime in seconds (0 for indefinite);
+  /// renew the subscription before it runs out.
+  /// [covIncrement] is the minimum change of an analog value that triggers
+  /// a notification; null uses the object's own COV_Increment. Raising it
+  /// on noisy sensors is the cheapest way to cut COV traffic.
+  ///
+  /// Completes when the device accepts the subscription. Throws a
+  /// [BacnetProtocolException] if it refuses (for example, not a COV
+  /// property).
+  ///
+  /// Example:
+  /// ```dart
+  /// await client.subscribeCOV(
+  ///   1234,
+  ///   BacnetObjectType.analogInput,
+  ///   1,
+  ///   lifetime: 600,
+  ///   covIncrement: 0.5,
+  /// );
+  /// ```
   Future<void> subscribeCOV(
     int deviceId,
     int objectType,
     int instance, {
     int propId = 85,
+    bool confirmed = false,
+    int lifetime = 120,
+    double? covIncrement,
   }) async {
-    await _system.send(
-      SubscribeCOVRequest(
-        deviceId: deviceId,
-        objectType: objectType,
-        instance: instance,
-        propertyId: propId,
-      ),
+    if (lifetime < 0) {
+      throw ArgumentError.value(lifetime, 'lifetime', 'Must not be negative');
+    }
+    if (covIncrement != null && covIncrement < 0) {
+      throw ArgumentError.value(
+        covIncrement,
+        'covIncrement',
+        'Must not be negative',
+      );
+    }
+    await _system.sendSubscribeCOV(
+      deviceId,
+      objectType,
+      instance,
+      propertyId: propId,
+      confirmed: confirmed,
+      lifetime: lifetime,
+      covIncrement: covIncrement,
     );
   }
 
-  /// Retrieves trend log data from a Trend Log object.
+  /// Cancels a subscription made with [subscribeCOV].
   ///
-  /// Note: This is currently a stub implementation and returns empty data.
-  /// Full implementation is planned for a future update.
+  /// [deviceId], [objectType], [instance] and [propId] identify the
+  /// subscription, as passed to [subscribeCOV]. The subscription stops
+  /// being renewed after a worker restart as soon as this is called.
+  /// Completes when the device acknowledges the cancellation.
+  Future<void> unsubscribeCOV(
+    int deviceId,
+    int objectType,
+    int instance, {
+    int propId = 85,
+  }) => _system.sendUnsubscribeCOV(
+    deviceId,
+    objectType,
+    instance,
+    propertyId: propId,
+  );
+
+  /// Retrieves the last 10 records of a Trend Log object.
+  ///
+  /// Use [readTrendLog] to read a given interval.
   ///
   /// [deviceId] is the device ID.
   /// [instance] is the trend log object instance.
@@ -344,24 +676,76 @@ class BacnetClient {
       // If count is negative, reference is starting index (counting backwards).
     );
 
-    // Convert raw data to TrendLogEntries
-    // Note: Manual parsing in onReadRangeAck is currently limited.
-    // Assuming data contains parsed maps if successful.
+    return _toTrendLogData(response);
+  }
+
+  /// Reads records from a Trend Log's log buffer with ReadRange.
+  ///
+  /// With [since], reads up to [count] records logged after that time (in
+  /// the device's local time). With [afterSequence], reads up to [count]
+  /// records following that sequence number. Otherwise reads the first
+  /// [count] records by position. [TrendLogData.moreItems] tells whether
+  /// another read is needed; continue with the last entry's
+  /// [TrendLogEntry.sequenceNumber].
+  ///
+  /// Example:
+  /// ```dart
+  /// final log = await client.readTrendLog(
+  ///   1234,
+  ///   1,
+  ///   since: DateTime.now().subtract(const Duration(hours: 1)),
+  /// );
+  /// ```
+  Future<TrendLogData> readTrendLog(
+    int deviceId,
+    int instance, {
+    DateTime? since,
+    int? afterSequence,
+    int count = 100,
+    BacnetRequestPriority priority = BacnetRequestPriority.interactive,
+  }) async {
+    if (count <= 0) {
+      throw ArgumentError.value(count, 'count', 'Must be positive');
+    }
+    final (requestType, reference) = switch ((since, afterSequence)) {
+      (final DateTime time, _) => (4, time),
+      (_, final int sequence) => (2, sequence + 1),
+      _ => (1, 1),
+    };
+    final response = await _system.sendReadRange(
+      deviceId,
+      objectType: BacnetObjectType.trendLog,
+      instance: instance,
+      propertyId: BacnetPropertyId.logBuffer,
+      requestType: requestType,
+      reference: reference,
+      count: count,
+      priority: priority,
+    );
+    return _toTrendLogData(response);
+  }
+
+  static TrendLogData _toTrendLogData(ReadRangeAckResponse response) {
+    final first = response.firstSequence;
+    final records = response.data is List ? response.data as List : const [];
     final entries = <TrendLogEntry>[];
-    if (response.data is List) {
-      final listData = response.data as List;
-      for (final item in listData) {
-        if (item is Map<String, dynamic>) {
-          // Parse entry
-          // entries.add(TrendLogEntry(...));
-        }
+    for (var i = 0; i < records.length; i++) {
+      final record = records[i];
+      if (record is Map && record['timestamp'] is DateTime) {
+        entries.add(
+          TrendLogEntry.fromRecord(
+            record,
+            sequenceNumber: first == null ? null : first + i,
+          ),
+        );
       }
     }
-
     return TrendLogData(
       itemCount: response.itemCount,
       totalRecords: response.itemCount, // Approximation
       entries: entries,
+      // Result flags bit 2 (MSB first on the wire): more items
+      moreItems: response.resultFlags & 0x20 != 0,
     );
   }
 
@@ -371,6 +755,11 @@ class BacnetClient {
   ///
   /// [deviceId] is the target device ID.
   /// [specs] is a list of [BacnetWriteAccessSpecification] defining what to write.
+  ///
+  /// Completes when the device acknowledges the writes. Throws a
+  /// [BacnetProtocolException] carrying the first failure otherwise.
+  /// Throws a [BacnetRequestNotSentException] without sending if an open
+  /// write journal cannot record the writes.
   Future<void> writeMultiple(
     int deviceId,
     List<BacnetWriteAccessSpecification> specs,
@@ -380,9 +769,15 @@ class BacnetClient {
 
   /// Disposes of the client and releases resources.
   ///
-  /// Stops the worker isolate and closes event streams.
-  /// The client cannot be used after calling dispose.
+  /// Closes event streams and fails pending requests. The worker isolate is
+  /// kept warm so a later [start] reuses the loaded library and bound socket;
+  /// call [shutdown] to stop it entirely.
   void dispose() {
     _system.dispose();
   }
+
+  /// Disposes of the client and stops the worker isolate.
+  void shutdown() {
+    _system.shutdown();
+  }
 }
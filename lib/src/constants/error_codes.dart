@@ -260,3 +260,71 @@ class BacnetErrorCode {
     }
   }
 }
+
+/// BACnet Abort Reason constants.
+///
+/// Reasons carried in an Abort PDU as per ASHRAE Standard 135.
+class BacnetAbortReason {
+  const BacnetAbortReason._();
+
+  /// Other abort reason.
+  static const int other = 0;
+
+  /// The response would not fit in the receiver's buffer.
+  static const int bufferOverflow = 1;
+
+  /// The APDU was not expected in the current transaction state.
+  static const int invalidApduInThisState = 2;
+
+  /// A higher priority task preempted the transaction.
+  static const int preemptedByHigherPriorityTask = 3;
+
+  /// The response needs segmentation, which the peer does not support.
+  static const int segmentationNotSupported = 4;
+
+  /// The response does not fit in the requester's maximum APDU size.
+  static const int apduTooLong = 11;
+
+  /// Returns true if [reason] means the response was too large to send.
+  static bool isResponseTooLarge(int reason) =>
+      reason == bufferOverflow ||
+      reason == segmentationNotSupported ||
+      reason == apduTooLong;
+}
+
+/// BACnet Reject Reason constants.
+///
+/// Reasons carried in a Reject PDU as per ASHRAE Standard 135.
+class BacnetRejectReason {
+  const BacnetRejectReason._();
+
+  /// Other reject reason.
+  static const int other = 0;
+
+  /// The request would not fit in the receiver's buffer.
+  static const int bufferOverflow = 1;
+
+  /// The request's parameters are inconsistent.
+  static const int inconsistentParameters = 2;
+
+  /// A parameter has an invalid data type.
+  static const int invalidParameterDataType = 3;
+
+  /// The request contains an invalid tag.
+  static const int invalidTag = 4;
+
+  /// A required parameter is missing.
+  static const int missingRequiredParameter = 5;
+
+  /// A parameter is out of range.
+  static const int parameterOutOfRange = 6;
+
+  /// The request has too many arguments.
+  static const int tooManyArguments = 7;
+
+  /// An enumeration value is not defined.
+  static const int undefinedEnumeration = 8;
+
+  /// The service is not supported by the device.
+  static const int unrecognizedService = 9;
+}
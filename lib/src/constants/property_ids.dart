@@ -325,6 +325,18 @@ class BacnetPropertyId {
   /// Weekly Schedule property (123).
   static const int weeklySchedule = 123;
 
+  /// Log Buffer property (131).
+  static const int logBuffer = 131;
+
+  /// Log Device Object Property property (132).
+  static const int logDeviceObjectProperty = 132;
+
+  /// Record Count property (141).
+  static const int recordCount = 141;
+
+  /// Total Record Count property (145).
+  static const int totalRecordCount = 145;
+
   /// Returns a human-readable name for the given property identifier.
   static String getName(int propertyId) {
     switch (propertyId) {
@@ -380,6 +392,14 @@ class BacnetPropertyId {
         return 'Protocol Object Types Supported';
       case systemStatus:
         return 'System Status';
+      case logBuffer:
+        return 'Log Buffer';
+      case logDeviceObjectProperty:
+        return 'Log Device Object Property';
+      case recordCount:
+        return 'Record Count';
+      case totalRecordCount:
+        return 'Total Record Count';
       default:
         return 'Property $propertyId';
     }
@@ -0,0 +1,228 @@
+import 'dart:async';
+import 'dart:collection';
+import 'dart:math' as math;
+
+import '../models/bacnet_metrics.dart';
+import 'exceptions.dart';
+
+/// Scheduling class of a request, used by admission control.
+enum BacnetRequestPriority {
+  /// A user is waiting on the result. Served first and never shed.
+  interactive,
+
+  /// Polls, scans and other bulk work. Shed first under overload.
+  background,
+}
+
+/// CoDel-style admission control for requests sent to the worker.
+///
+/// At most [maxInFlight] requests are outstanding; the rest wait in one
+/// FIFO queue per [BacnetRequestPriority], interactive first, and
+/// [reservedInteractive] slots are kept for interactive requests so a
+/// backlog of slow background work cannot block them.
+///
+/// The time each request waits for a slot (its sojourn time) is the
+/// overload signal. Once it has stayed above [target] for a whole
+/// [interval], the controller enters a dropping state: background requests
+/// are shed with [BacnetOverloadException], at a rate that grows with the
+/// square root of the drop count as in CoDel, and new background requests
+/// are rejected on arrival. It leaves the dropping state as soon as a
+/// request gets through within [target].
+class AdmissionController {
+  /// Creates an admission controller.
+  ///
+  /// [clock] returns the current time; tests can inject a fake one.
+  AdmissionController({
+    this.maxInFlight = 32,
+    this.reservedInteractive = 8,
+    this.target = const Duration(milliseconds: 100),
+    this.interval = const Duration(seconds: 1),
+    Duration Function()? clock,
+  }) : assert(reservedInteractive < maxInFlight, 'no background slots'),
+       _clock = clock ?? _monotonicClock();
+
+  /// Maximum outstanding requests.
+  final int maxInFlight;
+
+  /// Slots only interactive requests may use.
+  final int reservedInteractive;
+
+  /// Acceptable standing queueing delay.
+  final Duration target;
+
+  /// How long the delay must stay above [target] before shedding starts.
+  final Duration interval;
+
+  final Duration Function() _clock;
+  final Queue<_Waiter> _interactive = Queue();
+  final Queue<_Waiter> _background = Queue();
+  int _inFlight = 0;
+  int _backgroundInFlight = 0;
+
+  // CoDel state.
+  Duration? _firstAboveTime;
+  bool _dropping = false;
+  Duration _dropNext = Duration.zero;
+  int _dropCount = 0;
+
+  int _admitted = 0;
+  int _shed = 0;
+  int _rejected = 0;
+  Duration _lastSojourn = Duration.zero;
+  Duration _maxInteractiveSojourn = Duration.zero;
+
+  /// Whether background work is currently being shed.
+  bool get isDropping => _dropping;
+
+  /// Current counters.
+  AdmissionStats get stats => AdmissionStats(
+    admitted: _admitted,
+    shed: _shed,
+    rejected: _rejected,
+    inFlight: _inFlight,
+    queued: _interactive.length + _background.length,
+    dropping: _dropping,
+    lastSojourn: _lastSojourn,
+    maxInteractiveSojourn: _maxInteractiveSojourn,
+  );
+
+  /// Waits until a request of [priority] may be sent.
+  ///
+  /// Every successful call must be paired with one [release] call for the
+  /// same priority. Throws [BacnetOverloadException] if the request is shed.
+  Future<void> admit(BacnetRequestPriority priority) {
+    final now = _clock();
+    final background = priority == BacnetRequestPriority.background;
+    if (background && _background.isNotEmpty) {
+      // Judge the standing queue even when no slot has freed up lately.
+      final okToDrop = _observe(now - _background.first.enqueued, now);
+      if (okToDrop && !_dropping) _startDropping(now);
+    }
+    if (background && _dropping) {
+      _rejected++;
+      return Future.error(
+        const BacnetOverloadException('Rejected background request'),
+      );
+    }
+    final waiter = _Waiter(now);
+    (background ? _background : _interactive).add(waiter);
+    _pump();
+    return waiter.completer.future;
+  }
+
+  /// Frees the slot taken by a request of [priority].
+  void release(BacnetRequestPriority priority) {
+    _inFlight--;
+    if (priority == BacnetRequestPriority.background) _backgroundInFlight--;
+    _pump();
+  }
+
+  /// Fails every queued request, for example when the worker stops.
+  void failQueued(Object error) {
+    for (final waiter in [..._interactive, ..._background]) {
+      waiter.completer.completeError(error);
+    }
+    _interactive.clear();
+    _background.clear();
+  }
+
+  void _pump() {
+    while (_inFlight < maxInFlight) {
+      if (_interactive.isNotEmpty) {
+        final waiter = _interactive.removeFirst();
+        // Interactive requests jump the queue, so their wait says nothing
+        // about the standing delay; it is only reported.
+        final sojourn = _clock() - waiter.enqueued;
+        if (sojourn > _maxInteractiveSojourn) {
+          _maxInteractiveSojourn = sojourn;
+        }
+        _dispatch(waiter);
+        continue;
+      }
+      final backgroundSlots = maxInFlight - reservedInteractive;
+      if (_background.isEmpty || _backgroundInFlight >= backgroundSlots) {
+        break;
+      }
+      final waiter = _background.removeFirst();
+      final now = _clock();
+      if (_shouldDrop(now - waiter.enqueued, now)) {
+        _shed++;
+        waiter.completer.completeError(
+          const BacnetOverloadException('Shed queued background request'),
+        );
+        continue;
+      }
+      _backgroundInFlight++;
+      _dispatch(waiter);
+    }
+    if (_interactive.isEmpty && _background.isEmpty) {
+      // An empty queue has no standing delay.
+      _firstAboveTime = null;
+      _dropping = false;
+    }
+  }
+
+  void _dispatch(_Waiter waiter) {
+    _inFlight++;
+    _admitted++;
+    waiter.completer.complete();
+  }
+
+  /// Updates the CoDel state for a background request that waited
+  /// [sojourn]; returns true if it should be shed.
+  bool _shouldDrop(Duration sojourn, Duration now) {
+    final okToDrop = _observe(sojourn, now);
+    if (!_dropping) {
+      if (!okToDrop) return false;
+      _startDropping(now);
+      return true;
+    }
+    if (now >= _dropNext) {
+      _dropCount++;
+      _dropNext = _controlLaw(_dropNext);
+      return true;
+    }
+    return false;
+  }
+
+  void _startDropping(Duration now) {
+    _dropping = true;
+    // Resume near the previous rate if we were dropping recently.
+    _dropCount = _dropCount > 2 && now - _dropNext < interval * 16
+        ? _dropCount - 2
+        : 1;
+    _dropNext = _controlLaw(now);
+  }
+
+  /// Tracks how long the background delay has stayed above [target];
+  /// returns true once it has for a whole [interval].
+  bool _observe(Duration sojourn, Duration now) {
+    _lastSojourn = sojourn;
+    if (sojourn < target) {
+      _firstAboveTime = null;
+      _dropping = false;
+      return false;
+    }
+    final firstAbove = _firstAboveTime;
+    if (firstAbove == null) {
+      _firstAboveTime = now + interval;
+      return false;
+    }
+    return now >= firstAbove;
+  }
+
+  Duration _controlLaw(Duration from) =>
+      from + interval * (1 / math.sqrt(_dropCount));
+}
+
+final class _Waiter {
+  _Waiter(this.enqueued);
+
+  final Duration enqueued;
+  final Completer<void> completer = Completer<void>();
+}
+
+Duration Function() _monotonicClock() {
+  final stopwatch = Stopwatch()..start();
+  return () => stopwatch.elapsed;
+}
@@ -23,6 +23,8 @@ class BacnetConfig {
     this.requestTimeout = defaultRequestTimeout,
     this.maxRetries = defaultMaxRetries,
     this.logger = const DeveloperBacnetLogger(),
+    this.mstp,
+    this.executionMode = BacnetExecutionMode.worker,
   });
 
   /// Default BACnet/IP port number.
@@ -57,6 +59,15 @@ class BacnetConfig {
   /// for simple terminal output.
   final BacnetLogger logger;
 
+  /// MS/TP serial port settings, or null for BACnet/IP.
+  ///
+  /// When set, the stack runs as an MS/TP master node on the serial port
+  /// instead of binding [interface] and [port].
+  final MstpConfig? mstp;
+
+  /// Whether the stack runs on a worker isolate or on the caller's isolate.
+  final BacnetExecutionMode executionMode;
+
   /// Creates a copy of this configuration with updated values.
   ///
   /// Any parameters not specified will use the values from this configuration.
@@ -66,6 +77,8 @@ class BacnetConfig {
     Duration? requestTimeout,
     int? maxRetries,
     BacnetLogger? logger,
+    MstpConfig? mstp,
+    BacnetExecutionMode? executionMode,
   }) {
     return BacnetConfig(
       interface: interface ?? this.interface,
@@ -73,16 +86,202 @@ class BacnetConfig {
       requestTimeout: requestTimeout ?? this.requestTimeout,
       maxRetries: maxRetries ?? this.maxRetries,
       logger: logger ?? this.logger,
+      mstp: mstp ?? this.mstp,
+      executionMode: executionMode ?? this.executionMode,
     );
   }
 
   @override
   String toString() {
+    final direct = executionMode == BacnetExecutionMode.direct;
     return 'BacnetConfig('
         'interface: $interface, '
         'port: $port, '
         'timeout: ${requestTimeout.inSeconds}s, '
         'retries: $maxRetries'
+        '${mstp != null ? ', mstp: $mstp' : ''}'
+        '${direct ? ', mode: direct' : ''}'
         ')';
   }
 }
+
+/// Where the BACnet stack runs.
+enum BacnetExecutionMode {
+  /// On a dedicated worker isolate, exchanging messages with the caller.
+  ///
+  /// Keeps socket polling and decoding off the UI isolate; the right choice
+  /// for apps.
+  worker,
+
+  /// On the isolate that starts it, with direct FFI calls.
+  ///
+  /// Requests are sent and replies completed without isolate messages; a
+  /// non-blocking receive loop runs on the caller's event loop every
+  /// millisecond. Meant for command-line tools such as bulk exports, where
+  /// nothing else competes for the isolate. Long decodes delay the caller,
+  /// so avoid it on a UI isolate.
+  direct,
+}
+
+/// Settings of an MS/TP master node on an RS-485 serial port.
+///
+/// Example:
+/// ```dart
+/// await client.start(
+///   mstp: const MstpConfig(
+///     serialPort: '/dev/ttyUSB0',
+///     baudRate: 76800,
+///     macAddress: 3,
+///   ),
+/// );
+/// ```
+class MstpConfig {
+  /// Creates MS/TP settings.
+  const MstpConfig({
+    required this.serialPort,
+    this.baudRate = defaultBaudRate,
+    this.macAddress = 0,
+    this.maxMaster = 127,
+    this.maxInfoFrames = defaultMaxInfoFrames,
+  }) : assert(macAddress >= 0 && macAddress <= 127, 'macAddress is 0-127'),
+       assert(maxMaster >= macAddress && maxMaster <= 127, 'maxMaster'),
+       assert(maxInfoFrames > 0 && maxInfoFrames < 256, 'maxInfoFrames');
+
+  /// Default line rate.
+  static const int defaultBaudRate = 38400;
+
+  /// Default number of frames sent per token hold.
+  static const int defaultMaxInfoFrames = 16;
+
+  /// Line rates defined for MS/TP.
+  static const List<int> baudRates = [9600, 19200, 38400, 57600, 76800, 115200];
+
+  /// Serial device, e.g. '/dev/ttyUSB0' or a pseudo-terminal.
+  final String serialPort;
+
+  /// Line rate; one of [baudRates].
+  final int baudRate;
+
+  /// This node's MAC address on the bus (0-127).
+  final int macAddress;
+
+  /// Highest master MAC address polled for when passing the token.
+  ///
+  /// Set it to the highest address in use to shorten token rotation.
+  final int maxMaster;
+
+  /// Frames this node may send each time it holds the token.
+  ///
+  /// Queued requests beyond this wait for the next token rotation, so a
+  /// client node that sends bursts of requests should keep this well above
+  /// the standard's default of 1.
+  final int maxInfoFrames;
+
+  /// Creates a copy of these settings with updated values.
+  MstpConfig copyWith({
+    String? serialPort,
+    int? baudRate,
+    int? macAddress,
+    int? maxMaster,
+    int? maxInfoFrames,
+  }) {
+    return MstpConfig(
+      serialPort: serialPort ?? this.serialPort,
+      baudRate: baudRate ?? this.baudRate,
+      macAddress: macAddress ?? this.macAddress,
+      maxMaster: maxMaster ?? this.maxMaster,
+      maxInfoFrames: maxInfoFrames ?? this.maxInfoFrames,
+    );
+  }
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is MstpConfig &&
+          serialPort == other.serialPort &&
+          baudRate == other.baudRate &&
+          macAddress == other.macAddress &&
+          maxMaster == other.maxMaster &&
+          maxInfoFrames == other.maxInfoFrames;
+
+  @override
+  int get hashCode =>
+      Object.hash(serialPort, baudRate, macAddress, maxMaster, maxInfoFrames);
+
+  @override
+  String toString() =>
+      'MstpConfig($serialPort @ $baudRate, mac: $macAddress, '
+      'maxMaster: $maxMaster, maxInfoFrames: $maxInfoFrames)';
+}
+
+/// Real-time settings for the thread that runs the BACnet stack.
+///
+/// For control loops that care about jitter more than throughput. Applied
+/// with [BacnetClient.setRealtimeProfile]; each setting is best effort and
+/// [BacnetMetrics.realtime] reports what took effect.
+///
+/// * [cpu] pins the stack thread to one core. Pick a core the rest of the
+///   system leaves alone (e.g. one listed in `isolcpus`).
+/// * [priority] runs it under `SCHED_FIFO`, which needs `CAP_SYS_NICE` or
+///   an `rtprio` limit; without either the thread keeps its normal policy.
+/// * [lockMemory] locks the memory the process has mapped when the profile
+///   is applied with `mlockall`, so the stack's buffers cannot page-fault.
+///   Memory mapped later, such as new Dart heap pages or the per-request
+///   buffers of ReadPropertyMultiple and WritePropertyMultiple, is not
+///   locked. Needs a large enough `memlock` limit.
+/// * [busyPoll] polls the datalink continuously instead of every few
+///   milliseconds. Replies are picked up as they arrive and requests are
+///   sent without waiting out a blocking receive, at the cost of one core
+///   at 100%. The stack thread then never goes idle, so the worker isolate
+///   stays on one VM thread and the profile stays in place.
+///
+/// Example:
+/// ```dart
+/// await client.setRealtimeProfile(
+///   const RealtimeProfile(cpu: 3, priority: 50),
+/// );
+/// ```
+class RealtimeProfile {
+  /// Creates real-time settings.
+  const RealtimeProfile({
+    this.cpu,
+    this.priority = defaultPriority,
+    this.lockMemory = true,
+    this.busyPoll = true,
+  }) : assert(cpu == null || cpu >= 0, 'cpu must not be negative'),
+       assert(priority >= 0 && priority <= 99, 'priority is 0-99');
+
+  /// Default `SCHED_FIFO` priority, just below the 50 Linux gives threaded
+  /// interrupt handlers, so the network card's handlers still preempt the
+  /// stack.
+  static const int defaultPriority = 49;
+
+  /// Core the stack thread is pinned to, or null to leave it unpinned.
+  final int? cpu;
+
+  /// `SCHED_FIFO` priority (1-99), or 0 to keep the normal policy.
+  final int priority;
+
+  /// Whether to lock the process's mapped memory with `mlockall`.
+  final bool lockMemory;
+
+  /// Whether the worker polls the datalink continuously.
+  final bool busyPoll;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is RealtimeProfile &&
+          cpu == other.cpu &&
+          priority == other.priority &&
+          lockMemory == other.lockMemory &&
+          busyPoll == other.busyPoll;
+
+  @override
+  int get hashCode => Object.hash(cpu, priority, lockMemory, busyPoll);
+
+  @override
+  String toString() =>
+      'RealtimeProfile(cpu: $cpu, priority: $priority, '
+      'lockMemory: $lockMemory, busyPoll: $busyPoll)';
+}
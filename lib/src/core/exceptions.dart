@@ -1,3 +1,6 @@
+import '../constants/error_codes.dart';
+import 'types.dart';
+
 /// Base exception class for BACnet operations.
 ///
 /// All BACnet-specific exceptions extend this class.
@@ -52,7 +55,76 @@ class BacnetProtocolException extends BacnetException {
   /// BACnet error code.
   final int errorCode;
 
+  /// The error class and code as a [BacnetError].
+  BacnetError get error => BacnetError(errorClass, errorCode);
+
   @override
   String toString() =>
-      'BacnetProtocolException: $message (class: $errorClass, code: $errorCode)';
+      'BacnetProtocolException: $message '
+      '(${BacnetErrorClass.getName(errorClass)}: '
+      '${BacnetErrorCode.getName(errorCode)})';
+}
+
+/// Exception thrown when a device aborts a confirmed request.
+///
+/// Use [BacnetAbortReason] constants for interpreting [reason].
+class BacnetAbortException extends BacnetException {
+  /// Creates an abort exception.
+  const BacnetAbortException(super.message, {required this.reason});
+
+  /// BACnet abort reason.
+  final int reason;
+
+  @override
+  String toString() => 'BacnetAbortException: $message (reason: $reason)';
+}
+
+/// Exception thrown when a device rejects a confirmed request.
+///
+/// Use [BacnetRejectReason] constants for interpreting [reason].
+class BacnetRejectException extends BacnetException {
+  /// Creates a reject exception.
+  const BacnetRejectException(super.message, {required this.reason});
+
+  /// BACnet reject reason.
+  final int reason;
+
+  @override
+  String toString() => 'BacnetRejectException: $message (reason: $reason)';
+}
+
+/// Exception thrown when the stack could not encode or send a request.
+///
+/// Typically the device has no address binding yet, or the request does not
+/// fit in the device's maximum APDU size.
+class BacnetRequestNotSentException extends BacnetException {
+  /// Creates a request-not-sent exception.
+  const BacnetRequestNotSentException(super.message);
+
+  @override
+  String toString() => 'BacnetRequestNotSentException: $message';
+}
+
+/// Exception thrown when admission control sheds a request under overload.
+///
+/// Only background requests are shed. Retry later, or at a lower rate.
+class BacnetOverloadException extends BacnetException {
+  /// Creates an overload exception.
+  const BacnetOverloadException(super.message);
+
+  @override
+  String toString() => 'BacnetOverloadException: $message';
+}
+
+/// Exception thrown for an in-flight request when the worker isolate died.
+///
+/// Idempotent reads are reissued to the restarted worker instead; writes,
+/// subscriptions and other requests fail with this so the caller can decide
+/// whether repeating them is safe.
+class BacnetWorkerRestartedException extends BacnetException {
+  /// Creates a worker restarted exception.
+  const BacnetWorkerRestartedException(super.message);
+
+  @override
+  String toString() => 'BacnetWorkerRestartedException: $message';
 }
@@ -0,0 +1,332 @@
+import 'dart:async';
+import 'dart:math' as math;
+
+import 'package:meta/meta.dart';
+
+import '../models/bacnet_metrics.dart';
+import 'exceptions.dart';
+
+/// Settings for hedged reads.
+///
+/// Applied with [BacnetClient.setReadHedging]; see [ReadHedger].
+@immutable
+class ReadHedgingPolicy {
+  /// Creates hedging settings.
+  const ReadHedgingPolicy({
+    this.percentile = 0.95,
+    this.minSamples = 20,
+    this.window = 64,
+    this.minDelay = const Duration(milliseconds: 5),
+    this.deviceBudget = 0.1,
+    this.globalBudget = 0.05,
+    this.burst = 5,
+    this.maxInFlight = 8,
+  }) : assert(percentile > 0 && percentile < 1, 'percentile is 0-1'),
+       assert(minSamples > 0 && minSamples <= window, 'minSamples > window'),
+       assert(deviceBudget >= 0 && globalBudget >= 0, 'negative budget'),
+       assert(burst >= 1, 'burst must allow one hedge'),
+       assert(maxInFlight > 0, 'maxInFlight must be positive');
+
+  /// Round-trip percentile of a device after which a read is hedged.
+  final double percentile;
+
+  /// Replies needed from a device before its reads are hedged.
+  final int minSamples;
+
+  /// Most recent round trips kept per device.
+  final int window;
+
+  /// Shortest wait before hedging, for devices that answer in a few
+  /// microseconds on the loopback.
+  final Duration minDelay;
+
+  /// Hedges a device earns per read; 0.1 allows at most one extra request
+  /// per ten reads to that device.
+  final double deviceBudget;
+
+  /// Hedges earned per read across all devices.
+  final double globalBudget;
+
+  /// Most hedges a quiet device (or the whole client) can save up.
+  final double burst;
+
+  /// Most hedges outstanding at once across all devices.
+  final int maxInFlight;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is ReadHedgingPolicy &&
+          percentile == other.percentile &&
+          minSamples == other.minSamples &&
+          window == other.window &&
+          minDelay == other.minDelay &&
+          deviceBudget == other.deviceBudget &&
+          globalBudget == other.globalBudget &&
+          burst == other.burst &&
+          maxInFlight == other.maxInFlight;
+
+  @override
+  int get hashCode => Object.hash(
+    percentile,
+    minSamples,
+    window,
+    minDelay,
+    deviceBudget,
+    globalBudget,
+    burst,
+    maxInFlight,
+  );
+
+  @override
+  String toString() =>
+      'ReadHedgingPolicy(p${(percentile * 100).round()}, '
+      'minSamples: $minSamples, window: $window, '
+      'deviceBudget: $deviceBudget, globalBudget: $globalBudget, '
+      'burst: $burst, maxInFlight: $maxInFlight)';
+}
+
+/// Hedges idempotent reads against slow or lossy devices.
+///
+/// Each read is sent once. If no answer has arrived after the device's
+/// observed [ReadHedgingPolicy.percentile] round trip (p95 by default),
+/// the read is sent a second time, as a separate request with its own
+/// invoke ID, and whichever answer comes first is returned. A BACnet
+/// error, reject or abort is an answer; a timeout of one copy waits for
+/// the other.
+///
+/// Hedging is paid for with tokens. Every read earns
+/// [ReadHedgingPolicy.deviceBudget] for its device and
+/// [ReadHedgingPolicy.globalBudget] for the client, each capped at
+/// [ReadHedgingPolicy.burst], and a hedge spends one of each. Extra load is
+/// therefore bounded by those ratios however badly a device behaves, and
+/// at most [ReadHedgingPolicy.maxInFlight] hedges are outstanding. No
+/// hedge is sent while [canHedge] returns false, for example while
+/// admission control is shedding load.
+///
+/// [stats] compares the latency reads saw with the latency they would have
+/// seen without hedging: the time the first copy took to settle.
+class ReadHedger {
+  /// Creates a hedger.
+  ///
+  /// [clock] returns the current time and [timer] starts the hedge timers;
+  /// tests can inject fake ones.
+  ReadHedger(
+    this.policy, {
+    bool Function()? canHedge,
+    Duration Function()? clock,
+    Timer Function(Duration, void Function())? timer,
+  }) : _canHedge = canHedge ?? _always,
+       _clock = clock ?? _monotonicClock(),
+       _timer = timer ?? Timer.new;
+
+  /// Settings in force.
+  final ReadHedgingPolicy policy;
+
+  final bool Function() _canHedge;
+  final Duration Function() _clock;
+  final Timer Function(Duration, void Function()) _timer;
+  final Map<int, _DeviceState> _devices = {};
+  double _globalTokens = 0;
+
+  int _reads = 0;
+  int _hedged = 0;
+  int _hedgeWins = 0;
+  int _suppressed = 0;
+  int _inFlight = 0;
+  final _Window _latency = _Window(_reportWindow);
+  final _Window _unhedged = _Window(_reportWindow);
+
+  static const int _reportWindow = 1024;
+
+  /// Current counters, with percentiles over the last 1024 reads.
+  HedgingStats get stats => HedgingStats(
+    reads: _reads,
+    hedged: _hedged,
+    hedgeWins: _hedgeWins,
+    suppressed: _suppressed,
+    inFlight: _inFlight,
+    p50: _latency.percentile(0.5),
+    p99: _latency.percentile(0.99),
+    unhedgedP50: _unhedged.percentile(0.5),
+    unhedgedP99: _unhedged.percentile(0.99),
+  );
+
+  /// Delay after which a read of [deviceId] would be hedged now, or null
+  /// while too few of its round trips have been seen.
+  Duration? hedgeDelay(int deviceId) =>
+      _devices[deviceId]?.hedgeDelay(policy);
+
+  /// Runs [attempt], and once more if it is slow, returning the first
+  /// answer.
+  ///
+  /// [attempt] must send a new request each time it is called.
+  Future<T> run<T>(int deviceId, Future<T> Function() attempt) {
+    final device = _devices.putIfAbsent(
+      deviceId,
+      () => _DeviceState(policy.window),
+    );
+    _reads++;
+    device.tokens = math.min(device.tokens + policy.deviceBudget, policy.burst);
+    _globalTokens = math.min(
+      _globalTokens + policy.globalBudget,
+      policy.burst,
+    );
+
+    final read = _HedgedRead<T>(this, device, attempt, _clock());
+    read.launch(hedge: false);
+    final delay = device.hedgeDelay(policy);
+    if (delay != null) read.timer = _timer(delay, read.fire);
+    return read.result.future;
+  }
+
+  bool _tryAcquire(_DeviceState device) {
+    if (device.tokens < 1 ||
+        _globalTokens < 1 ||
+        _inFlight >= policy.maxInFlight ||
+        !_canHedge()) {
+      return false;
+    }
+    device.tokens -= 1;
+    _globalTokens -= 1;
+    return true;
+  }
+}
+
+/// One read and its possible hedge.
+final class _HedgedRead<T> {
+  _HedgedRead(this._hedger, this._device, this._attempt, this._start);
+
+  final ReadHedger _hedger;
+  final _DeviceState _device;
+  final Future<T> Function() _attempt;
+  final Duration _start;
+  final Completer<T> result = Completer<T>();
+  Timer? timer;
+  int _pending = 0;
+  Object? _deferredError;
+  StackTrace? _deferredStack;
+
+  void launch({required bool hedge}) {
+    _pending++;
+    _attempt().then(
+      (value) {
+        _settled(hedge: hedge, answered: true);
+        if (result.isCompleted) return;
+        _finish(hedge: hedge);
+        result.complete(value);
+      },
+      onError: (Object error, StackTrace stackTrace) {
+        final answered = _isAnswer(error);
+        _settled(hedge: hedge, answered: answered);
+        if (result.isCompleted) return;
+        if (!answered && _pending > 0) {
+          // The other copy may still get through.
+          _deferredError ??= error;
+          _deferredStack ??= stackTrace;
+          return;
+        }
+        _finish(hedge: hedge);
+        result.completeError(
+          answered ? error : _deferredError ?? error,
+          answered ? stackTrace : _deferredStack ?? stackTrace,
+        );
+      },
+    );
+  }
+
+  void fire() {
+    timer = null;
+    if (result.isCompleted) return;
+    if (!_hedger._tryAcquire(_device)) {
+      _hedger._suppressed++;
+      return;
+    }
+    _hedger
+      .._hedged += 1
+      .._inFlight += 1;
+    launch(hedge: true);
+  }
+
+  void _settled({required bool hedge, required bool answered}) {
+    _pending--;
+    if (hedge) {
+      _hedger._inFlight--;
+      return;
+    }
+    final elapsed = _hedger._clock() - _start;
+    // Only the first copy's timing reflects the device undisturbed.
+    if (answered) _device.add(elapsed);
+    _hedger._unhedged.add(elapsed);
+  }
+
+  void _finish({required bool hedge}) {
+    timer?.cancel();
+    timer = null;
+    _hedger._latency.add(_hedger._clock() - _start);
+    if (hedge) _hedger._hedgeWins++;
+  }
+
+  static bool _isAnswer(Object error) =>
+      error is! BacnetTimeoutException &&
+      error is! BacnetRequestNotSentException;
+}
+
+final class _DeviceState {
+  _DeviceState(int window) : _rtt = _Window(window);
+
+  final _Window _rtt;
+  double tokens = 0;
+  Duration? _delay;
+  int _sinceEstimate = 0;
+
+  void add(Duration rtt) {
+    _rtt.add(rtt);
+    _sinceEstimate++;
+  }
+
+  Duration? hedgeDelay(ReadHedgingPolicy policy) {
+    if (_rtt.length < policy.minSamples) return null;
+    // Sorting the window on every read would cost more than the read;
+    // the percentile moves slowly, so refresh it every few replies.
+    if (_delay == null || _sinceEstimate >= 8) {
+      final estimate = _rtt.percentile(policy.percentile);
+      _delay = estimate < policy.minDelay ? policy.minDelay : estimate;
+      _sinceEstimate = 0;
+    }
+    return _delay;
+  }
+}
+
+/// The last [capacity] durations, in microseconds.
+final class _Window {
+  _Window(this.capacity);
+
+  final int capacity;
+  final List<int> _samples = [];
+  int _next = 0;
+
+  int get length => _samples.length;
+
+  void add(Duration value) {
+    if (_samples.length < capacity) {
+      _samples.add(value.inMicroseconds);
+    } else {
+      _samples[_next] = value.inMicroseconds;
+      _next = (_next + 1) % capacity;
+    }
+  }
+
+  Duration percentile(double q) {
+    if (_samples.isEmpty) return Duration.zero;
+    final sorted = [..._samples]..sort();
+    return Duration(microseconds: sorted[((sorted.length - 1) * q).round()]);
+  }
+}
+
+bool _always() => true;
+
+Duration Function() _monotonicClock() {
+  final stopwatch = Stopwatch()..start();
+  return () => stopwatch.elapsed;
+}
@@ -0,0 +1,795 @@
+import 'package:meta/meta.dart';
+
+/// Native allocation counters for one allocation site in the worker.
+@immutable
+class NativeMemoryStats {
+  /// Creates allocation counters.
+  const NativeMemoryStats({
+    required this.allocations,
+    required this.frees,
+    required this.liveBytes,
+    required this.peakBytes,
+  });
+
+  /// Number of allocations made at this site.
+  final int allocations;
+
+  /// Number of those allocations that have been freed.
+  final int frees;
+
+  /// Bytes currently allocated and not yet freed.
+  final int liveBytes;
+
+  /// Highest value [liveBytes] has reached.
+  final int peakBytes;
+
+  /// Allocations that have not been freed yet.
+  int get liveAllocations => allocations - frees;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is NativeMemoryStats &&
+          allocations == other.allocations &&
+          frees == other.frees &&
+          liveBytes == other.liveBytes &&
+          peakBytes == other.peakBytes;
+
+  @override
+  int get hashCode => Object.hash(allocations, frees, liveBytes, peakBytes);
+
+  @override
+  String toString() =>
+      'NativeMemoryStats(allocations: $allocations, frees: $frees, '
+      'liveBytes: $liveBytes, peakBytes: $peakBytes)';
+}
+
+/// Counters of the native COV notification handlers.
+///
+/// A rising [retransmits] count means devices are not seeing our
+/// SimpleAcks in time and are resending confirmed notifications.
+@immutable
+class CovStats {
+  /// Creates COV counters.
+  const CovStats({
+    this.received = 0,
+    this.retransmits = 0,
+    this.acked = 0,
+    this.rejected = 0,
+    this.dropped = 0,
+  });
+
+  /// Notifications received, confirmed and unconfirmed.
+  final int received;
+
+  /// Confirmed notifications received again, with the same invoke ID and
+  /// body, within the APDU timeout times retries of the first.
+  final int retransmits;
+
+  /// SimpleAcks sent for confirmed notifications.
+  final int acked;
+
+  /// Confirmed notifications that could not be decoded.
+  final int rejected;
+
+  /// Events dropped because the worker did not drain the queue in time.
+  final int dropped;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is CovStats &&
+          received == other.received &&
+          retransmits == other.retransmits &&
+          acked == other.acked &&
+          rejected == other.rejected &&
+          dropped == other.dropped;
+
+  @override
+  int get hashCode =>
+      Object.hash(received, retransmits, acked, rejected, dropped);
+
+  @override
+  String toString() =>
+      'CovStats(received: $received, retransmits: $retransmits, '
+      'acked: $acked, rejected: $rejected, dropped: $dropped)';
+}
+
+/// Counters of the native receive pre-filter.
+@immutable
+class PacketFilterStats {
+  /// Creates packet filter counters.
+  const PacketFilterStats({
+    this.passed = 0,
+    this.droppedByService = 0,
+    this.droppedBySource = 0,
+    this.droppedNetworkMessages = 0,
+    this.droppedUnconfirmed = const {},
+  });
+
+  /// Packets handed on to the stack.
+  final int passed;
+
+  /// Requests dropped by a service rule.
+  final int droppedByService;
+
+  /// Packets dropped by a source rule.
+  final int droppedBySource;
+
+  /// Network-layer messages dropped.
+  final int droppedNetworkMessages;
+
+  /// Drops per unconfirmed service choice, for choices with any drops.
+  final Map<int, int> droppedUnconfirmed;
+
+  /// All dropped packets.
+  int get dropped =>
+      droppedByService + droppedBySource + droppedNetworkMessages;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is PacketFilterStats &&
+          passed == other.passed &&
+          droppedByService == other.droppedByService &&
+          droppedBySource == other.droppedBySource &&
+          droppedNetworkMessages == other.droppedNetworkMessages;
+
+  @override
+  int get hashCode => Object.hash(
+    passed,
+    droppedByService,
+    droppedBySource,
+    droppedNetworkMessages,
+  );
+
+  @override
+  String toString() =>
+      'PacketFilterStats(passed: $passed, dropped: $dropped, '
+      'byService: $droppedUnconfirmed)';
+}
+
+/// Counters of the server's paced I-Am responses.
+///
+/// [minDelay] to [maxDelay] is the spread other devices see; a rising
+/// [dropped] count means Who-Is requests arrive faster than the configured
+/// I-Am rate.
+@immutable
+class IAmPacingStats {
+  /// Creates I-Am pacing counters.
+  const IAmPacingStats({
+    this.whoIsReceived = 0,
+    this.sent = 0,
+    this.coalesced = 0,
+    this.dropped = 0,
+    this.sendFailed = 0,
+    this.minDelay = Duration.zero,
+    this.maxDelay = Duration.zero,
+    this.meanDelay = Duration.zero,
+  });
+
+  /// Who-Is requests received, for any device range.
+  final int whoIsReceived;
+
+  /// I-Am responses sent.
+  final int sent;
+
+  /// Who-Is requests answered by an I-Am that was already pending.
+  final int coalesced;
+
+  /// Who-Is requests dropped by the rate limit.
+  final int dropped;
+
+  /// I-Am responses the datalink failed to send.
+  final int sendFailed;
+
+  /// Shortest delay between a Who-Is and its I-Am.
+  final Duration minDelay;
+
+  /// Longest delay between a Who-Is and its I-Am.
+  final Duration maxDelay;
+
+  /// Mean delay between a Who-Is and its I-Am.
+  final Duration meanDelay;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is IAmPacingStats &&
+          whoIsReceived == other.whoIsReceived &&
+          sent == other.sent &&
+          coalesced == other.coalesced &&
+          dropped == other.dropped &&
+          sendFailed == other.sendFailed &&
+          minDelay == other.minDelay &&
+          maxDelay == other.maxDelay &&
+          meanDelay == other.meanDelay;
+
+  @override
+  int get hashCode => Object.hash(
+    whoIsReceived,
+    sent,
+    coalesced,
+    dropped,
+    sendFailed,
+    minDelay,
+    maxDelay,
+    meanDelay,
+  );
+
+  @override
+  String toString() =>
+      'IAmPacingStats(whoIs: $whoIsReceived, sent: $sent, '
+      'coalesced: $coalesced, dropped: $dropped, sendFailed: $sendFailed, '
+      'spread: ${minDelay.inMilliseconds}-${maxDelay.inMilliseconds}ms, '
+      'mean: ${meanDelay.inMilliseconds}ms)';
+}
+
+/// Counters of the MS/TP datalink, when the stack runs on MS/TP.
+@immutable
+class MstpStats {
+  /// Creates MS/TP counters.
+  const MstpStats({
+    this.active = false,
+    this.baudRate = 0,
+    this.macAddress = 0,
+    this.maxInfoFrames = 0,
+    this.transmitFrames = 0,
+    this.receiveValidFrames = 0,
+    this.receiveInvalidFrames = 0,
+    this.transmitPdus = 0,
+    this.receivePdus = 0,
+    this.lostTokens = 0,
+  });
+
+  /// Whether MS/TP is the datalink; all other fields are zero otherwise.
+  final bool active;
+
+  /// Serial line rate.
+  final int baudRate;
+
+  /// This node's MAC address.
+  final int macAddress;
+
+  /// Frames this node may send per token hold.
+  final int maxInfoFrames;
+
+  /// Frames sent, including tokens and Poll For Master.
+  final int transmitFrames;
+
+  /// Valid frames seen on the bus, for any station.
+  final int receiveValidFrames;
+
+  /// Frames received with a bad header or data CRC.
+  final int receiveInvalidFrames;
+
+  /// Data frames sent.
+  final int transmitPdus;
+
+  /// Data frames received for this node.
+  final int receivePdus;
+
+  /// Times the token was lost and had to be regenerated.
+  final int lostTokens;
+
+  /// Share of sent frames that carried data rather than token passing.
+  double get dataFrameRatio =>
+      transmitFrames == 0 ? 0 : transmitPdus / transmitFrames;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is MstpStats &&
+          active == other.active &&
+          baudRate == other.baudRate &&
+          macAddress == other.macAddress &&
+          maxInfoFrames == other.maxInfoFrames &&
+          transmitFrames == other.transmitFrames &&
+          receiveValidFrames == other.receiveValidFrames &&
+          receiveInvalidFrames == other.receiveInvalidFrames &&
+          transmitPdus == other.transmitPdus &&
+          receivePdus == other.receivePdus &&
+          lostTokens == other.lostTokens;
+
+  @override
+  int get hashCode => Object.hash(
+    active,
+    baudRate,
+    macAddress,
+    maxInfoFrames,
+    transmitFrames,
+    receiveValidFrames,
+    receiveInvalidFrames,
+    transmitPdus,
+    receivePdus,
+    lostTokens,
+  );
+
+  @override
+  String toString() => active
+      ? 'MstpStats(mac: $macAddress @ $baudRate, '
+            'maxInfoFrames: $maxInfoFrames, txFrames: $transmitFrames, '
+            'txPdus: $transmitPdus, rxPdus: $receivePdus, '
+            'rxValid: $receiveValidFrames, rxInvalid: $receiveInvalidFrames, '
+            'lostTokens: $lostTokens)'
+      : 'MstpStats(inactive)';
+}
+
+/// Counters of the native write journal.
+@immutable
+class WriteJournalStats {
+  /// Creates write journal counters.
+  const WriteJournalStats({
+    this.open = false,
+    this.records = 0,
+    this.refused = 0,
+    this.stalls = 0,
+    this.bytes = 0,
+    this.commits = 0,
+    this.maxBatchRecords = 0,
+    this.lastCommit = Duration.zero,
+    this.maxCommit = Duration.zero,
+    this.rotations = 0,
+    this.writeErrors = 0,
+    this.lostRecords = 0,
+  });
+
+  /// Whether the journal is recording.
+  final bool open;
+
+  /// Writes appended since the journal was opened.
+  final int records;
+
+  /// Writes refused because the journal could not record them: outgoing
+  /// ones were not sent and incoming ones were answered with an error.
+  final int refused;
+
+  /// Writes that waited for a full batch to be committed before they
+  /// could be recorded.
+  final int stalls;
+
+  /// Bytes written and synced to disk.
+  final int bytes;
+
+  /// Batches written, each with a single sync.
+  final int commits;
+
+  /// Most records committed in one batch.
+  final int maxBatchRecords;
+
+  /// Time to write and sync the most recent batch.
+  final Duration lastCommit;
+
+  /// Longest time to write and sync a batch.
+  final Duration maxCommit;
+
+  /// Times the journal file was rotated.
+  final int rotations;
+
+  /// Batches that could not be written or synced.
+  final int writeErrors;
+
+  /// Writes journaled but lost to [writeErrors]; they are not on disk.
+  ///
+  /// Once any are lost, flushing the journal fails until it is reopened.
+  final int lostRecords;
+
+  /// Whether every write journaled since the journal was opened is, or
+  /// will be, on disk.
+  bool get intact => lostRecords == 0;
+
+  /// Mean records per sync.
+  double get recordsPerCommit => commits == 0 ? 0 : records / commits;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is WriteJournalStats &&
+          open == other.open &&
+          records == other.records &&
+          refused == other.refused &&
+          stalls == other.stalls &&
+          bytes == other.bytes &&
+          commits == other.commits &&
+          maxBatchRecords == other.maxBatchRecords &&
+          lastCommit == other.lastCommit &&
+          maxCommit == other.maxCommit &&
+          rotations == other.rotations &&
+          writeErrors == other.writeErrors &&
+          lostRecords == other.lostRecords;
+
+  @override
+  int get hashCode => Object.hash(
+    open,
+    records,
+    refused,
+    stalls,
+    bytes,
+    commits,
+    maxBatchRecords,
+    lastCommit,
+    maxCommit,
+    rotations,
+    writeErrors,
+    lostRecords,
+  );
+
+  @override
+  String toString() =>
+      'WriteJournalStats(open: $open, records: $records, '
+      'refused: $refused, stalls: $stalls, bytes: $bytes, '
+      'commits: $commits, '
+      'maxBatch: $maxBatchRecords, maxCommit: ${maxCommit.inMicroseconds}us, '
+      'rotations: $rotations, writeErrors: $writeErrors, '
+      'lostRecords: $lostRecords)';
+}
+
+/// State of the real-time profile of the stack thread.
+@immutable
+class RealtimeStats {
+  /// Creates real-time profile state.
+  const RealtimeStats({
+    this.cpu,
+    this.priority = 0,
+    this.affinityApplied = false,
+    this.fifoApplied = false,
+    this.memoryLocked = false,
+    this.busyPoll = false,
+    this.threadChanges = 0,
+  });
+
+  /// Core requested for the stack thread, or null for none.
+  final int? cpu;
+
+  /// `SCHED_FIFO` priority requested, or 0 for none.
+  final int priority;
+
+  /// Whether the stack thread is pinned to [cpu].
+  final bool affinityApplied;
+
+  /// Whether the stack thread runs under `SCHED_FIFO`.
+  final bool fifoApplied;
+
+  /// Whether the memory mapped when the profile was applied is locked.
+  final bool memoryLocked;
+
+  /// Whether the worker polls the datalink continuously.
+  final bool busyPoll;
+
+  /// Times the worker isolate moved to another VM thread and the profile
+  /// followed it.
+  final int threadChanges;
+
+  /// Whether every requested setting took effect.
+  bool get fullyApplied =>
+      (cpu == null || affinityApplied) && (priority == 0 || fifoApplied);
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is RealtimeStats &&
+          cpu == other.cpu &&
+          priority == other.priority &&
+          affinityApplied == other.affinityApplied &&
+          fifoApplied == other.fifoApplied &&
+          memoryLocked == other.memoryLocked &&
+          busyPoll == other.busyPoll &&
+          threadChanges == other.threadChanges;
+
+  @override
+  int get hashCode => Object.hash(
+    cpu,
+    priority,
+    affinityApplied,
+    fifoApplied,
+    memoryLocked,
+    busyPoll,
+    threadChanges,
+  );
+
+  @override
+  String toString() =>
+      'RealtimeStats(cpu: $cpu${affinityApplied ? '' : ' (not applied)'}, '
+      'priority: $priority${fifoApplied ? '' : ' (not applied)'}, '
+      'memoryLocked: $memoryLocked, busyPoll: $busyPoll, '
+      'threadChanges: $threadChanges)';
+}
+
+/// Counters of the request admission controller in the main isolate.
+@immutable
+class AdmissionStats {
+  /// Creates admission counters.
+  const AdmissionStats({
+    this.admitted = 0,
+    this.shed = 0,
+    this.rejected = 0,
+    this.inFlight = 0,
+    this.queued = 0,
+    this.dropping = false,
+    this.lastSojourn = Duration.zero,
+    this.maxInteractiveSojourn = Duration.zero,
+  });
+
+  /// Requests sent to the worker.
+  final int admitted;
+
+  /// Queued background requests shed because they waited too long.
+  final int shed;
+
+  /// Background requests rejected on arrival while shedding.
+  final int rejected;
+
+  /// Requests currently outstanding.
+  final int inFlight;
+
+  /// Requests waiting for a slot.
+  final int queued;
+
+  /// Whether background work is being shed right now.
+  final bool dropping;
+
+  /// Queueing delay of the most recent background request.
+  final Duration lastSojourn;
+
+  /// Longest queueing delay any interactive request has seen.
+  final Duration maxInteractiveSojourn;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is AdmissionStats &&
+          admitted == other.admitted &&
+          shed == other.shed &&
+          rejected == other.rejected &&
+          inFlight == other.inFlight &&
+          queued == other.queued &&
+          dropping == other.dropping &&
+          lastSojourn == other.lastSojourn &&
+          maxInteractiveSojourn == other.maxInteractiveSojourn;
+
+  @override
+  int get hashCode => Object.hash(
+    admitted,
+    shed,
+    rejected,
+    inFlight,
+    queued,
+    dropping,
+    lastSojourn,
+    maxInteractiveSojourn,
+  );
+
+  @override
+  String toString() =>
+      'AdmissionStats(admitted: $admitted, shed: $shed, '
+      'rejected: $rejected, inFlight: $inFlight, queued: $queued, '
+      'dropping: $dropping)';
+}
+
+/// Counters of hedged reads in the main isolate.
+///
+/// Percentiles cover the last 1024 reads. [p99] is what reads saw;
+/// [unhedgedP99] is what they would have seen without hedging, taken from
+/// the first copy of each read, which is left to settle even after a hedge
+/// won.
+@immutable
+class HedgingStats {
+  /// Creates hedging counters.
+  const HedgingStats({
+    this.reads = 0,
+    this.hedged = 0,
+    this.hedgeWins = 0,
+    this.suppressed = 0,
+    this.inFlight = 0,
+    this.p50 = Duration.zero,
+    this.p99 = Duration.zero,
+    this.unhedgedP50 = Duration.zero,
+    this.unhedgedP99 = Duration.zero,
+  });
+
+  /// Reads run through the hedger.
+  final int reads;
+
+  /// Hedges sent.
+  final int hedged;
+
+  /// Reads answered by the hedge rather than the first copy.
+  final int hedgeWins;
+
+  /// Hedges not sent because the budget was spent or load was being shed.
+  final int suppressed;
+
+  /// Hedges currently outstanding.
+  final int inFlight;
+
+  /// Median read latency.
+  final Duration p50;
+
+  /// 99th percentile read latency.
+  final Duration p99;
+
+  /// Median latency of the first copies.
+  final Duration unhedgedP50;
+
+  /// 99th percentile latency of the first copies.
+  final Duration unhedgedP99;
+
+  /// Tail latency removed by hedging.
+  Duration get p99Saved => unhedgedP99 - p99;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is HedgingStats &&
+          reads == other.reads &&
+          hedged == other.hedged &&
+          hedgeWins == other.hedgeWins &&
+          suppressed == other.suppressed &&
+          inFlight == other.inFlight &&
+          p50 == other.p50 &&
+          p99 == other.p99 &&
+          unhedgedP50 == other.unhedgedP50 &&
+          unhedgedP99 == other.unhedgedP99;
+
+  @override
+  int get hashCode => Object.hash(
+    reads,
+    hedged,
+    hedgeWins,
+    suppressed,
+    inFlight,
+    p50,
+    p99,
+    unhedgedP50,
+    unhedgedP99,
+  );
+
+  @override
+  String toString() =>
+      'HedgingStats(reads: $reads, hedged: $hedged, wins: $hedgeWins, '
+      'suppressed: $suppressed, p50: ${p50.inMicroseconds}us, '
+      'p99: ${p99.inMicroseconds}us, '
+      'unhedgedP99: ${unhedgedP99.inMicroseconds}us)';
+}
+
+/// Counters of the worker supervisor in the main isolate.
+@immutable
+class SupervisorStats {
+  /// Creates supervisor counters.
+  const SupervisorStats({
+    this.restarts = 0,
+    this.reissuedRequests = 0,
+    this.failedRequests = 0,
+    this.replayedRequests = 0,
+    this.lastRecovery = Duration.zero,
+    this.maxRecovery = Duration.zero,
+    this.lastCause,
+    this.gaveUp = false,
+  });
+
+  /// Completed worker restarts.
+  final int restarts;
+
+  /// In-flight reads sent again to a restarted worker.
+  final int reissuedRequests;
+
+  /// In-flight requests failed because they were not safe to reissue.
+  final int failedRequests;
+
+  /// Bindings, registrations and subscriptions replayed after restarts.
+  final int replayedRequests;
+
+  /// Duration of the most recent recovery.
+  final Duration lastRecovery;
+
+  /// Longest recovery so far.
+  final Duration maxRecovery;
+
+  /// Why the worker last died, if it ever did.
+  final String? lastCause;
+
+  /// Whether the supervisor stopped restarting a crash-looping worker.
+  final bool gaveUp;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is SupervisorStats &&
+          restarts == other.restarts &&
+          reissuedRequests == other.reissuedRequests &&
+          failedRequests == other.failedRequests &&
+          replayedRequests == other.replayedRequests &&
+          lastRecovery == other.lastRecovery &&
+          maxRecovery == other.maxRecovery &&
+          lastCause == other.lastCause &&
+          gaveUp == other.gaveUp;
+
+  @override
+  int get hashCode => Object.hash(
+    restarts,
+    reissuedRequests,
+    failedRequests,
+    replayedRequests,
+    lastRecovery,
+    maxRecovery,
+    lastCause,
+    gaveUp,
+  );
+
+  @override
+  String toString() =>
+      'SupervisorStats(restarts: $restarts, reissued: $reissuedRequests, '
+      'failed: $failedRequests, lastRecovery: $lastRecovery, '
+      'maxRecovery: $maxRecovery, gaveUp: $gaveUp)';
+}
+
+/// Snapshot of runtime counters collected by the BACnet worker.
+///
+/// Obtain with [BacnetClient.getMetrics].
+@immutable
+class BacnetMetrics {
+  /// Creates a metrics snapshot.
+  const BacnetMetrics({
+    this.nativeMemory = const {},
+    this.internedStrings = 0,
+    this.internHits = 0,
+    this.cov = const CovStats(),
+    this.packetFilter = const PacketFilterStats(),
+    this.iAmPacing = const IAmPacingStats(),
+    this.mstp = const MstpStats(),
+    this.journal = const WriteJournalStats(),
+    this.realtime = const RealtimeStats(),
+    this.admission = const AdmissionStats(),
+    this.hedging = const HedgingStats(),
+    this.supervisor = const SupervisorStats(),
+  });
+
+  /// Native allocation counters keyed by allocation site.
+  final Map<String, NativeMemoryStats> nativeMemory;
+
+  /// Distinct decoded strings currently shared through the intern pool.
+  final int internedStrings;
+
+  /// Decoded strings that reused an already pooled instance.
+  final int internHits;
+
+  /// COV notification handling counters.
+  final CovStats cov;
+
+  /// Receive pre-filter counters.
+  final PacketFilterStats packetFilter;
+
+  /// Server I-Am pacing counters.
+  final IAmPacingStats iAmPacing;
+
+  /// MS/TP datalink counters.
+  final MstpStats mstp;
+
+  /// Write journal counters.
+  final WriteJournalStats journal;
+
+  /// Real-time profile of the stack thread.
+  final RealtimeStats realtime;
+
+  /// Admission control counters (collected in the main isolate).
+  final AdmissionStats admission;
+
+  /// Hedged read counters (collected in the main isolate).
+  final HedgingStats hedging;
+
+  /// Worker restart counters (collected in the main isolate).
+  final SupervisorStats supervisor;
+
+  /// Bytes of native memory currently held by the worker across all sites.
+  int get nativeLiveBytes =>
+      nativeMemory.values.fold(0, (sum, s) => sum + s.liveBytes);
+
+  @override
+  String toString() =>
+      'BacnetMetrics(nativeLiveBytes: $nativeLiveBytes, '
+      'sites: ${nativeMemory.length}, internedStrings: $internedStrings, '
+      'internHits: $internHits, cov: $cov, packetFilter: $packetFilter, '
+      'iAmPacing: $iAmPacing, mstp: $mstp, journal: $journal, '
+      'realtime: $realtime, admission: $admission, hedging: $hedging, '
+      'supervisor: $supervisor)';
+}
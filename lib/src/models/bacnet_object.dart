@@ -55,6 +55,19 @@ class BacnetObject {
   /// Values can be of any type depending on the property.
   final Map<int, dynamic> properties;
 
+  /// Creates a BACnet object from a `'type:instance'` result key, as used by
+  /// [BacnetClient.readMultiple].
+  ///
+  /// Throws a [FormatException] if [key] is not in that form.
+  factory BacnetObject.fromKey(String key) {
+    final parts = key.split(':');
+    if (parts.length != 2) throw FormatException('Invalid object key', key);
+    return BacnetObject(
+      type: int.parse(parts[0]),
+      instance: int.parse(parts[1]),
+    );
+  }
+
   /// Creates a BACnet object from JSON.
   factory BacnetObject.fromJson(Map<String, dynamic> json) =>
       _$BacnetObjectFromJson(json);
@@ -1,5 +1,14 @@
+import 'dart:isolate';
+
+import '../../core/bacnet_config.dart';
+import '../bacnet_metrics.dart';
+import '../bacnet_object.dart';
+import '../packet_filter.dart';
+import '../priority_array.dart';
 import '../rpm_models.dart';
+import '../server_image.dart';
 import '../wpm_models.dart';
+import '../write_journal.dart';
 
 /// Base class for all requests sent from main isolate to worker isolate.
 sealed class WorkerRequest {
@@ -25,6 +34,20 @@ class WhoIsRequest extends WorkerRequest {
   const WhoIsRequest({this.lowLimit = -1, this.highLimit = -1});
 }
 
+/// Request to send a unicast Who-Is to the cached address of each device.
+///
+/// Answered with a [DirectedWhoIsResponse].
+class DirectedWhoIsRequest extends WorkerRequest {
+  /// Devices to address, each with low = high = device ID.
+  final List<int> deviceIds;
+
+  /// Internal tracking ID for request-response matching.
+  final int trackingId;
+
+  /// Creates a directed Who-Is request.
+  const DirectedWhoIsRequest(this.deviceIds, {required this.trackingId});
+}
+
 /// Request to read a single property from a BACnet object.
 class ReadPropertyRequest extends WorkerRequest {
   /// Internal tracking ID for request-response matching.
@@ -79,6 +102,9 @@ class WritePropertyRequest extends WorkerRequest {
   /// BACnet application tag for the value.
   final int tag;
 
+  /// Tracking ID for correlating the acknowledgement.
+  final int? trackingId;
+
   /// Creates a WriteProperty request.
   const WritePropertyRequest({
     required this.deviceId,
@@ -88,6 +114,7 @@ class WritePropertyRequest extends WorkerRequest {
     required this.value,
     this.priority = 16,
     this.tag = 4,
+    this.trackingId,
   });
 }
 
@@ -143,15 +170,139 @@ class SubscribeCOVRequest extends WorkerRequest {
   /// Property to monitor.
   final int propertyId;
 
+  /// Whether the device should send confirmed notifications.
+  final bool confirmed;
+
+  /// Subscription lifetime in seconds (0 for indefinite).
+  final int lifetime;
+
+  /// Minimum change that triggers a notification, or null for the
+  /// device's own COV_Increment.
+  final double? covIncrement;
+
+  /// Whether this cancels the subscription instead of creating it.
+  final bool cancel;
+
+  /// Tracking ID for correlating the acknowledgement.
+  final int? trackingId;
+
   /// Creates a COV subscription request.
   const SubscribeCOVRequest({
     required this.deviceId,
     required this.objectType,
     required this.instance,
     this.propertyId = 65, // default prop PresentValue
+    this.confirmed = false,
+    this.lifetime = 120,
+    this.covIncrement,
+    this.cancel = false,
+    this.trackingId,
+  });
+}
+
+/// Request to set the COV_Increment of a local server object.
+class SetCovIncrementRequest extends WorkerRequest {
+  /// Object type (analog input or analog value).
+  final int objectType;
+
+  /// Object instance.
+  final int instance;
+
+  /// Minimum change of Present_Value that triggers a notification.
+  final double increment;
+
+  /// Creates a COV increment request.
+  const SetCovIncrementRequest(this.objectType, this.instance, this.increment);
+}
+
+/// Request to change how the server paces its I-Am responses.
+class SetIAmPacingRequest extends WorkerRequest {
+  /// Largest random delay before answering a Who-Is.
+  final Duration maxDelay;
+
+  /// Most I-Am responses sent per second.
+  final int maxPerSecond;
+
+  /// Creates an I-Am pacing request.
+  const SetIAmPacingRequest({
+    required this.maxDelay,
+    required this.maxPerSecond,
   });
 }
 
+/// Request to write the server object database to an image file.
+class ServerSnapshotRequest extends WorkerRequest {
+  /// Path of the image file; replaced atomically.
+  final String path;
+
+  /// Internal tracking ID for request-response matching.
+  final int trackingId;
+
+  /// Creates a snapshot request.
+  const ServerSnapshotRequest(this.path, {required this.trackingId});
+}
+
+/// Request to initialize the server from an image file.
+///
+/// Replaces [InitServerRequest] and the [AddObjectRequest]s that built
+/// the saved database.
+class ServerRestoreRequest extends WorkerRequest {
+  /// Path of the image file.
+  final String path;
+
+  /// Internal tracking ID for request-response matching.
+  final int trackingId;
+
+  /// Creates a restore request.
+  const ServerRestoreRequest(this.path, {required this.trackingId});
+}
+
+/// Request to apply, or with a null profile clear, the real-time profile
+/// of the stack thread.
+class SetRealtimeProfileRequest extends WorkerRequest {
+  /// Profile to apply, or null for the default scheduling.
+  final RealtimeProfile? profile;
+
+  /// Creates a real-time profile request.
+  const SetRealtimeProfileRequest(this.profile);
+}
+
+/// Request to start journaling writes to a file.
+///
+/// Recorded by the supervisor and replayed, untracked, after a worker
+/// restart.
+class OpenWriteJournalRequest extends WorkerRequest {
+  /// Journal settings.
+  final WriteJournalConfig config;
+
+  /// Internal tracking ID, or null when replayed.
+  final int? trackingId;
+
+  /// Creates an open request.
+  const OpenWriteJournalRequest(this.config, {this.trackingId});
+}
+
+/// Request to wait until every journaled write is on disk.
+class SyncWriteJournalRequest extends WorkerRequest {
+  /// Longest time to wait for the sync.
+  final Duration timeout;
+
+  /// Internal tracking ID for request-response matching.
+  final int trackingId;
+
+  /// Creates a sync request.
+  const SyncWriteJournalRequest(this.timeout, {required this.trackingId});
+}
+
+/// Request to commit outstanding writes and close the journal.
+class CloseWriteJournalRequest extends WorkerRequest {
+  /// Internal tracking ID for request-response matching.
+  final int trackingId;
+
+  /// Creates a close request.
+  const CloseWriteJournalRequest({required this.trackingId});
+}
+
 /// Request to initialize the BACnet server.
 class InitServerRequest extends WorkerRequest {
   /// Server device ID.
@@ -214,8 +365,77 @@ class WritePropertyMultipleRequest extends WorkerRequest {
   final int? trackingId;
 }
 
+/// Request for the worker to close its socket and exit.
+class ShutdownWorkerRequest extends WorkerRequest {
+  /// Creates a shutdown request.
+  const ShutdownWorkerRequest();
+}
+
+/// Request to read `priority_array` and `relinquish_default` of several
+/// commandable objects with one RPM.
+class ReadPriorityArraysRequest extends WorkerRequest {
+  /// Creates a priority array request.
+  const ReadPriorityArraysRequest({
+    required this.trackingId,
+    required this.deviceId,
+    required this.objects,
+  });
+
+  /// Internal tracking ID for request-response matching.
+  final int trackingId;
+
+  /// Target device ID.
+  final int deviceId;
+
+  /// Commandable objects to read.
+  final List<BacnetObject> objects;
+}
+
+/// Request to replace the native receive pre-filter.
+class SetPacketFilterRequest extends WorkerRequest {
+  /// The filter to install.
+  final BacnetPacketFilter filter;
+
+  /// Creates a packet filter request.
+  const SetPacketFilterRequest(this.filter);
+}
+
+/// Request for a snapshot of the worker's runtime counters.
+class MetricsRequest extends WorkerRequest {
+  /// Internal tracking ID for request-response matching.
+  final int trackingId;
+
+  /// Creates a metrics request.
+  const MetricsRequest({required this.trackingId});
+}
+
 // --- Responses (Worker -> Main) ---
 
+/// Response sent once the worker is ready to accept requests.
+///
+/// Carries the worker's [SendPort] and how long each startup phase took.
+class WorkerReadyResponse extends WorkerResponse {
+  /// Port for sending requests to the worker.
+  final SendPort sendPort;
+
+  /// Time spent opening the native library.
+  final Duration libraryLoad;
+
+  /// Time spent initializing BACnet/IP and binding the socket.
+  final Duration socketInit;
+
+  /// Time spent registering native service handlers.
+  final Duration handlerSetup;
+
+  /// Creates a worker ready response.
+  const WorkerReadyResponse({
+    required this.sendPort,
+    required this.libraryLoad,
+    required this.socketInit,
+    required this.handlerSetup,
+  });
+}
+
 /// Response indicating successful server initialization.
 class InitSuccessResponse extends WorkerResponse {
   /// Creates a successful initialization response.
@@ -227,8 +447,88 @@ class ErrorResponse extends WorkerResponse {
   /// Error message.
   final String error;
 
+  /// Tracking ID of the request that failed, if the error belongs to one.
+  final int? trackingId;
+
+  /// Whether the worker can no longer run and is exiting.
+  final bool fatal;
+
+  /// Creates an error response.
+  const ErrorResponse(this.error, {this.trackingId, this.fatal = false});
+}
+
+/// Event emitted after the worker isolate died and was restarted.
+///
+/// Sent by `BacnetSystem` itself, not by the worker, once bindings and
+/// subscriptions have been replayed to the new worker.
+class WorkerRestartedResponse extends WorkerResponse {
+  /// Why the previous worker died.
+  final String cause;
+
+  /// Time from detecting the death to the end of the replay.
+  final Duration recoveryTime;
+
+  /// In-flight reads sent again to the new worker.
+  final int reissuedRequests;
+
+  /// Creates a worker restarted event.
+  const WorkerRestartedResponse({
+    required this.cause,
+    required this.recoveryTime,
+    this.reissuedRequests = 0,
+  });
+}
+
+/// Response indicating a device aborted a confirmed request.
+class RequestAbortedResponse extends WorkerResponse {
+  /// Invoke ID of the aborted request.
+  final int invokeId;
+
+  /// BACnet abort reason.
+  final int reason;
+
+  /// Creates an abort response.
+  const RequestAbortedResponse({required this.invokeId, required this.reason});
+}
+
+/// Response indicating a device rejected a confirmed request.
+class RequestRejectedResponse extends WorkerResponse {
+  /// Invoke ID of the rejected request.
+  final int invokeId;
+
+  /// BACnet reject reason.
+  final int reason;
+
+  /// Creates a reject response.
+  const RequestRejectedResponse({required this.invokeId, required this.reason});
+}
+
+/// Response sent when a device answers a confirmed request with an Error PDU.
+class RequestErrorResponse extends WorkerResponse {
+  /// Invoke ID of the failed request.
+  final int invokeId;
+
+  /// BACnet error class.
+  final int errorClass;
+
+  /// BACnet error code.
+  final int errorCode;
+
   /// Creates an error response.
-  const ErrorResponse(this.error);
+  const RequestErrorResponse({
+    required this.invokeId,
+    required this.errorClass,
+    required this.errorCode,
+  });
+}
+
+/// Response sent when a device acknowledges a write or subscription.
+class SimpleAckResponse extends WorkerResponse {
+  /// Invoke ID of the acknowledged request.
+  final int invokeId;
+
+  /// Creates a SimpleAck response.
+  const SimpleAckResponse({required this.invokeId});
 }
 
 /// Response containing a log message from the worker.
@@ -345,12 +645,32 @@ class COVNotificationResponse extends WorkerResponse {
   /// Source device ID (-1 if unknown).
   final int deviceId;
 
+  /// Reported property (-1 if only status flags were reported).
+  final int propertyId;
+
+  /// New value of [propertyId] (null if not a primitive value).
+  final Object? value;
+
+  /// Status flags as bits 0-3: in-alarm, fault, overridden, out-of-service.
+  final int? statusFlags;
+
+  /// Seconds left on the subscription (0 for an indefinite one).
+  final int timeRemaining;
+
+  /// Whether the notification was confirmed (and acknowledged natively).
+  final bool confirmed;
+
   /// Creates a COV notification response.
   const COVNotificationResponse({
     required this.objectType,
     required this.instance,
     required this.timestamp,
     this.deviceId = -1,
+    this.propertyId = -1,
+    this.value,
+    this.statusFlags,
+    this.timeRemaining = 0,
+    this.confirmed = false,
   });
 }
 
@@ -405,7 +725,8 @@ class ReadRangeRequest extends WorkerRequest {
   /// Request type: 1=Position, 2=Sequence, 4=Time, 8=All.
   final int requestType;
 
-  /// Reference value (Index, Sequence Number, or DateTime string).
+  /// Reference value: an index, a sequence number, or a [DateTime] in the
+  /// device's local time.
   final dynamic reference;
 
   /// Number of items to read (positive for forward, negative for backward).
@@ -440,8 +761,14 @@ class ReadRangeAckResponse extends WorkerResponse {
   final int itemCount;
 
   /// List of items (raw data or parsed).
+  ///
+  /// Trend Log records decode to maps with `timestamp`, `value` and, when
+  /// present, `statusFlags`, `logStatus` and `error`.
   final dynamic data;
 
+  /// Sequence number of the first item, for reads by sequence or time.
+  final int? firstSequence;
+
   /// Tracking ID associated with the request (if any).
   final int? trackingId;
 
@@ -451,6 +778,130 @@ class ReadRangeAckResponse extends WorkerResponse {
     required this.resultFlags,
     required this.itemCount,
     this.data,
+    this.firstSequence,
     this.trackingId,
   });
 }
+
+/// Response containing decoded priority arrays for a
+/// [ReadPriorityArraysRequest].
+class PriorityArraysAckResponse extends WorkerResponse {
+  /// Invoke ID of the RPM that carried the request.
+  final int invokeId;
+
+  /// One result per requested object, in response order.
+  final List<BacnetPriorityArray> arrays;
+
+  /// Creates a priority arrays acknowledgment.
+  const PriorityArraysAckResponse({
+    required this.invokeId,
+    required this.arrays,
+  });
+}
+
+/// Response carrying the worker's runtime counters.
+class MetricsResponse extends WorkerResponse {
+  /// Tracking ID of the [MetricsRequest] being answered.
+  final int trackingId;
+
+  /// Native allocation counters keyed by allocation site.
+  final Map<String, NativeMemoryStats> nativeMemory;
+
+  /// Distinct strings in the worker's intern pool.
+  final int internedStrings;
+
+  /// Intern lookups that reused a pooled string.
+  final int internHits;
+
+  /// COV notification counters from the native handlers.
+  final CovStats cov;
+
+  /// Receive pre-filter counters.
+  final PacketFilterStats packetFilter;
+
+  /// Server I-Am pacing counters.
+  final IAmPacingStats iAmPacing;
+
+  /// MS/TP datalink counters.
+  final MstpStats mstp;
+
+  /// Write journal counters.
+  final WriteJournalStats journal;
+
+  /// Real-time profile state.
+  final RealtimeStats realtime;
+
+  /// Creates a metrics response.
+  const MetricsResponse({
+    required this.trackingId,
+    required this.nativeMemory,
+    this.internedStrings = 0,
+    this.internHits = 0,
+    this.cov = const CovStats(),
+    this.packetFilter = const PacketFilterStats(),
+    this.iAmPacing = const IAmPacingStats(),
+    this.mstp = const MstpStats(),
+    this.journal = const WriteJournalStats(),
+    this.realtime = const RealtimeStats(),
+  });
+
+  /// Combines these worker counters with those the main isolate keeps.
+  BacnetMetrics toMetrics({
+    AdmissionStats admission = const AdmissionStats(),
+    HedgingStats hedging = const HedgingStats(),
+    SupervisorStats supervisor = const SupervisorStats(),
+  }) => BacnetMetrics(
+    nativeMemory: nativeMemory,
+    internedStrings: internedStrings,
+    internHits: internHits,
+    cov: cov,
+    packetFilter: packetFilter,
+    iAmPacing: iAmPacing,
+    mstp: mstp,
+    journal: journal,
+    realtime: realtime,
+    admission: admission,
+    hedging: hedging,
+    supervisor: supervisor,
+  );
+}
+
+/// Response to a [ServerSnapshotRequest] or [ServerRestoreRequest].
+class ServerImageResponse extends WorkerResponse {
+  /// Tracking ID of the request being answered.
+  final int trackingId;
+
+  /// What was written or restored.
+  final BacnetServerImageInfo info;
+
+  /// Creates a server image response.
+  const ServerImageResponse({required this.trackingId, required this.info});
+}
+
+/// Response to an [OpenWriteJournalRequest], [SyncWriteJournalRequest] or
+/// [CloseWriteJournalRequest].
+class WriteJournalResponse extends WorkerResponse {
+  /// Tracking ID of the request being answered.
+  final int trackingId;
+
+  /// Journal counters after the request.
+  final WriteJournalStats stats;
+
+  /// Creates a write journal response.
+  const WriteJournalResponse({required this.trackingId, required this.stats});
+}
+
+/// Response to a [DirectedWhoIsRequest].
+class DirectedWhoIsResponse extends WorkerResponse {
+  /// Tracking ID of the request being answered.
+  final int trackingId;
+
+  /// Devices that were skipped because no address is bound for them.
+  final List<int> unbound;
+
+  /// Creates a directed Who-Is response.
+  const DirectedWhoIsResponse({
+    required this.trackingId,
+    required this.unbound,
+  });
+}
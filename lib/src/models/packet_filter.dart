@@ -0,0 +1,167 @@
+import 'dart:io';
+
+import 'package:meta/meta.dart';
+
+/// BACnet unconfirmed service choices, for [BacnetPacketFilter] rules.
+abstract final class BacnetUnconfirmedService {
+  /// I-Am.
+  static const int iAm = 0;
+
+  /// I-Have.
+  static const int iHave = 1;
+
+  /// UnconfirmedCOVNotification.
+  static const int covNotification = 2;
+
+  /// UnconfirmedEventNotification.
+  static const int eventNotification = 3;
+
+  /// UnconfirmedPrivateTransfer.
+  static const int privateTransfer = 4;
+
+  /// UnconfirmedTextMessage.
+  static const int textMessage = 5;
+
+  /// TimeSynchronization.
+  static const int timeSynchronization = 6;
+
+  /// Who-Has.
+  static const int whoHas = 7;
+
+  /// Who-Is.
+  static const int whoIs = 8;
+
+  /// UTCTimeSynchronization.
+  static const int utcTimeSynchronization = 9;
+
+  /// WriteGroup.
+  static const int writeGroup = 10;
+}
+
+/// How [BacnetPacketFilter.sources] is applied.
+enum BacnetSourceFilterMode {
+  /// Sources are not filtered.
+  off,
+
+  /// Only packets from listed sources are accepted.
+  allowOnly,
+
+  /// Packets from listed sources are dropped.
+  deny,
+}
+
+/// Rules for dropping received packets before the stack handles them.
+///
+/// The filter runs natively right after `bip_receive`, so dropped packets
+/// never reach the service handlers or the worker isolate. Service rules
+/// apply to incoming requests only; acks, errors, rejects and aborts for
+/// our own requests always pass unless their source is filtered.
+///
+/// Example:
+/// ```dart
+/// await client.setPacketFilter(
+///   BacnetPacketFilter(
+///     deniedUnconfirmedServices: {
+///       BacnetUnconfirmedService.whoHas,
+///       BacnetUnconfirmedService.timeSynchronization,
+///     },
+///     dropNetworkMessages: true,
+///   ),
+/// );
+/// ```
+@immutable
+class BacnetPacketFilter {
+  /// Creates a packet filter.
+  ///
+  /// Each entry of [sources] is an IPv4 address, optionally followed by
+  /// `:port`; without a port every port of that address matches. For
+  /// routed traffic the source is the router that forwarded the packet.
+  const BacnetPacketFilter({
+    this.deniedUnconfirmedServices = const {},
+    this.deniedConfirmedServices = const {},
+    this.dropNetworkMessages = false,
+    this.sourceMode = BacnetSourceFilterMode.off,
+    this.sources = const [],
+  });
+
+  /// A filter that accepts every packet.
+  static const BacnetPacketFilter allowAll = BacnetPacketFilter();
+
+  /// Maximum number of [sources] the native table holds.
+  static const int maxSources = 192;
+
+  /// Unconfirmed service choices to drop (see [BacnetUnconfirmedService]).
+  final Set<int> deniedUnconfirmedServices;
+
+  /// Confirmed service choices to drop when received as requests.
+  final Set<int> deniedConfirmedServices;
+
+  /// Whether to drop network-layer messages (router and BBMD chatter).
+  final bool dropNetworkMessages;
+
+  /// How [sources] is applied.
+  final BacnetSourceFilterMode sourceMode;
+
+  /// Source addresses as `ip` or `ip:port`.
+  final List<String> sources;
+
+  /// Parses a [sources] entry into a big-endian IPv4 address and a port
+  /// (0 for any port).
+  ///
+  /// Throws a [FormatException] if [source] is not an IPv4 address.
+  static (int, int) parseSource(String source) {
+    final colon = source.indexOf(':');
+    final host = colon < 0 ? source : source.substring(0, colon);
+    final port = colon < 0 ? 0 : int.tryParse(source.substring(colon + 1));
+    final address = InternetAddress.tryParse(host);
+    if (address == null ||
+        address.type != InternetAddressType.IPv4 ||
+        port == null ||
+        port < 0 ||
+        port > 0xFFFF) {
+      throw FormatException('Not an IPv4 source', source);
+    }
+    final raw = address.rawAddress;
+    return ((raw[0] << 24) | (raw[1] << 16) | (raw[2] << 8) | raw[3], port);
+  }
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is BacnetPacketFilter &&
+          _setEquals(
+            deniedUnconfirmedServices,
+            other.deniedUnconfirmedServices,
+          ) &&
+          _setEquals(deniedConfirmedServices, other.deniedConfirmedServices) &&
+          dropNetworkMessages == other.dropNetworkMessages &&
+          sourceMode == other.sourceMode &&
+          _listEquals(sources, other.sources);
+
+  @override
+  int get hashCode => Object.hash(
+    Object.hashAllUnordered(deniedUnconfirmedServices),
+    Object.hashAllUnordered(deniedConfirmedServices),
+    dropNetworkMessages,
+    sourceMode,
+    Object.hashAll(sources),
+  );
+
+  @override
+  String toString() =>
+      'BacnetPacketFilter(deniedUnconfirmed: $deniedUnconfirmedServices, '
+      'deniedConfirmed: $deniedConfirmedServices, '
+      'dropNetworkMessages: $dropNetworkMessages, '
+      'sourceMode: ${sourceMode.name}, sources: ${sources.length})';
+
+  static bool _setEquals(Set<int> a, Set<int> b) =>
+      a.length == b.length && a.containsAll(b);
+
+  static bool _listEquals(List<String> a, List<String> b) {
+    if (a.length != b.length) return false;
+    for (var i = 0; i < a.length; i++) {
+      if (a[i] != b[i]) return false;
+    }
+    return true;
+  }
+}
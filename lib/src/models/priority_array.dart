@@ -0,0 +1,131 @@
+import 'package:meta/meta.dart';
+
+import '../core/types.dart';
+import 'bacnet_object.dart';
+
+/// Command priorities of a commandable BACnet object.
+///
+/// Holds the 16 slots of the `priority_array` property (slot 1 is the
+/// highest priority; `null` means relinquished), the `relinquish_default`
+/// value, and which priority currently drives the output.
+///
+/// Example:
+/// ```dart
+/// final arrays = await client.readPriorityArrays(1234, outputs);
+/// for (final pa in arrays) {
+///   print('${pa.object}: priority ${pa.activePriority} -> ${pa.activeValue}');
+/// }
+/// ```
+@immutable
+class BacnetPriorityArray {
+  /// Creates a priority array result.
+  ///
+  /// [slots] must hold exactly [slotCount] entries.
+  BacnetPriorityArray({
+    required this.object,
+    required List<Object?> slots,
+    this.relinquishDefault,
+    this.error,
+  }) : assert(slots.length == slotCount, 'priority_array has 16 slots'),
+       slots = List.unmodifiable(slots),
+       activePriority = _firstCommanded(slots);
+
+  /// Creates a result from decoded `priority_array` and
+  /// `relinquish_default` property values.
+  ///
+  /// Arrays shorter than [slotCount] are padded with relinquished slots and
+  /// longer ones truncated. A [BacnetError] in [priorityArray] is kept in
+  /// [error] with every slot relinquished.
+  factory BacnetPriorityArray.fromDecoded(
+    BacnetObject object,
+    Object? priorityArray,
+    Object? relinquishDefault,
+  ) {
+    final slots = List<Object?>.filled(slotCount, null);
+    BacnetError? error;
+    if (priorityArray is BacnetError) {
+      error = priorityArray;
+    } else if (priorityArray is List) {
+      for (var i = 0; i < priorityArray.length && i < slotCount; i++) {
+        slots[i] = priorityArray[i];
+      }
+    } else if (priorityArray != null) {
+      // A single commanded slot decodes as a scalar.
+      slots[0] = priorityArray;
+    }
+    return BacnetPriorityArray(
+      object: object,
+      slots: slots,
+      relinquishDefault: relinquishDefault is BacnetError
+          ? null
+          : relinquishDefault,
+      error: error,
+    );
+  }
+
+  /// Number of command priorities defined by BACnet.
+  static const int slotCount = 16;
+
+  /// The commandable object these priorities belong to.
+  final BacnetObject object;
+
+  /// The 16 priority slots; index 0 is priority 1.
+  final List<Object?> slots;
+
+  /// Value used when every slot is relinquished.
+  final Object? relinquishDefault;
+
+  /// Error returned instead of the priority array, if any.
+  final BacnetError? error;
+
+  /// Highest commanded priority (1-16), or null if all are relinquished.
+  final int? activePriority;
+
+  /// Value currently driving the output.
+  Object? get activeValue => activePriority == null
+      ? relinquishDefault
+      : slots[activePriority! - 1];
+
+  /// Priorities (1-16) that currently hold a command.
+  List<int> get commandedPriorities => [
+    for (var i = 0; i < slotCount; i++)
+      if (slots[i] != null) i + 1,
+  ];
+
+  /// Value commanded at [priority] (1-16), or null if relinquished.
+  Object? operator [](int priority) => slots[priority - 1];
+
+  static int? _firstCommanded(List<Object?> slots) {
+    for (var i = 0; i < slots.length; i++) {
+      if (slots[i] != null) return i + 1;
+    }
+    return null;
+  }
+
+  @override
+  bool operator ==(Object other) {
+    if (identical(this, other)) return true;
+    if (other is! BacnetPriorityArray ||
+        other.object != object ||
+        other.relinquishDefault != relinquishDefault ||
+        other.error?.errorClass != error?.errorClass ||
+        other.error?.errorCode != error?.errorCode) {
+      return false;
+    }
+    for (var i = 0; i < slotCount; i++) {
+      if (other.slots[i] != slots[i]) return false;
+    }
+    return true;
+  }
+
+  @override
+  int get hashCode =>
+      Object.hash(object, relinquishDefault, Object.hashAll(slots));
+
+  @override
+  String toString() {
+    if (error != null) return 'BacnetPriorityArray($object, $error)';
+    return 'BacnetPriorityArray($object, active: ${activePriority ?? 'default'}'
+        ' = $activeValue, commanded: $commandedPriorities)';
+  }
+}
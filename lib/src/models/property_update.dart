@@ -12,6 +12,9 @@ enum UpdateSource {
 
   /// Manually read or other source.
   manual,
+
+  /// Recovered from a device Trend Log after updates were missed.
+  backfill,
 }
 
 /// Represents a property value update.
@@ -49,6 +52,10 @@ class PropertyUpdate {
   /// Error object if the update represents a failure.
   final Object? error;
 
+  /// Whether this update was recovered from a Trend Log after the fact,
+  /// in which case [timestamp] is when the device logged it.
+  bool get backfilled => source == UpdateSource.backfill;
+
   @override
   bool operator ==(Object other) =>
       identical(this, other) ||
@@ -0,0 +1,56 @@
+import 'package:meta/meta.dart';
+
+/// Result of saving or loading a server object database image.
+///
+/// Returned by [BacnetServer.saveImage] and [BacnetServer.loadImage].
+@immutable
+class BacnetServerImageInfo {
+  /// Creates an image summary.
+  const BacnetServerImageInfo({
+    required this.objects,
+    required this.properties,
+    required this.subscriptions,
+    required this.bytes,
+    required this.elapsed,
+    this.skipped = 0,
+  });
+
+  /// Objects written to or restored from the image.
+  final int objects;
+
+  /// Property values written to or restored from the image.
+  final int properties;
+
+  /// Property values the restored objects refused, e.g. read-only names.
+  final int skipped;
+
+  /// COV subscriptions written to or restored from the image.
+  final int subscriptions;
+
+  /// Size of the image file.
+  final int bytes;
+
+  /// Time the worker spent writing or loading the image.
+  final Duration elapsed;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is BacnetServerImageInfo &&
+          objects == other.objects &&
+          properties == other.properties &&
+          skipped == other.skipped &&
+          subscriptions == other.subscriptions &&
+          bytes == other.bytes &&
+          elapsed == other.elapsed;
+
+  @override
+  int get hashCode =>
+      Object.hash(objects, properties, skipped, subscriptions, bytes, elapsed);
+
+  @override
+  String toString() =>
+      'BacnetServerImageInfo(objects: $objects, properties: $properties, '
+      'skipped: $skipped, subscriptions: $subscriptions, bytes: $bytes, '
+      'elapsed: ${elapsed.inMicroseconds}us)';
+}
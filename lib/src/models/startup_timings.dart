@@ -0,0 +1,71 @@
+import 'package:meta/meta.dart';
+
+/// Breakdown of where time went while starting the BACnet worker.
+///
+/// Available from [BacnetSystem.startupTimings] after a successful start.
+/// When a warm worker is reused, [reused] is true and only [total] is set.
+@immutable
+class BacnetStartupTimings {
+  /// Creates a startup timing breakdown.
+  const BacnetStartupTimings({
+    required this.total,
+    this.spawn = Duration.zero,
+    this.libraryLoad = Duration.zero,
+    this.socketInit = Duration.zero,
+    this.handlerSetup = Duration.zero,
+    this.reused = false,
+  });
+
+  /// Time spent in `Isolate.spawn` before the worker started running.
+  final Duration spawn;
+
+  /// Time the worker spent opening the native library.
+  final Duration libraryLoad;
+
+  /// Time the worker spent in `bip_init` binding the UDP socket.
+  final Duration socketInit;
+
+  /// Time the worker spent registering native service handlers.
+  final Duration handlerSetup;
+
+  /// Wall-clock time from the start call until requests could be sent.
+  final Duration total;
+
+  /// Whether an already running worker was reused.
+  final bool reused;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is BacnetStartupTimings &&
+          spawn == other.spawn &&
+          libraryLoad == other.libraryLoad &&
+          socketInit == other.socketInit &&
+          handlerSetup == other.handlerSetup &&
+          total == other.total &&
+          reused == other.reused;
+
+  @override
+  int get hashCode => Object.hash(
+    spawn,
+    libraryLoad,
+    socketInit,
+    handlerSetup,
+    total,
+    reused,
+  );
+
+  @override
+  String toString() {
+    if (reused) {
+      return 'BacnetStartupTimings(reused, total: ${total.inMilliseconds}ms)';
+    }
+    return 'BacnetStartupTimings('
+        'spawn: ${spawn.inMilliseconds}ms, '
+        'libraryLoad: ${libraryLoad.inMilliseconds}ms, '
+        'socketInit: ${socketInit.inMilliseconds}ms, '
+        'handlerSetup: ${handlerSetup.inMilliseconds}ms, '
+        'total: ${total.inMilliseconds}ms'
+        ')';
+  }
+}
@@ -30,10 +30,12 @@ class TrendLogData {
   /// [itemCount] is the number of entries currently in the log.
   /// [totalRecords] is total number of records that have been logged.
   /// [entries] is the list of log entries.
+  /// [moreItems] is set when the device had more records than it returned.
   const TrendLogData({
     required this.itemCount,
     required this.totalRecords,
     this.entries = const [],
+    this.moreItems = false,
   });
 
   /// The number of entries currently in the trend log.
@@ -45,6 +47,10 @@ class TrendLogData {
   /// List of trend log entries.
   final List<TrendLogEntry> entries;
 
+  /// Whether the device has more records beyond [entries] in the direction
+  /// that was read.
+  final bool moreItems;
+
   /// Creates trend log data from JSON.
   factory TrendLogData.fromJson(Map<String, dynamic> json) =>
       _$TrendLogDataFromJson(json);
@@ -57,11 +63,13 @@ class TrendLogData {
     int? itemCount,
     int? totalRecords,
     List<TrendLogEntry>? entries,
+    bool? moreItems,
   }) {
     return TrendLogData(
       itemCount: itemCount ?? this.itemCount,
       totalRecords: totalRecords ?? this.totalRecords,
       entries: entries ?? this.entries,
+      moreItems: moreItems ?? this.moreItems,
     );
   }
 
@@ -81,12 +89,52 @@ class TrendLogEntry {
   /// [timestamp] is when the value was logged.
   /// [value] is the logged value (type depends on monitored property).
   /// [status] is the status flags at the time of logging.
+  /// [sequenceNumber] is the record's position in the log, when known.
   const TrendLogEntry({
     required this.timestamp,
     required this.value,
     required this.status,
+    this.sequenceNumber,
   });
 
+  /// Creates an entry from a log record decoded by the worker.
+  ///
+  /// [status] is 'OK', the set status flags joined by '|' (e.g.
+  /// 'IN_ALARM|FAULT'), 'LOG_STATUS' for a log status change, or 'ERROR'
+  /// for a failed read by the log.
+  factory TrendLogEntry.fromRecord(
+    Map<dynamic, dynamic> record, {
+    int? sequenceNumber,
+  }) {
+    final flags = record['statusFlags'] as int? ?? 0;
+    final String status;
+    if (record['error'] != null) {
+      status = 'ERROR';
+    } else if (record.containsKey('logStatus')) {
+      status = 'LOG_STATUS';
+    } else if (flags == 0) {
+      status = 'OK';
+    } else {
+      status = [
+        for (var i = 0; i < _statusFlagNames.length; i++)
+          if (flags & (1 << i) != 0) _statusFlagNames[i],
+      ].join('|');
+    }
+    return TrendLogEntry(
+      timestamp: record['timestamp'] as DateTime,
+      value: record['value'],
+      status: status,
+      sequenceNumber: sequenceNumber,
+    );
+  }
+
+  static const _statusFlagNames = [
+    'IN_ALARM',
+    'FAULT',
+    'OVERRIDDEN',
+    'OUT_OF_SERVICE',
+  ];
+
   /// The timestamp when this value was logged.
   final DateTime timestamp;
 
@@ -101,6 +149,16 @@ class TrendLogEntry {
   /// Common values: 'OK', 'IN_ALARM', 'FAULT', etc.
   final String status;
 
+  /// Sequence number of the record in the log, if known.
+  ///
+  /// Sequence numbers increase by one per record, so they identify the
+  /// records already fetched across reads.
+  final int? sequenceNumber;
+
+  /// Whether this entry holds a logged value rather than a log status
+  /// change or a failed read.
+  bool get hasValue => status != 'LOG_STATUS' && status != 'ERROR';
+
   /// Creates a trend log entry from JSON.
   factory TrendLogEntry.fromJson(Map<String, dynamic> json) =>
       _$TrendLogEntryFromJson(json);
@@ -109,11 +167,17 @@ class TrendLogEntry {
   Map<String, dynamic> toJson() => _$TrendLogEntryToJson(this);
 
   /// Creates a copy with updated values.
-  TrendLogEntry copyWith({DateTime? timestamp, dynamic value, String? status}) {
+  TrendLogEntry copyWith({
+    DateTime? timestamp,
+    dynamic value,
+    String? status,
+    int? sequenceNumber,
+  }) {
     return TrendLogEntry(
       timestamp: timestamp ?? this.timestamp,
       value: value ?? this.value,
       status: status ?? this.status,
+      sequenceNumber: sequenceNumber ?? this.sequenceNumber,
     );
   }
 
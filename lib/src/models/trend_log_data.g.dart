@@ -14,6 +14,7 @@ TrendLogData _$TrendLogDataFromJson(Map<String, dynamic> json) => TrendLogData(
           ?.map((e) => TrendLogEntry.fromJson(e as Map<String, dynamic>))
           .toList() ??
       const [],
+  moreItems: json['moreItems'] as bool? ?? false,
 );
 
 Map<String, dynamic> _$TrendLogDataToJson(TrendLogData instance) =>
@@ -21,6 +22,7 @@ Map<String, dynamic> _$TrendLogDataToJson(TrendLogData instance) =>
       'itemCount': instance.itemCount,
       'totalRecords': instance.totalRecords,
       'entries': instance.entries,
+      'moreItems': instance.moreItems,
     };
 
 TrendLogEntry _$TrendLogEntryFromJson(Map<String, dynamic> json) =>
@@ -28,6 +30,7 @@ TrendLogEntry _$TrendLogEntryFromJson(Map<String, dynamic> json) =>
       timestamp: DateTime.parse(json['timestamp'] as String),
       value: json['value'],
       status: json['status'] as String,
+      sequenceNumber: (json['sequenceNumber'] as num?)?.toInt(),
     );
 
 Map<String, dynamic> _$TrendLogEntryToJson(TrendLogEntry instance) =>
@@ -35,4 +38,5 @@ Map<String, dynamic> _$TrendLogEntryToJson(TrendLogEntry instance) =>
       'timestamp': instance.timestamp.toIso8601String(),
       'value': instance.value,
       'status': instance.status,
+      'sequenceNumber': instance.sequenceNumber,
     };
@@ -0,0 +1,276 @@
+import 'dart:typed_data';
+
+import 'package:meta/meta.dart';
+
+/// Settings of the native write journal.
+///
+/// Passed to [BacnetServer.openWriteJournal].
+@immutable
+class WriteJournalConfig {
+  /// Creates journal settings.
+  const WriteJournalConfig({
+    required this.path,
+    this.maxFileBytes = defaultMaxFileBytes,
+    this.keepFiles = 8,
+    this.commitInterval = const Duration(milliseconds: 5),
+    this.bufferBytes = defaultBufferBytes,
+  }) : assert(keepFiles >= 0 && keepFiles <= 255, 'keepFiles is 0-255'),
+       assert(bufferBytes >= minBufferBytes, 'bufferBytes too small');
+
+  /// Default size at which the journal rotates: 64 MiB.
+  static const int defaultMaxFileBytes = 64 << 20;
+
+  /// Default size of each of the two in-memory batches: 1 MiB.
+  static const int defaultBufferBytes = 1 << 20;
+
+  /// Smallest batch size the native journal accepts: two records of the
+  /// largest size.
+  static const int minBufferBytes = 2 * (32 + 1476 + 4);
+
+  /// Path of the active journal file. Rotated files are `path.1` (newest)
+  /// to `path.N`.
+  final String path;
+
+  /// Size at which the file is rotated; 0 never rotates.
+  final int maxFileBytes;
+
+  /// Rotated files kept; 0 discards the old file on rotation.
+  final int keepFiles;
+
+  /// Longest a record waits in memory before its batch is written and
+  /// synced. A batch that is half full is committed at once.
+  final Duration commitInterval;
+
+  /// Size of each in-memory batch. A write arriving while a batch is full
+  /// waits for it to be committed, counted in [WriteJournalStats.stalls],
+  /// so a batch too small for the write rate slows the network.
+  final int bufferBytes;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is WriteJournalConfig &&
+          path == other.path &&
+          maxFileBytes == other.maxFileBytes &&
+          keepFiles == other.keepFiles &&
+          commitInterval == other.commitInterval &&
+          bufferBytes == other.bufferBytes;
+
+  @override
+  int get hashCode =>
+      Object.hash(path, maxFileBytes, keepFiles, commitInterval, bufferBytes);
+
+  @override
+  String toString() =>
+      'WriteJournalConfig($path, maxFileBytes: $maxFileBytes, '
+      'keepFiles: $keepFiles, '
+      'commitInterval: ${commitInterval.inMilliseconds}ms, '
+      'bufferBytes: $bufferBytes)';
+}
+
+/// Origin of a [WriteJournalRecord].
+enum WriteJournalKind {
+  /// A WriteProperty or WritePropertyMultiple the server accepted.
+  incomingWrite(1),
+
+  /// A WriteProperty sent by the client.
+  outgoingWrite(2),
+
+  /// One value of a WritePropertyMultiple sent by the client.
+  outgoingWritePropertyMultiple(3);
+
+  const WriteJournalKind(this.code);
+
+  /// Value stored in the record.
+  final int code;
+}
+
+/// One write read back from a journal file.
+@immutable
+class WriteJournalRecord {
+  /// Creates a record.
+  const WriteJournalRecord({
+    required this.kind,
+    required this.time,
+    required this.deviceId,
+    required this.objectType,
+    required this.instance,
+    required this.propertyId,
+    required this.encodedValue,
+    this.invokeId = 0,
+    this.arrayIndex,
+    this.priority = 0,
+  });
+
+  /// Whether the server received or the client sent the write.
+  final WriteJournalKind kind;
+
+  /// When the write was journaled, UTC, to the millisecond.
+  final DateTime time;
+
+  /// Invoke ID of an outgoing request; 0 for incoming writes.
+  final int invokeId;
+
+  /// The device written to: this server for incoming writes, the target
+  /// for outgoing ones.
+  final int deviceId;
+
+  /// Object type written.
+  final int objectType;
+
+  /// Object instance written.
+  final int instance;
+
+  /// Property written.
+  final int propertyId;
+
+  /// Array index written, or null for the whole property.
+  final int? arrayIndex;
+
+  /// Write priority (1-16), or 0 if none was given.
+  final int priority;
+
+  /// The value as BACnet application-tagged data.
+  final Uint8List encodedValue;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is WriteJournalRecord &&
+          kind == other.kind &&
+          time == other.time &&
+          invokeId == other.invokeId &&
+          deviceId == other.deviceId &&
+          objectType == other.objectType &&
+          instance == other.instance &&
+          propertyId == other.propertyId &&
+          arrayIndex == other.arrayIndex &&
+          priority == other.priority &&
+          _bytesEqual(encodedValue, other.encodedValue);
+
+  @override
+  int get hashCode => Object.hash(
+    kind,
+    time,
+    invokeId,
+    deviceId,
+    objectType,
+    instance,
+    propertyId,
+    arrayIndex,
+    priority,
+    Object.hashAll(encodedValue),
+  );
+
+  @override
+  String toString() =>
+      'WriteJournalRecord(${kind.name} ${time.toIso8601String()}, '
+      'device: $deviceId, $objectType:$instance, property: $propertyId'
+      '${arrayIndex == null ? '' : '[$arrayIndex]'}, priority: $priority, '
+      'invokeId: $invokeId, ${encodedValue.length} value bytes)';
+
+  static bool _bytesEqual(Uint8List a, Uint8List b) {
+    if (a.length != b.length) return false;
+    for (var i = 0; i < a.length; i++) {
+      if (a[i] != b[i]) return false;
+    }
+    return true;
+  }
+}
+
+/// Decodes a write journal file.
+///
+/// The file starts with `BPWJ`, a format version and the record header
+/// length. Each record is length-prefixed and ends with a CRC-32, so a
+/// record torn by a crash mid-write is detected: decoding stops there and
+/// [validLength] tells how much of the file is intact.
+///
+/// Example:
+/// ```dart
+/// final journal = WriteJournalReader(File(path).readAsBytesSync());
+/// for (final record in journal.records) {
+///   print(record);
+/// }
+/// ```
+class WriteJournalReader {
+  /// Decodes [bytes], the content of one journal file.
+  ///
+  /// Throws [FormatException] if the file header is not a journal header.
+  WriteJournalReader(Uint8List bytes) {
+    final data = ByteData.sublistView(bytes);
+    if (bytes.length < _fileHeaderLength ||
+        String.fromCharCodes(bytes, 0, 4) != magic) {
+      throw const FormatException('Not a write journal');
+    }
+    final version = data.getUint16(4);
+    if (version != 1) {
+      throw FormatException('Unsupported write journal version $version');
+    }
+    final headerLength = data.getUint16(6);
+    var offset = _fileHeaderLength;
+    while (offset + 2 <= bytes.length) {
+      final length = data.getUint16(offset);
+      if (length < headerLength + 4 || offset + length > bytes.length) break;
+      final crc = data.getUint32(offset + length - 4);
+      if (crc != crc32(bytes, offset, offset + length - 4)) break;
+      final kind = _kinds[bytes[offset + 2]];
+      if (kind != null) {
+        final valueLength = data.getUint16(offset + 30);
+        final arrayIndex = data.getUint32(offset + 26);
+        final valueStart = offset + headerLength;
+        _records.add(
+          WriteJournalRecord(
+            kind: kind,
+            priority: bytes[offset + 3],
+            time: DateTime.fromMillisecondsSinceEpoch(
+              data.getUint32(offset + 4) * 1000 + data.getUint16(offset + 8),
+              isUtc: true,
+            ),
+            invokeId: bytes[offset + 10],
+            deviceId: data.getUint32(offset + 12),
+            objectType: data.getUint16(offset + 16),
+            instance: data.getUint32(offset + 18),
+            propertyId: data.getUint32(offset + 22),
+            arrayIndex: arrayIndex == _arrayAll ? null : arrayIndex,
+            encodedValue: Uint8List.fromList(
+              bytes.sublist(valueStart, valueStart + valueLength),
+            ),
+          ),
+        );
+      }
+      offset += length;
+    }
+    validLength = offset;
+  }
+
+  /// File signature.
+  static const String magic = 'BPWJ';
+
+  static const int _fileHeaderLength = 8;
+  static const int _arrayAll = 0xFFFFFFFF;
+  static final Map<int, WriteJournalKind> _kinds = {
+    for (final kind in WriteJournalKind.values) kind.code: kind,
+  };
+
+  final List<WriteJournalRecord> _records = [];
+
+  /// Intact records, in the order they were written. Records of unknown
+  /// kinds are skipped.
+  List<WriteJournalRecord> get records => List.unmodifiable(_records);
+
+  /// Bytes of the file up to the end of the last intact record. Less than
+  /// the file length if the last batch was torn or corrupted.
+  late final int validLength;
+
+  /// CRC-32 (IEEE 802.3) of `bytes[start, end)`, as stored in records.
+  static int crc32(List<int> bytes, [int start = 0, int? end]) {
+    var crc = 0xFFFFFFFF;
+    for (var i = start; i < (end ?? bytes.length); i++) {
+      crc ^= bytes[i];
+      for (var bit = 0; bit < 8; bit++) {
+        crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+      }
+    }
+    return ~crc & 0xFFFFFFFF;
+  }
+}
@@ -3,13 +3,24 @@ import 'dart:isolate';
 
 import 'package:flutter/foundation.dart';
 
+import '../core/admission_control.dart';
+import '../core/bacnet_config.dart';
 import '../core/exceptions.dart';
 import '../core/logger.dart';
+import '../core/read_hedging.dart';
 import '../core/types.dart';
+import '../models/bacnet_metrics.dart';
+import '../models/bacnet_object.dart';
 import '../models/internal/worker_message.dart';
+import '../models/priority_array.dart';
 import '../models/rpm_models.dart';
+import '../models/server_image.dart';
+import '../models/startup_timings.dart';
 import '../models/wpm_models.dart';
+import '../models/write_journal.dart';
 import 'worker/entry_point.dart';
+import 'worker/local_send_port.dart';
+import 'worker_supervisor.dart';
 
 /// Low-level BACnet system interface managing the worker isolate.
 ///
@@ -26,6 +37,19 @@ class BacnetSystem {
 
   Isolate? _workerIsolate;
   SendPort? _workerSendPort;
+  ReceivePort? _workerReceivePort;
+  ReceivePort? _workerExitPort;
+  Future<void>? _startFuture;
+  String? _workerInterface;
+  int? _workerPort;
+  MstpConfig? _workerMstp;
+  BacnetExecutionMode _workerMode = BacnetExecutionMode.worker;
+  WorkerReadyResponse? _readyMessage;
+  BacnetStartupTimings? _startupTimings;
+
+  /// True while no client holds the system (after [dispose]); the worker
+  /// stays warm but its events are dropped.
+  bool _suspended = true;
   Completer<void> _initCompleter = Completer<void>();
   StreamController<dynamic> _eventController =
       StreamController<dynamic>.broadcast();
@@ -34,6 +58,13 @@ class BacnetSystem {
   int _trackingIdCounter = 0;
   final Map<int, int> _invokeToTrackingMap = {};
 
+  final AdmissionController _admission = AdmissionController();
+  final WorkerSupervisor _supervisor = WorkerSupervisor();
+  ReadHedger? _hedger;
+
+  /// Idempotent requests in flight, reissued if the worker dies.
+  final Map<int, WorkerRequest> _reissuable = {};
+
   BacnetLogger _logger = const DeveloperBacnetLogger();
 
   /// Sets the logger for BACnet system messages.
@@ -56,55 +87,219 @@ class BacnetSystem {
   /// Includes I-Am responses, COV notifications, and write notifications.
   Stream<dynamic> get events => _eventController.stream;
 
+  /// Startup phase breakdown of the most recent [start] or [prewarm].
+  BacnetStartupTimings? get startupTimings => _startupTimings;
+
   /// Starts the BACnet worker isolate and initializes the BACnet stack.
   ///
+  /// If a worker is already running (for example after [prewarm], or after
+  /// [dispose]) with the same [interface] and [port], it is reused and this
+  /// returns without reloading the library or rebinding the socket.
+  ///
   /// [interface] - Optional network interface name to bind to.
   /// [port] - UDP port to listen on (default 47808).
-  Future<void> start({String? interface, int port = 47808}) async {
-    // Idempotent: if already started, just return
-    if (_workerIsolate != null) {
-      return;
-    }
+  /// [mstp] - MS/TP serial settings; when set, the stack runs as an MS/TP
+  /// master node instead of on BACnet/IP and [interface] and [port] are
+  /// ignored.
+  /// [mode] - Whether the stack runs on a worker isolate or on this one;
+  /// see [BacnetExecutionMode].
+  Future<void> start({
+    String? interface,
+    int port = 47808,
+    MstpConfig? mstp,
+    BacnetExecutionMode mode = BacnetExecutionMode.worker,
+  }) async {
+    final stopwatch = Stopwatch()..start();
+    final warm = _startFuture != null && _matches(interface, port, mstp, mode);
 
-    // Recreate completer and event controller if disposed
-    if (_initCompleter.isCompleted) {
-      _initCompleter = Completer<void>();
-    }
     if (_eventController.isClosed) {
       _eventController = StreamController<dynamic>.broadcast();
     }
+    await _ensureWorker(interface, port, mstp, mode);
+    _suspended = false;
+
+    if (warm) {
+      _startupTimings = BacnetStartupTimings(
+        total: stopwatch.elapsed,
+        reused: true,
+      );
+    }
+  }
+
+  /// Spawns the worker, loads the native library and binds the socket
+  /// without making the system active.
+  ///
+  /// Call this during app launch so a later [start] with the same arguments
+  /// completes immediately.
+  Future<void> prewarm({
+    String? interface,
+    int port = 47808,
+    MstpConfig? mstp,
+    BacnetExecutionMode mode = BacnetExecutionMode.worker,
+  }) => _ensureWorker(interface, port, mstp, mode);
+
+  bool _matches(
+    String? interface,
+    int port,
+    MstpConfig? mstp,
+    BacnetExecutionMode mode,
+  ) =>
+      mode == _workerMode &&
+      (mstp != null
+          ? mstp == _workerMstp
+          : _workerMstp == null &&
+                interface == _workerInterface &&
+                port == _workerPort);
+
+  Future<void> _ensureWorker(
+    String? interface,
+    int port,
+    MstpConfig? mstp,
+    BacnetExecutionMode mode,
+  ) {
+    final existing = _startFuture;
+    if (existing != null) {
+      if (_matches(interface, port, mstp, mode)) return existing;
+      _killWorker();
+    }
+    return _startFuture = _spawnWorker(interface, port, mstp, mode);
+  }
+
+  Future<void> _spawnWorker(
+    String? interface,
+    int port,
+    MstpConfig? mstp,
+    BacnetExecutionMode mode, {
+    bool recovering = false,
+  }) async {
+    final stopwatch = Stopwatch()..start();
+    _workerInterface = interface;
+    _workerPort = port;
+    _workerMstp = mstp;
+    _workerMode = mode;
+    // Requests issued while a crashed worker is being replaced already wait
+    // on the pending completer.
+    if (_initCompleter.isCompleted) _initCompleter = Completer<void>();
+    final initCompleter = _initCompleter;
 
     final receivePort = ReceivePort();
-    _workerIsolate = await Isolate.spawn(bacnetWorkerEntryPoint, {
-      'sendPort': receivePort.sendPort,
+    _workerReceivePort = receivePort;
+    final exitPort = ReceivePort();
+    _workerExitPort = exitPort;
+    exitPort.listen((message) {
+      if (!identical(_workerExitPort, exitPort)) return;
+      // onError delivers [error, stack]; onExit delivers null.
+      _onWorkerDied(
+        message is List && message.isNotEmpty
+            ? 'Uncaught worker error: ${message.first}'
+            : 'Worker isolate exited',
+      );
+    });
+    void onMessage(dynamic message) {
+      if (message is WorkerReadyResponse) {
+        _workerSendPort = message.sendPort;
+        _readyMessage = message;
+        if (!initCompleter.isCompleted) {
+          initCompleter.complete();
+        }
+      } else if (message is WorkerResponse) {
+        _handleWorkerMessage(message);
+      }
+    }
+
+    final args = <String, dynamic>{
       'interface': interface,
       'port': port,
-    }, debugName: 'BacnetWorker');
+      'mstp': mstp,
+      'recovering': recovering,
+    };
 
-    receivePort.listen((message) {
-      if (message is SendPort) {
-        _workerSendPort = message;
-        if (!_initCompleter.isCompleted) {
-          _initCompleter.complete();
+    try {
+      if (mode == BacnetExecutionMode.direct) {
+        // Replies are raised from inside native callbacks; handle them once
+        // the stack has unwound so completions cannot re-enter it.
+        bacnetDirectEntryPoint({
+          ...args,
+          'sendPort': LocalSendPort((message) {
+            scheduleMicrotask(() {
+              if (identical(_workerReceivePort, receivePort)) {
+                onMessage(message);
+              }
+            });
+          }),
+        });
+      } else {
+        receivePort.listen(onMessage);
+        final isolate = await Isolate.spawn(
+          bacnetWorkerEntryPoint,
+          {...args, 'sendPort': receivePort.sendPort},
+          debugName: 'BacnetWorker',
+          onExit: exitPort.sendPort,
+          onError: exitPort.sendPort,
+        );
+        if (!identical(_workerReceivePort, receivePort)) {
+          // A start with different arguments replaced this worker meanwhile.
+          isolate.kill(priority: Isolate.immediate);
+          throw const BacnetException('Worker start superseded');
         }
-      } else if (message is WorkerResponse) {
-        _handleWorkerMessage(message);
+        _workerIsolate = isolate;
       }
-    });
+      final spawn = stopwatch.elapsed;
+
+      await initCompleter.future;
+
+      final ready = _readyMessage!;
+      _startupTimings = BacnetStartupTimings(
+        spawn: spawn,
+        libraryLoad: ready.libraryLoad,
+        socketInit: ready.socketInit,
+        handlerSetup: ready.handlerSetup,
+        total: stopwatch.elapsed,
+      );
+      _logger.log(BacnetLogLevel.info, 'Worker started: $_startupTimings');
+    } on Object {
+      if (identical(_workerReceivePort, receivePort)) _killWorker();
+      rethrow;
+    }
+  }
+
+  void _emit(WorkerResponse message) {
+    if (_suspended || _eventController.isClosed) return;
+    _eventController.add(message);
   }
 
   void _handleWorkerMessage(WorkerResponse message) {
     if (message is ErrorResponse) {
+      final trackingId = message.trackingId;
+      if (trackingId != null) {
+        _failRequest(
+          trackingId,
+          BacnetRequestNotSentException(message.error),
+        );
+        return;
+      }
       if (!_initCompleter.isCompleted) {
         _initCompleter.completeError(message.error);
+      } else if (message.fatal) {
+        _onWorkerDied(message.error);
       } else {
-        _eventController.add(message);
+        _emit(message);
       }
       return;
     }
 
     if (message is ReadPropertySentResponse) {
       _invokeToTrackingMap[message.invokeId] = message.trackingId;
+    } else if (message is WritePropertyMultipleSentResponse) {
+      _invokeToTrackingMap[message.invokeId] = message.trackingId;
+    } else if (message is SimpleAckResponse) {
+      final trackingId = _invokeToTrackingMap.remove(message.invokeId);
+      if (trackingId != null) {
+        final completer = _pendingRequests.remove(trackingId);
+        if (completer != null && !completer.isCompleted) {
+          completer.complete(null);
+        }
+      }
     } else if (message is ReadPropertyAckResponse) {
       final trackingId = _invokeToTrackingMap.remove(message.invokeId);
       if (trackingId != null) {
@@ -113,7 +308,7 @@ class BacnetSystem {
           completer.complete(message.value);
         }
       }
-      _eventController.add(message);
+      _emit(message);
     } else if (message is ReadRangeAckResponse) {
       final trackingId = _invokeToTrackingMap.remove(message.invokeId);
       if (trackingId != null) {
@@ -122,7 +317,7 @@ class BacnetSystem {
           completer.complete(message);
         }
       }
-      _eventController.add(message);
+      _emit(message);
     } else if (message is ReadPropertyMultipleAckResponse) {
       final trackingId = _invokeToTrackingMap.remove(message.invokeId);
       if (trackingId != null) {
@@ -131,7 +326,78 @@ class BacnetSystem {
           completer.complete(message.values);
         }
       }
-      _eventController.add(message);
+      _emit(message);
+    } else if (message is PriorityArraysAckResponse) {
+      final trackingId = _invokeToTrackingMap.remove(message.invokeId);
+      if (trackingId != null) {
+        final completer = _pendingRequests.remove(trackingId);
+        if (completer != null && !completer.isCompleted) {
+          completer.complete(message.arrays);
+        }
+      }
+    } else if (message is RequestAbortedResponse) {
+      final trackingId = _invokeToTrackingMap.remove(message.invokeId);
+      if (trackingId != null) {
+        _failRequest(
+          trackingId,
+          BacnetAbortException(
+            'Request aborted by device',
+            reason: message.reason,
+          ),
+        );
+      }
+    } else if (message is RequestRejectedResponse) {
+      final trackingId = _invokeToTrackingMap.remove(message.invokeId);
+      if (trackingId != null) {
+        _failRequest(
+          trackingId,
+          BacnetRejectException(
+            'Request rejected by device',
+            reason: message.reason,
+          ),
+        );
+      }
+    } else if (message is RequestErrorResponse) {
+      final trackingId = _invokeToTrackingMap.remove(message.invokeId);
+      if (trackingId != null) {
+        _failRequest(
+          trackingId,
+          BacnetProtocolException(
+            'Device returned an error',
+            errorClass: message.errorClass,
+            errorCode: message.errorCode,
+          ),
+        );
+      }
+    } else if (message is MetricsResponse) {
+      final completer = _pendingRequests.remove(message.trackingId);
+      if (completer != null && !completer.isCompleted) {
+        completer.complete(
+          message.toMetrics(
+            admission: _admission.stats,
+            hedging: _hedger?.stats ?? const HedgingStats(),
+            supervisor: _supervisor.stats,
+          ),
+        );
+      }
+    } else if (message is DirectedWhoIsResponse) {
+      final completer = _pendingRequests.remove(message.trackingId);
+      if (completer != null && !completer.isCompleted) {
+        completer.complete(message.unbound);
+      }
+    } else if (message is ServerImageResponse) {
+      final completer = _pendingRequests.remove(message.trackingId);
+      if (completer != null && !completer.isCompleted) {
+        completer.complete(message.info);
+      }
+    } else if (message is WriteJournalResponse) {
+      final completer = _pendingRequests.remove(message.trackingId);
+      if (completer != null && !completer.isCompleted) {
+        completer.complete(message.stats);
+      }
+    } else if (message is IAmResponse) {
+      _supervisor.recordIAm(message);
+      _emit(message);
     } else if (message is LogResponse) {
       // Also print to console for debugging
       debugPrint('[Worker] ${message.message}');
@@ -144,16 +410,49 @@ class BacnetSystem {
             : null,
       );
     } else {
-      _eventController.add(message);
+      _emit(message);
     }
   }
 
   /// Sends a request to the worker isolate.
+  ///
+  /// Bindings, foreign device registration and the packet filter are
+  /// remembered and replayed if the worker has to be restarted.
   Future<void> send(WorkerRequest request) async {
     await _initCompleter.future;
+    _supervisor.record(request);
+    _workerSendPort?.send(request);
+  }
+
+  /// Sends a tracked request, remembering idempotent ones so they can be
+  /// reissued after a worker restart.
+  void _sendTracked(int trackingId, WorkerRequest request) {
+    _reissuable.removeWhere((id, _) => !_pendingRequests.containsKey(id));
+    if (WorkerSupervisor.isReissuable(request)) {
+      _reissuable[trackingId] = request;
+    }
     _workerSendPort?.send(request);
   }
 
+  /// Turns hedging of ReadProperty and ReadPropertyMultiple on with
+  /// [policy], or off with null. Replacing the policy resets the round
+  /// trips seen so far.
+  void setReadHedging(ReadHedgingPolicy? policy) {
+    _hedger = policy == null
+        ? null
+        : ReadHedger(policy, canHedge: () => !_admission.isDropping);
+  }
+
+  /// Runs [attempt] through the hedger, if hedging is on.
+  ///
+  /// A hedge is sent within the slot admission control gave the read, so
+  /// a copy still in flight when the read returns is not counted there;
+  /// the hedging budget bounds those.
+  Future<T> _hedged<T>(int deviceId, Future<T> Function() attempt) {
+    final hedger = _hedger;
+    return hedger == null ? attempt() : hedger.run(deviceId, attempt);
+  }
+
   /// Sends a ReadProperty request and waits for the response.
   Future<dynamic> sendReadProperty(
     int deviceId,
@@ -161,13 +460,35 @@ class BacnetSystem {
     int instance,
     int propertyId, {
     int arrayIndex = -1,
-  }) async {
+    BacnetRequestPriority priority = BacnetRequestPriority.interactive,
+  }) => _admitted(
+    priority,
+    () => _hedged(
+      deviceId,
+      () => _readPropertyOnce(
+        deviceId,
+        objectType,
+        instance,
+        propertyId,
+        arrayIndex,
+      ),
+    ),
+  );
+
+  Future<dynamic> _readPropertyOnce(
+    int deviceId,
+    int objectType,
+    int instance,
+    int propertyId,
+    int arrayIndex,
+  ) async {
     await _initCompleter.future;
     final trackingId = ++_trackingIdCounter;
     final completer = Completer<dynamic>();
     _pendingRequests[trackingId] = completer;
 
-    _workerSendPort?.send(
+    _sendTracked(
+      trackingId,
       ReadPropertyRequest(
         trackingId: trackingId,
         deviceId: deviceId,
@@ -189,6 +510,15 @@ class BacnetSystem {
 
   /// Sends a ReadPropertyMultiple request and waits for the response.
   Future<Map<String, Map<int, dynamic>>> sendReadPropertyMultiple(
+    int deviceId,
+    List<BacnetReadAccessSpecification> specs, {
+    BacnetRequestPriority priority = BacnetRequestPriority.interactive,
+  }) => _admitted(
+    priority,
+    () => _hedged(deviceId, () => _readPropertyMultipleOnce(deviceId, specs)),
+  );
+
+  Future<Map<String, Map<int, dynamic>>> _readPropertyMultipleOnce(
     int deviceId,
     List<BacnetReadAccessSpecification> specs,
   ) async {
@@ -205,7 +535,8 @@ class BacnetSystem {
 
     debugPrint('🟢 Main: Sending RPM to worker (trackingId: $trackingId)');
 
-    _workerSendPort?.send(
+    _sendTracked(
+      trackingId,
       ReadPropertyMultipleRequest(
         trackingId: trackingId,
         deviceId: deviceId,
@@ -224,21 +555,147 @@ class BacnetSystem {
     );
   }
 
-  /// Sends a WritePropertyMultiple request.
-  Future<void> sendWritePropertyMultiple(
+  /// Reads the priority arrays of [objects] with one RPM.
+  ///
+  /// The worker decodes the ack into one [BacnetPriorityArray] per object.
+  Future<List<BacnetPriorityArray>> sendReadPriorityArrays(
     int deviceId,
-    List<BacnetWriteAccessSpecification> specs, {
-    int? trackingId,
-  }) async {
-    await send(
-      WritePropertyMultipleRequest(
-        deviceId: deviceId,
-        writeAccessSpecs: specs,
+    List<BacnetObject> objects, {
+    BacnetRequestPriority priority = BacnetRequestPriority.interactive,
+  }) => _admitted(priority, () async {
+    await _initCompleter.future;
+    final trackingId = ++_trackingIdCounter;
+    final completer = Completer<dynamic>();
+    _pendingRequests[trackingId] = completer;
+
+    _sendTracked(
+      trackingId,
+      ReadPriorityArraysRequest(
         trackingId: trackingId,
+        deviceId: deviceId,
+        objects: objects,
       ),
     );
+
+    final response = await completer.future.timeout(
+      const Duration(seconds: 15),
+      onTimeout: () {
+        _pendingRequests.remove(trackingId);
+        throw const BacnetTimeoutException('Priority array read timed out');
+      },
+    );
+    return response as List<BacnetPriorityArray>;
+  });
+
+  /// Sends a WriteProperty request and waits for the SimpleAck.
+  Future<void> sendWriteProperty(
+    int deviceId,
+    int objectType,
+    int instance,
+    int propertyId,
+    dynamic value, {
+    int priority = 16,
+    int tag = 4,
+  }) => _sendConfirmed(
+    (trackingId) => WritePropertyRequest(
+      deviceId: deviceId,
+      objectType: objectType,
+      instance: instance,
+      propertyId: propertyId,
+      value: value,
+      priority: priority,
+      tag: tag,
+      trackingId: trackingId,
+    ),
+    'WriteProperty timed out',
+  );
+
+  /// Sends a WritePropertyMultiple request and waits for the SimpleAck.
+  Future<void> sendWritePropertyMultiple(
+    int deviceId,
+    List<BacnetWriteAccessSpecification> specs,
+  ) => _sendConfirmed(
+    (trackingId) => WritePropertyMultipleRequest(
+      deviceId: deviceId,
+      writeAccessSpecs: specs,
+      trackingId: trackingId,
+    ),
+    'WritePropertyMultiple timed out',
+  );
+
+  /// Sends a SubscribeCOVProperty request and waits for the SimpleAck.
+  ///
+  /// Acknowledged subscriptions are replayed if the worker is restarted.
+  Future<void> sendSubscribeCOV(
+    int deviceId,
+    int objectType,
+    int instance, {
+    int propertyId = 85,
+    bool confirmed = false,
+    int lifetime = 120,
+    double? covIncrement,
+  }) async {
+    SubscribeCOVRequest build(int? trackingId) => SubscribeCOVRequest(
+      deviceId: deviceId,
+      objectType: objectType,
+      instance: instance,
+      propertyId: propertyId,
+      confirmed: confirmed,
+      lifetime: lifetime,
+      covIncrement: covIncrement,
+      trackingId: trackingId,
+    );
+    await _sendConfirmed(build, 'SubscribeCOV timed out');
+    _supervisor.record(build(null));
   }
 
+  /// Cancels a SubscribeCOVProperty subscription and waits for the
+  /// SimpleAck.
+  ///
+  /// The subscription is no longer replayed after a worker restart, even
+  /// if the device does not acknowledge the cancellation.
+  Future<void> sendUnsubscribeCOV(
+    int deviceId,
+    int objectType,
+    int instance, {
+    int propertyId = 85,
+  }) async {
+    SubscribeCOVRequest build(int? trackingId) => SubscribeCOVRequest(
+      deviceId: deviceId,
+      objectType: objectType,
+      instance: instance,
+      propertyId: propertyId,
+      cancel: true,
+      trackingId: trackingId,
+    );
+    _supervisor.record(build(null));
+    await _sendConfirmed(build, 'SubscribeCOV cancellation timed out');
+  }
+
+  /// Sends a confirmed request that is answered with a SimpleAck.
+  ///
+  /// Error, Reject and Abort PDUs fail the future as soon as they arrive.
+  Future<void> _sendConfirmed(
+    WorkerRequest Function(int trackingId) build,
+    String timeoutMessage, {
+    BacnetRequestPriority priority = BacnetRequestPriority.interactive,
+  }) => _admitted(priority, () async {
+    await _initCompleter.future;
+    final trackingId = ++_trackingIdCounter;
+    final completer = Completer<dynamic>();
+    _pendingRequests[trackingId] = completer;
+
+    _workerSendPort?.send(build(trackingId));
+
+    await completer.future.timeout(
+      const Duration(seconds: 15),
+      onTimeout: () {
+        _pendingRequests.remove(trackingId);
+        throw BacnetTimeoutException(timeoutMessage);
+      },
+    );
+  });
+
   /// Sends a ReadRange request.
   Future<ReadRangeAckResponse> sendReadRange(
     int deviceId, {
@@ -249,13 +706,15 @@ class BacnetSystem {
     int requestType = 1, // RR_BY_POSITION
     dynamic reference = 1, // Start index 1
     int count = 0,
-  }) async {
+    BacnetRequestPriority priority = BacnetRequestPriority.interactive,
+  }) => _admitted(priority, () async {
     await _initCompleter.future;
     final trackingId = ++_trackingIdCounter;
     final completer = Completer<dynamic>();
     _pendingRequests[trackingId] = completer;
 
-    _workerSendPort?.send(
+    _sendTracked(
+      trackingId,
       ReadRangeRequest(
         deviceId: deviceId,
         objectType: objectType,
@@ -282,24 +741,318 @@ class BacnetSystem {
     } else {
       throw BacnetException('Unexpected response: $response');
     }
+  });
+
+  /// Runs [send] once admission control lets a [priority] request through.
+  ///
+  /// Throws [BacnetOverloadException] if the request is shed.
+  Future<T> _admitted<T>(
+    BacnetRequestPriority priority,
+    Future<T> Function() send,
+  ) async {
+    await _initCompleter.future;
+    await _admission.admit(priority);
+    try {
+      return await send();
+    } finally {
+      _admission.release(priority);
+    }
+  }
+
+  /// Requests a snapshot of the worker's runtime counters.
+  Future<BacnetMetrics> getMetrics() async {
+    await _initCompleter.future;
+    final trackingId = ++_trackingIdCounter;
+    final completer = Completer<dynamic>();
+    _pendingRequests[trackingId] = completer;
+
+    _workerSendPort?.send(MetricsRequest(trackingId: trackingId));
+
+    final response = await completer.future.timeout(
+      const Duration(seconds: 5),
+      onTimeout: () {
+        _pendingRequests.remove(trackingId);
+        throw const BacnetTimeoutException('Metrics request timed out');
+      },
+    );
+    return response as BacnetMetrics;
+  }
+
+  /// Sends a unicast Who-Is to the cached address of each of [deviceIds].
+  ///
+  /// Returns the devices that have no cached address and were skipped.
+  Future<List<int>> sendDirectedWhoIs(List<int> deviceIds) async {
+    await _initCompleter.future;
+    final trackingId = ++_trackingIdCounter;
+    final completer = Completer<dynamic>();
+    _pendingRequests[trackingId] = completer;
+
+    _workerSendPort?.send(
+      DirectedWhoIsRequest(deviceIds, trackingId: trackingId),
+    );
+
+    final response = await completer.future.timeout(
+      const Duration(seconds: 5),
+      onTimeout: () {
+        _pendingRequests.remove(trackingId);
+        throw const BacnetTimeoutException('Directed Who-Is timed out');
+      },
+    );
+    return response as List<int>;
+  }
+
+  /// Writes the hosted object database to the image file at [path].
+  Future<BacnetServerImageInfo> saveServerImage(String path) => _serverImage(
+    (trackingId) => ServerSnapshotRequest(path, trackingId: trackingId),
+  );
+
+  /// Initializes the hosted device from the image file at [path].
+  Future<BacnetServerImageInfo> loadServerImage(String path) => _serverImage(
+    (trackingId) => ServerRestoreRequest(path, trackingId: trackingId),
+  );
+
+  Future<BacnetServerImageInfo> _serverImage(
+    WorkerRequest Function(int trackingId) request,
+  ) async {
+    await _initCompleter.future;
+    final trackingId = ++_trackingIdCounter;
+    final completer = Completer<dynamic>();
+    _pendingRequests[trackingId] = completer;
+
+    _workerSendPort?.send(request(trackingId));
+
+    final response = await completer.future.timeout(
+      const Duration(seconds: 30),
+      onTimeout: () {
+        _pendingRequests.remove(trackingId);
+        throw const BacnetTimeoutException('Server image request timed out');
+      },
+    );
+    return response as BacnetServerImageInfo;
+  }
+
+  /// Opens the native write journal with [config].
+  ///
+  /// The journal is reopened with the same settings if the worker restarts.
+  Future<WriteJournalStats> openWriteJournal(
+    WriteJournalConfig config,
+  ) async {
+    final stats = await _writeJournal(
+      (trackingId) => OpenWriteJournalRequest(config, trackingId: trackingId),
+    );
+    _supervisor.record(OpenWriteJournalRequest(config));
+    return stats;
+  }
+
+  /// Waits up to [timeout] until every journaled write is on disk.
+  Future<WriteJournalStats> flushWriteJournal(Duration timeout) =>
+      _writeJournal(
+        (trackingId) =>
+            SyncWriteJournalRequest(timeout, trackingId: trackingId),
+        timeout: timeout + const Duration(seconds: 5),
+      );
+
+  /// Commits outstanding writes and closes the journal.
+  Future<WriteJournalStats> closeWriteJournal() {
+    // Forget it first, so a restart during the close does not reopen it.
+    _supervisor.record(const CloseWriteJournalRequest(trackingId: 0));
+    return _writeJournal(
+      (trackingId) => CloseWriteJournalRequest(trackingId: trackingId),
+    );
   }
 
-  /// Stops the worker isolate and cleans up resources.
+  Future<WriteJournalStats> _writeJournal(
+    WorkerRequest Function(int trackingId) request, {
+    Duration timeout = const Duration(seconds: 10),
+  }) async {
+    await _initCompleter.future;
+    final trackingId = ++_trackingIdCounter;
+    final completer = Completer<dynamic>();
+    _pendingRequests[trackingId] = completer;
+
+    _workerSendPort?.send(request(trackingId));
+
+    final response = await completer.future.timeout(
+      timeout,
+      onTimeout: () {
+        _pendingRequests.remove(trackingId);
+        throw const BacnetTimeoutException('Write journal request timed out');
+      },
+    );
+    return response as WriteJournalStats;
+  }
+
+  /// Detaches from the worker and cleans up resources.
+  ///
+  /// The worker isolate stays warm: the native library stays loaded and the
+  /// socket stays bound, so a later [start] with the same interface and port
+  /// resumes immediately. Use [shutdown] to stop the worker isolate itself.
   void dispose() {
+    _suspended = true;
+
+    // Close current event controller
+    _eventController.close();
+
+    _failPending('BacnetSystem disposed');
+  }
+
+  /// Stops the worker isolate and closes its socket.
+  void shutdown() {
+    dispose();
+    _killWorker();
+  }
+
+  /// Handles an unexpected worker death: fails what cannot be retried and
+  /// starts the replacement worker.
+  void _onWorkerDied(String cause) {
+    if (_workerExitPort == null) return;
+    if (!_initCompleter.isCompleted) {
+      // Died before it was ready; _spawnWorker reports the failure.
+      _initCompleter.completeError(
+        BacnetException('BACnet worker died during startup: $cause'),
+      );
+      return;
+    }
+    final detected = Stopwatch()..start();
+    _logger.log(BacnetLogLevel.error, 'BACnet worker died: $cause');
+
+    _workerExitPort?.close();
+    _workerExitPort = null;
     _workerIsolate?.kill(priority: Isolate.immediate);
     _workerIsolate = null;
     _workerSendPort = null;
+    _workerReceivePort?.close();
+    _workerReceivePort = null;
+    _readyMessage = null;
+    // Invoke IDs belonged to the dead worker's stack.
+    _invokeToTrackingMap.clear();
+    _initCompleter = Completer<void>();
 
-    // Close current event controller
-    _eventController.close();
+    final delay = _supervisor.onCrash(cause);
+    if (delay == null) {
+      _logger.log(
+        BacnetLogLevel.error,
+        'BACnet worker keeps crashing; not restarting it again',
+      );
+      _startFuture = null;
+      _initCompleter.completeError(
+        BacnetException('BacnetSystem worker crashed: $cause'),
+      );
+      _failPending('BacnetSystem worker crashed: $cause');
+      return;
+    }
+
+    final failed = [
+      for (final trackingId in _pendingRequests.keys)
+        if (!_reissuable.containsKey(trackingId)) trackingId,
+    ];
+    for (final trackingId in failed) {
+      _failRequest(
+        trackingId,
+        BacnetWorkerRestartedException(
+          'Worker restarted while the request was in flight: $cause',
+        ),
+      );
+    }
+    _supervisor.recordFailed(failed.length);
+
+    _startFuture = _recover(cause, delay, detected);
+  }
+
+  Future<void> _recover(
+    String cause,
+    Duration delay,
+    Stopwatch detected,
+  ) async {
+    if (delay > Duration.zero) await Future<void>.delayed(delay);
+    try {
+      await _spawnWorker(
+        _workerInterface,
+        _workerPort ?? 47808,
+        _workerMstp,
+        _workerMode,
+        recovering: true,
+      );
+    } on Object catch (e, st) {
+      _logger.log(BacnetLogLevel.error, 'BACnet worker restart failed', e, st);
+      return;
+    }
+
+    final sendPort = _workerSendPort;
+    if (sendPort == null) return;
+    final replay = _supervisor.replayPlan();
+    for (final request in replay) {
+      sendPort.send(request);
+    }
+
+    var reissued = 0;
+    _reissuable.removeWhere((id, _) => !_pendingRequests.containsKey(id));
+    for (final request in _reissuable.values) {
+      sendPort.send(request);
+      reissued++;
+    }
+
+    final elapsed = detected.elapsed;
+    _supervisor.recordRecovery(
+      elapsed,
+      replayed: replay.length,
+      reissued: reissued,
+    );
+    _logger.log(
+      BacnetLogLevel.warning,
+      'BACnet worker restarted in ${elapsed.inMilliseconds} ms '
+      '(${replay.length} replayed, $reissued reads reissued)',
+    );
+    _emit(
+      WorkerRestartedResponse(
+        cause: cause,
+        recoveryTime: elapsed,
+        reissuedRequests: reissued,
+      ),
+    );
+  }
+
+  void _killWorker() {
+    final wasStarted = _startFuture != null;
+    _workerExitPort?.close();
+    _workerExitPort = null;
+    final sendPort = _workerSendPort;
+    if (sendPort != null) {
+      // Let the worker close its socket before it exits.
+      sendPort.send(const ShutdownWorkerRequest());
+    } else {
+      _workerIsolate?.kill(priority: Isolate.immediate);
+    }
+    _workerIsolate = null;
+    _workerSendPort = null;
+    _workerReceivePort?.close();
+    _workerReceivePort = null;
+    _readyMessage = null;
+    _startFuture = null;
+    if (wasStarted && !_initCompleter.isCompleted) {
+      _initCompleter.completeError(
+        const BacnetException('BacnetSystem worker stopped'),
+      );
+    }
+    _failPending('BacnetSystem worker stopped');
+  }
+
+  void _failRequest(int trackingId, BacnetException error) {
+    final completer = _pendingRequests.remove(trackingId);
+    if (completer != null && !completer.isCompleted) {
+      completer.completeError(error);
+    }
+  }
 
-    // Clear pending requests
+  void _failPending(String reason) {
     for (final completer in _pendingRequests.values) {
       if (!completer.isCompleted) {
-        completer.completeError('BacnetSystem disposed');
+        completer.completeError(reason);
       }
     }
     _pendingRequests.clear();
     _invokeToTrackingMap.clear();
+    _reissuable.clear();
+    _admission.failQueued(BacnetException(reason));
   }
 }
@@ -0,0 +1,141 @@
+import 'dart:ffi' as ffi;
+
+import '../../../bacnet_plugin_bindings.g.dart';
+import '../../core/types.dart';
+import '../../models/rpm_models.dart';
+import '../../models/wpm_models.dart';
+import 'globals.dart';
+
+/// Builds the native `BACNET_READ_ACCESS_DATA` list for an RPM request.
+///
+/// Every node is allocated with [allocator] and appended to [owned]; the
+/// caller frees [owned] once the request has been encoded.
+ffi.Pointer<BACNET_READ_ACCESS_DATA> buildReadAccessData(
+  List<BacnetReadAccessSpecification> specs,
+  ffi.Allocator allocator,
+  List<ffi.Pointer> owned,
+) {
+  ffi.Pointer<BACNET_READ_ACCESS_DATA> head = ffi.nullptr;
+  ffi.Pointer<BACNET_READ_ACCESS_DATA> current = ffi.nullptr;
+
+  for (final spec in specs) {
+    final radPtr = allocator<BACNET_READ_ACCESS_DATA>();
+    owned.add(radPtr);
+
+    if (head == ffi.nullptr) {
+      head = radPtr;
+    } else {
+      current.ref.next = radPtr;
+    }
+    current = radPtr;
+
+    radPtr.ref.object_typeAsInt = spec.objectIdentifier.type;
+    radPtr.ref.object_instance = spec.objectIdentifier.instance;
+    radPtr.ref.next = ffi.nullptr;
+
+    ffi.Pointer<BACNET_PROPERTY_REFERENCE> headPropRef = ffi.nullptr;
+    ffi.Pointer<BACNET_PROPERTY_REFERENCE> currentPropRef = ffi.nullptr;
+
+    for (final prop in spec.properties) {
+      final propPtr = allocator<BACNET_PROPERTY_REFERENCE>();
+      owned.add(propPtr);
+
+      if (headPropRef == ffi.nullptr) {
+        headPropRef = propPtr;
+      } else {
+        currentPropRef.ref.next = propPtr;
+      }
+      currentPropRef = propPtr;
+
+      propPtr.ref.propertyIdentifierAsInt = prop.propertyIdentifier;
+      propPtr.ref.propertyArrayIndex = prop.propertyArrayIndex;
+      propPtr.ref.next = ffi.nullptr;
+    }
+
+    radPtr.ref.listOfProperties = headPropRef;
+  }
+
+  return head;
+}
+
+/// Builds the native `BACNET_WRITE_ACCESS_DATA` list for a WPM request.
+///
+/// Every node is allocated with [allocator] and appended to [owned]; the
+/// caller frees [owned] once the request has been encoded.
+ffi.Pointer<BACNET_WRITE_ACCESS_DATA> buildWriteAccessData(
+  List<BacnetWriteAccessSpecification> specs,
+  ffi.Allocator allocator,
+  List<ffi.Pointer> owned,
+) {
+  ffi.Pointer<BACNET_WRITE_ACCESS_DATA> head = ffi.nullptr;
+  ffi.Pointer<BACNET_WRITE_ACCESS_DATA> current = ffi.nullptr;
+
+  for (final spec in specs) {
+    final wadPtr = allocator<BACNET_WRITE_ACCESS_DATA>();
+    owned.add(wadPtr);
+
+    if (head == ffi.nullptr) {
+      head = wadPtr;
+    } else {
+      current.ref.next = wadPtr;
+    }
+    current = wadPtr;
+
+    wadPtr.ref.object_typeAsInt = spec.objectIdentifier.type;
+    wadPtr.ref.object_instance = spec.objectIdentifier.instance;
+    wadPtr.ref.next = ffi.nullptr;
+
+    ffi.Pointer<BACNET_PROPERTY_VALUE> headPropVal = ffi.nullptr;
+    ffi.Pointer<BACNET_PROPERTY_VALUE> currentPropVal = ffi.nullptr;
+
+    for (final prop in spec.listOfProperties) {
+      final propValPtr = allocator<BACNET_PROPERTY_VALUE>();
+      owned.add(propValPtr);
+
+      if (headPropVal == ffi.nullptr) {
+        headPropVal = propValPtr;
+      } else {
+        currentPropVal.ref.next = propValPtr;
+      }
+      currentPropVal = propValPtr;
+
+      propValPtr.ref.propertyIdentifierAsInt = prop.propertyIdentifier;
+      propValPtr.ref.propertyArrayIndex = prop.propertyArrayIndex;
+      propValPtr.ref.priority = prop.priority;
+      propValPtr.ref.next = ffi.nullptr;
+
+      // The value structure is embedded in BACNET_PROPERTY_VALUE as 'value'
+      // type BACNET_APPLICATION_DATA_VALUE
+      final appData = propValPtr.ref.value;
+      final value = prop.value;
+      final tag = prop.tag;
+
+      appData.tag = tag;
+      appData.context_specific = false;
+
+      switch (tag) {
+        case 1: // Boolean
+          appData.type.Boolean = value as bool;
+          break;
+        case 2: // Unsigned Int
+          appData.type.Unsigned_Int = value as int;
+          break;
+        case 3: // Signed Int
+          appData.type.Signed_Int = value as int;
+          break;
+        case 4: // Real
+          appData.type.Real = (value as num).toDouble();
+          break;
+        case 9: // Enumerated
+          appData.type.Enumerated = value as int;
+          break;
+        // Add more types as needed (String, Object ID, etc.)
+        default:
+          logToMain(BacnetLogLevel.warning, 'Unsupported WPM tag: $tag');
+      }
+    }
+    wadPtr.ref.listOfProperties = headPropVal;
+  }
+
+  return head;
+}
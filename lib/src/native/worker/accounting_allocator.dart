@@ -0,0 +1,88 @@
+import 'dart:ffi' as ffi;
+
+import 'package:ffi/ffi.dart';
+
+import '../../models/bacnet_metrics.dart';
+
+/// Native allocator that counts allocations per call site.
+///
+/// Every worker allocation goes through a named [site], so leaks show up as
+/// a site whose live bytes keep growing. Counters are exposed through the
+/// metrics API as [NativeMemoryStats].
+final class AccountingAllocator {
+  /// Creates an accounting allocator backed by [backing] (default [calloc]).
+  AccountingAllocator([this._backing = calloc]);
+
+  final ffi.Allocator _backing;
+  final Map<String, _SiteCounters> _sites = {};
+  final Map<int, (_SiteCounters, int)> _live = {};
+
+  /// Returns an allocator that records its allocations under [name].
+  ffi.Allocator site(String name) =>
+      _SiteAllocator(this, _sites.putIfAbsent(name, _SiteCounters.new));
+
+  /// Bytes currently allocated across all sites.
+  int get liveBytes => _sites.values.fold(0, (sum, c) => sum + c.liveBytes);
+
+  /// Current counters for every site that has allocated.
+  Map<String, NativeMemoryStats> snapshot() => {
+    for (final entry in _sites.entries) entry.key: entry.value.toStats(),
+  };
+
+  ffi.Pointer<T> _allocate<T extends ffi.NativeType>(
+    _SiteCounters counters,
+    int byteCount,
+    int? alignment,
+  ) {
+    final pointer = _backing.allocate<T>(byteCount, alignment: alignment);
+    counters
+      ..allocations++
+      ..liveBytes += byteCount;
+    if (counters.liveBytes > counters.peakBytes) {
+      counters.peakBytes = counters.liveBytes;
+    }
+    _live[pointer.address] = (counters, byteCount);
+    return pointer;
+  }
+
+  void _free(ffi.Pointer pointer) {
+    final entry = _live.remove(pointer.address);
+    if (entry != null) {
+      final (counters, byteCount) = entry;
+      counters
+        ..frees++
+        ..liveBytes -= byteCount;
+    }
+    _backing.free(pointer);
+  }
+}
+
+final class _SiteCounters {
+  int allocations = 0;
+  int frees = 0;
+  int liveBytes = 0;
+  int peakBytes = 0;
+
+  NativeMemoryStats toStats() => NativeMemoryStats(
+    allocations: allocations,
+    frees: frees,
+    liveBytes: liveBytes,
+    peakBytes: peakBytes,
+  );
+}
+
+final class _SiteAllocator implements ffi.Allocator {
+  _SiteAllocator(this._owner, this._counters);
+
+  final AccountingAllocator _owner;
+  final _SiteCounters _counters;
+
+  @override
+  ffi.Pointer<T> allocate<T extends ffi.NativeType>(
+    int byteCount, {
+    int? alignment,
+  }) => _owner._allocate<T>(_counters, byteCount, alignment);
+
+  @override
+  void free(ffi.Pointer pointer) => _owner._free(pointer);
+}
@@ -4,10 +4,17 @@ import 'package:bacnet_plugin/src/native/worker/read_range_decoder.dart';
 import 'package:bacnet_plugin/src/native/worker/rpm_decoder.dart';
 
 import '../../../bacnet_plugin_bindings.g.dart';
+import '../../constants/error_codes.dart';
+import '../../constants/property_ids.dart';
 import '../../core/types.dart';
+import '../../models/bacnet_metrics.dart';
+import '../../models/bacnet_object.dart';
+import '../../models/priority_array.dart';
 import '../../models/internal/worker_message.dart';
 import 'decoder.dart';
+import 'error_decoder.dart';
 import 'globals.dart';
+import 'hot_path_bindings.dart';
 
 /// Callback handler for I-Am service responses.
 ///
@@ -114,70 +121,57 @@ void onReadPropertyAck(
   );
 }
 
-/// Callback handler for unconfirmed COV (Change of Value) notifications.
+/// Forwards COV notifications queued by the native handlers.
 ///
-/// Processes COV notifications that do not require acknowledgment.
-void onUnconfirmedCOVNotification(
-  ffi.Pointer<ffi.Uint8> serviceRequest,
-  int serviceLen,
-  ffi.Pointer<BACNET_ADDRESS> src,
-) {
-  _processCOVNotification(serviceRequest, serviceLen);
-}
-
-/// Callback handler for confirmed COV (Change of Value) notifications.
-///
-/// Processes COV notifications that require acknowledgment from the client.
-void onConfirmedCOVNotification(
-  ffi.Pointer<ffi.Uint8> serviceRequest,
-  int serviceLen,
-  ffi.Pointer<BACNET_ADDRESS> src,
-  ffi.Pointer<BACNET_CONFIRMED_SERVICE_DATA> serviceData,
-) {
-  _processCOVNotification(serviceRequest, serviceLen);
-}
-
-void _processCOVNotification(
-  ffi.Pointer<ffi.Uint8> serviceRequest,
-  int serviceLen,
-) {
-  try {
-    int offset = 0;
-    int monitoredTypeId = -1;
-    int monitoredInst = -1;
-
-    // Heuristic: Search for Monitored Object ID (Context Tag 2 -> 0x2C)
-    while (offset < serviceLen - 5) {
-      int tag = serviceRequest[offset];
-      if (tag == 0x2C) {
-        offset++;
-        int val = 0;
-        for (int i = 0; i < 4; i++) {
-          val = (val << 8) | serviceRequest[offset++];
-        }
-        monitoredTypeId = (val >> 22) & 0x3FF;
-        monitoredInst = val & 0x3FFFFF;
-        break;
-      }
-      offset++;
-    }
-
+/// The stack decodes and acknowledges confirmed notifications itself, so
+/// the SimpleAck never waits on this isolate. Called after each receive to
+/// drain the queue through [event].
+void drainCovEvents(ffi.Pointer<BacnetPluginCovEvent> event) {
+  while (hotPath.covEventPop(event)) {
+    final e = event.ref;
+    final hasProperty = e.propertyId != BacnetPluginCovEvent.noProperty;
     workerToMainSendPort?.send(
       COVNotificationResponse(
-        objectType: monitoredTypeId,
-        instance: monitoredInst,
+        objectType: e.objectType,
+        instance: e.objectInstance,
         timestamp: DateTime.now().toIso8601String(),
+        deviceId: e.deviceId,
+        propertyId: hasProperty ? e.propertyId : -1,
+        value: hasProperty ? _covValue(e.valueTag, e.value) : null,
+        statusFlags: e.hasStatusFlags ? e.statusFlags : null,
+        timeRemaining: e.timeRemaining,
+        confirmed: e.confirmed,
       ),
     );
-    logToMain(
-      BacnetLogLevel.info,
-      'Rx COV Notification for $monitoredTypeId:$monitoredInst',
+  }
+}
+
+/// Reads the native COV counters.
+CovStats readCovStats() {
+  final alloc = nativeMemory.site('readCovStats');
+  final stats = alloc<BacnetPluginCovStats>();
+  try {
+    hotPath.covStats(stats);
+    final s = stats.ref;
+    return CovStats(
+      received: s.received,
+      retransmits: s.retransmits,
+      acked: s.acked,
+      rejected: s.rejected,
+      dropped: s.dropped,
     );
-  } on Exception catch (e) {
-    logToMain(BacnetLogLevel.error, 'COV Decode Error', e);
+  } finally {
+    alloc.free(stats);
   }
 }
 
+Object? _covValue(int tag, double value) => switch (tag) {
+  1 => value != 0,
+  2 || 3 || 9 => value.toInt(),
+  4 || 5 => value,
+  _ => null,
+};
+
 /// Callback handler for ReadPropertyMultiple acknowledgment responses.
 ///
 /// Decodes multiple property values from RPM responses and forwards them to
@@ -190,6 +184,17 @@ void onReadPropertyMultipleAck(
 ) {
   try {
     final decoded = RPMDecoder.decode(serviceRequest, serviceLen);
+    final invokeId = serviceData.ref.invoke_id;
+
+    if (priorityArrayInvokeIds.remove(invokeId)) {
+      workerToMainSendPort?.send(
+        PriorityArraysAckResponse(
+          invokeId: invokeId,
+          arrays: _toPriorityArrays(decoded),
+        ),
+      );
+      return;
+    }
 
     if (decoded.isNotEmpty) {
       workerToMainSendPort?.send(
@@ -216,6 +221,19 @@ void onReadPropertyMultipleAck(
   }
 }
 
+List<BacnetPriorityArray> _toPriorityArrays(
+  Map<String, Map<int, dynamic>> decoded,
+) {
+  return [
+    for (final MapEntry(:key, :value) in decoded.entries)
+      BacnetPriorityArray.fromDecoded(
+        BacnetObject.fromKey(key),
+        value[BacnetPropertyId.priorityArray],
+        value[BacnetPropertyId.relinquishDefault],
+      ),
+  ];
+}
+
 /// Callback handler for ReadRange acknowledgment responses.
 ///
 /// Decodes the ReadRange response including ResultFlags, ItemCount, and Data.
@@ -260,9 +278,106 @@ void onReadRangeAck(
         resultFlags: resultFlags,
         itemCount: itemCount,
         data: items,
+        firstSequence: decoded['firstSequence'] as int?,
       ),
     );
   } on Exception catch (e, st) {
     logToMain(BacnetLogLevel.error, 'ReadRange Ack Handler Error', e, st);
   }
 }
+
+/// Callback handler for Abort PDUs.
+///
+/// Forwards the abort to the main isolate so the pending request fails
+/// immediately instead of timing out. Aborts sent by a server answer one
+/// of our requests; the others abort a transaction we serve, whose invoke
+/// ID belongs to the peer and must not touch our TSM.
+void onAbort(
+  ffi.Pointer<BACNET_ADDRESS> src,
+  int invokeId,
+  int abortReason,
+  bool server,
+) {
+  if (!server) return;
+  logToMain(
+    BacnetLogLevel.warning,
+    'Rx Abort: invokeId $invokeId, reason $abortReason',
+  );
+  bindings.tsm_free_invoke_id(invokeId);
+  priorityArrayInvokeIds.remove(invokeId);
+  workerToMainSendPort?.send(
+    RequestAbortedResponse(invokeId: invokeId, reason: abortReason),
+  );
+}
+
+/// Callback handler for Reject PDUs.
+///
+/// Forwards the reject to the main isolate so the pending request fails
+/// immediately instead of timing out.
+void onReject(
+  ffi.Pointer<BACNET_ADDRESS> src,
+  int invokeId,
+  int rejectReason,
+) {
+  logToMain(
+    BacnetLogLevel.warning,
+    'Rx Reject: invokeId $invokeId, reason $rejectReason',
+  );
+  bindings.tsm_free_invoke_id(invokeId);
+  priorityArrayInvokeIds.remove(invokeId);
+  workerToMainSendPort?.send(
+    RequestRejectedResponse(invokeId: invokeId, reason: rejectReason),
+  );
+}
+
+/// Callback handler for Error PDUs of confirmed services.
+///
+/// Forwards the error class and code so the pending request fails
+/// immediately with a `BacnetProtocolException` instead of timing out.
+void onError(
+  ffi.Pointer<BACNET_ADDRESS> src,
+  int invokeId,
+  int errorClass,
+  int errorCode,
+) {
+  logToMain(
+    BacnetLogLevel.warning,
+    'Rx Error: invokeId $invokeId, class $errorClass, code $errorCode',
+  );
+  bindings.tsm_free_invoke_id(invokeId);
+  priorityArrayInvokeIds.remove(invokeId);
+  workerToMainSendPort?.send(
+    RequestErrorResponse(
+      invokeId: invokeId,
+      errorClass: errorClass,
+      errorCode: errorCode,
+    ),
+  );
+}
+
+/// Callback handler for complex Error PDUs (WritePropertyMultiple).
+///
+/// Decodes the error class and code from the service-specific payload and
+/// forwards them like [onError].
+void onComplexError(
+  ffi.Pointer<BACNET_ADDRESS> src,
+  int invokeId,
+  int serviceChoice,
+  ffi.Pointer<ffi.Uint8> serviceRequest,
+  int serviceLen,
+) {
+  final decoded = decodeComplexError(serviceRequest, serviceLen);
+  onError(
+    src,
+    invokeId,
+    decoded?.$1 ?? BacnetErrorClass.services,
+    decoded?.$2 ?? BacnetErrorCode.other,
+  );
+}
+
+/// Callback handler for SimpleAck PDUs (writes and COV subscriptions).
+///
+/// Completes the pending request that was waiting for the acknowledgement.
+void onSimpleAck(ffi.Pointer<BACNET_ADDRESS> src, int invokeId) {
+  workerToMainSendPort?.send(SimpleAckResponse(invokeId: invokeId));
+}
@@ -0,0 +1,145 @@
+import 'dart:convert';
+import 'dart:ffi' as ffi;
+import 'dart:typed_data';
+
+import 'globals.dart';
+
+/// BACnet character sets (ASHRAE 135, clause 20.2.9).
+abstract final class BacnetCharacterSet {
+  /// ANSI X3.4 / UTF-8.
+  static const int utf8 = 0;
+
+  /// IBM/Microsoft DBCS, followed by a two-byte code page.
+  static const int dbcs = 1;
+
+  /// JIS X 0208.
+  static const int jisX0208 = 2;
+
+  /// ISO 10646 UCS-4.
+  static const int ucs4 = 3;
+
+  /// ISO 10646 UCS-2.
+  static const int ucs2 = 4;
+
+  /// ISO 8859-1.
+  static const int latin1 = 5;
+}
+
+/// Canonicalizes repeated strings so equal values share one instance.
+///
+/// Object names, descriptions and unit texts repeat heavily across a site.
+/// Strings are immutable and passed by reference between the worker and
+/// the main isolate, so interning here also deduplicates what the app holds.
+final class StringInterner {
+  /// Creates an interner holding at most [maxEntries] strings of up to
+  /// [maxLength] characters.
+  StringInterner({this.maxEntries = 65536, this.maxLength = 256});
+
+  /// Pool size at which the pool is cleared and starts over.
+  final int maxEntries;
+
+  /// Longer strings are returned as-is; they rarely repeat.
+  final int maxLength;
+
+  final Map<String, String> _pool = {};
+
+  /// Number of lookups that returned an existing instance.
+  int hits = 0;
+
+  /// Number of distinct strings currently pooled.
+  int get length => _pool.length;
+
+  /// Returns the pooled instance equal to [value], pooling it if new.
+  String intern(String value) {
+    if (value.length > maxLength) return value;
+    final existing = _pool[value];
+    if (existing != null) {
+      hits++;
+      return existing;
+    }
+    if (_pool.length >= maxEntries) _pool.clear();
+    return _pool[value] = value;
+  }
+}
+
+/// Decodes a BACnet CharacterString of [length] bytes at [data] + [offset].
+///
+/// The first byte is the character set. Text is decoded from a view over
+/// native memory without copying it into a Dart list first. DBCS and
+/// JIS X 0208 text is converted natively. The result is interned.
+String decodeCharacterString(
+  ffi.Pointer<ffi.Uint8> data,
+  int offset,
+  int length,
+) {
+  if (length <= 0) return '';
+  final charset = data[offset];
+  final text = data + (offset + 1);
+  final bytes = text.asTypedList(length - 1);
+
+  final value = switch (charset) {
+    BacnetCharacterSet.utf8 => utf8.decode(bytes, allowMalformed: true),
+    BacnetCharacterSet.latin1 => latin1.decode(bytes),
+    BacnetCharacterSet.ucs2 => _decodeUcs2(bytes),
+    BacnetCharacterSet.ucs4 => _decodeUcs4(bytes),
+    BacnetCharacterSet.dbcs when bytes.length >= 2 => _decodeNative(
+      (bytes[0] << 8) | bytes[1],
+      text + 2,
+      bytes.length - 2,
+    ),
+    BacnetCharacterSet.jisX0208 => _decodeJis(bytes),
+    _ => latin1.decode(bytes),
+  };
+  return stringInterner.intern(value);
+}
+
+String _decodeUcs2(Uint8List bytes) {
+  final units = Uint16List(bytes.length ~/ 2);
+  for (var i = 0; i < units.length; i++) {
+    units[i] = (bytes[2 * i] << 8) | bytes[2 * i + 1];
+  }
+  return String.fromCharCodes(units);
+}
+
+String _decodeUcs4(Uint8List bytes) {
+  final codePoints = Uint32List(bytes.length ~/ 4);
+  final view = ByteData.sublistView(bytes);
+  for (var i = 0; i < codePoints.length; i++) {
+    codePoints[i] = view.getUint32(i * 4, Endian.big);
+  }
+  return String.fromCharCodes(codePoints);
+}
+
+// JIS X 0208 code pairs become EUC-JP by setting the high bit of each byte.
+const int _eucJpCodePage = 20932;
+
+String _decodeJis(Uint8List bytes) {
+  final alloc = nativeMemory.site('decodeCharacterString');
+  final euc = alloc<ffi.Uint8>(bytes.length);
+  try {
+    final view = euc.asTypedList(bytes.length);
+    for (var i = 0; i < bytes.length; i++) {
+      view[i] = bytes[i] | 0x80;
+    }
+    return _decodeNative(_eucJpCodePage, euc, bytes.length);
+  } finally {
+    alloc.free(euc);
+  }
+}
+
+String _decodeNative(int codePage, ffi.Pointer<ffi.Uint8> src, int length) {
+  if (length == 0) return '';
+  final alloc = nativeMemory.site('decodeCharacterString');
+  // Every DBCS character is at least one byte, so length units suffice.
+  final dst = alloc<ffi.Uint16>(length);
+  try {
+    final count = hotPath.decodeDbcs(codePage, src, length, dst, length);
+    if (count < 0) {
+      // Code page not available: keep the ASCII subset readable.
+      return latin1.decode(src.asTypedList(length));
+    }
+    return String.fromCharCodes(dst.asTypedList(count));
+  } finally {
+    alloc.free(dst);
+  }
+}
@@ -1,7 +1,8 @@
-import 'dart:convert';
 import 'dart:ffi' as ffi;
 import 'dart:typed_data';
 
+import 'charset_decoder.dart';
+
 /// Decodes BACnet application data from native memory.
 ///
 /// Parses BACnet-encoded data and returns Dart objects based on
@@ -62,14 +63,9 @@ dynamic decodeApplicationData(
     return ByteData.sublistView(list).getFloat32(0, Endian.big);
   }
   if (tagNumber == 7) {
-    // String
-    offset++; // Encoding byte skip
-    final strLen = contentLen - 1;
-    final bytes = <int>[];
-    for (int i = 0; i < strLen; i++) {
-      bytes.add(data[offset + i]);
-    }
-    return utf8.decode(bytes, allowMalformed: true);
+    // String (charset byte first)
+    if (offset + contentLen > len) return null;
+    return decodeCharacterString(data, offset, contentLen);
   }
   if (tagNumber == 9) {
     // Enumerated
@@ -1,17 +1,20 @@
 import 'dart:async';
 import 'dart:ffi' as ffi;
-import 'dart:io';
 import 'dart:isolate';
 
 import 'package:ffi/ffi.dart';
 
 import '../../../bacnet_plugin_bindings.g.dart';
+import '../../core/bacnet_config.dart';
 import '../../core/types.dart';
 import '../../models/internal/worker_message.dart';
 import 'callbacks.dart';
 import 'globals.dart';
 import 'handlers/client_handlers.dart';
 import 'handlers/server_handlers.dart';
+import 'hot_path_bindings.dart';
+import 'local_send_port.dart';
+import 'worker_buffers.dart';
 
 /// Entry point for the BACnet worker isolate.
 ///
@@ -20,34 +23,121 @@ import 'handlers/server_handlers.dart';
 /// handlers for various BACnet services and processes requests from the main isolate.
 void bacnetWorkerEntryPoint(Map<String, dynamic> args) {
   workerToMainSendPort = args['sendPort'] as SendPort;
+  final receivePort = ReceivePort();
+
+  final handle = _startStack(
+    args,
+    receivePort.sendPort,
+    pollInterval: const Duration(milliseconds: 10),
+    receiveTimeoutMs: 5,
+    exit: () {
+      receivePort.close();
+      Isolate.exit();
+    },
+  );
+  if (handle == null) return;
+
+  receivePort.listen((message) {
+    logToMain(
+      BacnetLogLevel.info,
+      '🟡 Worker: Received message of type: ${message.runtimeType}',
+    );
+    if (message is WorkerRequest) handle(message);
+  });
+}
+
+/// Starts the BACnet stack on the calling isolate.
+///
+/// Used by [BacnetExecutionMode.direct]. `args` are those of
+/// [bacnetWorkerEntryPoint], with `sendPort` a [LocalSendPort]; the
+/// [WorkerReadyResponse] carries another [LocalSendPort] that runs each
+/// request's handler synchronously. The receive loop polls without
+/// blocking every millisecond, so the caller's event loop keeps running.
+void bacnetDirectEntryPoint(Map<String, dynamic> args) {
+  workerToMainSendPort = args['sendPort'] as SendPort;
+  void Function(WorkerRequest)? handle;
+
+  handle = _startStack(
+    args,
+    LocalSendPort((message) {
+      if (message is WorkerRequest) handle?.call(message);
+    }),
+    pollInterval: const Duration(milliseconds: 1),
+    receiveTimeoutMs: 0,
+    exit: () => handle = null,
+  );
+}
+
+/// Initializes the datalink and handlers, starts the receive loop and
+/// reports [WorkerReadyResponse] with [requestPort].
+///
+/// Returns the request dispatcher, or null if initialization failed. [exit]
+/// runs after the stack has been torn down by a shutdown or native crash.
+void Function(WorkerRequest)? _startStack(
+  Map<String, dynamic> args,
+  SendPort requestPort, {
+  required Duration pollInterval,
+  required int receiveTimeoutMs,
+  required void Function() exit,
+}) {
   final interface = args['interface'] as String?;
   final port = args['port'] as int;
-  final receivePort = ReceivePort();
+  final mstp = args['mstp'] as MstpConfig?;
+  final recovering = args['recovering'] as bool? ?? false;
 
   try {
-    var libraryPath = Platform.isWindows
-        ? 'bacnet_plugin.dll'
-        : 'libbacnet_plugin.so';
-    if (Platform.isMacOS) libraryPath = 'libbacnet_plugin.dylib';
+    final startup = Stopwatch()..start();
 
-    bindings = BacnetBindings(ffi.DynamicLibrary.open(libraryPath));
-    bindings.bip_set_port(port);
+    final library = openBacnetLibrary();
+    bindings = BacnetBindings(library);
+    hotPath = HotPathBindings(library);
+    final libraryLoad = startup.elapsed;
 
-    final ifnamePtr = interface?.toNativeUtf8();
-    final success = bindings.bacnet_plugin_safe_bip_init(
-      ifnamePtr?.cast() ?? ffi.nullptr,
-    );
-    if (ifnamePtr != null) calloc.free(ifnamePtr);
+    if (recovering) {
+      // The library is process-wide, so the crashed worker's socket or
+      // serial port is still open.
+      hotPath.datalinkCleanup();
+    }
 
-    if (!success) {
-      workerToMainSendPort?.send(
-        const ErrorResponse('Failed to initialize BACnet/IP'),
+    if (mstp != null) {
+      final initAlloc = nativeMemory.site('mstp_init');
+      final portPtr = mstp.serialPort.toNativeUtf8(allocator: initAlloc);
+      final success = hotPath.mstpInit(
+        portPtr.cast(),
+        mstp.baudRate,
+        mstp.macAddress,
+        mstp.maxMaster,
+        mstp.maxInfoFrames,
       );
-      return;
+      initAlloc.free(portPtr);
+
+      if (!success) {
+        workerToMainSendPort?.send(
+          ErrorResponse('Failed to open MS/TP port ${mstp.serialPort}'),
+        );
+        return null;
+      }
+    } else {
+      bindings.bip_set_port(port);
+
+      final initAlloc = nativeMemory.site('bip_init');
+      final ifnamePtr = interface?.toNativeUtf8(allocator: initAlloc);
+      final success = bindings.bacnet_plugin_safe_bip_init(
+        ifnamePtr?.cast() ?? ffi.nullptr,
+      );
+      if (ifnamePtr != null) initAlloc.free(ifnamePtr);
+
+      if (!success) {
+        workerToMainSendPort?.send(
+          const ErrorResponse('Failed to initialize BACnet/IP'),
+        );
+        return null;
+      }
     }
+    final socketInit = startup.elapsed - libraryLoad;
 
-    // Keep callables alive to prevent GC
-    final keepAlive = <Object>[];
+    // Keep callables alive to prevent GC; closed on shutdown.
+    final keepAlive = <ffi.NativeCallable>[];
 
     final iamCallable =
         ffi.NativeCallable<unconfirmed_functionFunction>.isolateLocal(onIAm);
@@ -78,26 +168,71 @@ void bacnetWorkerEntryPoint(Map<String, dynamic> args) {
       rpmAckCallable.nativeFunction,
     );
 
-    // COV Notification Handlers
-    final covUnconfirmedCallable =
-        ffi.NativeCallable<unconfirmed_functionFunction>.isolateLocal(
-          onUnconfirmedCOVNotification,
+    // ReadRange Ack Handler
+    final readRangeAckCallable =
+        ffi.NativeCallable<confirmed_ack_functionFunction>.isolateLocal(
+          onReadRangeAck,
         );
-    keepAlive.add(covUnconfirmedCallable);
-    bindings.apdu_set_unconfirmed_handler(
-      BACnet_Unconfirmed_Service_Choice.SERVICE_UNCONFIRMED_COV_NOTIFICATION,
-      covUnconfirmedCallable.nativeFunction,
+    keepAlive.add(readRangeAckCallable);
+    bindings.apdu_set_confirmed_ack_handler(
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_READ_RANGE,
+      readRangeAckCallable.nativeFunction,
     );
 
-    final covConfirmedCallable =
-        ffi.NativeCallable<confirmed_functionFunction>.isolateLocal(
-          onConfirmedCOVNotification,
+    // Abort / Reject Handlers (all confirmed services)
+    final abortCallable =
+        ffi.NativeCallable<abort_functionFunction>.isolateLocal(onAbort);
+    keepAlive.add(abortCallable);
+    bindings.apdu_set_abort_handler(abortCallable.nativeFunction);
+
+    final rejectCallable =
+        ffi.NativeCallable<reject_functionFunction>.isolateLocal(onReject);
+    keepAlive.add(rejectCallable);
+    bindings.apdu_set_reject_handler(rejectCallable.nativeFunction);
+
+    // Error / SimpleAck Handlers, correlated by invoke ID in the main isolate
+    final errorCallable =
+        ffi.NativeCallable<error_functionFunction>.isolateLocal(onError);
+    keepAlive.add(errorCallable);
+    final complexErrorCallable =
+        ffi.NativeCallable<complex_error_functionFunction>.isolateLocal(
+          onComplexError,
+        );
+    keepAlive.add(complexErrorCallable);
+    final simpleAckCallable =
+        ffi.NativeCallable<confirmed_simple_ack_functionFunction>.isolateLocal(
+          onSimpleAck,
         );
-    keepAlive.add(covConfirmedCallable);
-    bindings.apdu_set_confirmed_handler(
-      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_COV_NOTIFICATION,
-      covConfirmedCallable.nativeFunction,
+    keepAlive.add(simpleAckCallable);
+    for (final service in const [
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_READ_PROPERTY,
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_READ_PROP_MULTIPLE,
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_READ_RANGE,
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_WRITE_PROPERTY,
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_SUBSCRIBE_COV,
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY,
+    ]) {
+      bindings.apdu_set_error_handler(service, errorCallable.nativeFunction);
+    }
+    // WPM errors carry the first failed write attempt.
+    bindings.apdu_set_complex_error_handler(
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE,
+      complexErrorCallable.nativeFunction,
     );
+    for (final service in const [
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_WRITE_PROPERTY,
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE,
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_SUBSCRIBE_COV,
+      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY,
+    ]) {
+      bindings.apdu_set_confirmed_simple_ack_handler(
+        service,
+        simpleAckCallable.nativeFunction,
+      );
+    }
+
+    // COV notifications are decoded and acknowledged natively
+    hotPath.covHandlersInit();
 
     // Write Property Handler (Server)
     final writePropCallable =
@@ -106,98 +241,222 @@ void bacnetWorkerEntryPoint(Map<String, dynamic> args) {
           exceptionalReturn: false,
         );
     keepAlive.add(writePropCallable);
-    bindings.Device_Write_Property_Store_Callback_Set(
-      writePropCallable.nativeFunction,
+    writePropertyStoreCallback = writePropCallable.nativeFunction;
+    // Installed behind the native write journal hook.
+    hotPath.writeStoreCallbackSet(writePropertyStoreCallback);
+
+    final buffers = workerBuffers = WorkerBuffers(nativeMemory);
+    final srcAddressBuffer = buffers.srcAddress;
+    final pduBuffer = buffers.pdu;
+
+    workerToMainSendPort?.send(
+      WorkerReadyResponse(
+        sendPort: requestPort,
+        libraryLoad: libraryLoad,
+        socketInit: socketInit,
+        handlerSetup: startup.elapsed - libraryLoad - socketInit,
+      ),
     );
 
-    final srcAddressBuffer = calloc<BACNET_ADDRESS>();
-    final pduBuffer = calloc<ffi.Uint8>(maxAPDU);
+    // The TSM expects elapsed milliseconds since the previous tick. The
+    // watch is never reset, so the sub-millisecond remainder of each tick
+    // carries into the next instead of being dropped.
+    final tickWatch = Stopwatch()..start();
+    var lastTickMs = 0;
+
+    Timer? pollTimer;
+    var busyPoll = false;
 
-    workerToMainSendPort?.send(receivePort.sendPort);
+    void teardown() {
+      pollTimer?.cancel();
+      hotPath
+        ..clientStop()
+        ..journalClose()
+        ..realtimeConfigure(-1, 0, false)
+        ..datalinkCleanup();
+      for (final callable in keepAlive) {
+        callable.close();
+      }
+      buffers.dispose();
+    }
 
-    Timer.periodic(const Duration(milliseconds: 10), (_) {
+    // Receives and handles at most one PDU and runs the stack timers.
+    // Returns false once a native crash has torn the stack down.
+    bool poll() {
       try {
+        // Follows the isolate if it moved to another VM thread.
+        hotPath.realtimeEnter();
         int pduLen = bindings.bacnet_plugin_safe_bip_receive(
           srcAddressBuffer,
           pduBuffer,
           maxAPDU,
-          5,
+          busyPoll ? 0 : receiveTimeoutMs,
         );
+        if (pduLen < 0) {
+          // The native wrapper intercepted a crash or exit(); the stack's
+          // state can no longer be trusted, so let the supervisor restart us.
+          workerToMainSendPort?.send(
+            const ErrorResponse('Native crash in bip_receive', fatal: true),
+          );
+          teardown();
+          exit();
+          return false;
+        }
         if (pduLen > 0) {
-          logToMain(BacnetLogLevel.debug, 'Rx PDU: $pduLen bytes');
+          // Skipped when busy polling: it allocates on every packet.
+          if (!busyPoll) {
+            logToMain(BacnetLogLevel.debug, 'Rx PDU: $pduLen bytes');
+          }
           bindings.bacnet_plugin_safe_npdu_handler(
             srcAddressBuffer,
             pduBuffer,
             pduLen,
           );
+          drainCovEvents(buffers.covEvent);
         }
-        bindings.tsm_timer_milliseconds(
-          DateTime.now().millisecondsSinceEpoch & 0xFFFFFFFF,
-        );
+        final nowMs = tickWatch.elapsedMilliseconds;
+        final elapsed = nowMs - lastTickMs;
+        if (elapsed > 0) {
+          lastTickMs = nowMs;
+          final clamped = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+          hotPath.tsmTimerMilliseconds(clamped);
+          hotPath
+            ..serverCovTask(clamped)
+            ..serverIAmTask(clamped);
+        }
+        // Native client API requests are sent from the stack's own thread.
+        hotPath.clientTask();
       } on Exception {
         /* suppress */
       }
-    });
+      return true;
+    }
 
-    receivePort.listen((message) {
-      logToMain(
-        BacnetLogLevel.info,
-        '🟡 Worker: Received message of type: ${message.runtimeType}',
-      );
-      if (message is WorkerRequest) {
-        switch (message) {
-          case WhoIsRequest():
-            handleWhoIs(message);
-            break;
-          case ReadPropertyRequest():
-            handleReadProp(message);
-            break;
-          case WritePropertyRequest():
-            handleWriteProp(message);
-            break;
-          case RegisterFdrRequest():
-            handleRegisterFDR(message);
-            break;
-          case AddDeviceBindingRequest():
-            handleAddBinding(message);
-            break;
-          case SubscribeCOVRequest():
-            handleSubscribeCOV(message);
-            break;
-          case InitServerRequest():
-            handleInitServer(message);
-            break;
-          case AddObjectRequest():
-            handleAddObject(message);
-            break;
-          case ReadPropertyMultipleRequest():
-            logToMain(
-              BacnetLogLevel.info,
-              '🔴 Worker: Received ReadPropertyMultipleRequest for device ${message.deviceId}',
-            );
-            handleReadPropMultiple(message);
-            break;
-          case WritePropertyMultipleRequest():
-            handleWritePropMultiple(message);
-            break;
-          case ReadRangeRequest():
-            handleReadRange(message);
-            break;
+    // Busy polling reschedules with zero-delay timers rather than looping,
+    // so requests from the main isolate are still handled between polls.
+    void schedulePolling() {
+      pollTimer?.cancel();
+      if (busyPoll) {
+        void spin() {
+          if (poll()) pollTimer = Timer(Duration.zero, spin);
         }
+
+        pollTimer = Timer(Duration.zero, spin);
+      } else {
+        pollTimer = Timer.periodic(pollInterval, (_) => poll());
       }
-    });
+    }
 
-    // ReadRange Ack Handler
-    final readRangeAckCallable =
-        ffi.NativeCallable<confirmed_ack_functionFunction>.isolateLocal(
-          onReadRangeAck,
-        );
-    keepAlive.add(readRangeAckCallable);
-    bindings.apdu_set_confirmed_ack_handler(
-      BACnet_Confirmed_Service_Choice.SERVICE_CONFIRMED_READ_RANGE,
-      readRangeAckCallable.nativeFunction,
-    );
+    schedulePolling();
+
+    return (message) {
+      switch (message) {
+        case WhoIsRequest():
+          handleWhoIs(message);
+          break;
+        case DirectedWhoIsRequest():
+          handleDirectedWhoIs(message);
+          break;
+        case ReadPropertyRequest():
+          handleReadProp(message);
+          break;
+        case WritePropertyRequest():
+          handleWriteProp(message);
+          break;
+        case RegisterFdrRequest():
+          handleRegisterFDR(message);
+          break;
+        case AddDeviceBindingRequest():
+          handleAddBinding(message);
+          break;
+        case SubscribeCOVRequest():
+          handleSubscribeCOV(message);
+          break;
+        case InitServerRequest():
+          handleInitServer(message);
+          break;
+        case AddObjectRequest():
+          handleAddObject(message);
+          break;
+        case ServerSnapshotRequest():
+          handleServerSnapshot(message);
+          break;
+        case ServerRestoreRequest():
+          handleServerRestore(message);
+          break;
+        case SetCovIncrementRequest():
+          handleSetCovIncrement(message);
+          break;
+        case SetIAmPacingRequest():
+          handleSetIAmPacing(message);
+          break;
+        case SetRealtimeProfileRequest(:final profile):
+          handleSetRealtimeProfile(message);
+          if (busyPoll != (profile?.busyPoll ?? false)) {
+            busyPoll = !busyPoll;
+            schedulePolling();
+          }
+          break;
+        case OpenWriteJournalRequest():
+          handleOpenWriteJournal(message);
+          break;
+        case SyncWriteJournalRequest():
+          handleSyncWriteJournal(message);
+          break;
+        case CloseWriteJournalRequest():
+          handleCloseWriteJournal(message);
+          break;
+        case ReadPropertyMultipleRequest():
+          logToMain(
+            BacnetLogLevel.info,
+            '🔴 Worker: Received ReadPropertyMultipleRequest for device ${message.deviceId}',
+          );
+          handleReadPropMultiple(message);
+          break;
+        case WritePropertyMultipleRequest():
+          handleWritePropMultiple(message);
+          break;
+        case ReadRangeRequest():
+          handleReadRange(message);
+          break;
+        case ReadPriorityArraysRequest():
+          handleReadPriorityArrays(message);
+          break;
+        case SetPacketFilterRequest():
+          handleSetPacketFilter(message);
+          break;
+        case MetricsRequest():
+          workerToMainSendPort?.send(
+            MetricsResponse(
+              trackingId: message.trackingId,
+              nativeMemory: nativeMemory.snapshot(),
+              internedStrings: stringInterner.length,
+              internHits: stringInterner.hits,
+              cov: readCovStats(),
+              packetFilter: readPacketFilterStats(),
+              iAmPacing: readIAmPacingStats(),
+              mstp: readMstpStats(),
+              journal: readWriteJournalStats(),
+              realtime: readRealtimeStats(busyPoll: busyPoll),
+            ),
+          );
+          break;
+        case ShutdownWorkerRequest():
+          teardown();
+          if (nativeMemory.liveBytes > 0) {
+            logToMain(
+              BacnetLogLevel.warning,
+              'Worker exiting with ${nativeMemory.liveBytes} native bytes '
+              'still allocated: ${nativeMemory.snapshot()}',
+            );
+          }
+          exit();
+      }
+    };
   } on Exception catch (e, st) {
-    workerToMainSendPort?.send(ErrorResponse('Worker exception: $e\n$st'));
+    workerToMainSendPort?.send(
+      ErrorResponse('Worker exception: $e\n$st', fatal: true),
+    );
+    return null;
   }
 }
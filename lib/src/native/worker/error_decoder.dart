@@ -0,0 +1,29 @@
+import 'dart:ffi' as ffi;
+
+/// Decodes the error class and code from a complex Error PDU.
+///
+/// Services such as WritePropertyMultiple wrap the `BACnetError` in context
+/// tag 0, followed by service-specific data (for WPM, the first failed write
+/// attempt). Returns `(errorClass, errorCode)`, or null if the payload does
+/// not start with that structure.
+(int, int)? decodeComplexError(ffi.Pointer<ffi.Uint8> data, int length) {
+  // Opening tag 0, then two enumerated application values.
+  if (length < 1 || data[0] != 0x0E) return null;
+  var offset = 1;
+  final values = <int>[];
+  while (values.length < 2) {
+    if (offset >= length) return null;
+    final tag = data[offset++];
+    final contentLength = tag & 0x07;
+    if ((tag >> 4) != 9 || (tag & 0x08) != 0 || contentLength > 4) {
+      return null;
+    }
+    if (offset + contentLength > length) return null;
+    var value = 0;
+    for (var i = 0; i < contentLength; i++) {
+      value = (value << 8) | data[offset++];
+    }
+    values.add(value);
+  }
+  return (values[0], values[1]);
+}
@@ -1,18 +1,60 @@
+import 'dart:ffi' as ffi;
+import 'dart:io';
 import 'dart:isolate';
 
 import '../../../bacnet_plugin_bindings.g.dart';
 import '../../core/types.dart';
 import '../../models/internal/worker_message.dart';
+import 'accounting_allocator.dart';
+import 'charset_decoder.dart';
+import 'hot_path_bindings.dart';
+import 'worker_buffers.dart';
 
 /// Global instance of BACnet native bindings.
 late BacnetBindings bindings;
 
+/// Global instance of the hand-tuned hot-path bindings.
+late HotPathBindings hotPath;
+
+/// Buffers the worker reuses for its lifetime; set when the stack starts.
+late WorkerBuffers workerBuffers;
+
+/// Accounting allocator for every native allocation made by the worker.
+///
+/// Handlers allocate through a named site, e.g.
+/// `nativeMemory.site('handleReadRange')`, so leaks can be attributed.
+final AccountingAllocator nativeMemory = AccountingAllocator();
+
+/// Interner for decoded character strings (names, descriptions, units).
+final StringInterner stringInterner = StringInterner();
+
+/// Invoke IDs of in-flight RPMs issued for priority array reads.
+///
+/// Their acks are decoded into priority arrays instead of a property map.
+final Set<int> priorityArrayInvokeIds = {};
+
+/// Native entry point of the server's WriteProperty store callback.
+///
+/// Kept so the callback can be detached while an image is restored, which
+/// would otherwise report every restored value as a client write.
+ffi.Pointer<ffi.NativeFunction<write_property_functionFunction>>
+writePropertyStoreCallback = ffi.nullptr;
+
 /// SendPort for sending messages from worker isolate to main isolate.
 SendPort? workerToMainSendPort;
 
 /// Maximum APDU (Application Protocol Data Unit) size in bytes.
 const int maxAPDU = 1476;
 
+/// Opens the platform-specific native BACnet library.
+ffi.DynamicLibrary openBacnetLibrary() {
+  var libraryPath = Platform.isWindows
+      ? 'bacnet_plugin.dll'
+      : 'libbacnet_plugin.so';
+  if (Platform.isMacOS) libraryPath = 'libbacnet_plugin.dylib';
+  return ffi.DynamicLibrary.open(libraryPath);
+}
+
 /// Sends a log message from the worker isolate to the main isolate.
 ///
 /// This is the worker isolate's logging interface that forwards log messages
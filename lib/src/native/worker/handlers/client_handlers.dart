@@ -1,20 +1,43 @@
 import 'dart:ffi' as ffi;
+import 'dart:io';
 
 import 'package:ffi/ffi.dart';
 
 import '../../../../bacnet_plugin_bindings.g.dart';
+import '../../../constants/property_ids.dart';
 import '../../../core/types.dart';
+import '../../../models/bacnet_metrics.dart';
+import '../../../models/packet_filter.dart';
+import '../../../models/priority_array.dart';
+import '../../../models/rpm_models.dart';
 import '../../../models/internal/worker_message.dart';
+import '../access_data_builders.dart';
 import '../globals.dart';
+import '../hot_path_bindings.dart';
 
 /// Handles manual device binding requests.
 ///
 /// Adds a device address binding for direct communication with a specific
 /// BACnet device using its IP address and port.
 void handleAddBinding(AddDeviceBindingRequest req) {
-  final ipStr = req.ip.toNativeUtf8();
-  final bipAddr = calloc<BACNET_IP_ADDRESS>();
-  final addr = calloc<BACNET_ADDRESS>();
+  // Dotted-quad addresses take the flat leaf path; host names still need
+  // the stack's resolver.
+  final parsed = InternetAddress.tryParse(req.ip);
+  if (parsed != null && parsed.type == InternetAddressType.IPv4) {
+    final raw = parsed.rawAddress;
+    final ipv4 = (raw[0] << 24) | (raw[1] << 16) | (raw[2] << 8) | raw[3];
+    hotPath.addressAddIpv4(req.deviceId, ipv4, req.port);
+    logToMain(
+      BacnetLogLevel.info,
+      'Manual Binding Added: Device ${req.deviceId} -> ${req.ip}:${req.port}',
+    );
+    return;
+  }
+
+  final alloc = nativeMemory.site('handleAddBinding');
+  final ipStr = req.ip.toNativeUtf8(allocator: alloc);
+  final bipAddr = alloc<BACNET_IP_ADDRESS>();
+  final addr = alloc<BACNET_ADDRESS>();
   try {
     if (bindings.bip_get_addr_by_name(ipStr.cast(), bipAddr)) {
       addr.ref.mac_len = 6;
@@ -38,39 +61,46 @@ void handleAddBinding(AddDeviceBindingRequest req) {
       );
     }
   } finally {
-    calloc.free(bipAddr);
-    calloc.free(addr);
-    calloc.free(ipStr);
+    alloc
+      ..free(bipAddr)
+      ..free(addr)
+      ..free(ipStr);
   }
 }
 
 /// Handles COV (Change of Value) subscription requests.
 ///
 /// Subscribes to property changes on a specific BACnet object to receive
-/// notifications when values change.
+/// notifications when values change, or cancels such a subscription.
 void handleSubscribeCOV(SubscribeCOVRequest req) {
-  final ptr = calloc<BACnet_Subscribe_COV_Data>();
-  try {
-    ptr.ref.monitoredObjectIdentifier.typeAsInt = req.objectType;
-    ptr.ref.monitoredObjectIdentifier.instance = req.instance;
-
-    ptr.ref.monitoredProperty.property_identifierAsInt = req.propertyId;
-    ptr.ref.monitoredProperty.property_array_index = -1;
-
-    ptr.ref.issueConfirmedNotifications = false;
-    ptr.ref.lifetime = 120; // 2 minutes
-    ptr.ref.cancellationRequest = false;
-    ptr.ref.covSubscribeToProperty = true;
-    ptr.ref.covIncrementPresent = false;
+  final invokeId = hotPath.sendCovSubscribe(
+    req.deviceId,
+    req.objectType,
+    req.instance,
+    req.propertyId,
+    req.confirmed,
+    req.lifetime,
+    req.cancel,
+    req.covIncrement != null,
+    req.covIncrement ?? 0,
+  );
+  logToMain(
+    BacnetLogLevel.info,
+    'Sent SubscribeCOV${req.cancel ? ' cancellation' : ''} '
+    'to Device ${req.deviceId}',
+  );
+  _reportSent(req.trackingId, invokeId, 'SubscribeCOV');
+}
 
-    bindings.Send_COV_Subscribe(req.deviceId, ptr);
-    logToMain(
-      BacnetLogLevel.info,
-      'Sent SubscribeCOV to Device ${req.deviceId}',
-    );
-  } finally {
-    calloc.free(ptr);
-  }
+/// Tells the main isolate which invoke ID carries [trackingId], or that
+/// the request could not be sent.
+void _reportSent(int? trackingId, int invokeId, String service) {
+  if (trackingId == null) return;
+  workerToMainSendPort?.send(
+    invokeId > 0
+        ? ReadPropertySentResponse(trackingId: trackingId, invokeId: invokeId)
+        : ErrorResponse('Failed to send $service', trackingId: trackingId),
+  );
 }
 
 /// Handles foreign device registration (FDR) requests.
@@ -78,15 +108,17 @@ void handleSubscribeCOV(SubscribeCOVRequest req) {
 /// Registers this device with a BBMD (BACnet Broadcast Management Device)
 /// to enable communication across subnets.
 void handleRegisterFDR(RegisterFdrRequest req) {
-  final ipStr = req.ip.toNativeUtf8();
-  final bbmdAddr = calloc<BACNET_IP_ADDRESS>();
+  final alloc = nativeMemory.site('handleRegisterFDR');
+  final ipStr = req.ip.toNativeUtf8(allocator: alloc);
+  final bbmdAddr = alloc<BACNET_IP_ADDRESS>();
   try {
     bindings.bip_get_addr_by_name(ipStr.cast(), bbmdAddr);
     bbmdAddr.ref.port = req.port;
     bindings.bvlc_register_with_bbmd(bbmdAddr, req.ttl);
   } finally {
-    calloc.free(bbmdAddr);
-    calloc.free(ipStr);
+    alloc
+      ..free(bbmdAddr)
+      ..free(ipStr);
   }
 }
 
@@ -98,6 +130,20 @@ void handleWhoIs(WhoIsRequest req) {
   bindings.Send_WhoIs_Global(req.lowLimit, req.highLimit);
 }
 
+/// Handles directed Who-Is requests.
+///
+/// Each device is asked at its cached address only; devices without one are
+/// reported back instead of falling back to a broadcast.
+void handleDirectedWhoIs(DirectedWhoIsRequest req) {
+  final unbound = <int>[
+    for (final deviceId in req.deviceIds)
+      if (!hotPath.sendWhoIsDirected(deviceId)) deviceId,
+  ];
+  workerToMainSendPort?.send(
+    DirectedWhoIsResponse(trackingId: req.trackingId, unbound: unbound),
+  );
+}
+
 /// Handles ReadProperty requests.
 ///
 /// Sends a request to read a single property value from a BACnet object.
@@ -107,11 +153,11 @@ void handleReadProp(ReadPropertyRequest req) {
     '📤 Sending ReadProperty to device ${req.deviceId}, prop ${req.propertyId}',
   );
 
-  final invokeId = bindings.Send_Read_Property_Request(
+  final invokeId = hotPath.sendReadProperty(
     req.deviceId,
-    BACnetObjectType.fromValue(req.objectType),
+    req.objectType,
     req.instance,
-    BACnetPropertyIdentifier.fromValue(req.propertyId),
+    req.propertyId,
     req.arrayIndex,
   );
 
@@ -126,36 +172,37 @@ void handleReadProp(ReadPropertyRequest req) {
 ///
 /// Sends a request to write a value to a specific property of a BACnet object.
 void handleWriteProp(WritePropertyRequest req) {
-  final ptr = calloc<BACNET_APPLICATION_DATA_VALUE>();
-  try {
-    final value = req.value;
-    final tag = req.tag;
-    ptr.ref.tag = tag;
-    ptr.ref.context_specific = false;
-    switch (tag) {
-      case 1:
-        ptr.ref.type.Boolean = value as bool;
-        break;
-      case 4:
-        ptr.ref.type.Real = (value as num).toDouble();
-        break;
-      case 2:
-        ptr.ref.type.Unsigned_Int = value as int;
-        break;
-    }
-
-    bindings.Send_Write_Property_Request(
-      req.deviceId,
-      BACnetObjectType.fromValue(req.objectType),
-      req.instance,
-      BACnetPropertyIdentifier.fromValue(req.propertyId),
-      ptr,
-      req.priority,
-      req.priority == 16 ? -1 : req.priority,
-    );
-  } finally {
-    calloc.free(ptr);
+  // Reused for every write; the request is encoded before the call returns.
+  final ptr = workerBuffers.writeValue;
+  final value = req.value;
+  final tag = req.tag;
+  ptr.ref
+    ..tag = tag
+    ..context_specific = false
+    ..next = ffi.nullptr;
+  switch (tag) {
+    case 1:
+      ptr.ref.type.Boolean = value as bool;
+      break;
+    case 4:
+      ptr.ref.type.Real = (value as num).toDouble();
+      break;
+    case 2:
+      ptr.ref.type.Unsigned_Int = value as int;
+      break;
   }
+
+  // Journaled natively when the write journal is open.
+  final invokeId = hotPath.sendWriteProperty(
+    req.deviceId,
+    req.objectType,
+    req.instance,
+    req.propertyId,
+    ptr,
+    req.priority,
+    0xFFFFFFFF, // BACNET_ARRAY_ALL
+  );
+  _reportSent(req.trackingId, invokeId, 'WriteProperty');
 }
 
 /// Handles ReadPropertyMultiple (RPM) requests.
@@ -168,64 +215,72 @@ void handleReadPropMultiple(ReadPropertyMultipleRequest req) {
     '🔵 RPM Handler: Starting for device ${req.deviceId} with ${req.readAccessSpecs.length} specs',
   );
 
-  // We need to keep track of allocated pointers to free them later
+  _sendReadPropertyMultiple(
+    req.deviceId,
+    req.readAccessSpecs,
+    req.trackingId,
+    'handleReadPropMultiple',
+  );
+}
+
+/// Handles bulk priority array requests.
+///
+/// Reads `priority_array` and `relinquish_default` of every object with one
+/// RPM. The ack is decoded into [BacnetPriorityArray]s in the worker.
+void handleReadPriorityArrays(ReadPriorityArraysRequest req) {
+  final invokeId = _sendReadPropertyMultiple(
+    req.deviceId,
+    [
+      for (final object in req.objects)
+        BacnetReadAccessSpecification(
+          objectIdentifier: object,
+          properties: const [
+            BacnetPropertyReference(
+              propertyIdentifier: BacnetPropertyId.priorityArray,
+            ),
+            BacnetPropertyReference(
+              propertyIdentifier: BacnetPropertyId.relinquishDefault,
+            ),
+          ],
+        ),
+    ],
+    req.trackingId,
+    'handleReadPriorityArrays',
+  );
+  if (invokeId > 0) priorityArrayInvokeIds.add(invokeId);
+}
+
+/// Encodes and sends an RPM, reporting the outcome to the main isolate.
+///
+/// Returns the invoke ID, or 0 if the request could not be sent.
+int _sendReadPropertyMultiple(
+  int deviceId,
+  List<BacnetReadAccessSpecification> specs,
+  int? trackingId,
+  String site,
+) {
+  final alloc = nativeMemory.site(site);
   final allocatedPointers = <ffi.Pointer>[];
 
   try {
-    ffi.Pointer<BACNET_READ_ACCESS_DATA> headReadAccessData = ffi.nullptr;
-    ffi.Pointer<BACNET_READ_ACCESS_DATA> currentReadAccessData = ffi.nullptr;
-
-    for (final spec in req.readAccessSpecs) {
-      final radPtr = calloc<BACNET_READ_ACCESS_DATA>();
-      allocatedPointers.add(radPtr);
-
-      if (headReadAccessData == ffi.nullptr) {
-        headReadAccessData = radPtr;
-        currentReadAccessData = radPtr;
-      } else {
-        currentReadAccessData.ref.next = radPtr;
-        currentReadAccessData = radPtr;
-      }
-
-      radPtr.ref.object_typeAsInt = spec.objectIdentifier.type;
-      radPtr.ref.object_instance = spec.objectIdentifier.instance;
-      radPtr.ref.next = ffi.nullptr;
-
-      ffi.Pointer<BACNET_PROPERTY_REFERENCE> headPropRef = ffi.nullptr;
-      ffi.Pointer<BACNET_PROPERTY_REFERENCE> currentPropRef = ffi.nullptr;
-
-      for (final prop in spec.properties) {
-        final propPtr = calloc<BACNET_PROPERTY_REFERENCE>();
-        allocatedPointers.add(propPtr);
-
-        if (headPropRef == ffi.nullptr) {
-          headPropRef = propPtr;
-          currentPropRef = propPtr;
-        } else {
-          currentPropRef.ref.next = propPtr;
-          currentPropRef = propPtr;
-        }
-
-        propPtr.ref.propertyIdentifierAsInt = prop.propertyIdentifier;
-        propPtr.ref.propertyArrayIndex = prop.propertyArrayIndex;
-        propPtr.ref.next = ffi.nullptr;
-      }
-
-      radPtr.ref.listOfProperties = headPropRef;
-    }
+    final headReadAccessData = buildReadAccessData(
+      specs,
+      alloc,
+      allocatedPointers,
+    );
 
-    final pduBuffer = calloc<ffi.Uint8>(maxAPDU);
+    final pduBuffer = alloc<ffi.Uint8>(maxAPDU);
     allocatedPointers.add(pduBuffer);
 
     logToMain(
       BacnetLogLevel.info,
-      '🔵 RPM Handler: Calling native Send_Read_Property_Multiple_Request for device ${req.deviceId}',
+      '🔵 RPM Handler: Calling native Send_Read_Property_Multiple_Request for device $deviceId',
     );
 
     final invokeId = bindings.Send_Read_Property_Multiple_Request(
       pduBuffer,
       maxAPDU,
-      req.deviceId,
+      deviceId,
       headReadAccessData,
     );
 
@@ -235,32 +290,37 @@ void handleReadPropMultiple(ReadPropertyMultipleRequest req) {
     );
 
     if (invokeId > 0) {
+      // The invoke ID may be reused from an abandoned priority array read.
+      priorityArrayInvokeIds.remove(invokeId);
       logToMain(
         BacnetLogLevel.info,
-        '✅ RPM Handler: Sending ReadPropertySentResponse (trackingId: ${req.trackingId}, invokeId: $invokeId)',
+        '✅ RPM Handler: Sending ReadPropertySentResponse (trackingId: $trackingId, invokeId: $invokeId)',
       );
       workerToMainSendPort?.send(
         ReadPropertySentResponse(
-          trackingId: req.trackingId ?? 0,
+          trackingId: trackingId ?? 0,
           invokeId: invokeId,
         ),
       );
     } else {
       logToMain(
         BacnetLogLevel.error,
-        'Failed to send RPM request to device ${req.deviceId}',
+        'Failed to send RPM request to device $deviceId',
       );
+      // Usually the request does not fit the device's max APDU.
       workerToMainSendPort?.send(
-        const ErrorResponse('Failed to send RPM request'),
+        ErrorResponse('Failed to send RPM request', trackingId: trackingId),
       );
     }
+    return invokeId;
   } on Exception catch (e, st) {
     logToMain(BacnetLogLevel.error, 'Exception in RPM handler', e, st);
-    workerToMainSendPort?.send(ErrorResponse('RPM Exception: $e'));
+    workerToMainSendPort?.send(
+      ErrorResponse('RPM Exception: $e', trackingId: trackingId),
+    );
+    return 0;
   } finally {
-    for (final ptr in allocatedPointers) {
-      calloc.free(ptr);
-    }
+    allocatedPointers.forEach(alloc.free);
   }
 }
 
@@ -269,81 +329,15 @@ void handleReadPropMultiple(ReadPropertyMultipleRequest req) {
 /// Sends a request to write multiple properties to multiple objects in a
 /// single transaction for improved efficiency.
 void handleWritePropMultiple(WritePropertyMultipleRequest req) {
+  final alloc = nativeMemory.site('handleWritePropMultiple');
   final allocatedPointers = <ffi.Pointer>[];
 
   try {
-    ffi.Pointer<BACNET_WRITE_ACCESS_DATA> headWriteAccessData = ffi.nullptr;
-    ffi.Pointer<BACNET_WRITE_ACCESS_DATA> currentWriteAccessData = ffi.nullptr;
-
-    for (final spec in req.writeAccessSpecs) {
-      final wadPtr = calloc<BACNET_WRITE_ACCESS_DATA>();
-      allocatedPointers.add(wadPtr);
-
-      if (headWriteAccessData == ffi.nullptr) {
-        headWriteAccessData = wadPtr;
-        currentWriteAccessData = wadPtr;
-      } else {
-        currentWriteAccessData.ref.next = wadPtr;
-        currentWriteAccessData = wadPtr;
-      }
-
-      wadPtr.ref.object_typeAsInt = spec.objectIdentifier.type;
-      wadPtr.ref.object_instance = spec.objectIdentifier.instance;
-      wadPtr.ref.next = ffi.nullptr;
-
-      ffi.Pointer<BACNET_PROPERTY_VALUE> headPropVal = ffi.nullptr;
-      ffi.Pointer<BACNET_PROPERTY_VALUE> currentPropVal = ffi.nullptr;
-
-      for (final prop in spec.listOfProperties) {
-        final propValPtr = calloc<BACNET_PROPERTY_VALUE>();
-        allocatedPointers.add(propValPtr);
-
-        if (headPropVal == ffi.nullptr) {
-          headPropVal = propValPtr;
-          currentPropVal = propValPtr;
-        } else {
-          currentPropVal.ref.next = propValPtr;
-          currentPropVal = propValPtr;
-        }
-
-        propValPtr.ref.propertyIdentifierAsInt = prop.propertyIdentifier;
-        propValPtr.ref.propertyArrayIndex = prop.propertyArrayIndex;
-        propValPtr.ref.priority = prop.priority;
-        propValPtr.ref.next = ffi.nullptr;
-
-        // Set value
-        // The value structure is embedded in BACNET_PROPERTY_VALUE as 'value'
-        // type BACNET_APPLICATION_DATA_VALUE
-        final appData = propValPtr.ref.value;
-        final value = prop.value;
-        final tag = prop.tag; // Ensure BacnetPropertyValue model has tag/value
-
-        appData.tag = tag;
-        appData.context_specific = false;
-
-        switch (tag) {
-          case 1: // Boolean
-            appData.type.Boolean = value as bool;
-            break;
-          case 2: // Unsigned Int
-            appData.type.Unsigned_Int = value as int;
-            break;
-          case 3: // Signed Int
-            appData.type.Signed_Int = value as int;
-            break;
-          case 4: // Real
-            appData.type.Real = (value as num).toDouble();
-            break;
-          case 9: // Enumerated
-            appData.type.Enumerated = value as int;
-            break;
-          // Add more types as needed (String, Object ID, etc.)
-          default:
-            logToMain(BacnetLogLevel.warning, 'Unsupported WPM tag: $tag');
-        }
-      }
-      wadPtr.ref.listOfProperties = headPropVal;
-    }
+    final headWriteAccessData = buildWriteAccessData(
+      req.writeAccessSpecs,
+      alloc,
+      allocatedPointers,
+    );
 
     final invokeId = bindings.bacnet_plugin_send_write_property_multiple(
       req.deviceId,
@@ -363,16 +357,16 @@ void handleWritePropMultiple(WritePropertyMultipleRequest req) {
         'Failed to send WPM request to device ${req.deviceId}',
       );
       workerToMainSendPort?.send(
-        const ErrorResponse('Failed to send WPM request'),
+        ErrorResponse('Failed to send WPM request', trackingId: req.trackingId),
       );
     }
   } on Exception catch (e, st) {
     logToMain(BacnetLogLevel.error, 'Exception in WPM handler', e, st);
-    workerToMainSendPort?.send(ErrorResponse('WPM Exception: $e'));
+    workerToMainSendPort?.send(
+      ErrorResponse('WPM Exception: $e', trackingId: req.trackingId),
+    );
   } finally {
-    for (final ptr in allocatedPointers) {
-      calloc.free(ptr);
-    }
+    allocatedPointers.forEach(alloc.free);
   }
 }
 
@@ -380,9 +374,10 @@ void handleWritePropMultiple(WritePropertyMultipleRequest req) {
 ///
 /// Sends a ReadRange request to a device (e.g. for TrendLogs).
 void handleReadRange(ReadRangeRequest req) {
+  final alloc = nativeMemory.site('handleReadRange');
   final allocatedPointers = <ffi.Pointer>[];
   try {
-    final rrData = calloc<BACNET_READ_RANGE_DATA>();
+    final rrData = alloc<BACNET_READ_RANGE_DATA>();
     allocatedPointers.add(rrData);
 
     rrData.ref.object_typeAsInt = req.objectType;
@@ -411,10 +406,19 @@ void handleReadRange(ReadRangeRequest req) {
       // Sequence
       rrData.ref.Range.RefSeqNum = req.reference as int;
     } else if (req.requestType == 4) {
-      // Time
-      // Need to parse DateTime which is hard. Assuming Sequence for TrendLogs usually.
-      // If time provided, we need to populate RefTime (BACNET_DATE_TIME).
-      // Leaving Time unsupported for this iteration unless critical.
+      // Time, in the device's local time
+      final time = req.reference as DateTime;
+      final ref = rrData.ref.Range.RefTime;
+      ref.date
+        ..year = time.year
+        ..month = time.month
+        ..day = time.day
+        ..wday = time.weekday;
+      ref.time
+        ..hour = time.hour
+        ..min = time.minute
+        ..sec = time.second
+        ..hundredths = time.millisecond ~/ 10;
     }
 
     final invokeId = bindings.bacnet_plugin_send_read_range_request(
@@ -435,15 +439,134 @@ void handleReadRange(ReadRangeRequest req) {
         'Failed to send ReadRange request to device ${req.deviceId}',
       );
       workerToMainSendPort?.send(
-        const ErrorResponse('Failed to send ReadRange request'),
+        ErrorResponse(
+          'Failed to send ReadRange request',
+          trackingId: req.trackingId,
+        ),
       );
     }
   } on Exception catch (e, s) {
     logToMain(BacnetLogLevel.error, 'ReadRange Handle Error', e, s);
-    workerToMainSendPort?.send(ErrorResponse('ReadRange Error: $e'));
+    workerToMainSendPort?.send(
+      ErrorResponse('ReadRange Error: $e', trackingId: req.trackingId),
+    );
   } finally {
-    for (final ptr in allocatedPointers) {
-      calloc.free(ptr);
+    allocatedPointers.forEach(alloc.free);
+  }
+}
+
+/// Replaces the native receive pre-filter with [req]'s rules.
+void handleSetPacketFilter(SetPacketFilterRequest req) {
+  final filter = req.filter;
+  hotPath.filterReset();
+  for (final service in filter.deniedUnconfirmedServices) {
+    hotPath.filterSetService(false, service, true);
+  }
+  for (final service in filter.deniedConfirmedServices) {
+    hotPath.filterSetService(true, service, true);
+  }
+  hotPath.filterSetNetworkMessages(filter.dropNetworkMessages);
+
+  var added = 0;
+  for (final source in filter.sources) {
+    try {
+      final (ipv4, port) = BacnetPacketFilter.parseSource(source);
+      if (hotPath.filterAddSource(ipv4, port)) added++;
+    } on FormatException catch (e) {
+      logToMain(BacnetLogLevel.warning, 'Packet filter: ${e.message}', e);
     }
   }
+  if (added < filter.sources.length) {
+    logToMain(
+      BacnetLogLevel.warning,
+      'Packet filter: ${filter.sources.length - added} sources not added',
+    );
+  }
+  // Mode last, so an allow-list never applies half-populated.
+  hotPath.filterSetSourceMode(filter.sourceMode.index);
+}
+
+/// Reads the native receive pre-filter counters.
+PacketFilterStats readPacketFilterStats() {
+  final alloc = nativeMemory.site('readPacketFilterStats');
+  final stats = alloc<BacnetPluginFilterStats>();
+  try {
+    hotPath.filterStats(stats);
+    final s = stats.ref;
+    return PacketFilterStats(
+      passed: s.passed,
+      droppedByService: s.droppedService,
+      droppedBySource: s.droppedSource,
+      droppedNetworkMessages: s.droppedNetwork,
+      droppedUnconfirmed: {
+        for (var i = 0; i < 16; i++)
+          if (s.droppedUnconfirmed[i] > 0) i: s.droppedUnconfirmed[i],
+      },
+    );
+  } finally {
+    alloc.free(stats);
+  }
+}
+
+/// Reads the MS/TP datalink counters.
+MstpStats readMstpStats() {
+  final alloc = nativeMemory.site('readMstpStats');
+  final stats = alloc<BacnetPluginMstpStats>();
+  try {
+    if (!hotPath.mstpStats(stats)) return const MstpStats();
+    final s = stats.ref;
+    return MstpStats(
+      active: true,
+      baudRate: s.baudRate,
+      macAddress: s.macAddress,
+      maxInfoFrames: s.maxInfoFrames,
+      transmitFrames: s.transmitFrames,
+      receiveValidFrames: s.receiveValidFrames,
+      receiveInvalidFrames: s.receiveInvalidFrames,
+      transmitPdus: s.transmitPdus,
+      receivePdus: s.receivePdus,
+      lostTokens: s.lostTokens,
+    );
+  } finally {
+    alloc.free(stats);
+  }
+}
+
+/// Applies [SetRealtimeProfileRequest.profile] to the native stack; the
+/// worker's poll loop switches to busy polling itself.
+void handleSetRealtimeProfile(SetRealtimeProfileRequest req) {
+  final profile = req.profile;
+  hotPath
+    ..realtimeConfigure(
+      profile?.cpu ?? -1,
+      profile?.priority ?? 0,
+      profile?.lockMemory ?? false,
+    )
+    ..realtimeEnter();
+  final stats = readRealtimeStats(busyPoll: profile?.busyPoll ?? false);
+  logToMain(
+    stats.fullyApplied ? BacnetLogLevel.info : BacnetLogLevel.warning,
+    'Real-time profile: $stats',
+  );
+}
+
+/// Reads the real-time profile state of the stack thread.
+RealtimeStats readRealtimeStats({required bool busyPoll}) {
+  final alloc = nativeMemory.site('readRealtimeStats');
+  final stats = alloc<BacnetPluginRealtimeStats>();
+  try {
+    hotPath.realtimeStats(stats);
+    final s = stats.ref;
+    return RealtimeStats(
+      cpu: s.cpu < 0 ? null : s.cpu,
+      priority: s.priority,
+      affinityApplied: s.affinityApplied,
+      fifoApplied: s.fifoApplied,
+      memoryLocked: s.memoryLocked,
+      busyPoll: busyPoll,
+      threadChanges: s.threadChanges,
+    );
+  } finally {
+    alloc.free(stats);
+  }
 }
@@ -4,19 +4,26 @@ import 'package:ffi/ffi.dart';
 
 import '../../../../bacnet_plugin_bindings.g.dart';
 import '../../../core/types.dart';
+import '../../../models/bacnet_metrics.dart';
 import '../../../models/internal/worker_message.dart';
+import '../../../models/server_image.dart';
 import '../globals.dart';
+import '../hot_path_bindings.dart';
 
 /// Handles server initialization requests.
 ///
 /// Sets up the BACnet server with the specified device ID and name.
 void handleInitServer(InitServerRequest req) {
   bindings.Device_Set_Object_Instance_Number(req.deviceId);
-  final namePtr = req.deviceName.toNativeUtf8();
+  final alloc = nativeMemory.site('handleInitServer');
+  final namePtr = req.deviceName.toNativeUtf8(allocator: alloc);
   bindings.Device_Object_Name_ANSI_Init(namePtr.cast());
-  calloc.free(namePtr);
+  alloc.free(namePtr);
 
   bindings.Device_Init(ffi.nullptr);
+  hotPath
+    ..serverCovInit()
+    ..serverIAmInit();
 
   workerToMainSendPort?.send(const InitSuccessResponse());
   logToMain(
@@ -29,7 +36,8 @@ void handleInitServer(InitServerRequest req) {
 ///
 /// Creates a new BACnet object with the specified type and instance number.
 void handleAddObject(AddObjectRequest req) {
-  final data = calloc<BACNET_CREATE_OBJECT_DATA>();
+  final alloc = nativeMemory.site('handleAddObject');
+  final data = alloc<BACNET_CREATE_OBJECT_DATA>();
   try {
     data.ref.object_typeAsInt = req.objectType;
     data.ref.object_instance = req.instance;
@@ -45,7 +53,231 @@ void handleAddObject(AddObjectRequest req) {
       );
     }
   } finally {
-    calloc.free(data);
+    alloc.free(data);
+  }
+}
+
+/// Handles requests to write the server object database to an image.
+void handleServerSnapshot(ServerSnapshotRequest req) {
+  _runImageCall(
+    'snapshot',
+    req.path,
+    req.trackingId,
+    hotPath.serverSnapshot,
+  );
+}
+
+/// Handles requests to initialize the server from an image.
+///
+/// The write-store callback is detached while the image loads, so restored
+/// values are not reported as [WriteNotificationResponse]s.
+void handleServerRestore(ServerRestoreRequest req) {
+  hotPath.writeStoreCallbackSet(ffi.nullptr);
+  try {
+    _runImageCall('restore', req.path, req.trackingId, hotPath.serverRestore);
+  } finally {
+    hotPath.writeStoreCallbackSet(writePropertyStoreCallback);
+  }
+}
+
+void _runImageCall(
+  String operation,
+  String path,
+  int trackingId,
+  int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<BacnetPluginImageStats>)
+  call,
+) {
+  final alloc = nativeMemory.site('handleServerImage');
+  final pathPtr = path.toNativeUtf8(allocator: alloc);
+  final stats = alloc<BacnetPluginImageStats>();
+  try {
+    final stopwatch = Stopwatch()..start();
+    final status = call(pathPtr.cast(), stats);
+    stopwatch.stop();
+    if (status != 0) {
+      workerToMainSendPort?.send(
+        ErrorResponse(
+          'Server image $operation of $path failed: '
+          '${_imageErrors[status] ?? 'error $status'}',
+          trackingId: trackingId,
+        ),
+      );
+      return;
+    }
+    final info = BacnetServerImageInfo(
+      objects: stats.ref.objects,
+      properties: stats.ref.properties,
+      skipped: stats.ref.skipped,
+      subscriptions: stats.ref.subscriptions,
+      bytes: stats.ref.bytes,
+      elapsed: stopwatch.elapsed,
+    );
+    workerToMainSendPort?.send(
+      ServerImageResponse(trackingId: trackingId, info: info),
+    );
+    logToMain(BacnetLogLevel.info, 'Server image $operation: $info');
+  } finally {
+    alloc
+      ..free(stats)
+      ..free(pathPtr);
+  }
+}
+
+/// Messages for the `BACNET_PLUGIN_IMAGE_ERROR_*` codes.
+const Map<int, String> _imageErrors = {
+  -1: 'cannot read or write the file',
+  -2: 'not a valid server image',
+  -3: 'unsupported image version',
+};
+
+/// Handles requests to set the COV_Increment of a server object.
+///
+/// Analog objects only notify subscribers once Present_Value has moved by
+/// at least this much since the last notification.
+void handleSetCovIncrement(SetCovIncrementRequest req) {
+  if (!hotPath.setCovIncrement(req.objectType, req.instance, req.increment)) {
+    logToMain(
+      BacnetLogLevel.error,
+      'Cannot set COV increment of Type ${req.objectType}, '
+      'Instance ${req.instance}',
+    );
+  }
+}
+
+/// Handles requests to change the I-Am response pacing.
+void handleSetIAmPacing(SetIAmPacingRequest req) {
+  final delay = req.maxDelay.inMilliseconds;
+  hotPath.serverIAmConfigure(
+    delay > 0xFFFF ? 0xFFFF : delay,
+    req.maxPerSecond > 0xFFFF ? 0xFFFF : req.maxPerSecond,
+  );
+}
+
+/// Reads the I-Am pacing counters of the native Who-Is handler.
+IAmPacingStats readIAmPacingStats() {
+  final alloc = nativeMemory.site('readIAmPacingStats');
+  final stats = alloc<BacnetPluginIAmStats>();
+  try {
+    hotPath.serverIAmStats(stats);
+    final s = stats.ref;
+    return IAmPacingStats(
+      whoIsReceived: s.whoIsReceived,
+      sent: s.sent,
+      coalesced: s.coalesced,
+      dropped: s.dropped,
+      sendFailed: s.sendFailed,
+      minDelay: Duration(milliseconds: s.delayMinMs),
+      maxDelay: Duration(milliseconds: s.delayMaxMs),
+      meanDelay: Duration(
+        milliseconds: s.sent == 0 ? 0 : s.delayTotalMs ~/ s.sent,
+      ),
+    );
+  } finally {
+    alloc.free(stats);
+  }
+}
+
+/// Handles requests to open the write journal.
+///
+/// Replayed requests after a worker restart carry no tracking ID and are
+/// only logged on failure.
+void handleOpenWriteJournal(OpenWriteJournalRequest req) {
+  final config = req.config;
+  final alloc = nativeMemory.site('handleOpenWriteJournal');
+  final pathPtr = config.path.toNativeUtf8(allocator: alloc);
+  final interval = config.commitInterval.inMilliseconds;
+  try {
+    final opened = hotPath.journalOpen(
+      pathPtr.cast(),
+      config.maxFileBytes > 0xFFFFFFFF ? 0xFFFFFFFF : config.maxFileBytes,
+      config.keepFiles,
+      interval > 0xFFFF ? 0xFFFF : interval,
+      config.bufferBytes,
+    );
+    final trackingId = req.trackingId;
+    if (!opened) {
+      final message = 'Cannot open write journal ${config.path}';
+      logToMain(BacnetLogLevel.error, message);
+      if (trackingId != null) {
+        workerToMainSendPort?.send(
+          ErrorResponse(message, trackingId: trackingId),
+        );
+      }
+      return;
+    }
+    logToMain(BacnetLogLevel.info, 'Write journal open: $config');
+    if (trackingId != null) {
+      workerToMainSendPort?.send(
+        WriteJournalResponse(
+          trackingId: trackingId,
+          stats: readWriteJournalStats(),
+        ),
+      );
+    }
+  } finally {
+    alloc.free(pathPtr);
+  }
+}
+
+/// Handles requests to wait until journaled writes are durable.
+///
+/// Blocks the worker for at most the request's timeout; the committer
+/// thread normally finishes within one commit interval.
+void handleSyncWriteJournal(SyncWriteJournalRequest req) {
+  final ms = req.timeout.inMilliseconds;
+  if (!hotPath.journalSync(ms > 0xFFFFFFFF ? 0xFFFFFFFF : ms)) {
+    final lost = readWriteJournalStats().lostRecords;
+    workerToMainSendPort?.send(
+      ErrorResponse(
+        lost > 0
+            ? 'Write journal lost $lost records to write errors'
+            : 'Write journal is closed or did not sync in ${ms}ms',
+        trackingId: req.trackingId,
+      ),
+    );
+    return;
+  }
+  workerToMainSendPort?.send(
+    WriteJournalResponse(
+      trackingId: req.trackingId,
+      stats: readWriteJournalStats(),
+    ),
+  );
+}
+
+/// Handles requests to close the write journal.
+void handleCloseWriteJournal(CloseWriteJournalRequest req) {
+  hotPath.journalClose();
+  final stats = readWriteJournalStats();
+  workerToMainSendPort?.send(
+    WriteJournalResponse(trackingId: req.trackingId, stats: stats),
+  );
+  logToMain(BacnetLogLevel.info, 'Write journal closed: $stats');
+}
+
+/// Reads the write journal counters.
+WriteJournalStats readWriteJournalStats() {
+  final alloc = nativeMemory.site('readWriteJournalStats');
+  final stats = alloc<BacnetPluginJournalStats>();
+  try {
+    hotPath.journalStats(stats);
+    final s = stats.ref;
+    return WriteJournalStats(
+      open: s.open,
+      records: s.records,
+      refused: s.refused,
+      stalls: s.stalls,
+      bytes: s.bytes,
+      commits: s.commits,
+      maxBatchRecords: s.maxBatchRecords,
+      lastCommit: Duration(microseconds: s.lastCommitUs),
+      maxCommit: Duration(microseconds: s.maxCommitUs),
+      rotations: s.rotations,
+      writeErrors: s.writeErrors,
+      lostRecords: s.lostRecords,
+    );
+  } finally {
+    alloc.free(stats);
   }
 }
 
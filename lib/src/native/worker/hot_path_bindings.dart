@@ -0,0 +1,801 @@
+import 'dart:ffi' as ffi;
+
+import '../../../bacnet_plugin_bindings.g.dart';
+
+/// Hand-tuned bindings for the native calls made on every tick or request.
+///
+/// The generated `BacnetBindings` cover the whole stack and route every call
+/// through the general FFI transition. This layer binds only the hot entry
+/// points, resolves each symbol on first use, and marks calls that only
+/// touch memory as leaf calls. Plugin entry points take flat scalar
+/// arguments, so no native structs are allocated per request.
+///
+/// Calls that transmit, block or may re-enter Dart are never leaf calls; a
+/// leaf call holds up the isolate's safepoints for as long as it runs.
+final class HotPathBindings {
+  /// Creates hot-path bindings resolving symbols from [library].
+  HotPathBindings(this._library);
+
+  final ffi.DynamicLibrary _library;
+
+  /// Advances the transaction state machine timers by [milliseconds].
+  ///
+  /// Not a leaf call: a request whose timer expires is retransmitted.
+  late final void Function(int milliseconds) tsmTimerMilliseconds = _library
+      .lookupFunction<ffi.Void Function(ffi.Uint16), void Function(int)>(
+        'tsm_timer_milliseconds',
+      );
+
+  /// Sends a ReadProperty request and returns its invoke ID (0 on failure).
+  ///
+  /// Unlike the generated binding, proprietary object types and properties
+  /// are passed through without a Dart enum lookup. Not a leaf call: it
+  /// transmits.
+  late final int Function(
+    int deviceId,
+    int objectType,
+    int instance,
+    int propertyId,
+    int arrayIndex,
+  )
+  sendReadProperty = _library
+      .lookupFunction<
+        ffi.Uint8 Function(
+          ffi.Uint32,
+          ffi.Uint32,
+          ffi.Uint32,
+          ffi.Uint32,
+          ffi.Uint32,
+        ),
+        int Function(int, int, int, int, int)
+      >('bacnet_plugin_send_read_property');
+
+  /// Adds a static BACnet/IP address binding for a device.
+  ///
+  /// [ipv4] is the address packed big-endian into 32 bits.
+  late final void Function(int deviceId, int ipv4, int port) addressAddIpv4 =
+      _library
+          .lookupFunction<
+            ffi.Void Function(ffi.Uint32, ffi.Uint32, ffi.Uint16),
+            void Function(int, int, int)
+          >('bacnet_plugin_address_add_ipv4', isLeaf: true);
+
+  /// Sends a SubscribeCOVProperty request and returns its invoke ID.
+  ///
+  /// [increment] is only sent when [incrementPresent] is true. Not a leaf
+  /// call: it transmits.
+  late final int Function(
+    int deviceId,
+    int objectType,
+    int instance,
+    int propertyId,
+    bool confirmed,
+    int lifetime,
+    bool cancel,
+    bool incrementPresent,
+    double increment,
+  )
+  sendCovSubscribe = _library
+      .lookupFunction<
+        ffi.Uint8 Function(
+          ffi.Uint32,
+          ffi.Uint32,
+          ffi.Uint32,
+          ffi.Uint32,
+          ffi.Bool,
+          ffi.Uint32,
+          ffi.Bool,
+          ffi.Bool,
+          ffi.Float,
+        ),
+        int Function(int, int, int, int, bool, int, bool, bool, double)
+      >('bacnet_plugin_send_cov_subscribe');
+
+  /// Converts DBCS text in [codePage] to UTF-16 code units in [dst].
+  ///
+  /// Returns the number of code units written, or -1 if the code page is
+  /// unavailable or the text is invalid.
+  late final int Function(
+    int codePage,
+    ffi.Pointer<ffi.Uint8> src,
+    int srcLength,
+    ffi.Pointer<ffi.Uint16> dst,
+    int dstCapacity,
+  )
+  decodeDbcs = _library
+      .lookupFunction<
+        ffi.Int32 Function(
+          ffi.Uint16,
+          ffi.Pointer<ffi.Uint8>,
+          ffi.Uint32,
+          ffi.Pointer<ffi.Uint16>,
+          ffi.Uint32,
+        ),
+        int Function(
+          int,
+          ffi.Pointer<ffi.Uint8>,
+          int,
+          ffi.Pointer<ffi.Uint16>,
+          int,
+        )
+      >('bacnet_plugin_decode_dbcs', isLeaf: true);
+
+  /// Installs the native COV notification handlers.
+  ///
+  /// Confirmed notifications are acknowledged natively; decoded events are
+  /// queued for [covEventPop].
+  late final void Function() covHandlersInit = _library
+      .lookupFunction<ffi.Void Function(), void Function()>(
+        'bacnet_plugin_cov_handlers_init',
+        isLeaf: true,
+      );
+
+  /// Moves the oldest queued COV event into [event].
+  ///
+  /// Returns false when the queue is empty.
+  late final bool Function(ffi.Pointer<BacnetPluginCovEvent> event)
+  covEventPop = _library
+      .lookupFunction<
+        ffi.Bool Function(ffi.Pointer<BacnetPluginCovEvent>),
+        bool Function(ffi.Pointer<BacnetPluginCovEvent>)
+      >('bacnet_plugin_cov_event_pop', isLeaf: true);
+
+  /// Copies the native COV counters into [stats].
+  late final void Function(ffi.Pointer<BacnetPluginCovStats> stats) covStats =
+      _library
+          .lookupFunction<
+            ffi.Void Function(ffi.Pointer<BacnetPluginCovStats>),
+            void Function(ffi.Pointer<BacnetPluginCovStats>)
+          >('bacnet_plugin_cov_stats', isLeaf: true);
+
+  /// Clears every receive pre-filter rule (counters are kept).
+  late final void Function() filterReset = _library
+      .lookupFunction<ffi.Void Function(), void Function()>(
+        'bacnet_plugin_filter_reset',
+        isLeaf: true,
+      );
+
+  /// Denies or allows a confirmed or unconfirmed service choice.
+  late final void Function(bool confirmed, int serviceChoice, bool deny)
+  filterSetService = _library
+      .lookupFunction<
+        ffi.Void Function(ffi.Bool, ffi.Uint8, ffi.Bool),
+        void Function(bool, int, bool)
+      >('bacnet_plugin_filter_set_service', isLeaf: true);
+
+  /// Sets whether network-layer messages are dropped.
+  late final void Function(bool deny) filterSetNetworkMessages = _library
+      .lookupFunction<ffi.Void Function(ffi.Bool), void Function(bool)>(
+        'bacnet_plugin_filter_set_network_messages',
+        isLeaf: true,
+      );
+
+  /// Sets how the source table is applied (see `BACNET_PLUGIN_FILTER_*`).
+  late final void Function(int mode) filterSetSourceMode = _library
+      .lookupFunction<ffi.Void Function(ffi.Uint8), void Function(int)>(
+        'bacnet_plugin_filter_set_source_mode',
+        isLeaf: true,
+      );
+
+  /// Adds a source to the filter table; port 0 matches any port.
+  ///
+  /// Returns false when the table is full.
+  late final bool Function(int ipv4, int port) filterAddSource = _library
+      .lookupFunction<
+        ffi.Bool Function(ffi.Uint32, ffi.Uint16),
+        bool Function(int, int)
+      >('bacnet_plugin_filter_add_source', isLeaf: true);
+
+  /// Copies the receive pre-filter counters into [stats].
+  late final void Function(ffi.Pointer<BacnetPluginFilterStats> stats)
+  filterStats = _library
+      .lookupFunction<
+        ffi.Void Function(ffi.Pointer<BacnetPluginFilterStats>),
+        void Function(ffi.Pointer<BacnetPluginFilterStats>)
+      >('bacnet_plugin_filter_stats', isLeaf: true);
+
+  /// Sends a Who-Is for one device to its cached address only.
+  ///
+  /// Returns false if no address is bound for the device. Not a leaf call:
+  /// it transmits on the datalink.
+  late final bool Function(int deviceId) sendWhoIsDirected = _library
+      .lookupFunction<ffi.Bool Function(ffi.Uint32), bool Function(int)>(
+        'bacnet_plugin_send_who_is_directed',
+      );
+
+  /// Enables SubscribeCOV handling for the local server's objects.
+  late final void Function() serverCovInit = _library
+      .lookupFunction<ffi.Void Function(), void Function()>(
+        'bacnet_plugin_server_cov_init',
+        isLeaf: true,
+      );
+
+  /// Advances subscription lifetimes and sends pending COV notifications.
+  ///
+  /// Not a leaf call: it transmits notifications.
+  late final void Function(int elapsedMilliseconds) serverCovTask = _library
+      .lookupFunction<ffi.Void Function(ffi.Uint16), void Function(int)>(
+        'bacnet_plugin_server_cov_task',
+      );
+
+  /// Sets the COV_Increment of a local analog input or value.
+  ///
+  /// Returns false if the object does not exist or has no COV_Increment.
+  late final bool Function(int objectType, int instance, double increment)
+  setCovIncrement = _library
+      .lookupFunction<
+        ffi.Bool Function(ffi.Uint32, ffi.Uint32, ffi.Float),
+        bool Function(int, int, double)
+      >('bacnet_plugin_set_cov_increment', isLeaf: true);
+
+  /// Answers Who-Is for the local device with paced I-Am responses.
+  late final void Function() serverIAmInit = _library
+      .lookupFunction<ffi.Void Function(), void Function()>(
+        'bacnet_plugin_server_iam_init',
+        isLeaf: true,
+      );
+
+  /// Sets the largest random I-Am delay and the I-Am rate limit.
+  late final void Function(int maxDelayMilliseconds, int maxPerSecond)
+  serverIAmConfigure = _library
+      .lookupFunction<
+        ffi.Void Function(ffi.Uint16, ffi.Uint16),
+        void Function(int, int)
+      >('bacnet_plugin_server_iam_configure', isLeaf: true);
+
+  /// Refills the I-Am rate limit and sends a pending I-Am once it is due.
+  ///
+  /// Not a leaf call: it transmits.
+  late final void Function(int elapsedMilliseconds) serverIAmTask = _library
+      .lookupFunction<ffi.Void Function(ffi.Uint16), void Function(int)>(
+        'bacnet_plugin_server_iam_task',
+      );
+
+  /// Copies the I-Am pacing counters into `stats`.
+  late final void Function(ffi.Pointer<BacnetPluginIAmStats> stats)
+  serverIAmStats = _library
+      .lookupFunction<
+        ffi.Void Function(ffi.Pointer<BacnetPluginIAmStats>),
+        void Function(ffi.Pointer<BacnetPluginIAmStats>)
+      >('bacnet_plugin_server_iam_stats', isLeaf: true);
+
+  /// Writes the server object database to an image file at `path`.
+  ///
+  /// Returns 0 or one of the negative `BACNET_PLUGIN_IMAGE_ERROR_*` codes.
+  late final int Function(
+    ffi.Pointer<ffi.Char> path,
+    ffi.Pointer<BacnetPluginImageStats> stats,
+  )
+  serverSnapshot = _library
+      .lookupFunction<
+        ffi.Int32 Function(
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<BacnetPluginImageStats>,
+        ),
+        int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<BacnetPluginImageStats>)
+      >('bacnet_plugin_server_snapshot');
+
+  /// Rebuilds the server object database from the image at `path`.
+  ///
+  /// Not a leaf call: restored writes go through the write-store callback.
+  late final int Function(
+    ffi.Pointer<ffi.Char> path,
+    ffi.Pointer<BacnetPluginImageStats> stats,
+  )
+  serverRestore = _library
+      .lookupFunction<
+        ffi.Int32 Function(
+          ffi.Pointer<ffi.Char>,
+          ffi.Pointer<BacnetPluginImageStats>,
+        ),
+        int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<BacnetPluginImageStats>)
+      >('bacnet_plugin_server_restore');
+
+  /// Opens `port` as an MS/TP master node and makes it the datalink.
+  ///
+  /// Returns false if the port cannot be opened, the arguments are out of
+  /// range, or the library was built without MS/TP. Not a leaf call: it
+  /// opens the port and starts the node thread.
+  late final bool Function(
+    ffi.Pointer<ffi.Char> port,
+    int baudRate,
+    int macAddress,
+    int maxMaster,
+    int maxInfoFrames,
+  )
+  mstpInit = _library
+      .lookupFunction<
+        ffi.Bool Function(
+          ffi.Pointer<ffi.Char>,
+          ffi.Uint32,
+          ffi.Uint8,
+          ffi.Uint8,
+          ffi.Uint8,
+        ),
+        bool Function(ffi.Pointer<ffi.Char>, int, int, int, int)
+      >('bacnet_plugin_mstp_init');
+
+  /// Closes the active datalink, BACnet/IP or MS/TP.
+  ///
+  /// Not a leaf call: stopping MS/TP joins the node thread.
+  late final void Function() datalinkCleanup = _library
+      .lookupFunction<ffi.Void Function(), void Function()>(
+        'bacnet_plugin_datalink_cleanup',
+      );
+
+  /// Copies the MS/TP counters into `stats`; false if MS/TP is not active.
+  late final bool Function(ffi.Pointer<BacnetPluginMstpStats> stats)
+  mstpStats = _library
+      .lookupFunction<
+        ffi.Bool Function(ffi.Pointer<BacnetPluginMstpStats>),
+        bool Function(ffi.Pointer<BacnetPluginMstpStats>)
+      >('bacnet_plugin_mstp_stats', isLeaf: true);
+
+  /// Opens the write journal at `path` and starts its committer thread.
+  ///
+  /// Returns false if the file cannot be opened or `bufferBytes` is too
+  /// small. Not a leaf call: an open journal is closed first, which joins
+  /// its thread.
+  late final bool Function(
+    ffi.Pointer<ffi.Char> path,
+    int maxFileBytes,
+    int keepFiles,
+    int commitIntervalMs,
+    int bufferBytes,
+  )
+  journalOpen = _library
+      .lookupFunction<
+        ffi.Bool Function(
+          ffi.Pointer<ffi.Char>,
+          ffi.Uint32,
+          ffi.Uint8,
+          ffi.Uint16,
+          ffi.Uint32,
+        ),
+        bool Function(ffi.Pointer<ffi.Char>, int, int, int, int)
+      >('bacnet_plugin_journal_open');
+
+  /// Appends a record to the current journal batch; false if the journal is
+  /// closed or the batch is full. Never waits on the disk.
+  late final bool Function(
+    int kind,
+    int invokeId,
+    int deviceId,
+    int objectType,
+    int instance,
+    int property,
+    int arrayIndex,
+    int priority,
+    ffi.Pointer<ffi.Uint8> value,
+    int valueLength,
+  )
+  journalAppend = _library
+      .lookupFunction<
+        ffi.Bool Function(
+          ffi.Uint8,
+          ffi.Uint8,
+          ffi.Uint32,
+          ffi.Uint16,
+          ffi.Uint32,
+          ffi.Uint32,
+          ffi.Uint32,
+          ffi.Uint8,
+          ffi.Pointer<ffi.Uint8>,
+          ffi.Uint16,
+        ),
+        bool Function(
+          int,
+          int,
+          int,
+          int,
+          int,
+          int,
+          int,
+          int,
+          ffi.Pointer<ffi.Uint8>,
+          int,
+        )
+      >('bacnet_plugin_journal_append', isLeaf: true);
+
+  /// Waits up to `timeoutMs` until every appended record is on disk.
+  ///
+  /// Returns false on timeout, or once a batch has failed to reach disk.
+  /// Not a leaf call: it blocks on the committer thread.
+  late final bool Function(int timeoutMs) journalSync = _library
+      .lookupFunction<ffi.Bool Function(ffi.Uint32), bool Function(int)>(
+        'bacnet_plugin_journal_sync',
+      );
+
+  /// Commits outstanding records and closes the journal.
+  ///
+  /// Not a leaf call: it joins the committer thread.
+  late final void Function() journalClose = _library
+      .lookupFunction<ffi.Void Function(), void Function()>(
+        'bacnet_plugin_journal_close',
+      );
+
+  /// Copies the write journal counters into `stats`.
+  late final void Function(ffi.Pointer<BacnetPluginJournalStats> stats)
+  journalStats = _library
+      .lookupFunction<
+        ffi.Void Function(ffi.Pointer<BacnetPluginJournalStats>),
+        void Function(ffi.Pointer<BacnetPluginJournalStats>)
+      >('bacnet_plugin_journal_stats', isLeaf: true);
+
+  /// Installs the server write-store callback behind the journal hook;
+  /// `nullptr` detaches it.
+  late final void Function(
+    ffi.Pointer<ffi.NativeFunction<write_property_functionFunction>> callback,
+  )
+  writeStoreCallbackSet = _library
+      .lookupFunction<
+        ffi.Void Function(
+          ffi.Pointer<ffi.NativeFunction<write_property_functionFunction>>,
+        ),
+        void Function(
+          ffi.Pointer<ffi.NativeFunction<write_property_functionFunction>>,
+        )
+      >('bacnet_plugin_write_store_callback_set', isLeaf: true);
+
+  /// Sends a WriteProperty request, journaling it, and returns its invoke
+  /// ID (0 on failure).
+  ///
+  /// Not a leaf call: it transmits on the datalink.
+  late final int Function(
+    int deviceId,
+    int objectType,
+    int instance,
+    int property,
+    ffi.Pointer<BACNET_APPLICATION_DATA_VALUE> value,
+    int priority,
+    int arrayIndex,
+  )
+  sendWriteProperty = _library
+      .lookupFunction<
+        ffi.Uint8 Function(
+          ffi.Uint32,
+          ffi.Uint32,
+          ffi.Uint32,
+          ffi.Uint32,
+          ffi.Pointer<BACNET_APPLICATION_DATA_VALUE>,
+          ffi.Uint8,
+          ffi.Uint32,
+        ),
+        int Function(
+          int,
+          int,
+          int,
+          int,
+          ffi.Pointer<BACNET_APPLICATION_DATA_VALUE>,
+          int,
+          int,
+        )
+      >('bacnet_plugin_send_write_property');
+
+  /// Sets the real-time profile; `cpu` -1 and `priority` 0 clear it.
+  ///
+  /// Applied to the polling thread by [realtimeEnter]. Not a leaf call:
+  /// locking or unlocking memory can take a while.
+  late final void Function(int cpu, int priority, bool lockMemory)
+  realtimeConfigure = _library
+      .lookupFunction<
+        ffi.Void Function(ffi.Int32, ffi.Uint8, ffi.Bool),
+        void Function(int, int, bool)
+      >('bacnet_plugin_realtime_configure');
+
+  /// Moves the real-time profile to the calling thread if it does not hold
+  /// it yet; a single comparison once it does.
+  late final void Function() realtimeEnter = _library
+      .lookupFunction<ffi.Void Function(), void Function()>(
+        'bacnet_plugin_realtime_enter',
+        isLeaf: true,
+      );
+
+  /// Monotonic clock in microseconds, the clock of the send and receive
+  /// timestamps in [BacnetPluginRealtimeStats].
+  late final int Function() monotonicUs = _library
+      .lookupFunction<ffi.Uint64 Function(), int Function()>(
+        'bacnet_plugin_monotonic_us',
+        isLeaf: true,
+      );
+
+  /// Copies the real-time profile state into `stats`.
+  late final void Function(ffi.Pointer<BacnetPluginRealtimeStats> stats)
+  realtimeStats = _library
+      .lookupFunction<
+        ffi.Void Function(ffi.Pointer<BacnetPluginRealtimeStats>),
+        void Function(ffi.Pointer<BacnetPluginRealtimeStats>)
+      >('bacnet_plugin_realtime_stats', isLeaf: true);
+
+  /// Sends requests submitted through the native client API and times out
+  /// unanswered ones. Called on every poll.
+  ///
+  /// Not a leaf call: it transmits and runs native completion callbacks.
+  late final void Function() clientTask = _library
+      .lookupFunction<ffi.Void Function(), void Function()>(
+        'bacnet_plugin_client_task',
+      );
+
+  /// Completes every outstanding native client request as stopped.
+  ///
+  /// Not a leaf call: it runs native completion callbacks.
+  late final void Function() clientStop = _library
+      .lookupFunction<ffi.Void Function(), void Function()>(
+        'bacnet_plugin_client_stop',
+      );
+}
+
+/// Mirror of `BACNET_PLUGIN_COV_EVENT` in `bacnet_plugin.h`.
+final class BacnetPluginCovEvent extends ffi.Struct {
+  /// Initiating device instance.
+  @ffi.Uint32()
+  external int deviceId;
+
+  /// Monitored object type.
+  @ffi.Uint32()
+  external int objectType;
+
+  /// Monitored object instance.
+  @ffi.Uint32()
+  external int objectInstance;
+
+  /// Seconds left on the subscription.
+  @ffi.Uint32()
+  external int timeRemaining;
+
+  /// First reported property other than status_flags, or [noProperty].
+  @ffi.Uint32()
+  external int propertyId;
+
+  /// Numeric form of the reported value.
+  @ffi.Double()
+  external double value;
+
+  /// Application tag of the reported value.
+  @ffi.Uint8()
+  external int valueTag;
+
+  /// Status flags packed as bits 0-3.
+  @ffi.Uint8()
+  external int statusFlags;
+
+  /// Whether [statusFlags] was reported.
+  @ffi.Bool()
+  external bool hasStatusFlags;
+
+  /// Whether the notification was confirmed.
+  @ffi.Bool()
+  external bool confirmed;
+
+  /// Value of [propertyId] when only status flags were reported.
+  static const int noProperty = 0xFFFFFFFF;
+}
+
+/// Mirror of `BACNET_PLUGIN_COV_STATS` in `bacnet_plugin.h`.
+final class BacnetPluginCovStats extends ffi.Struct {
+  /// COV notifications received, confirmed and unconfirmed.
+  @ffi.Uint32()
+  external int received;
+
+  /// Confirmed notifications the sender repeated because an ack was lost.
+  @ffi.Uint32()
+  external int retransmits;
+
+  /// SimpleAcks sent.
+  @ffi.Uint32()
+  external int acked;
+
+  /// Confirmed notifications answered with a Reject or Abort.
+  @ffi.Uint32()
+  external int rejected;
+
+  /// Events dropped because the queue was full.
+  @ffi.Uint32()
+  external int dropped;
+}
+
+/// Mirror of `BACNET_PLUGIN_FILTER_STATS` in `bacnet_plugin.h`.
+final class BacnetPluginFilterStats extends ffi.Struct {
+  /// Packets handed on to `npdu_handler`.
+  @ffi.Uint32()
+  external int passed;
+
+  /// Requests dropped by a service rule.
+  @ffi.Uint32()
+  external int droppedService;
+
+  /// Packets dropped by a source rule.
+  @ffi.Uint32()
+  external int droppedSource;
+
+  /// Network-layer messages dropped.
+  @ffi.Uint32()
+  external int droppedNetwork;
+
+  /// Drops per unconfirmed service choice 0-15.
+  @ffi.Array(16)
+  external ffi.Array<ffi.Uint32> droppedUnconfirmed;
+}
+
+/// Mirror of `BACNET_PLUGIN_IMAGE_STATS` in `bacnet_plugin.h`.
+final class BacnetPluginImageStats extends ffi.Struct {
+  /// Objects written or restored.
+  @ffi.Uint32()
+  external int objects;
+
+  /// Property values written or restored.
+  @ffi.Uint32()
+  external int properties;
+
+  /// Property values an object refused on restore.
+  @ffi.Uint32()
+  external int skipped;
+
+  /// COV subscriptions written or replayed.
+  @ffi.Uint32()
+  external int subscriptions;
+
+  /// Size of the image file.
+  @ffi.Uint32()
+  external int bytes;
+}
+
+/// Mirror of `BACNET_PLUGIN_IAM_STATS` in `bacnet_plugin.h`.
+final class BacnetPluginIAmStats extends ffi.Struct {
+  /// Who-Is requests received, for any device range.
+  @ffi.Uint32()
+  external int whoIsReceived;
+
+  /// I-Am responses sent.
+  @ffi.Uint32()
+  external int sent;
+
+  /// Who-Is requests answered by an I-Am that was already pending.
+  @ffi.Uint32()
+  external int coalesced;
+
+  /// Who-Is requests dropped by the rate limit.
+  @ffi.Uint32()
+  external int dropped;
+
+  /// I-Am responses the datalink failed to send.
+  @ffi.Uint32()
+  external int sendFailed;
+
+  /// Shortest delay before an I-Am was sent.
+  @ffi.Uint32()
+  external int delayMinMs;
+
+  /// Longest delay before an I-Am was sent.
+  @ffi.Uint32()
+  external int delayMaxMs;
+
+  /// Sum of all I-Am delays.
+  @ffi.Uint32()
+  external int delayTotalMs;
+}
+
+/// Mirror of `BACNET_PLUGIN_MSTP_STATS` in `bacnet_plugin.h`.
+final class BacnetPluginMstpStats extends ffi.Struct {
+  /// Serial line rate.
+  @ffi.Uint32()
+  external int baudRate;
+
+  /// This node's MS/TP MAC address.
+  @ffi.Uint8()
+  external int macAddress;
+
+  /// Frames this node may send per token hold.
+  @ffi.Uint8()
+  external int maxInfoFrames;
+
+  /// Frames sent, including tokens and polls.
+  @ffi.Uint32()
+  external int transmitFrames;
+
+  /// Valid frames received, for any station.
+  @ffi.Uint32()
+  external int receiveValidFrames;
+
+  /// Frames received with a bad header or data CRC.
+  @ffi.Uint32()
+  external int receiveInvalidFrames;
+
+  /// Data frames sent.
+  @ffi.Uint32()
+  external int transmitPdus;
+
+  /// Data frames received for this node.
+  @ffi.Uint32()
+  external int receivePdus;
+
+  /// Times the token was lost and regenerated.
+  @ffi.Uint32()
+  external int lostTokens;
+}
+
+/// Mirror of `BACNET_PLUGIN_JOURNAL_STATS` in `bacnet_plugin.h`.
+final class BacnetPluginJournalStats extends ffi.Struct {
+  /// Bytes committed to disk.
+  @ffi.Uint64()
+  external int bytes;
+
+  /// Records appended.
+  @ffi.Uint32()
+  external int records;
+
+  /// Writes refused because they could not be journaled.
+  @ffi.Uint32()
+  external int refused;
+
+  /// Appends that waited for a full batch to be committed.
+  @ffi.Uint32()
+  external int stalls;
+
+  /// Batches written and synced.
+  @ffi.Uint32()
+  external int commits;
+
+  /// Most records in one batch.
+  @ffi.Uint32()
+  external int maxBatchRecords;
+
+  /// Write and sync time of the last batch.
+  @ffi.Uint32()
+  external int lastCommitUs;
+
+  /// Longest write and sync time of a batch.
+  @ffi.Uint32()
+  external int maxCommitUs;
+
+  /// File rotations.
+  @ffi.Uint32()
+  external int rotations;
+
+  /// Batches that failed to write or sync.
+  @ffi.Uint32()
+  external int writeErrors;
+
+  /// Records in batches that failed to write or sync.
+  @ffi.Uint32()
+  external int lostRecords;
+
+  /// Whether the journal is open.
+  @ffi.Bool()
+  external bool open;
+}
+
+/// Mirror of `BACNET_PLUGIN_REALTIME_STATS` in `bacnet_plugin.h`.
+final class BacnetPluginRealtimeStats extends ffi.Struct {
+  /// Monotonic time the last request was sent.
+  @ffi.Uint64()
+  external int lastSendUs;
+
+  /// Monotonic time the last PDU was received.
+  @ffi.Uint64()
+  external int lastReceiveUs;
+
+  /// Pinned CPU, -1 for none.
+  @ffi.Int32()
+  external int cpu;
+
+  /// Times the profile moved to another thread.
+  @ffi.Uint32()
+  external int threadChanges;
+
+  /// Requested SCHED_FIFO priority, 0 for none.
+  @ffi.Uint8()
+  external int priority;
+
+  /// Whether the holder thread is pinned.
+  @ffi.Bool()
+  external bool affinityApplied;
+
+  /// Whether the holder thread runs under SCHED_FIFO.
+  @ffi.Bool()
+  external bool fifoApplied;
+
+  /// Whether the process's memory is locked.
+  @ffi.Bool()
+  external bool memoryLocked;
+}
@@ -0,0 +1,19 @@
+import 'dart:isolate';
+
+import '../../core/bacnet_config.dart';
+
+/// A [SendPort] that hands messages to a function on the same isolate.
+///
+/// Lets the worker's handlers and the main side of [BacnetExecutionMode.direct]
+/// talk through the same `send` calls as in worker mode, without copying
+/// messages or crossing an isolate boundary.
+class LocalSendPort implements SendPort {
+  /// Creates a port that calls [onMessage] for every message sent.
+  LocalSendPort(this.onMessage);
+
+  /// Receives each message, synchronously, on the sending isolate.
+  final void Function(Object? message) onMessage;
+
+  @override
+  void send(Object? message) => onMessage(message);
+}
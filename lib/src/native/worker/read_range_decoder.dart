@@ -1,10 +1,11 @@
-import 'dart:convert';
 import 'dart:ffi' as ffi;
 import 'dart:typed_data';
 
 import 'package:bacnet_plugin/bacnet_plugin.dart';
 import 'package:bacnet_plugin/src/native/worker/globals.dart';
 
+import 'charset_decoder.dart';
+
 /// Decoder for ReadRange responses.
 class ReadRangeDecoder {
   /// Decodes ReadRange response data.
@@ -62,6 +63,11 @@ class ReadRangeDecoder {
                   break;
                 }
                 try {
+                  if (data[offset.value] == 0x0E) {
+                    // Opening tag 0: a Trend Log BACnetLogRecord
+                    items.add(_decodeLogRecord(data, offset, length));
+                    continue;
+                  }
                   final val = _decodeApplicationData(data, offset);
                   if (val != null) {
                     items.add(val);
@@ -94,6 +100,122 @@ class ReadRangeDecoder {
     return result;
   }
 
+  /// Decodes one BACnetLogRecord into a map containing:
+  /// - timestamp: DateTime (device local time)
+  /// - value: the logged datum (null for a log status record)
+  /// - logStatus: int, set for log status records (bits 0-2)
+  /// - error: [BacnetError], set for failure records
+  /// - statusFlags: int (optional, bits 0-3 as in-alarm..out-of-service)
+  static Map<String, dynamic> _decodeLogRecord(
+    ffi.Pointer<ffi.Uint8> data,
+    _Offset offset,
+    int length,
+  ) {
+    int next() {
+      if (offset.value >= length) {
+        throw const FormatException('Log record runs past end of data');
+      }
+      return data[offset.value++];
+    }
+
+    final record = <String, dynamic>{};
+    next(); // Opening tag 0
+    final dateTag = next(); // Application Date, length 4
+    if (dateTag != 0xA4) throw const FormatException('Expected Date');
+    final year = next() + 1900;
+    final month = next();
+    final day = next();
+    next(); // Day of week
+    final timeTag = next(); // Application Time, length 4
+    if (timeTag != 0xB4) throw const FormatException('Expected Time');
+    final hour = next();
+    final minute = next();
+    final second = next();
+    final hundredths = next();
+    if (next() != 0x0F) throw const FormatException('Expected closing tag 0');
+    record['timestamp'] = DateTime(
+      year,
+      month,
+      day,
+      hour == 0xFF ? 0 : hour,
+      minute == 0xFF ? 0 : minute,
+      second == 0xFF ? 0 : second,
+      hundredths == 0xFF ? 0 : hundredths * 10,
+    );
+
+    if (next() != 0x1E) throw const FormatException('Expected opening tag 1');
+    final tagByte = next();
+    final choice = tagByte >> 4;
+    final lvt = tagByte & 0x07;
+    if (lvt == 6) {
+      // Constructed choice: failure [8] or any-value [10]
+      final values = <int>[];
+      while (offset.value < length &&
+          !_isClosingTag(data, offset.value, choice)) {
+        final inner = next();
+        var len = inner & 0x07;
+        if (len == 5) len = next();
+        var v = 0;
+        for (var i = 0; i < len; i++) {
+          v = (v << 8) | next();
+        }
+        values.add(v);
+      }
+      next(); // Closing choice tag
+      if (choice == 8 && values.length >= 2) {
+        record['error'] = BacnetError(values[0], values[1]);
+      }
+      record['value'] = null;
+    } else {
+      var len = lvt;
+      if (len == 5) len = next();
+      final bytes = [for (var i = 0; i < len; i++) next()];
+      int unsigned() => bytes.fold(0, (v, b) => (v << 8) | b);
+      switch (choice) {
+        case 0: // log-status bit string
+          record['logStatus'] = bytes.length > 1 ? _bits(bytes[1], 3) : 0;
+          record['value'] = null;
+        case 1: // boolean
+          record['value'] = bytes.isNotEmpty && bytes[0] != 0;
+        case 2 || 9: // real, time-change
+          final list = Uint8List.fromList(bytes);
+          record['value'] = bytes.length == 4
+              ? ByteData.sublistView(list).getFloat32(0, Endian.big)
+              : null;
+        case 3 || 4: // enumerated, unsigned
+          record['value'] = unsigned();
+        case 5: // signed
+          var v = unsigned();
+          if (len > 0 && (v & (1 << (len * 8 - 1))) != 0) v -= 1 << (len * 8);
+          record['value'] = v;
+        case 6: // bit string
+          record['value'] = bytes.length > 1 ? bytes.sublist(1) : <int>[];
+        default: // null
+          record['value'] = null;
+      }
+    }
+    if (next() != 0x1F) throw const FormatException('Expected closing tag 1');
+
+    if (offset.value < length && (data[offset.value] & 0xF8) == 0x28) {
+      // Context tag 2: status flags bit string
+      var len = next() & 0x07;
+      if (len == 5) len = next();
+      final bytes = [for (var i = 0; i < len; i++) next()];
+      if (bytes.length > 1) record['statusFlags'] = _bits(bytes[1], 4);
+    }
+    return record;
+  }
+
+  /// The first [count] bits of a bit string byte, sent MSB first, packed
+  /// with bit string bit 0 as bit 0.
+  static int _bits(int byte, int count) {
+    var bits = 0;
+    for (var i = 0; i < count; i++) {
+      if ((byte & (0x80 >> i)) != 0) bits |= 1 << i;
+    }
+    return bits;
+  }
+
   static int _decodeUnsigned(ffi.Pointer<ffi.Uint8> data, _Offset offset) {
     final b = data[offset.value++];
     int len = b & 0x07;
@@ -167,13 +289,10 @@ class ReadRangeDecoder {
       return ByteData.sublistView(list).getFloat32(0, Endian.big);
     }
     if (tagNumber == 7) {
-      // String
-      offset.value++; // Skip encoding
-      final bytes = <int>[];
-      for (int i = 0; i < len - 1; i++) {
-        bytes.add(data[offset.value++]);
-      }
-      return utf8.decode(bytes);
+      // String (charset byte first)
+      final value = decodeCharacterString(data, offset.value, len);
+      offset.value += len;
+      return value;
     }
     if (tagNumber == 9) {
       // Enumerated
@@ -1,20 +1,26 @@
-import 'dart:convert';
 import 'dart:ffi' as ffi;
 import 'dart:typed_data';
 
 import 'package:bacnet_plugin/src/native/worker/globals.dart';
 
 import '../../core/types.dart';
+import 'charset_decoder.dart';
 
 /// Decoder for ReadPropertyMultiple (RPM) responses.
 ///
 /// Parses raw BACnet RPM acknowledgment data into structured Maps containing
-/// object identifiers and their property values.
+/// object identifiers and their property values. Handles the wide responses
+/// returned for the ALL, REQUIRED and OPTIONAL property identifiers: every
+/// application tag, list and array values, and constructed values.
 class RPMDecoder {
   /// Decodes RPM response data into a map of objects and their properties.
   ///
   /// Returns a Map where keys are 'type:instance' strings and values are Maps
-  /// of property ID to property value.
+  /// of property ID to property value. A property holding several values
+  /// (such as an array read in full) decodes to a `List`; a property that
+  /// could not be read decodes to a [BacnetError]. A property read at
+  /// several array indexes in one request, such as a page of `object_list`,
+  /// decodes to a `Map<int, dynamic>` from array index to value.
   static Map<String, Map<int, dynamic>> decode(
     ffi.Pointer<ffi.Uint8> data,
     int length,
@@ -22,276 +28,306 @@ class RPMDecoder {
     if (length <= 0) return {};
 
     final result = <String, Map<int, dynamic>>{};
-    final offset = _Offset(0);
+    final reader = _Reader(data, length);
 
     try {
-      while (offset.value < length) {
+      while (!reader.atEnd) {
         // 1. Decode Object Identifier (Context Tag 0)
-        if (!_isContextTag(data, offset.value, 0)) {
+        final objectTag = reader.peekTag();
+        if (!objectTag.isContext || objectTag.number != 0) {
           // If we hit something else, maybe end of packet?
           break;
         }
-
-        final objectId = _decodeObjectId(data, offset);
-        final objKey = '${objectId['type']}:${objectId['instance']}';
+        reader.readTag();
+        final objectId = reader.readUnsigned(objectTag.length);
+        final objKey = '${(objectId >> 22) & 0x3FF}:${objectId & 0x3FFFFF}';
         final propsMap = <int, dynamic>{};
+        // Array index of each property's first indexed result.
+        final firstIndex = <int, int>{};
+        // Keep what was decoded so far if the packet is cut short.
+        result[objKey] = propsMap;
 
         // 2. Expect Opening Tag 1 (List of Results)
-        if (!_decodeOpeningTag(data, offset, 1)) {
-          throw Exception('Expected Opening Tag 1 after Object ID');
+        if (!reader.readTag().isOpening(1)) {
+          throw const FormatException(
+            'Expected Opening Tag 1 after Object ID',
+          );
         }
 
         // 3. Decode Properties
-        while (offset.value < length) {
+        while (true) {
+          final tag = reader.readTag();
           // Check for Closing Tag 1
-          if (_isClosingTag(data, offset.value, 1)) {
-            offset.value++;
-            break;
-          }
+          if (tag.isClosing(1)) break;
 
           // Property Identifier (Context Tag 2)
-          if (!_isContextTag(data, offset.value, 2)) {
-            throw Exception('Expected Property ID (Tag 2)');
+          if (!tag.isContext || tag.number != 2) {
+            throw const FormatException('Expected Property ID (Tag 2)');
           }
-          final propertyId = _decodeEnumerated(data, offset, 2);
+          final propertyId = reader.readUnsigned(tag.length);
 
           // Optional Array Index (Context Tag 3)
-          if (_isContextTag(data, offset.value, 3)) {
-            // Unused currently in map, but we must decode to advance offset
-            _decodeUnsigned(data, offset, 3);
+          int? arrayIndex;
+          var resultTag = reader.readTag();
+          if (resultTag.isContext && resultTag.number == 3) {
+            arrayIndex = reader.readUnsigned(resultTag.length);
+            resultTag = reader.readTag();
           }
 
           // Result Choice: Value (Tag 4) or Error (Tag 5)
-          if (_isOpeningTag(data, offset.value, 4)) {
-            // Property Value
-            offset.value++; // Consume Opening Tag 4
-
-            // Check if it's immediately closing (empty value?)
-            if (_isClosingTag(data, offset.value, 4)) {
-              propsMap[propertyId] = null;
-              offset.value++;
-            } else {
-              // Decode Application Data
-              try {
-                final val = _decodeApplicationData(data, offset);
-                propsMap[propertyId] = val;
-              } on Exception catch (e) {
-                propsMap[propertyId] = 'DecodeError: $e';
-                // Fast forward to closing tag 4
-                _fastForwardToClosingTag(data, offset, 4);
-              }
-
-              // Expect Closing Tag 4
-              if (!_decodeClosingTag(data, offset, 4)) {
-                // Should have been consumed by loop if multiple values or by logic above
-              }
+          if (resultTag.isOpening(4)) {
+            final start = reader.offset;
+            try {
+              final values = reader.readValuesUntilClosing(4);
+              final value = switch (values.length) {
+                0 => null,
+                1 => values.first,
+                _ => values,
+              };
+              _store(propsMap, firstIndex, propertyId, arrayIndex, value);
+            } on FormatException catch (e) {
+              _store(
+                propsMap,
+                firstIndex,
+                propertyId,
+                arrayIndex,
+                'DecodeError: ${e.message}',
+              );
+              reader
+                ..offset = start
+                ..skipUntilClosing(4);
             }
-          } else if (_isOpeningTag(data, offset.value, 5)) {
+          } else if (resultTag.isOpening(5)) {
             // Property Access Error
-            offset.value++; // Consume Opening Tag 5
-
-            final errClass = _decodeEnumerated(data, offset, -1); // App tag
-            final errCode = _decodeEnumerated(data, offset, -1);
-
-            propsMap[propertyId] = BacnetError(errClass, errCode);
-
-            if (!_decodeClosingTag(data, offset, 5)) {
-              throw Exception('Expected Closing Tag 5');
+            final errClass = reader.readUnsigned(reader.readTag().length);
+            final errCode = reader.readUnsigned(reader.readTag().length);
+            _store(
+              propsMap,
+              firstIndex,
+              propertyId,
+              arrayIndex,
+              BacnetError(errClass, errCode),
+            );
+
+            if (!reader.readTag().isClosing(5)) {
+              throw const FormatException('Expected Closing Tag 5');
             }
           } else {
-            throw Exception('Expected Value (Tag 4) or Error (Tag 5)');
+            throw const FormatException(
+              'Expected Value (Tag 4) or Error (Tag 5)',
+            );
           }
         }
-
-        result[objKey] = propsMap;
       }
-    } on Exception catch (e) {
-      // ignore: avoid_print
+    } on FormatException catch (e) {
       logToMain(
         BacnetLogLevel.error,
-        'RPM Manual Decode Error: $e (Offset: ${offset.value})',
+        'RPM Manual Decode Error: ${e.message} (Offset: ${reader.offset})',
       );
     }
 
     return result;
   }
 
-  // --- Primitives ---
-
-  static bool _isContextTag(
-    ffi.Pointer<ffi.Uint8> data,
-    int offset,
-    int tagNumber,
+  /// Stores one result, collecting repeated array-indexed reads of the same
+  /// property into an index-to-value map.
+  static void _store(
+    Map<int, dynamic> props,
+    Map<int, int> firstIndex,
+    int propertyId,
+    int? arrayIndex,
+    Object? value,
   ) {
-    final b = data[offset];
-    // if ((b & 0x08) != 0) return true; // Removed buggy short-circuit
-    // Actually standard says:
-    // Bit 3: Class (0=Application, 1=Context Specific)
-    // Bit 7-4: Tag Number
-    final isContext = (b & 0x08) != 0;
-    final num = (b & 0xF0) >> 4;
-    return isContext && num == tagNumber;
+    if (arrayIndex == null) {
+      props[propertyId] = value;
+      return;
+    }
+    final first = firstIndex[propertyId];
+    if (first == null) {
+      firstIndex[propertyId] = arrayIndex;
+      props[propertyId] = value;
+    } else if (first >= 0) {
+      props[propertyId] = <int, dynamic>{
+        first: props[propertyId],
+        arrayIndex: value,
+      };
+      // Marks the property as already collected.
+      firstIndex[propertyId] = -1;
+    } else {
+      (props[propertyId] as Map<int, dynamic>)[arrayIndex] = value;
+    }
   }
+}
 
-  static bool _isOpeningTag(
-    ffi.Pointer<ffi.Uint8> data,
-    int offset,
-    int tagNumber,
-  ) {
-    final b = data[offset];
-    final num = (b & 0xF0) >> 4;
-    final isContext = (b & 0x08) != 0;
-    final lvt = b & 0x07;
-    return isContext && (num == tagNumber) && (lvt == 6); // 6 = Opening Tag
-  }
+/// A decoded BACnet tag header.
+class _Tag {
+  _Tag(this.number, this.isContext, this.lvt, this.length);
 
-  static bool _isClosingTag(
-    ffi.Pointer<ffi.Uint8> data,
-    int offset,
-    int tagNumber,
-  ) {
-    final b = data[offset];
-    final num = (b & 0xF0) >> 4;
-    final isContext = (b & 0x08) != 0;
-    final lvt = b & 0x07;
-    return isContext && (num == tagNumber) && (lvt == 7); // 7 = Closing Tag
-  }
+  final int number;
+  final bool isContext;
 
-  static bool _decodeOpeningTag(
-    ffi.Pointer<ffi.Uint8> data,
-    _Offset offset,
-    int tagNumber,
-  ) {
-    if (_isOpeningTag(data, offset.value, tagNumber)) {
-      offset.value++;
-      return true;
-    }
-    return false;
-  }
+  /// Raw length/value/type bits (also the value of an application boolean).
+  final int lvt;
 
-  static bool _decodeClosingTag(
-    ffi.Pointer<ffi.Uint8> data,
-    _Offset offset,
-    int tagNumber,
-  ) {
-    if (_isClosingTag(data, offset.value, tagNumber)) {
-      offset.value++;
-      return true;
-    }
-    return false;
-  }
+  /// Content length in bytes (0 for opening/closing tags and booleans).
+  final int length;
 
-  static Map<String, int> _decodeObjectId(
-    ffi.Pointer<ffi.Uint8> data,
-    _Offset offset,
-  ) {
-    offset.value++; // Consume Tag byte
+  bool isOpening(int tagNumber) => isContext && lvt == 6 && number == tagNumber;
+  bool isClosing(int tagNumber) => isContext && lvt == 7 && number == tagNumber;
+  bool get isOpeningAny => isContext && lvt == 6;
+  bool get isClosingAny => isContext && lvt == 7;
+}
 
-    int val = 0;
-    for (int i = 0; i < 4; i++) {
-      val = (val << 8) | data[offset.value++];
+/// Bounds-checked cursor over the native response buffer.
+class _Reader {
+  _Reader(this._data, this._length);
+
+  final ffi.Pointer<ffi.Uint8> _data;
+  final int _length;
+  int offset = 0;
+
+  bool get atEnd => offset >= _length;
+
+  int _next() {
+    if (offset >= _length) {
+      throw const FormatException('Unexpected end of data');
     }
-    final type = (val >> 22) & 0x3FF;
-    final inst = val & 0x3FFFFF;
-    return {'type': type, 'instance': inst};
+    return _data[offset++];
   }
 
-  static int _decodeEnumerated(
-    ffi.Pointer<ffi.Uint8> data,
-    _Offset offset,
-    // ignore: unused_element
-    int contextTag,
-  ) {
-    final b = data[offset.value++];
+  _Tag peekTag() {
+    final start = offset;
+    final tag = readTag();
+    offset = start;
+    return tag;
+  }
+
+  _Tag readTag() {
+    final b = _next();
+    var number = b >> 4;
+    if (number == 15) number = _next(); // Extended tag number
+    final isContext = (b & 0x08) != 0;
+    final lvt = b & 0x07;
 
-    int len = b & 0x07;
-    if (len == 5) {
-      len = data[offset.value++]; // Extended length
+    if (isContext && lvt >= 6) return _Tag(number, true, lvt, 0);
+    if (!isContext && number == 1) return _Tag(number, false, lvt, 0);
+
+    var length = lvt;
+    if (lvt == 5) {
+      length = _next(); // Extended length
+      if (length == 254) {
+        length = readUnsigned(2);
+      } else if (length == 255) {
+        length = readUnsigned(4);
+      }
     }
+    return _Tag(number, isContext, lvt, length);
+  }
 
-    int val = 0;
-    for (int i = 0; i < len; i++) {
-      val = (val << 8) | data[offset.value++];
+  int readUnsigned(int len) {
+    var val = 0;
+    for (var i = 0; i < len; i++) {
+      val = (val << 8) | _next();
     }
     return val;
   }
 
-  static int _decodeUnsigned(
-    ffi.Pointer<ffi.Uint8> data,
-    _Offset offset,
-    int contextTag,
-  ) {
-    // Same logic as enumerated
-    return _decodeEnumerated(data, offset, contextTag);
+  Uint8List readBytes(int len) {
+    if (offset + len > _length) {
+      throw const FormatException('Value runs past end of data');
+    }
+    final bytes = _data.asTypedList(_length).sublist(offset, offset + len);
+    offset += len;
+    return bytes;
   }
 
-  static dynamic _decodeApplicationData(
-    ffi.Pointer<ffi.Uint8> data,
-    _Offset offset,
-  ) {
-    // Check if closing tag (end of list of values)
-    if ((data[offset.value] & 0x08) != 0 && (data[offset.value] & 0x07) == 7) {
-      return null; // Closing tag found
+  /// Decodes values until the closing tag [tagNumber], which is consumed.
+  List<dynamic> readValuesUntilClosing(int tagNumber) {
+    final values = <dynamic>[];
+    while (true) {
+      final tag = readTag();
+      if (tag.isClosing(tagNumber)) return values;
+      values.add(_readValue(tag));
     }
+  }
 
-    final tagByte = data[offset.value++];
-    final tagNumber = (tagByte & 0xF0) >> 4;
-    // final isContext = (tagByte & 0x08) != 0; // Unused
-    var len = tagByte & 0x07;
-
-    if (len == 5) {
-      len = data[offset.value++];
+  /// Skips forward past the closing tag [tagNumber], honouring nesting.
+  void skipUntilClosing(int tagNumber) {
+    var depth = 0;
+    while (true) {
+      final tag = readTag();
+      if (tag.isOpeningAny) {
+        depth++;
+      } else if (tag.isClosingAny) {
+        if (depth == 0 && tag.number == tagNumber) return;
+        depth--;
+      } else {
+        offset += tag.length;
+      }
     }
+  }
 
-    // Basic Types
-    if (tagNumber == 1) return len == 1; // Boolean
-    if (tagNumber == 2) {
-      // Unsigned
-      int val = 0;
-      for (int i = 0; i < len; i++) {
-        val = (val << 8) | data[offset.value++];
-      }
-      return val;
+  dynamic _readValue(_Tag tag) {
+    if (tag.isOpeningAny) {
+      // Constructed value: decode its members as a list.
+      return readValuesUntilClosing(tag.number);
     }
-    if (tagNumber == 4) {
-      // Real
-      final list = Uint8List(4);
-      for (int i = 0; i < 4; i++) {
-        list[i] = data[offset.value++];
-      }
-      return ByteData.sublistView(list).getFloat32(0, Endian.big);
+    if (tag.isClosingAny) {
+      throw FormatException('Unexpected closing tag ${tag.number}');
     }
-    if (tagNumber == 7) {
-      // String
-      offset.value++; // Skip encoding
-      final bytes = <int>[];
-      for (int i = 0; i < len - 1; i++) {
-        bytes.add(data[offset.value++]);
-      }
-      return utf8.decode(bytes);
+    if (tag.isContext) {
+      // Context-tagged primitive: meaning depends on the property.
+      return tag.length <= 6 ? readUnsigned(tag.length) : readBytes(tag.length);
     }
 
-    // Skip unknown
-    offset.value += len;
-    return 'UnknownTag$tagNumber';
-  }
-
-  static void _fastForwardToClosingTag(
-    ffi.Pointer<ffi.Uint8> data,
-    _Offset offset,
-    int tagNumber,
-  ) {
-    // Scan until we find closing tag
-    // Dangerous manual scan
-    while (true) {
-      if (_isClosingTag(data, offset.value, tagNumber)) break;
-      offset.value++;
-      if (offset.value > 10000) break; // Safety break
+    final len = tag.length;
+    switch (tag.number) {
+      case 0: // Null
+        return null;
+      case 1: // Boolean
+        return tag.lvt == 1;
+      case 2: // Unsigned
+      case 9: // Enumerated
+        return readUnsigned(len);
+      case 3: // Signed
+        var val = readUnsigned(len);
+        if (len > 0 && len <= 6 && (val & (1 << (len * 8 - 1))) != 0) {
+          val -= 1 << (len * 8);
+        }
+        return val;
+      case 4: // Real
+        return ByteData.sublistView(readBytes(4)).getFloat32(0, Endian.big);
+      case 5: // Double
+        return ByteData.sublistView(readBytes(8)).getFloat64(0, Endian.big);
+      case 6: // Octet String
+        return readBytes(len);
+      case 7: // Character String
+        if (offset + len > _length) {
+          throw const FormatException('Value runs past end of data');
+        }
+        final value = decodeCharacterString(_data, offset, len);
+        offset += len;
+        return value;
+      case 8: // Bit String
+        if (len == 0) return <bool>[];
+        final unused = _next();
+        final bytes = readBytes(len - 1);
+        return [
+          for (var i = 0; i < bytes.length * 8 - unused; i++)
+            (bytes[i >> 3] & (0x80 >> (i & 7))) != 0,
+        ];
+      case 10 when len == 4: // Date
+        final d = readBytes(len);
+        return '${d[0] + 1900}-${d[1]}-${d[2]} (W:${d[3]})';
+      case 11 when len == 4: // Time
+        final t = readBytes(len);
+        return '${t[0]}:${t[1]}:${t[2]}.${t[3]}';
+      case 12 when len == 4: // Object ID
+        final val = readUnsigned(len);
+        return {'type': (val >> 22) & 0x3FF, 'instance': val & 0x3FFFFF};
+      default:
+        offset += len;
+        return 'UnknownTag${tag.number}';
     }
   }
 }
-
-class _Offset {
-  int value;
-  _Offset(this.value);
-}
@@ -0,0 +1,72 @@
+import 'dart:ffi' as ffi;
+
+import 'package:ffi/ffi.dart';
+
+import '../../../bacnet_plugin_bindings.g.dart';
+import 'accounting_allocator.dart';
+import 'globals.dart';
+import 'hot_path_bindings.dart';
+
+/// Receive, event and request buffers the worker keeps for its whole
+/// lifetime, so the receive path and single-property requests allocate no
+/// native memory.
+///
+/// [dispose] frees them on an orderly shutdown. If the isolate is killed
+/// without one, the attached [ffi.NativeFinalizer] releases them instead.
+final class WorkerBuffers implements ffi.Finalizable {
+  /// Allocates the buffers from [memory].
+  WorkerBuffers(AccountingAllocator memory)
+    : _allocator = memory.site('workerBuffers') {
+    srcAddress = _allocator<BACNET_ADDRESS>();
+    pdu = _allocator<ffi.Uint8>(maxAPDU);
+    covEvent = _allocator<BacnetPluginCovEvent>();
+    writeValue = _allocator<BACNET_APPLICATION_DATA_VALUE>();
+    _finalizer
+      ..attach(
+        this,
+        srcAddress.cast(),
+        detach: this,
+        externalSize: ffi.sizeOf<BACNET_ADDRESS>(),
+      )
+      ..attach(this, pdu.cast(), detach: this, externalSize: maxAPDU)
+      ..attach(
+        this,
+        covEvent.cast(),
+        detach: this,
+        externalSize: ffi.sizeOf<BacnetPluginCovEvent>(),
+      )
+      ..attach(
+        this,
+        writeValue.cast(),
+        detach: this,
+        externalSize: ffi.sizeOf<BACNET_APPLICATION_DATA_VALUE>(),
+      );
+  }
+
+  // The accounting allocator is backed by calloc, so calloc's free matches.
+  static final _finalizer = ffi.NativeFinalizer(calloc.nativeFree);
+
+  final ffi.Allocator _allocator;
+
+  /// Source address filled in by `bip_receive`.
+  late final ffi.Pointer<BACNET_ADDRESS> srcAddress;
+
+  /// PDU buffer of [maxAPDU] bytes filled in by `bip_receive`.
+  late final ffi.Pointer<ffi.Uint8> pdu;
+
+  /// Slot [HotPathBindings.covEventPop] copies queued COV events into.
+  late final ffi.Pointer<BacnetPluginCovEvent> covEvent;
+
+  /// Value of a WriteProperty request, filled in per request.
+  late final ffi.Pointer<BACNET_APPLICATION_DATA_VALUE> writeValue;
+
+  /// Frees all buffers. Must not be used afterwards.
+  void dispose() {
+    _finalizer.detach(this);
+    _allocator
+      ..free(srcAddress)
+      ..free(pdu)
+      ..free(covEvent)
+      ..free(writeValue);
+  }
+}
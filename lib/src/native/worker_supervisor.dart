@@ -0,0 +1,216 @@
+import '../models/bacnet_metrics.dart';
+import '../models/internal/worker_message.dart';
+import '../models/packet_filter.dart';
+
+/// Remembers the worker state that must be rebuilt after a worker restart,
+/// and decides when to restart.
+///
+/// The worker isolate owns the BACnet stack, so everything the main isolate
+/// configured through it — address bindings, foreign device registration,
+/// the packet filter, COV subscriptions, the write journal and the
+/// real-time profile — is recorded here as the requests that created it.
+/// After a crash, [replayPlan] returns those requests again, deduplicated
+/// so that only the latest state is replayed.
+class WorkerSupervisor {
+  /// Creates a supervisor.
+  ///
+  /// At most [maxRestarts] restarts are attempted within [restartWindow];
+  /// a worker that keeps crashing after that is left stopped.
+  WorkerSupervisor({
+    this.maxRestarts = 5,
+    this.restartWindow = const Duration(minutes: 1),
+    DateTime Function()? clock,
+  }) : _clock = clock ?? DateTime.now;
+
+  /// Restart backoff, indexed by the number of recent restarts.
+  static const List<Duration> backoff = [
+    Duration.zero,
+    Duration(milliseconds: 250),
+    Duration(seconds: 1),
+    Duration(seconds: 5),
+  ];
+
+  /// Maximum restarts within [restartWindow].
+  final int maxRestarts;
+
+  /// Window over which restarts are counted.
+  final Duration restartWindow;
+
+  final DateTime Function() _clock;
+  final List<DateTime> _recentCrashes = [];
+
+  RegisterFdrRequest? _fdr;
+  SetPacketFilterRequest? _filter;
+  OpenWriteJournalRequest? _journal;
+  SetRealtimeProfileRequest? _realtime;
+  final Map<int, WorkerRequest> _bindings = {};
+  // Subscriptions with their expiry, or null for indefinite ones.
+  final Map<(int, int, int, int), (SubscribeCOVRequest, DateTime?)>
+  _subscriptions = {};
+
+  int _restarts = 0;
+  int _reissued = 0;
+  int _failed = 0;
+  int _replayed = 0;
+  Duration _lastRecovery = Duration.zero;
+  Duration _maxRecovery = Duration.zero;
+  String? _lastCause;
+  bool _gaveUp = false;
+
+  /// Whether [request] can be sent again without side effects on the
+  /// device, so an in-flight copy may be reissued after a restart.
+  static bool isReissuable(WorkerRequest request) => switch (request) {
+    ReadPropertyRequest() ||
+    ReadPropertyMultipleRequest() ||
+    ReadRangeRequest() ||
+    ReadPriorityArraysRequest() => true,
+    _ => false,
+  };
+
+  /// Current counters.
+  SupervisorStats get stats => SupervisorStats(
+    restarts: _restarts,
+    reissuedRequests: _reissued,
+    failedRequests: _failed,
+    replayedRequests: _replayed,
+    lastRecovery: _lastRecovery,
+    maxRecovery: _maxRecovery,
+    lastCause: _lastCause,
+    gaveUp: _gaveUp,
+  );
+
+  /// Records a request that changes state the worker must keep.
+  ///
+  /// Other requests are ignored. [SubscribeCOVRequest]s should only be
+  /// recorded once the device has acknowledged them; a cancellation drops
+  /// the subscription, as does the end of its lifetime.
+  void record(WorkerRequest request) {
+    switch (request) {
+      case RegisterFdrRequest():
+        _fdr = request;
+      case SetPacketFilterRequest(:final filter):
+        _filter = filter == BacnetPacketFilter.allowAll ? null : request;
+      case OpenWriteJournalRequest(:final config):
+        _journal = OpenWriteJournalRequest(config);
+      case CloseWriteJournalRequest():
+        _journal = null;
+      case SetRealtimeProfileRequest(:final profile):
+        _realtime = profile == null ? null : request;
+      case AddDeviceBindingRequest(:final deviceId):
+        _bindings[deviceId] = request;
+      case SubscribeCOVRequest(
+        :final deviceId,
+        :final objectType,
+        :final instance,
+        :final propertyId,
+        :final lifetime,
+      ):
+        final key = (deviceId, objectType, instance, propertyId);
+        if (request.cancel) {
+          _subscriptions.remove(key);
+          break;
+        }
+        _subscriptions[key] = (
+          SubscribeCOVRequest(
+            deviceId: deviceId,
+            objectType: objectType,
+            instance: instance,
+            propertyId: propertyId,
+            confirmed: request.confirmed,
+            lifetime: lifetime,
+            covIncrement: request.covIncrement,
+          ),
+          lifetime == 0 ? null : _clock().add(Duration(seconds: lifetime)),
+        );
+      default:
+        break;
+    }
+  }
+
+  /// Records the address a device announced in an I-Am.
+  ///
+  /// Local B/IP devices are rebound directly. Devices behind a router are
+  /// found again with a directed Who-Is, since the I-Am does not carry the
+  /// remote address.
+  void recordIAm(IAmResponse iAm) {
+    if (iAm.deviceId < 0) return;
+    final mac = iAm.mac;
+    if (iAm.net == 0 && mac.length == 6) {
+      _bindings[iAm.deviceId] = AddDeviceBindingRequest(
+        deviceId: iAm.deviceId,
+        ip: '${mac[0]}.${mac[1]}.${mac[2]}.${mac[3]}',
+        port: (mac[4] << 8) | mac[5],
+      );
+    } else {
+      _bindings[iAm.deviceId] = WhoIsRequest(
+        lowLimit: iAm.deviceId,
+        highLimit: iAm.deviceId,
+      );
+    }
+  }
+
+  /// Requests that rebuild the recorded state on a fresh worker, in order.
+  ///
+  /// Subscriptions are renewed for the rest of their lifetime only;
+  /// expired ones are dropped.
+  List<WorkerRequest> replayPlan() {
+    final now = _clock();
+    _subscriptions.removeWhere((_, entry) {
+      final expires = entry.$2;
+      return expires != null && !expires.isAfter(now);
+    });
+    return [
+      ?_realtime,
+      ?_journal,
+      ?_fdr,
+      ?_filter,
+      ..._bindings.values,
+      for (final (request, expires) in _subscriptions.values)
+        if (expires == null)
+          request
+        else
+          SubscribeCOVRequest(
+            deviceId: request.deviceId,
+            objectType: request.objectType,
+            instance: request.instance,
+            propertyId: request.propertyId,
+            confirmed: request.confirmed,
+            // Round up so the renewal never ends early.
+            lifetime:
+                (expires.difference(now).inMilliseconds + 999) ~/ 1000,
+            covIncrement: request.covIncrement,
+          ),
+    ];
+  }
+
+  /// Records a worker death and returns how long to wait before
+  /// restarting, or null if the restart budget is used up.
+  Duration? onCrash(String cause) {
+    final now = _clock();
+    _lastCause = cause;
+    _recentCrashes
+      ..removeWhere((crash) => now.difference(crash) > restartWindow)
+      ..add(now);
+    _gaveUp = _recentCrashes.length > maxRestarts;
+    if (_gaveUp) return null;
+    final index = _recentCrashes.length - 1;
+    return backoff[index < backoff.length ? index : backoff.length - 1];
+  }
+
+  /// Records in-flight requests that could not be reissued.
+  void recordFailed(int count) => _failed += count;
+
+  /// Records a completed recovery that took [elapsed] from detection to
+  /// the last replayed request.
+  void recordRecovery(
+    Duration elapsed, {
+    required int replayed,
+    required int reissued,
+  }) {
+    _restarts++;
+    _replayed += replayed;
+    _reissued += reissued;
+    _lastRecovery = elapsed;
+    if (elapsed > _maxRecovery) _maxRecovery = elapsed;
+  }
+}
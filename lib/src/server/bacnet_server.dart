@@ -1,5 +1,11 @@
+import '../constants/object_types.dart';
+import '../core/bacnet_config.dart';
+import '../core/exceptions.dart';
 import '../core/logger.dart';
+import '../models/bacnet_metrics.dart';
 import '../models/internal/worker_message.dart';
+import '../models/server_image.dart';
+import '../models/write_journal.dart';
 import '../native/bacnet_system.dart';
 
 export '../core/logger.dart';
@@ -67,8 +73,14 @@ class BacnetServer {
   /// [interface] is the local network interface IP to bind to. If null,
   /// binds to all interfaces.
   /// [port] is the UDP port for BACnet/IP (default: 47808).
-  Future<void> start({String? interface, int port = 47808}) async {
-    await _system.start(interface: interface, port: port);
+  /// [mstp] runs the device as an MS/TP master node on a serial port
+  /// instead; see [MstpConfig].
+  Future<void> start({
+    String? interface,
+    int port = 47808,
+    MstpConfig? mstp,
+  }) async {
+    await _system.start(interface: interface, port: port, mstp: mstp);
   }
 
   /// Initializes this server as a BACnet device.
@@ -108,11 +120,164 @@ class BacnetServer {
     await _system.send(AddObjectRequest(objectType, instance));
   }
 
+  /// Sets the COV_Increment of an analog input or analog value object.
+  ///
+  /// Clients subscribed to the object are only notified once its present
+  /// value has moved by at least [increment] since the last notification.
+  /// Other object types notify on every change of state.
+  ///
+  /// Example:
+  /// ```dart
+  /// await server.addObject(BacnetObjectType.analogInput, 1);
+  /// await server.setCovIncrement(BacnetObjectType.analogInput, 1, 0.5);
+  /// ```
+  Future<void> setCovIncrement(
+    int objectType,
+    int instance,
+    double increment,
+  ) async {
+    if (objectType != BacnetObjectType.analogInput &&
+        objectType != BacnetObjectType.analogValue) {
+      throw ArgumentError.value(
+        objectType,
+        'objectType',
+        'Only analog inputs and analog values have a COV increment',
+      );
+    }
+    if (increment < 0) {
+      throw ArgumentError.value(increment, 'increment', 'Must not be negative');
+    }
+    await _system.send(SetCovIncrementRequest(objectType, instance, increment));
+  }
+
+  /// Sets how this server paces its answers to Who-Is.
+  ///
+  /// Each matching Who-Is is answered with a broadcast I-Am after a random
+  /// delay of up to [maxDelay], so that many devices answering the same
+  /// global Who-Is do not reply in the same instant. At most [maxPerSecond]
+  /// I-Am responses are sent per second; Who-Is requests beyond that are
+  /// dropped, and one arriving while an I-Am is pending is answered by it.
+  /// The defaults are 500 ms and 5 per second. The effective spread and drop
+  /// counts are reported in [BacnetMetrics.iAmPacing].
+  ///
+  /// Example:
+  /// ```dart
+  /// await server.setIAmPacing(
+  ///   maxDelay: const Duration(seconds: 2),
+  ///   maxPerSecond: 2,
+  /// );
+  /// ```
+  Future<void> setIAmPacing({
+    Duration maxDelay = const Duration(milliseconds: 500),
+    int maxPerSecond = 5,
+  }) async {
+    if (maxDelay.isNegative) {
+      throw ArgumentError.value(maxDelay, 'maxDelay', 'Must not be negative');
+    }
+    if (maxPerSecond < 1) {
+      throw ArgumentError.value(maxPerSecond, 'maxPerSecond', 'Must be >= 1');
+    }
+    await _system.send(
+      SetIAmPacingRequest(maxDelay: maxDelay, maxPerSecond: maxPerSecond),
+    );
+  }
+
+  /// Saves the hosted object database to a binary image at [path].
+  ///
+  /// The image holds the device identity, every object with its name,
+  /// description, units, COV increment, out-of-service state and present
+  /// value (or, for commandable objects, each occupied priority array
+  /// slot), and the COV subscriptions clients currently hold. The file is
+  /// replaced atomically.
+  ///
+  /// Example:
+  /// ```dart
+  /// final info = await server.saveImage('/var/lib/gateway/server.img');
+  /// print('Saved ${info.objects} objects in ${info.bytes} bytes');
+  /// ```
+  Future<BacnetServerImageInfo> saveImage(String path) =>
+      _system.saveServerImage(path);
+
+  /// Initializes this server from an image written by [saveImage].
+  ///
+  /// Use instead of [init] and [addObject] after [start]. The image is
+  /// memory-mapped and loaded in a single pass, so the device answers
+  /// requests as soon as this returns. Restored values do not appear on
+  /// [writeEvents]. Subscriptions come back silently, with the lifetime
+  /// they had left when the image was saved, and their subscribers are
+  /// notified of changes until they renew or the lifetime runs out.
+  ///
+  /// Throws [BacnetRequestNotSentException] if the file is missing or is
+  /// not a valid image.
+  ///
+  /// Example:
+  /// ```dart
+  /// await server.start();
+  /// try {
+  ///   await server.loadImage(imagePath);
+  /// } on BacnetRequestNotSentException {
+  ///   await server.init(4194304, 'Gateway');
+  ///   // ...add objects
+  /// }
+  /// ```
+  Future<BacnetServerImageInfo> loadImage(String path) =>
+      _system.loadServerImage(path);
+
+  /// Starts recording every write to a durable, append-only journal.
+  ///
+  /// Each WriteProperty and WritePropertyMultiple this server accepts is
+  /// journaled natively on the stack thread, before it reaches
+  /// [writeEvents], and so is each WriteProperty and WritePropertyMultiple
+  /// a [BacnetClient] in this process sends. Records are batched and
+  /// synced together on a separate thread at most
+  /// [WriteJournalConfig.commitInterval] after they arrive, so neither the
+  /// network nor the main isolate waits on the disk. Read files back with
+  /// [WriteJournalReader]. Counters are reported in [BacnetMetrics.journal].
+  ///
+  /// The journal stays open across worker restarts until
+  /// [closeWriteJournal]. Opening it again switches to the new settings.
+  ///
+  /// Throws [BacnetRequestNotSentException] if the file cannot be opened.
+  ///
+  /// Example:
+  /// ```dart
+  /// await server.openWriteJournal(
+  ///   const WriteJournalConfig(path: '/var/lib/gateway/writes.journal'),
+  /// );
+  /// ```
+  Future<WriteJournalStats> openWriteJournal(WriteJournalConfig config) =>
+      _system.openWriteJournal(config);
+
+  /// Waits until every write journaled so far is on disk.
+  ///
+  /// Writes become durable within one commit interval anyway; use this
+  /// before acting on a write that must not be lost, such as an export.
+  /// Throws [BacnetRequestNotSentException] if the journal is closed, did
+  /// not sync within [timeout], or lost writes to a disk error since it was
+  /// opened (see [WriteJournalStats.lostRecords]).
+  Future<WriteJournalStats> flushWriteJournal({
+    Duration timeout = const Duration(seconds: 5),
+  }) => _system.flushWriteJournal(timeout);
+
+  /// Commits outstanding writes and closes the journal.
+  Future<WriteJournalStats> closeWriteJournal() => _system.closeWriteJournal();
+
   /// Disposes of the server and releases resources.
   ///
-  /// Stops the worker isolate and closes event streams.
-  /// The server cannot be used after calling dispose.
+  /// Closes event streams. The worker isolate is kept warm so a later
+  /// [start] reuses the loaded library, the bound socket and the hosted
+  /// objects; call [shutdown] to stop it entirely.
   void dispose() {
     _system.dispose();
   }
+
+  /// Disposes of the server and stops the worker isolate.
+  ///
+  /// The worker is shared with any `BacnetClient` in the process, which
+  /// stops working as well. Hosted objects are lost; save them first with
+  /// [saveImage] if they should survive, and close the write journal with
+  /// [closeWriteJournal] so no journaled write is left uncommitted.
+  void shutdown() {
+    _system.shutdown();
+  }
 }
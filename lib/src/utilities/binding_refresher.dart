@@ -0,0 +1,154 @@
+import 'dart:async';
+
+import 'package:flutter/foundation.dart';
+
+import '../client/bacnet_client.dart';
+
+/// Outcome of one [BindingRefresher.refresh] run.
+@immutable
+class BindingRefreshReport {
+  /// Creates a refresh report.
+  const BindingRefreshReport({
+    required this.responded,
+    required this.missed,
+    required this.unbound,
+    required this.unreachable,
+    required this.elapsed,
+  });
+
+  /// Devices that answered with an I-Am.
+  final Set<int> responded;
+
+  /// Devices that were asked but did not answer this time.
+  final Set<int> missed;
+
+  /// Devices skipped because no address is cached for them.
+  final Set<int> unbound;
+
+  /// Devices currently marked unreachable, including earlier runs.
+  final Set<int> unreachable;
+
+  /// Time from the first batch to the end of the response window.
+  final Duration elapsed;
+
+  @override
+  String toString() =>
+      'BindingRefreshReport(responded: ${responded.length}, '
+      'missed: ${missed.length}, unbound: ${unbound.length}, '
+      'unreachable: ${unreachable.length}, '
+      'elapsed: ${elapsed.inMilliseconds}ms)';
+}
+
+/// Keeps the address bindings of known devices fresh without a global
+/// Who-Is.
+///
+/// Each device is sent a Who-Is with low = high = its device ID, unicast to
+/// the address cached for it, so only that device answers and the rest of
+/// the site never sees the request. Devices are asked [batchSize] at a time,
+/// [batchInterval] apart; a device that misses [missesBeforeUnreachable]
+/// refreshes in a row is marked unreachable until it answers again.
+///
+/// Example:
+/// ```dart
+/// final refresher = BindingRefresher(client);
+/// Timer.periodic(const Duration(minutes: 5), (_) async {
+///   final report = await refresher.refresh(knownDeviceIds);
+///   for (final id in report.unreachable) markOffline(id);
+/// });
+/// ```
+class BindingRefresher {
+  /// Creates a binding refresher.
+  BindingRefresher(
+    this.client, {
+    this.batchSize = 50,
+    this.batchInterval = const Duration(milliseconds: 100),
+    this.responseTimeout = const Duration(seconds: 3),
+    this.missesBeforeUnreachable = 2,
+  }) : assert(batchSize > 0, 'batchSize must be positive'),
+       assert(
+         missesBeforeUnreachable > 0,
+         'missesBeforeUnreachable must be positive',
+       );
+
+  /// Client the Who-Is requests are sent through.
+  final BacnetClient client;
+
+  /// Devices asked per batch.
+  final int batchSize;
+
+  /// Pause between batches.
+  final Duration batchInterval;
+
+  /// How long to wait for I-Am responses after the last batch.
+  final Duration responseTimeout;
+
+  /// Consecutive missed refreshes before a device is marked unreachable.
+  final int missesBeforeUnreachable;
+
+  final Map<int, int> _misses = {};
+
+  /// Devices currently marked unreachable.
+  Set<int> get unreachable => {
+    for (final entry in _misses.entries)
+      if (entry.value >= missesBeforeUnreachable) entry.key,
+  };
+
+  /// Sends a directed Who-Is to each of [deviceIds] and waits for the
+  /// answers.
+  ///
+  /// Completes as soon as every asked device has answered, or
+  /// [responseTimeout] after the last batch was sent.
+  Future<BindingRefreshReport> refresh(Iterable<int> deviceIds) async {
+    final ids = deviceIds.toSet().toList();
+    final asked = <int>{};
+    final responded = <int>{};
+    final unbound = <int>{};
+    final clock = Stopwatch()..start();
+    var allAnswered = Completer<void>();
+
+    final subscription = client.events.listen((event) {
+      if (event is IAmResponse &&
+          asked.contains(event.deviceId) &&
+          responded.add(event.deviceId) &&
+          responded.length == asked.length &&
+          !allAnswered.isCompleted) {
+        allAnswered.complete();
+      }
+    });
+    try {
+      for (var i = 0; i < ids.length; i += batchSize) {
+        if (i > 0) await Future<void>.delayed(batchInterval);
+        final batch = ids.sublist(
+          i,
+          i + batchSize > ids.length ? ids.length : i + batchSize,
+        );
+        asked.addAll(batch);
+        final skipped = await client.sendDirectedWhoIs(batch);
+        unbound.addAll(skipped);
+        asked.removeAll(skipped);
+      }
+      if (asked.isNotEmpty && responded.length < asked.length) {
+        if (allAnswered.isCompleted) allAnswered = Completer<void>();
+        await allAnswered.future.timeout(responseTimeout, onTimeout: () {});
+      }
+    } finally {
+      await subscription.cancel();
+    }
+    clock.stop();
+
+    final missed = asked.difference(responded);
+    for (final id in responded) {
+      _misses.remove(id);
+    }
+    for (final id in missed) {
+      _misses[id] = (_misses[id] ?? 0) + 1;
+    }
+    return BindingRefreshReport(
+      responded: responded,
+      missed: missed,
+      unbound: unbound,
+      unreachable: unreachable,
+      elapsed: clock.elapsed,
+    );
+  }
+}
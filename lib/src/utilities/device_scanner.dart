@@ -341,7 +341,11 @@ class DeviceScanner {
       }).toList();
 
       try {
-        final batchResults = await client.readMultiple(deviceId, specs);
+        final batchResults = await client.readMultiple(
+          deviceId,
+          specs,
+          priority: BacnetRequestPriority.background,
+        );
 
         // Map string keys back to BacnetObjects
         // Key format from client is likely "${type}:${instance}"
@@ -408,4 +412,92 @@ class DeviceScanner {
       supportedServices: const [],
     );
   }
+
+  /// Reads the number of entries in a device's `object_list`.
+  Future<int> readObjectCount(int deviceId) async {
+    final count = await client.readProperty(
+      deviceId,
+      BacnetObjectType.device,
+      deviceId,
+      BacnetPropertyId.objectList,
+      arrayIndex: 0,
+      priority: BacnetRequestPriority.background,
+    );
+    if (count is! int) {
+      throw BacnetException('Device $deviceId returned no object count');
+    }
+    return count;
+  }
+
+  /// Reads entry [index] (1-based) of a device's `object_list`.
+  ///
+  /// Large devices cannot return the whole list in one APDU without
+  /// segmentation, so callers page through it; prefer
+  /// [readObjectListRange], which reads a whole page per request.
+  Future<BacnetObject> readObjectListEntry(int deviceId, int index) async {
+    final value = await client.readProperty(
+      deviceId,
+      BacnetObjectType.device,
+      deviceId,
+      BacnetPropertyId.objectList,
+      arrayIndex: index,
+      priority: BacnetRequestPriority.background,
+    );
+    return _toObject(deviceId, value, index);
+  }
+
+  /// Reads entries [first] to [last] (1-based, inclusive) of a device's
+  /// `object_list` in one ReadPropertyMultiple, by array index.
+  ///
+  /// Devices that reject ReadPropertyMultiple are read entry by entry
+  /// instead, through [readObjectListEntry].
+  Future<List<BacnetObject>> readObjectListRange(
+    int deviceId,
+    int first,
+    int last,
+  ) async {
+    if (last < first) return const [];
+    final Map<String, Map<int, dynamic>> results;
+    try {
+      results = await client.readMultiple(deviceId, [
+        BacnetReadAccessSpecification(
+          objectIdentifier: BacnetObject(
+            type: BacnetObjectType.device,
+            instance: deviceId,
+          ),
+          properties: [
+            for (var i = first; i <= last; i++)
+              BacnetPropertyReference(
+                propertyIdentifier: BacnetPropertyId.objectList,
+                propertyArrayIndex: i,
+              ),
+          ],
+        ),
+      ], priority: BacnetRequestPriority.background);
+    } on BacnetRejectException {
+      return Future.wait([
+        for (var i = first; i <= last; i++) readObjectListEntry(deviceId, i),
+      ]);
+    }
+
+    // Several indexes decode to an index map, a single one to its value.
+    final properties = results['${BacnetObjectType.device}:$deviceId'];
+    final raw = properties?[BacnetPropertyId.objectList];
+    final entries = raw is Map<int, dynamic> ? raw : <int, dynamic>{first: raw};
+    return [
+      for (var i = first; i <= last; i++) _toObject(deviceId, entries[i], i),
+    ];
+  }
+
+  static BacnetObject _toObject(int deviceId, Object? value, int index) {
+    if (value is Map && value['type'] is int && value['instance'] is int) {
+      return BacnetObject(
+        type: value['type'] as int,
+        instance: value['instance'] as int,
+      );
+    }
+    throw BacnetException(
+      'Device $deviceId object_list[$index] is not an object identifier',
+    );
+  }
 }
@@ -0,0 +1,628 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+
+import '../client/bacnet_client.dart';
+import '../constants/property_ids.dart';
+import 'device_scanner.dart';
+import 'request_budget.dart';
+
+/// Stage a device has reached in an [InventoryJob].
+enum InventoryStatus {
+  /// Not started yet.
+  pending,
+
+  /// Reading the object list.
+  listing,
+
+  /// Reading object properties.
+  reading,
+
+  /// Inventory complete.
+  done,
+
+  /// Gave up after an error; retried on the next run.
+  failed,
+}
+
+/// Inventory progress and results for one device.
+///
+/// Part of an [InventoryCheckpoint]; updated in place as the job runs.
+class DeviceInventory {
+  /// Creates an empty inventory record for [deviceId].
+  DeviceInventory(this.deviceId, {this.address});
+
+  /// Restores a record saved by [toJson].
+  factory DeviceInventory.fromJson(Map<String, dynamic> json) =>
+      DeviceInventory(json['deviceId'] as int).._merge(json);
+
+  /// Device instance number.
+  final int deviceId;
+
+  /// `ip:port` the device answered from, used to rebind on resume.
+  String? address;
+
+  /// Current stage.
+  InventoryStatus status = InventoryStatus.pending;
+
+  /// Length of the device's `object_list`, once read.
+  int? objectCount;
+
+  /// Objects read from `object_list` so far, in list order.
+  final List<BacnetObject> objects = [];
+
+  /// Property values keyed by `type:instance`, for objects read so far.
+  final Map<String, Map<int, Object?>> properties = {};
+
+  /// Last error, when [status] is [InventoryStatus.failed].
+  String? error;
+
+  /// Number of objects whose properties have been read.
+  int get objectsRead => properties.length;
+
+  /// Converts this record to JSON.
+  Map<String, dynamic> toJson() =>
+      _pageJson(objects: objects, keys: properties.keys);
+
+  /// Converts the current stage plus one page of results to JSON: the
+  /// [objects] just listed, or the properties of the objects in [keys].
+  Map<String, dynamic> _pageJson({
+    List<BacnetObject> objects = const [],
+    Iterable<String> keys = const [],
+  }) => {
+    'deviceId': deviceId,
+    'address': address,
+    'status': status.name,
+    'objectCount': objectCount,
+    'error': error,
+    'objects': [for (final o in objects) '${o.type}:${o.instance}'],
+    'properties': {
+      for (final key in keys)
+        key: {
+          for (final p in properties[key]!.entries) '${p.key}': p.value,
+        },
+    },
+  };
+
+  /// Applies a record or page saved by [_pageJson]: the stage is replaced,
+  /// objects are appended and properties added.
+  void _merge(Map<String, dynamic> json) {
+    address = json['address'] as String?;
+    status = InventoryStatus.values.byName(json['status'] as String);
+    objectCount = json['objectCount'] as int?;
+    error = json['error'] as String?;
+    objects.addAll(
+      (json['objects'] as List).map((k) => BacnetObject.fromKey(k as String)),
+    );
+    final pageProperties = json['properties'] as Map<String, dynamic>;
+    for (final entry in pageProperties.entries) {
+      properties[entry.key] = {
+        for (final p in (entry.value as Map<String, dynamic>).entries)
+          int.parse(p.key): p.value,
+      };
+    }
+  }
+}
+
+/// Persistent state of an [InventoryJob].
+///
+/// On disk, the first line of the checkpoint file is this snapshot as
+/// [toJson]; each following line is one device page appended since.
+class InventoryCheckpoint {
+  /// Creates an empty checkpoint.
+  InventoryCheckpoint();
+
+  /// Restores a checkpoint saved by [toJson].
+  factory InventoryCheckpoint.fromJson(Map<String, dynamic> json) {
+    final checkpoint = InventoryCheckpoint()
+      ..discovered = json['discovered'] as bool;
+    for (final d in json['devices'] as List) {
+      final record = DeviceInventory.fromJson(d as Map<String, dynamic>);
+      checkpoint.devices[record.deviceId] = record;
+    }
+    return checkpoint;
+  }
+
+  /// Whether the device list is final (discovery ran or IDs were given).
+  bool discovered = false;
+
+  /// Per-device records keyed by device instance.
+  final Map<int, DeviceInventory> devices = {};
+
+  /// Converts this checkpoint to JSON.
+  Map<String, dynamic> toJson() => {
+    'version': 1,
+    'discovered': discovered,
+    'devices': [for (final d in devices.values) d.toJson()],
+  };
+}
+
+/// Progress report emitted by [InventoryJob.progress].
+class InventoryProgress {
+  /// Creates a progress report.
+  const InventoryProgress({
+    required this.devicesTotal,
+    required this.devicesDone,
+    required this.devicesFailed,
+    required this.objectsKnown,
+    required this.objectsRead,
+    required this.objectsEstimated,
+    required this.requests,
+    required this.elapsed,
+    this.eta,
+    this.checkpointError,
+  });
+
+  /// Devices in the inventory.
+  final int devicesTotal;
+
+  /// Devices completely inventoried.
+  final int devicesDone;
+
+  /// Devices that failed in this run.
+  final int devicesFailed;
+
+  /// Objects listed so far across all devices.
+  final int objectsKnown;
+
+  /// Objects whose properties have been read, including earlier runs.
+  final int objectsRead;
+
+  /// Estimated total objects, extrapolating devices not yet listed.
+  final int objectsEstimated;
+
+  /// Requests completed in this run.
+  final int requests;
+
+  /// Time spent in this run.
+  final Duration elapsed;
+
+  /// Estimated time to finish at this run's rate, or null before any
+  /// object has been read.
+  final Duration? eta;
+
+  /// Why the last checkpoint write failed, or null if it succeeded.
+  ///
+  /// The job keeps running on a failed write and retries on the next page;
+  /// progress since the last successful write is lost if it stops first.
+  final Object? checkpointError;
+
+  /// Requests per second in this run.
+  double get requestsPerSecond => elapsed.inMicroseconds == 0
+      ? 0
+      : requests * Duration.microsecondsPerSecond / elapsed.inMicroseconds;
+
+  /// Fraction of the estimated objects read, from 0 to 1.
+  double get fraction => objectsEstimated == 0
+      ? 0
+      : (objectsRead / objectsEstimated).clamp(0.0, 1.0);
+
+  @override
+  String toString() =>
+      'InventoryProgress(devices: $devicesDone/$devicesTotal, '
+      'objects: $objectsRead/$objectsEstimated, '
+      '${requestsPerSecond.toStringAsFixed(1)} req/s, eta: $eta'
+      '${checkpointError == null ? '' : ', checkpoint: $checkpointError'})';
+}
+
+/// Resumable inventory of a whole site.
+///
+/// Discovers devices (unless [deviceIds] is given), pages through each
+/// device's `object_list` and reads [propertyIds] of every object. Each
+/// page is appended to the checkpoint at [checkpointPath] as it completes,
+/// so a job that is cancelled or crashes resumes where it stopped the next
+/// time [run] is called with the same path. Appending keeps the cost of a
+/// page independent of the site's size; the file is compacted back to one
+/// snapshot when a run starts and ends. Up to [maxConcurrentDevices]
+/// devices are inventoried at once, with every request going through
+/// [budget].
+///
+/// Example:
+/// ```dart
+/// final job = InventoryJob(
+///   scanner: DeviceScanner(client),
+///   checkpointPath: '${dir.path}/site.inventory.json',
+/// );
+/// job.progress.listen((p) => print(p));
+/// final result = await job.run();
+/// ```
+class InventoryJob {
+  /// Creates an inventory job.
+  InventoryJob({
+    required this.scanner,
+    required this.checkpointPath,
+    this.deviceIds,
+    this.discoveryTimeout = const Duration(seconds: 10),
+    this.propertyIds = defaultPropertyIds,
+    this.pageSize = 20,
+    this.maxConcurrentDevices = 4,
+    RequestBudget? budget,
+  }) : budget = budget ?? RequestBudget(8);
+
+  /// Properties read for every object unless [propertyIds] is given.
+  static const List<int> defaultPropertyIds = [
+    BacnetPropertyId.objectName,
+    BacnetPropertyId.description,
+    BacnetPropertyId.presentValue,
+    BacnetPropertyId.units,
+  ];
+
+  /// Scanner used for discovery and object-list reads.
+  final DeviceScanner scanner;
+
+  /// File the checkpoint is stored in.
+  final String checkpointPath;
+
+  /// Devices to inventory; null to discover them with Who-Is.
+  final List<int>? deviceIds;
+
+  /// How long to collect I-Am responses during discovery.
+  final Duration discoveryTimeout;
+
+  /// Properties read for each object.
+  final List<int> propertyIds;
+
+  /// Object-list entries, and objects' properties, read per RPM.
+  final int pageSize;
+
+  /// Devices inventoried concurrently.
+  final int maxConcurrentDevices;
+
+  /// Shared limit on outstanding requests.
+  final RequestBudget budget;
+
+  final StreamController<InventoryProgress> _progress =
+      StreamController.broadcast();
+  final Stopwatch _clock = Stopwatch();
+  InventoryCheckpoint _checkpoint = InventoryCheckpoint();
+  int _requests = 0;
+  int _failed = 0;
+  int _readAtStart = 0;
+  bool _cancelled = false;
+  Future<void>? _saving;
+  final List<String> _unsaved = [];
+  bool _snapshotDue = false;
+  Object? _saveError;
+
+  BacnetClient get _client => scanner.client;
+
+  /// Progress reports, one per completed page.
+  Stream<InventoryProgress> get progress => _progress.stream;
+
+  /// The current state, including results gathered so far.
+  InventoryCheckpoint get checkpoint => _checkpoint;
+
+  /// Stops the job after the pages in flight; [run] then completes with the
+  /// checkpoint saved so far.
+  void cancel() => _cancelled = true;
+
+  /// Runs or resumes the inventory and returns the final state.
+  ///
+  /// Devices that fail are marked [InventoryStatus.failed] and retried on
+  /// the next run; the others are unaffected. Throws if the final
+  /// checkpoint cannot be written; [checkpoint] still holds the results.
+  Future<InventoryCheckpoint> run() async {
+    _cancelled = false;
+    _requests = 0;
+    _failed = 0;
+    _saveError = null;
+    _clock
+      ..reset()
+      ..start();
+
+    _checkpoint = await _load() ?? InventoryCheckpoint();
+    _readAtStart = _checkpoint.devices.values.fold(
+      0,
+      (sum, d) => sum + d.objectsRead,
+    );
+    if (!_checkpoint.discovered) {
+      await _discover();
+      _checkpoint.discovered = true;
+    }
+    // Compact the pages appended by the last run.
+    _snapshotDue = true;
+    _saveInBackground();
+
+    final queue = _checkpoint.devices.values
+        .where((d) => d.status != InventoryStatus.done)
+        .toList();
+    Future<void> worker() async {
+      while (queue.isNotEmpty && !_cancelled) {
+        await _inventoryDevice(queue.removeAt(0));
+      }
+    }
+
+    await Future.wait([
+      for (var i = 0; i < maxConcurrentDevices; i++) worker(),
+    ]);
+    // A page's save may still be failing; write once more after it.
+    await _saving?.then<void>((_) {}, onError: (Object _) {});
+    _snapshotDue = true;
+    await _save();
+    _clock.stop();
+    _report();
+    return _checkpoint;
+  }
+
+  /// Releases the progress stream.
+  Future<void> dispose() => _progress.close();
+
+  Future<void> _discover() async {
+    final ids = deviceIds;
+    if (ids != null) {
+      for (final id in ids) {
+        _checkpoint.devices.putIfAbsent(id, () => DeviceInventory(id));
+      }
+      return;
+    }
+    final subscription = _client.events.listen((event) {
+      if (event is IAmResponse && event.deviceId >= 0) {
+        final mac = event.mac;
+        final address = mac.length == 6
+            ? '${mac[0]}.${mac[1]}.${mac[2]}.${mac[3]}:'
+                  '${(mac[4] << 8) | mac[5]}'
+            : null;
+        final id = event.deviceId;
+        final record = _checkpoint.devices.putIfAbsent(
+          id,
+          () => DeviceInventory(id),
+        );
+        record.address ??= address;
+      }
+    });
+    try {
+      await _client.sendWhoIs();
+      await Future<void>.delayed(discoveryTimeout);
+    } finally {
+      await subscription.cancel();
+    }
+  }
+
+  Future<void> _inventoryDevice(DeviceInventory device) async {
+    try {
+      final address = device.address;
+      if (address != null) {
+        // Bindings do not survive a restart; restore the one we saw.
+        final colon = address.lastIndexOf(':');
+        await _client.addDeviceBinding(
+          device.deviceId,
+          address.substring(0, colon),
+          port: int.parse(address.substring(colon + 1)),
+        );
+      }
+
+      device
+        ..status = InventoryStatus.listing
+        ..error = null;
+      device.objectCount ??= await _request(
+        () => scanner.readObjectCount(device.deviceId),
+      );
+      final count = device.objectCount!;
+      while (device.objects.length < count && !_cancelled) {
+        final start = device.objects.length + 1;
+        final end = (start + pageSize - 1).clamp(start, count);
+        final page = await _request(
+          () => scanner.readObjectListRange(device.deviceId, start, end),
+        );
+        device.objects.addAll(page);
+        _pageDone(device, objects: page);
+      }
+
+      device.status = InventoryStatus.reading;
+      while (device.objectsRead < device.objects.length && !_cancelled) {
+        final start = device.objectsRead;
+        final end = (start + pageSize).clamp(start, device.objects.length);
+        final batch = device.objects.sublist(start, end);
+        final results = await _request(
+          () => _client.readMultiple(device.deviceId, [
+            for (final object in batch)
+              BacnetReadAccessSpecification(
+                objectIdentifier: object,
+                properties: [
+                  for (final id in propertyIds)
+                    BacnetPropertyReference(propertyIdentifier: id),
+                ],
+              ),
+          ], priority: BacnetRequestPriority.background),
+        );
+        final keys = [for (final o in batch) '${o.type}:${o.instance}'];
+        for (final key in keys) {
+          device.properties[key] = {
+            for (final entry in (results[key] ?? const {}).entries)
+              entry.key: _jsonValue(entry.value),
+          };
+        }
+        _pageDone(device, keys: keys);
+      }
+
+      if (!_cancelled) device.status = InventoryStatus.done;
+    } on Object catch (e, st) {
+      _failed++;
+      device
+        ..status = InventoryStatus.failed
+        ..error = '$e';
+      _client.log(
+        BacnetLogLevel.warning,
+        'Inventory of device ${device.deviceId} failed',
+        e,
+        st,
+      );
+    }
+    _pageDone(device);
+  }
+
+  Future<T> _request<T>(Future<T> Function() request) async {
+    final result = await budget.run(request);
+    _requests++;
+    return result;
+  }
+
+  void _pageDone(
+    DeviceInventory device, {
+    List<BacnetObject> objects = const [],
+    Iterable<String> keys = const [],
+  }) {
+    final page = device._pageJson(objects: objects, keys: keys);
+    _unsaved.add('${jsonEncode(page)}\n');
+    _saveInBackground();
+    _report();
+  }
+
+  void _saveInBackground() {
+    // Failures are logged and reported by [_save]; the next page retries.
+    unawaited(_save().then<void>((_) {}, onError: (Object _) {}));
+  }
+
+  void _report() {
+    if (_progress.isClosed) return;
+    var known = 0;
+    var read = 0;
+    var counted = 0;
+    var listedDevices = 0;
+    var done = 0;
+    for (final d in _checkpoint.devices.values) {
+      known += d.objects.length;
+      read += d.objectsRead;
+      if (d.status == InventoryStatus.done) done++;
+      final count = d.objectCount;
+      if (count != null) {
+        counted += count;
+        listedDevices++;
+      }
+    }
+    final total = _checkpoint.devices.length;
+    // Assume devices not listed yet hold as many objects as the average.
+    final estimated = listedDevices == 0
+        ? known
+        : counted + (total - listedDevices) * counted ~/ listedDevices;
+
+    final readThisRun = read - _readAtStart;
+    final elapsed = _clock.elapsed;
+    Duration? eta;
+    if (readThisRun > 0) {
+      final remaining = estimated - read;
+      eta = remaining <= 0
+          ? Duration.zero
+          : elapsed * (remaining / readThisRun);
+    }
+
+    _progress.add(
+      InventoryProgress(
+        devicesTotal: total,
+        devicesDone: done,
+        devicesFailed: _failed,
+        objectsKnown: known,
+        objectsRead: read,
+        objectsEstimated: estimated,
+        requests: _requests,
+        elapsed: elapsed,
+        eta: eta,
+        checkpointError: _saveError,
+      ),
+    );
+  }
+
+  Future<InventoryCheckpoint?> _load() async {
+    final file = File(checkpointPath);
+    if (!file.existsSync()) return null;
+    final List<String> lines;
+    final InventoryCheckpoint checkpoint;
+    try {
+      lines = await file.readAsLines();
+      final json = jsonDecode(lines.first);
+      checkpoint = InventoryCheckpoint.fromJson(json as Map<String, dynamic>);
+    } on Object catch (e, st) {
+      _client.log(
+        BacnetLogLevel.warning,
+        'Ignoring unreadable inventory checkpoint $checkpointPath',
+        e,
+        st,
+      );
+      return null;
+    }
+    for (var i = 1; i < lines.length; i++) {
+      try {
+        final page = jsonDecode(lines[i]) as Map<String, dynamic>;
+        final id = page['deviceId'] as int;
+        checkpoint.devices.putIfAbsent(id, () => DeviceInventory(id))
+          .._merge(page);
+      } on Object catch (e, st) {
+        // A crash mid-append tears the last line; later pages are redone.
+        _client.log(
+          BacnetLogLevel.warning,
+          'Ignoring inventory checkpoint $checkpointPath from line ${i + 1}',
+          e,
+          st,
+        );
+        break;
+      }
+    }
+    return checkpoint;
+  }
+
+  /// Appends the pages completed so far to the checkpoint, or rewrites it
+  /// as one snapshot when one is due. Pages completed while a write is in
+  /// flight are appended by a single follow-up write.
+  ///
+  /// A failed write is logged and shown in [progress] until a later write
+  /// succeeds, and completes the returned future with the error.
+  Future<void> _save() {
+    final inFlight = _saving;
+    if (inFlight != null) return inFlight;
+    if (!_snapshotDue && _unsaved.isEmpty) return Future.value();
+    return _saving = () async {
+      try {
+        while (_snapshotDue || _unsaved.isNotEmpty) {
+          if (_snapshotDue) {
+            // The snapshot already holds every page queued so far.
+            _snapshotDue = false;
+            _unsaved.clear();
+            final tmp = File('$checkpointPath.tmp');
+            await tmp.writeAsString(
+              '${jsonEncode(_checkpoint.toJson())}\n',
+              flush: true,
+            );
+            // Rename is atomic, so a crash never leaves a torn snapshot.
+            await tmp.rename(checkpointPath);
+          } else {
+            final pages = _unsaved.join();
+            _unsaved.clear();
+            await File(checkpointPath).writeAsString(
+              pages,
+              mode: FileMode.append,
+              flush: true,
+            );
+          }
+        }
+        _saveError = null;
+      } on Object catch (e, st) {
+        // An append may have torn its last line; start over from a snapshot.
+        _snapshotDue = true;
+        _saveError = e;
+        _client.log(
+          BacnetLogLevel.warning,
+          'Could not write inventory checkpoint $checkpointPath',
+          e,
+          st,
+        );
+        _report();
+        rethrow;
+      } finally {
+        _saving = null;
+      }
+    }();
+  }
+
+  static Object? _jsonValue(Object? value) => switch (value) {
+    null || bool() || num() || String() => value,
+    BacnetError(:final errorClass, :final errorCode) => {
+      'errorClass': errorClass,
+      'errorCode': errorCode,
+    },
+    List() => [for (final v in value) _jsonValue(v)],
+    Map() => {
+      for (final e in value.entries) '${e.key}': _jsonValue(e.value),
+    },
+    _ => '$value',
+  };
+}
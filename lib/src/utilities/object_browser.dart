@@ -0,0 +1,360 @@
+import 'dart:async';
+import 'dart:collection';
+
+import 'package:flutter/foundation.dart';
+
+import '../client/bacnet_client.dart';
+import '../constants/object_types.dart';
+import '../constants/property_ids.dart';
+import 'device_scanner.dart';
+
+/// One object of an [ObjectPage] with its display properties.
+@immutable
+class BrowsedObject {
+  /// Creates a browsed object.
+  const BrowsedObject({
+    required this.object,
+    this.name,
+    this.presentValue,
+    this.units,
+  });
+
+  /// The object identifier.
+  final BacnetObject object;
+
+  /// Object_Name, or null if it could not be read.
+  final String? name;
+
+  /// Present_Value, or null for objects without one.
+  final Object? presentValue;
+
+  /// Units (engineering units enumeration), or null for objects without
+  /// them.
+  final int? units;
+
+  @override
+  bool operator ==(Object other) =>
+      other is BrowsedObject &&
+      other.object == object &&
+      other.name == name &&
+      other.presentValue == presentValue &&
+      other.units == units;
+
+  @override
+  int get hashCode => Object.hash(object, name, presentValue, units);
+
+  @override
+  String toString() =>
+      'BrowsedObject(${object.type}:${object.instance}, name: $name, '
+      'presentValue: $presentValue, units: $units)';
+}
+
+/// A page of a device's `object_list`.
+@immutable
+class ObjectPage {
+  /// Creates a page.
+  const ObjectPage({
+    required this.index,
+    required this.objectCount,
+    required this.objects,
+  });
+
+  /// Page number, from 0.
+  final int index;
+
+  /// Length of the device's `object_list` when the page was read.
+  final int objectCount;
+
+  /// The page's objects, in list order.
+  final List<BrowsedObject> objects;
+
+  @override
+  String toString() =>
+      'ObjectPage($index, ${objects.length} of $objectCount objects)';
+}
+
+/// Pages through a device's objects on demand.
+///
+/// Each page costs two ReadPropertyMultiple requests: one for its slice of
+/// `object_list`, read by array index, and one for the name, present value
+/// and units of those objects. The first page's slice also carries the
+/// list length, so the first screenful arrives after two round trips
+/// however large the device is. Once a page arrives, the next
+/// [prefetchPages] are read in the background, and the last
+/// [maxCachedPages] pages stay cached so scrolling back costs nothing.
+///
+/// Devices that reject ReadPropertyMultiple are read entry by entry
+/// instead, through [DeviceScanner.readObjectListEntry].
+///
+/// Example:
+/// ```dart
+/// final browser = ObjectBrowser(client, 1234);
+/// final first = await browser.page(0);
+/// print('${first.objectCount} objects');
+/// for (final o in first.objects) {
+///   print('${o.name}: ${o.presentValue}');
+/// }
+/// ```
+class ObjectBrowser {
+  /// Creates a browser for [deviceId].
+  ObjectBrowser(
+    this.client,
+    this.deviceId, {
+    this.pageSize = 20,
+    this.prefetchPages = 1,
+    this.maxCachedPages = 50,
+  }) : assert(pageSize > 0, 'pageSize must be positive'),
+       assert(prefetchPages >= 0, 'prefetchPages must not be negative'),
+       assert(maxCachedPages > prefetchPages, 'cache smaller than prefetch');
+
+  /// Client the requests are sent through.
+  final BacnetClient client;
+
+  /// Device being browsed.
+  final int deviceId;
+
+  /// Objects per page.
+  final int pageSize;
+
+  /// Pages read ahead after each page is shown.
+  final int prefetchPages;
+
+  /// Pages kept in the cache, least recently used evicted first.
+  final int maxCachedPages;
+
+  // Insertion order doubles as recency; see [_touch].
+  final LinkedHashMap<int, Future<ObjectPage>> _pages = LinkedHashMap();
+  final Map<int, ObjectPage> _loaded = {};
+  int? _objectCount;
+  bool _rpmUnsupported = false;
+  int _requests = 0;
+
+  /// Length of the device's `object_list`, once the first page is read.
+  int? get objectCount => _objectCount;
+
+  /// Number of pages, once the first page is read.
+  int? get pageCount {
+    final count = _objectCount;
+    return count == null ? null : (count + pageSize - 1) ~/ pageSize;
+  }
+
+  /// Requests sent so far, prefetches included.
+  int get requests => _requests;
+
+  /// Returns page [index] if it is cached, without reading it.
+  ObjectPage? cachedPage(int index) => _loaded[index];
+
+  /// Returns page [index], reading it unless it is cached or in flight,
+  /// and starts prefetching the pages after it.
+  ///
+  /// Throws [RangeError] if [index] is past the last page.
+  Future<ObjectPage> page(int index) {
+    final count = pageCount;
+    if (index < 0 || (count != null && count > 0 && index >= count)) {
+      throw RangeError.range(index, 0, count == null ? null : count - 1);
+    }
+    final result = _fetch(index, BacnetRequestPriority.interactive);
+    unawaited(result.then((_) => _prefetch(index), onError: (Object _) {}));
+    return result;
+  }
+
+  /// Drops every cached page, e.g. after the device's objects changed.
+  void clear() {
+    _pages.clear();
+    _loaded.clear();
+    _objectCount = null;
+  }
+
+  void _prefetch(int index) {
+    final count = pageCount ?? 0;
+    for (var next = index + 1; next <= index + prefetchPages; next++) {
+      if (next >= count) break;
+      if (_pages.containsKey(next)) continue;
+      unawaited(
+        _fetch(
+          next,
+          BacnetRequestPriority.background,
+        ).then<void>((_) {}, onError: (Object _) {}),
+      );
+    }
+  }
+
+  Future<ObjectPage> _fetch(int index, BacnetRequestPriority priority) {
+    final cached = _pages[index];
+    if (cached != null) {
+      _touch(index, cached);
+      return cached;
+    }
+    final future = _read(index, priority);
+    _pages[index] = future;
+    future.then(
+      (page) {
+        if (identical(_pages[index], future)) _loaded[index] = page;
+      },
+      onError: (Object _) {
+        // Let a later call retry.
+        if (identical(_pages[index], future)) _pages.remove(index);
+      },
+    );
+    while (_pages.length > maxCachedPages) {
+      _loaded.remove(_pages.keys.first);
+      _pages.remove(_pages.keys.first);
+    }
+    return future;
+  }
+
+  void _touch(int index, Future<ObjectPage> page) {
+    _pages
+      ..remove(index)
+      ..[index] = page;
+  }
+
+  Future<ObjectPage> _read(int index, BacnetRequestPriority priority) async {
+    final first = index * pageSize + 1;
+    final objects = await _readListSlice(first, priority);
+    return ObjectPage(
+      index: index,
+      objectCount: _objectCount ?? objects.length,
+      objects: await _readDisplayProperties(objects, priority),
+    );
+  }
+
+  /// Reads `object_list` entries from [first] (1-based) on, plus the list
+  /// length if it is not known yet.
+  Future<List<BacnetObject>> _readListSlice(
+    int first,
+    BacnetRequestPriority priority,
+  ) async {
+    final known = _objectCount;
+    final last = known == null ? first + pageSize - 1 : known;
+    final end = first + pageSize - 1 < last ? first + pageSize - 1 : last;
+    if (end < first) return const [];
+    if (_rpmUnsupported) return _readListEntries(first, end, priority);
+
+    final Map<String, Map<int, dynamic>> results;
+    try {
+      _requests++;
+      results = await client.readMultiple(deviceId, [
+        BacnetReadAccessSpecification(
+          objectIdentifier: BacnetObject(
+            type: BacnetObjectType.device,
+            instance: deviceId,
+          ),
+          properties: [
+            if (known == null)
+              const BacnetPropertyReference(
+                propertyIdentifier: BacnetPropertyId.objectList,
+                propertyArrayIndex: 0,
+              ),
+            for (var i = first; i <= end; i++)
+              BacnetPropertyReference(
+                propertyIdentifier: BacnetPropertyId.objectList,
+                propertyArrayIndex: i,
+              ),
+          ],
+        ),
+      ], priority: priority);
+    } on BacnetRejectException {
+      _rpmUnsupported = true;
+      return _readListEntries(first, end, priority);
+    }
+
+    // Several indexes decode to an index map, a single one to its value.
+    final properties = results['${BacnetObjectType.device}:$deviceId'];
+    final raw = properties?[BacnetPropertyId.objectList];
+    final entries = raw is Map<int, dynamic>
+        ? raw
+        : <int, dynamic>{known == null ? 0 : first: raw};
+    if (known == null) {
+      final count = entries[0];
+      if (count is! int) {
+        throw BacnetException('Device $deviceId returned no object count');
+      }
+      _objectCount = count;
+    }
+    final count = _objectCount!;
+    return [
+      for (var i = first; i <= end && i <= count; i++)
+        _toObject(entries[i], i),
+    ];
+  }
+
+  Future<List<BacnetObject>> _readListEntries(
+    int first,
+    int end,
+    BacnetRequestPriority priority,
+  ) async {
+    final scanner = DeviceScanner(client);
+    if (_objectCount == null) {
+      _requests++;
+      _objectCount = await scanner.readObjectCount(deviceId);
+    }
+    final last = end < _objectCount! ? end : _objectCount!;
+    _requests += last - first + 1;
+    return Future.wait([
+      for (var i = first; i <= last; i++)
+        scanner.readObjectListEntry(deviceId, i),
+    ]);
+  }
+
+  BacnetObject _toObject(Object? value, int index) {
+    if (value is Map && value['type'] is int && value['instance'] is int) {
+      return BacnetObject(
+        type: value['type'] as int,
+        instance: value['instance'] as int,
+      );
+    }
+    throw BacnetException(
+      'Device $deviceId object_list[$index] is not an object identifier',
+    );
+  }
+
+  Future<List<BrowsedObject>> _readDisplayProperties(
+    List<BacnetObject> objects,
+    BacnetRequestPriority priority,
+  ) async {
+    if (objects.isEmpty) return const [];
+    var results = const <String, Map<int, dynamic>>{};
+    try {
+      _requests++;
+      results = await client.readMultiple(deviceId, [
+        for (final object in objects)
+          BacnetReadAccessSpecification(
+            objectIdentifier: object,
+            properties: const [
+              BacnetPropertyReference(
+                propertyIdentifier: BacnetPropertyId.objectName,
+              ),
+              BacnetPropertyReference(
+                propertyIdentifier: BacnetPropertyId.presentValue,
+              ),
+              BacnetPropertyReference(
+                propertyIdentifier: BacnetPropertyId.units,
+              ),
+            ],
+          ),
+      ], priority: priority);
+    } on BacnetRejectException {
+      // Still show the identifiers.
+    }
+    return [
+      for (final object in objects)
+        _toBrowsed(
+          object,
+          results['${object.type}:${object.instance}'] ?? const {},
+        ),
+    ];
+  }
+
+  static BrowsedObject _toBrowsed(BacnetObject object, Map<int, dynamic> p) {
+    final name = p[BacnetPropertyId.objectName];
+    final value = p[BacnetPropertyId.presentValue];
+    final units = p[BacnetPropertyId.units];
+    return BrowsedObject(
+      object: object,
+      name: name is String ? name : null,
+      presentValue: value is BacnetError ? null : value,
+      units: units is int ? units : null,
+    );
+  }
+}
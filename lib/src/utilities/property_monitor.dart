@@ -22,13 +22,22 @@ class PropertyMonitor {
   /// If [preferPolling] is true, or if COV is not reliable (logic to be enhanced),
   /// it runs a polling loop with the specified [pollingInterval].
   ///
-  /// Returns a stream of [PropertyUpdate] events.
+  /// The COV subscription uses [covIncrement] (null for the object's own
+  /// COV_Increment), [confirmedCov] and [covLifetime], and is renewed
+  /// before the lifetime runs out; see [BacnetClient.subscribeCOV]. It is
+  /// cancelled on the device when the last listener cancels.
+  ///
+  /// Returns a stream of [PropertyUpdate] events. A failed poll is reported
+  /// as an update with [PropertyUpdate.error] set and a null value.
   Stream<PropertyUpdate> monitor({
     required int deviceId,
     required BacnetObject object,
     required int propertyId,
     Duration pollingInterval = const Duration(seconds: 2),
     bool preferPolling = false,
+    double? covIncrement,
+    bool confirmedCov = false,
+    Duration covLifetime = const Duration(minutes: 2),
   }) {
     final key = _generateKey(deviceId, object, propertyId);
 
@@ -41,7 +50,9 @@ class PropertyMonitor {
     _activeMonitors[key] = controller;
 
     Timer? pollingTimer;
+    Timer? renewTimer;
     StreamSubscription<dynamic>? eventSubscription;
+    var subscribed = false;
 
     void startPolling() {
       pollingTimer?.cancel();
@@ -53,6 +64,7 @@ class PropertyMonitor {
             object.type,
             object.instance,
             propertyId,
+            priority: BacnetRequestPriority.background,
           );
           if (!controller.isClosed) {
             controller.add(
@@ -68,10 +80,23 @@ class PropertyMonitor {
               ),
             );
           }
-        } on Object catch (_) {
+        } on Object catch (e) {
           if (!controller.isClosed) {
-            // Don't error the stream on polling failure, just log or add error update
-            // controller.addError(e); // Optional: decide if we want to terminate stream
+            // Report the missed poll without ending the stream, so
+            // listeners (e.g. TrendLogBackfill) can see the outage.
+            controller.add(
+              PropertyUpdate(
+                deviceId: deviceId,
+                objectIdentifier: object,
+                propertyIdentifier: propertyId,
+                value: null,
+                timestamp: DateTime.now(),
+                source: preferPolling
+                    ? UpdateSource.manual
+                    : UpdateSource.missingCovFallback,
+                error: e,
+              ),
+            );
           }
         }
       });
@@ -82,6 +107,49 @@ class PropertyMonitor {
       pollingTimer = null;
     }
 
+    Future<void> subscribe() async {
+      await client.subscribeCOV(
+        deviceId,
+        object.type,
+        object.instance,
+        propId: propertyId,
+        confirmed: confirmedCov,
+        lifetime: covLifetime.inSeconds,
+        covIncrement: covIncrement,
+      );
+      subscribed = true;
+    }
+
+    Future<void> unsubscribe() async {
+      if (!subscribed) return;
+      subscribed = false;
+      try {
+        await client.unsubscribeCOV(
+          deviceId,
+          object.type,
+          object.instance,
+          propId: propertyId,
+        );
+      } on Object catch (_) {
+        // Best effort; the device drops it once the lifetime runs out.
+      }
+    }
+
+    void scheduleRenewal() {
+      if (covLifetime.inSeconds <= 0) return;
+      // Renew with a margin so the device never drops the subscription.
+      renewTimer = Timer(covLifetime * 0.8, () async {
+        if (controller.isClosed) return;
+        try {
+          await subscribe();
+          if (controller.isClosed) return unsubscribe();
+          scheduleRenewal();
+        } on Object catch (_) {
+          if (!controller.isClosed) startPolling();
+        }
+      });
+    }
+
     // Handle stream lifecycle
     controller.onListen = () async {
       // 1. Initial read to get current value immediately
@@ -110,12 +178,10 @@ class PropertyMonitor {
       // 2. Subscribe to COV if not strictly polling preferred
       if (!preferPolling) {
         try {
-          await client.subscribeCOV(
-            deviceId,
-            object.type,
-            object.instance,
-            propId: propertyId,
-          );
+          await subscribe();
+          // Cancelled while subscribing; onCancel had nothing to undo.
+          if (controller.isClosed) return unsubscribe();
+          scheduleRenewal();
         } on Object catch (_) {
           // If subscription fails, fallback to polling immediately
           startPolling();
@@ -130,24 +196,28 @@ class PropertyMonitor {
           if (event.deviceId == deviceId &&
               event.objectType == object.type &&
               event.instance == object.instance) {
-            // Note: COVNotificationResponse in current model might not carry propertyId/value
-            // Depending on the implementation of COVNotificationResponse.
-            // Let's check the model definition.
-            // If the event doesn't have the value, we might need to read it.
-
-            // Assuming for now we trigger a read or if the event has data.
-            // Checking COVNotificationResponse definition...
-            // It has objectType, instance, timestamp, deviceId.
-            // It DOES NOT seem to have propertyId or value in the current definition seen previously?
-            // Wait, I need to check COVNotificationResponse definition again.
-
-            // If it doesn't have value, we must read it.
+            if (event.propertyId == propertyId && event.value != null) {
+              controller.add(
+                PropertyUpdate(
+                  deviceId: deviceId,
+                  objectIdentifier: object,
+                  propertyIdentifier: propertyId,
+                  value: event.value,
+                  timestamp: DateTime.now(),
+                  source: UpdateSource.cov,
+                ),
+              );
+              return;
+            }
+
+            // The notification did not carry this property; read it.
             client
                 .readProperty(
                   deviceId,
                   object.type,
                   object.instance,
                   propertyId,
+                  priority: BacnetRequestPriority.background,
                 )
                 .then((val) {
                   if (!controller.isClosed) {
@@ -157,7 +227,7 @@ class PropertyMonitor {
                         objectIdentifier: object,
                         propertyIdentifier: propertyId,
                         value: val,
-                        timestamp: DateTime.now(), // or parse event.timestamp
+                        timestamp: DateTime.now(),
                         source: UpdateSource.cov,
                       ),
                     );
@@ -170,6 +240,8 @@ class PropertyMonitor {
 
     controller.onCancel = () async {
       stopPolling();
+      renewTimer?.cancel();
+      unawaited(unsubscribe());
       await eventSubscription?.cancel();
       _activeMonitors.remove(key);
       await controller.close();
@@ -0,0 +1,64 @@
+import 'dart:async';
+import 'dart:collection';
+
+/// Limits how many requests run at once.
+///
+/// Share one budget between jobs that talk to the same network so that
+/// together they never exceed [maxConcurrent] outstanding requests; the
+/// rest wait in FIFO order.
+///
+/// Example:
+/// ```dart
+/// final budget = RequestBudget(8);
+/// final value = await budget.run(
+///   () => client.readProperty(1234, 0, 1, BacnetPropertyId.presentValue),
+/// );
+/// ```
+class RequestBudget {
+  /// Creates a budget allowing [maxConcurrent] requests at once.
+  RequestBudget(this.maxConcurrent)
+    : assert(maxConcurrent > 0, 'maxConcurrent must be positive');
+
+  /// Maximum number of requests running at once.
+  final int maxConcurrent;
+
+  final Queue<Completer<void>> _waiters = Queue();
+  int _active = 0;
+
+  /// Number of requests currently running.
+  int get active => _active;
+
+  /// Number of requests waiting for a slot.
+  int get waiting => _waiters.length;
+
+  /// Runs [request] once a slot is free and releases the slot afterwards.
+  Future<T> run<T>(Future<T> Function() request) async {
+    await acquire();
+    try {
+      return await request();
+    } finally {
+      release();
+    }
+  }
+
+  /// Waits for a free slot and takes it. Pair with [release].
+  Future<void> acquire() {
+    if (_active < maxConcurrent) {
+      _active++;
+      return Future.value();
+    }
+    final waiter = Completer<void>();
+    _waiters.add(waiter);
+    return waiter.future;
+  }
+
+  /// Frees a slot taken with [acquire], handing it to the next waiter.
+  void release() {
+    if (_waiters.isNotEmpty) {
+      // The slot passes straight to the waiter; _active is unchanged.
+      _waiters.removeFirst().complete();
+    } else {
+      _active--;
+    }
+  }
+}
@@ -0,0 +1,329 @@
+import 'dart:async';
+
+import 'package:flutter/foundation.dart';
+
+import '../client/bacnet_client.dart';
+import '../constants/property_ids.dart';
+import 'request_budget.dart';
+
+/// One property of one object on one device.
+///
+/// The unit of work of [BacnetClient.readMany].
+@immutable
+class PointRef {
+  /// Creates a point reference; [propertyId] defaults to Present_Value.
+  const PointRef(
+    this.deviceId,
+    this.objectType,
+    this.instance, {
+    this.propertyId = BacnetPropertyId.presentValue,
+    this.arrayIndex = -1,
+  });
+
+  /// Device instance number.
+  final int deviceId;
+
+  /// Object type.
+  final int objectType;
+
+  /// Object instance.
+  final int instance;
+
+  /// Property to read.
+  final int propertyId;
+
+  /// Array index, or -1 for the whole property.
+  final int arrayIndex;
+
+  @override
+  bool operator ==(Object other) =>
+      identical(this, other) ||
+      other is PointRef &&
+          deviceId == other.deviceId &&
+          objectType == other.objectType &&
+          instance == other.instance &&
+          propertyId == other.propertyId &&
+          arrayIndex == other.arrayIndex;
+
+  @override
+  int get hashCode =>
+      Object.hash(deviceId, objectType, instance, propertyId, arrayIndex);
+
+  @override
+  String toString() =>
+      'PointRef($deviceId/$objectType:$instance.$propertyId'
+      '${arrayIndex != -1 ? '[$arrayIndex]' : ''})';
+}
+
+/// Outcome of reading one [PointRef].
+@immutable
+class PointReading {
+  /// Creates a reading.
+  const PointReading({
+    required this.point,
+    required this.elapsed,
+    this.value,
+    this.error,
+  });
+
+  /// The point that was read.
+  final PointRef point;
+
+  /// Decoded value; null if [error] is set.
+  final Object? value;
+
+  /// Why the point could not be read: a [BacnetException] for the request
+  /// or, for a property the device refused, a [BacnetProtocolException].
+  final Object? error;
+
+  /// Time from the start of the read until this result was available.
+  final Duration elapsed;
+
+  /// Whether the point was read successfully.
+  bool get hasValue => error == null;
+
+  @override
+  String toString() => hasValue
+      ? 'PointReading($point = $value, ${elapsed.inMilliseconds}ms)'
+      : 'PointReading($point failed: $error, ${elapsed.inMilliseconds}ms)';
+}
+
+/// Reads points spread over many devices and streams each result as soon
+/// as its device answers.
+///
+/// Points are grouped per device and packed into ReadPropertyMultiple
+/// requests of up to [maxPointsPerRequest] points. Requests run
+/// concurrently, at most [perDevice] at a time per device and at most
+/// [RequestBudget.maxConcurrent] of [budget] overall, so results arrive in
+/// completion order: a healthy device's values are delivered after its own
+/// round trip, not after the slowest device's.
+///
+/// Once a request to a device times out, the device's remaining requests
+/// fail at once instead of each waiting out the timeout.
+///
+/// Normally used through [BacnetClient.readMany].
+class ScatterGatherReader {
+  /// Creates a reader.
+  ScatterGatherReader(
+    this.client, {
+    RequestBudget? budget,
+    this.perDevice = 2,
+    this.maxPointsPerRequest = 16,
+    this.priority = BacnetRequestPriority.interactive,
+  }) : assert(perDevice > 0, 'perDevice must be positive'),
+       assert(maxPointsPerRequest > 0, 'maxPointsPerRequest must be positive'),
+       budget = budget ?? RequestBudget(32);
+
+  /// Client the reads are sent through.
+  final BacnetClient client;
+
+  /// Limit on outstanding requests across all devices.
+  final RequestBudget budget;
+
+  /// Outstanding requests allowed per device.
+  final int perDevice;
+
+  /// Points packed into one ReadPropertyMultiple request.
+  final int maxPointsPerRequest;
+
+  /// Admission class of the requests.
+  final BacnetRequestPriority priority;
+
+  /// Reads [points], emitting one [PointReading] per point in completion
+  /// order, then closes.
+  ///
+  /// Errors are reported per point and never as stream errors. Points still
+  /// outstanding when [deadline] expires are emitted with a
+  /// [BacnetTimeoutException]. Cancelling the subscription stops requests
+  /// that have not been sent yet.
+  Stream<PointReading> read(List<PointRef> points, {Duration? deadline}) {
+    final controller = StreamController<PointReading>();
+    final done = List<bool>.filled(points.length, false);
+    final clock = Stopwatch();
+    var remaining = points.length;
+    var closed = false;
+    Timer? timer;
+
+    void finish() {
+      if (closed) return;
+      closed = true;
+      timer?.cancel();
+      unawaited(controller.close());
+    }
+
+    void emit(int index, {Object? value, Object? error}) {
+      if (closed || done[index]) return;
+      done[index] = true;
+      remaining--;
+      controller.add(
+        PointReading(
+          point: points[index],
+          value: value,
+          error: error,
+          elapsed: clock.elapsed,
+        ),
+      );
+      if (remaining == 0) finish();
+    }
+
+    controller
+      ..onListen = () {
+        clock.start();
+        if (points.isEmpty) {
+          finish();
+          return;
+        }
+        if (deadline != null) {
+          timer = Timer(deadline, () {
+            final error = BacnetTimeoutException(
+              'readMany deadline of ${deadline.inMilliseconds} ms exceeded',
+            );
+            for (var i = 0; i < points.length; i++) {
+              emit(i, error: error);
+            }
+          });
+        }
+        final byDevice = <int, List<int>>{};
+        for (var i = 0; i < points.length; i++) {
+          byDevice.putIfAbsent(points[i].deviceId, () => []).add(i);
+        }
+        for (final entry in byDevice.entries) {
+          unawaited(
+            _readDevice(entry.key, entry.value, points, emit, () => closed),
+          );
+        }
+      }
+      ..onCancel = finish;
+    return controller.stream;
+  }
+
+  Future<void> _readDevice(
+    int deviceId,
+    List<int> indices,
+    List<PointRef> points,
+    void Function(int index, {Object? value, Object? error}) emit,
+    bool Function() closed,
+  ) async {
+    final device = RequestBudget(perDevice);
+    Object? unreachable;
+
+    Future<void> run(List<int> batch) async {
+      await device.acquire();
+      try {
+        if (closed()) return;
+        final failure = unreachable;
+        if (failure != null) {
+          for (final i in batch) {
+            emit(i, error: failure);
+          }
+          return;
+        }
+        try {
+          final values = await budget.run(
+            () async => closed() ? null : _readBatch(deviceId, batch, points),
+          );
+          if (values == null) return;
+          for (final i in batch) {
+            final value = values[i];
+            if (value is BacnetException) {
+              emit(i, error: value);
+            } else {
+              emit(i, value: value);
+            }
+          }
+        } on Object catch (e) {
+          if (e is BacnetTimeoutException) unreachable = e;
+          for (final i in batch) {
+            emit(i, error: e);
+          }
+        }
+      } finally {
+        device.release();
+      }
+    }
+
+    await Future.wait([
+      for (final batch in _batches(indices, points)) run(batch),
+    ]);
+  }
+
+  /// Splits one device's points into requests. Points with an array index
+  /// are read on their own, since RPM results are keyed by property only.
+  List<List<int>> _batches(List<int> indices, List<PointRef> points) {
+    final batches = <List<int>>[];
+    var current = <int>[];
+    for (final i in indices) {
+      if (points[i].arrayIndex != -1) {
+        batches.add([i]);
+        continue;
+      }
+      current.add(i);
+      if (current.length == maxPointsPerRequest) {
+        batches.add(current);
+        current = [];
+      }
+    }
+    if (current.isNotEmpty) batches.add(current);
+    return batches;
+  }
+
+  Future<Map<int, Object?>> _readBatch(
+    int deviceId,
+    List<int> batch,
+    List<PointRef> points,
+  ) async {
+    final first = points[batch.first];
+    if (first.arrayIndex != -1) {
+      final value = await client.readProperty(
+        deviceId,
+        first.objectType,
+        first.instance,
+        first.propertyId,
+        arrayIndex: first.arrayIndex,
+        priority: priority,
+      );
+      return {batch.first: value};
+    }
+
+    final specs = <String, List<BacnetPropertyReference>>{};
+    for (final i in batch) {
+      final point = points[i];
+      final properties = specs.putIfAbsent(
+        '${point.objectType}:${point.instance}',
+        () => [],
+      );
+      final reference = BacnetPropertyReference(
+        propertyIdentifier: point.propertyId,
+      );
+      if (!properties.contains(reference)) properties.add(reference);
+    }
+    final results = await client.readMultiple(deviceId, [
+      for (final entry in specs.entries)
+        BacnetReadAccessSpecification(
+          objectIdentifier: BacnetObject.fromKey(entry.key),
+          properties: entry.value,
+        ),
+    ], priority: priority);
+
+    return {for (final i in batch) i: _valueOf(results, points[i])};
+  }
+
+  static Object? _valueOf(
+    Map<String, Map<int, dynamic>> results,
+    PointRef point,
+  ) {
+    final properties = results['${point.objectType}:${point.instance}'];
+    if (properties == null || !properties.containsKey(point.propertyId)) {
+      return BacnetException('$point missing from the response');
+    }
+    final Object? value = properties[point.propertyId];
+    if (value is BacnetError) {
+      return BacnetProtocolException(
+        'Device returned an error for $point',
+        errorClass: value.errorClass,
+        errorCode: value.errorCode,
+      );
+    }
+    return value;
+  }
+}
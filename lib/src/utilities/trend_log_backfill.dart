@@ -0,0 +1,295 @@
+import 'dart:async';
+
+import '../client/bacnet_client.dart';
+import '../constants/object_types.dart';
+import '../constants/property_ids.dart';
+import '../models/property_update.dart';
+import '../models/trend_log_data.dart';
+import 'property_monitor.dart';
+import 'request_budget.dart';
+
+/// Fills the holes an outage leaves in monitored streams from the devices'
+/// own Trend Logs.
+///
+/// Each monitored point is mapped to the Trend Log that records it, either
+/// with [addSource] or by reading the logs' Log_DeviceObjectProperty with
+/// [discover]. [attach] passes a [PropertyMonitor] stream through and
+/// watches it: when a point comes back after failed reads, only the records
+/// logged between its last good value and the recovery are fetched with
+/// ReadRange, by time for the first page and by sequence number after
+/// that, and are added to the stream as [UpdateSource.backfill] updates
+/// carrying the time the device logged them.
+///
+/// Record times are the device's local time, so the device clock must
+/// roughly agree with this host's for the interval to line up.
+///
+/// Example:
+/// ```dart
+/// final backfill = TrendLogBackfill(client);
+/// await backfill.discover(1234, [1, 2, 3]);
+/// backfill
+///     .attach(monitor.monitor(deviceId: 1234, object: ai1, propertyId: 85))
+///     .listen((update) {
+///       if (update.backfilled) history.insert(update);
+///     });
+/// ```
+class TrendLogBackfill {
+  /// Creates a backfill job.
+  TrendLogBackfill(
+    this.client, {
+    this.minGap = const Duration(seconds: 30),
+    this.pageSize = 50,
+    this.maxPages = 20,
+    RequestBudget? budget,
+  }) : assert(pageSize > 0, 'pageSize must be positive'),
+       assert(maxPages > 0, 'maxPages must be positive'),
+       budget = budget ?? RequestBudget(4);
+
+  /// Client the ReadRange requests are sent through.
+  final BacnetClient client;
+
+  /// Outages shorter than this are not backfilled.
+  final Duration minGap;
+
+  /// Records requested per ReadRange.
+  final int pageSize;
+
+  /// ReadRange requests allowed per gap.
+  final int maxPages;
+
+  /// Limit on backfills running at once.
+  final RequestBudget budget;
+
+  final Map<String, int> _logs = {};
+  int _gapsDetected = 0;
+  int _gapsFilled = 0;
+  int _gapsFailed = 0;
+  int _recordsBackfilled = 0;
+
+  /// Gaps seen on points that have a Trend Log.
+  int get gapsDetected => _gapsDetected;
+
+  /// Gaps for which at least one record was recovered.
+  int get gapsFilled => _gapsFilled;
+
+  /// Gaps whose Trend Log could not be read.
+  int get gapsFailed => _gapsFailed;
+
+  /// Records recovered across all gaps.
+  int get recordsBackfilled => _recordsBackfilled;
+
+  /// Records that [trendLog] on [deviceId] logs [propertyId] of [object].
+  void addSource({
+    required int deviceId,
+    required BacnetObject object,
+    required int propertyId,
+    required int trendLog,
+  }) {
+    _logs[_key(deviceId, object, propertyId)] = trendLog;
+  }
+
+  /// Trend Log instance mapped to a point, if any.
+  int? trendLogFor(int deviceId, BacnetObject object, int propertyId) =>
+      _logs[_key(deviceId, object, propertyId)];
+
+  /// Maps each of [trendLogs] on [deviceId] to the point it logs.
+  ///
+  /// Reads Log_DeviceObjectProperty of all logs in one
+  /// ReadPropertyMultiple. Logs that record another device, or whose
+  /// reference could not be read, are skipped. Returns the number mapped.
+  Future<int> discover(int deviceId, Iterable<int> trendLogs) async {
+    final instances = trendLogs.toSet();
+    if (instances.isEmpty) return 0;
+    final results = await client.readMultiple(deviceId, [
+      for (final instance in instances)
+        BacnetReadAccessSpecification(
+          objectIdentifier: BacnetObject(
+            type: BacnetObjectType.trendLog,
+            instance: instance,
+          ),
+          properties: const [
+            BacnetPropertyReference(
+              propertyIdentifier: BacnetPropertyId.logDeviceObjectProperty,
+            ),
+          ],
+        ),
+    ], priority: BacnetRequestPriority.background);
+
+    var mapped = 0;
+    for (final entry in results.entries) {
+      final reference = entry.value[BacnetPropertyId.logDeviceObjectProperty];
+      // [object id, property id, array index?, device id?]
+      if (reference is! List || reference.length < 2) continue;
+      if (reference.any((v) => v is! int)) continue;
+      final values = reference.cast<int>();
+      if (values.length > 2) {
+        final device = values.last;
+        final isDevice = (device >> 22) & 0x3FF == BacnetObjectType.device;
+        if (isDevice && device & 0x3FFFFF != deviceId) continue;
+      }
+      addSource(
+        deviceId: deviceId,
+        object: BacnetObject(
+          type: (values[0] >> 22) & 0x3FF,
+          instance: values[0] & 0x3FFFFF,
+        ),
+        propertyId: values[1],
+        trendLog: BacnetObject.fromKey(entry.key).instance,
+      );
+      mapped++;
+    }
+    return mapped;
+  }
+
+  /// Passes [updates] through, adding backfilled records after each
+  /// recovery from failed reads.
+  ///
+  /// [updates] may carry several points, e.g. merged monitor streams; gaps
+  /// are tracked per point. Backfilled updates follow the update that ended
+  /// the gap, oldest first. A failed backfill is counted in [gapsFailed]
+  /// and never errors the stream.
+  Stream<PropertyUpdate> attach(Stream<PropertyUpdate> updates) {
+    final controller = StreamController<PropertyUpdate>();
+    final lastGood = <String, DateTime>{};
+    final failing = <String>{};
+    final pending = <Future<void>>{};
+    StreamSubscription<PropertyUpdate>? subscription;
+    var sourceDone = false;
+
+    void closeIfDone() {
+      if (sourceDone && pending.isEmpty && !controller.isClosed) {
+        unawaited(controller.close());
+      }
+    }
+
+    void onUpdate(PropertyUpdate update) {
+      controller.add(update);
+      if (update.backfilled) return;
+      final key = _key(
+        update.deviceId,
+        update.objectIdentifier,
+        update.propertyIdentifier,
+      );
+      if (update.error != null) {
+        if (lastGood.containsKey(key)) failing.add(key);
+        return;
+      }
+      final from = lastGood[key];
+      lastGood[key] = update.timestamp;
+      if (!failing.remove(key) || from == null) return;
+      if (update.timestamp.difference(from) < minGap) return;
+      if (!_logs.containsKey(key)) return;
+
+      late final Future<void> job;
+      job = fill(
+            update.deviceId,
+            update.objectIdentifier,
+            update.propertyIdentifier,
+            from,
+            update.timestamp,
+          )
+          .then<void>((records) {
+            if (controller.isClosed) return;
+            records.forEach(controller.add);
+          }, onError: (Object _) {
+            _gapsFailed++;
+          })
+          .whenComplete(() {
+            pending.remove(job);
+            closeIfDone();
+          });
+      pending.add(job);
+    }
+
+    controller
+      ..onListen = () {
+        subscription = updates.listen(
+          onUpdate,
+          onError: controller.addError,
+          onDone: () {
+            sourceDone = true;
+            closeIfDone();
+          },
+        );
+      }
+      ..onPause = (() => subscription?.pause())
+      ..onResume = (() => subscription?.resume())
+      ..onCancel = () => subscription?.cancel();
+    return controller.stream;
+  }
+
+  /// Reads the records logged for a point strictly between [from] and
+  /// [to] from its Trend Log.
+  ///
+  /// Returns an empty list if the point has no Trend Log. Log status
+  /// changes and failed reads recorded by the log are left out.
+  Future<List<PropertyUpdate>> fill(
+    int deviceId,
+    BacnetObject object,
+    int propertyId,
+    DateTime from,
+    DateTime to,
+  ) async {
+    final log = _logs[_key(deviceId, object, propertyId)];
+    if (log == null) return const [];
+    _gapsDetected++;
+
+    final records = await budget.run(() async {
+      final records = <PropertyUpdate>[];
+      var page = await client.readTrendLog(
+        deviceId,
+        log,
+        since: from,
+        count: pageSize,
+        priority: BacnetRequestPriority.background,
+      );
+      for (var pages = 1; ; pages++) {
+        var pastEnd = false;
+        for (final entry in page.entries) {
+          if (!entry.timestamp.isBefore(to)) {
+            pastEnd = true;
+            break;
+          }
+          if (entry.hasValue && entry.timestamp.isAfter(from)) {
+            records.add(_toUpdate(deviceId, object, propertyId, entry));
+          }
+        }
+        if (pastEnd || !page.moreItems || page.entries.isEmpty) break;
+        if (pages == maxPages) break;
+
+        final last = page.entries.last;
+        final sequence = last.sequenceNumber;
+        page = await client.readTrendLog(
+          deviceId,
+          log,
+          since: sequence == null ? last.timestamp : null,
+          afterSequence: sequence,
+          count: pageSize,
+          priority: BacnetRequestPriority.background,
+        );
+      }
+      return records;
+    });
+
+    if (records.isNotEmpty) _gapsFilled++;
+    _recordsBackfilled += records.length;
+    return records;
+  }
+
+  static PropertyUpdate _toUpdate(
+    int deviceId,
+    BacnetObject object,
+    int propertyId,
+    TrendLogEntry entry,
+  ) => PropertyUpdate(
+    deviceId: deviceId,
+    objectIdentifier: object,
+    propertyIdentifier: propertyId,
+    value: entry.value,
+    timestamp: entry.timestamp,
+    source: UpdateSource.backfill,
+  );
+
+  static String _key(int deviceId, BacnetObject object, int propertyId) =>
+      '$deviceId:${object.type}:${object.instance}:$propertyId';
+}
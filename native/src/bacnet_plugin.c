@@ -1,12 +1,70 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* pthread_setaffinity_np and cpu_set_t, for the real-time profile */
+#define _GNU_SOURCE
+#endif
 #include "bacnet_plugin.h"
 #include <setjmp.h>
-#include <windows.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <iconv.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(BACDL_MSTP)
+#include "bacnet/datalink/dlmstp.h"
+#endif
+
+/*
+ * Crash containment around calls into the stack. Windows also catches
+ * access violations with structured exception handling; elsewhere only
+ * intercepted exit() calls are recovered, through the jump buffer below.
+ */
+#ifdef _WIN32
+#define PLUGIN_TRY __try
+#define PLUGIN_EXCEPT __except (EXCEPTION_EXECUTE_HANDLER)
+#define plugin_debug_log(text) OutputDebugStringA(text)
+#else
+#define PLUGIN_TRY if (1)
+#define PLUGIN_EXCEPT else
+#define plugin_debug_log(text) fputs((text), stderr)
+#endif
 
 /* Global jump buffer to intercept exit() calls */
 static jmp_buf g_exit_jmp;
 static bool g_jmp_active = false;
 
+/* Set while MS/TP, rather than BACnet/IP, is the process datalink */
+static bool Datalink_Mstp_Active = false;
+
+/* Monotonic times of the last request sent and PDU received; see the
+ * real-time profile */
+static uint64_t Realtime_Last_Send_Us;
+static uint64_t Realtime_Last_Receive_Us;
+static uint64_t realtime_now_us(void);
+
+/* Records a sent WPM in the write journal, after journal_make_room for
+ * journal_write_access_len bytes; defined with the journal */
+static bool journal_make_room(uint32_t bytes);
+static uint32_t journal_write_access_len(
+    BACNET_WRITE_ACCESS_DATA *write_access_data);
+static void journal_write_access(
+    uint8_t invoke_id,
+    uint32_t device_id,
+    BACNET_WRITE_ACCESS_DATA *write_access_data);
+
+/* Completes native client requests answered by a PDU, and any request
+ * whose answer crashed the decoder; defined with the native client */
+static bool client_apdu_handler(
+    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t pdu_len);
+static void client_recover(void);
+
 /* 
  * Custom exit handler to prevent the native library from terminating the entire 
  * Flutter process. Redefined via CMake: -Dexit=bacnet_plugin_exit_handler
@@ -18,14 +76,18 @@ void bacnet_plugin_exit_handler(int code)
 {
     char buf[256];
     sprintf(buf, "BACnet Native Exit Intercepted: code %d\n", code);
-    OutputDebugStringA(buf);
+    plugin_debug_log(buf);
     
     if (g_jmp_active) {
         longjmp(g_exit_jmp, 1);
     }
     
     /* Fallback if jump is not active (should not happen in wrapped calls) */
+#ifdef _WIN32
     TerminateThread(GetCurrentThread(), code);
+#else
+    pthread_exit(NULL);
+#endif
 }
 
 /* Wrapper to simplify calling Send_Write_Property_Multiple_Request */
@@ -34,17 +96,26 @@ uint8_t bacnet_plugin_send_write_property_multiple(
     BACNET_WRITE_ACCESS_DATA *write_access_data)
 {
     uint8_t result = 0;
-    __try {
+    PLUGIN_TRY {
         g_jmp_active = true;
         if (setjmp(g_exit_jmp) == 0) {
             uint8_t pdu[MAX_APDU] = {0};
-            result = Send_Write_Property_Multiple_Request(pdu, sizeof(pdu), device_id, write_access_data);
+            /* Refuse the WPM rather than send one the journal cannot hold */
+            if (journal_make_room(
+                    journal_write_access_len(write_access_data))) {
+                result = Send_Write_Property_Multiple_Request(
+                    pdu, sizeof(pdu), device_id, write_access_data);
+            }
+            if (result) {
+                Realtime_Last_Send_Us = realtime_now_us();
+                journal_write_access(result, device_id, write_access_data);
+            }
         } else {
-            OutputDebugStringA("BACnet WPM: Intercepted exit()\n");
+            plugin_debug_log("BACnet WPM: Intercepted exit()\n");
             result = 0;
         }
-    } __except(EXCEPTION_EXECUTE_HANDLER) {
-        OutputDebugStringA("BACnet WPM: Caught Access Violation/Crash!\n");
+    } PLUGIN_EXCEPT {
+        plugin_debug_log("BACnet WPM: Caught Access Violation/Crash!\n");
         result = 0;
     }
     g_jmp_active = false;
@@ -56,16 +127,19 @@ uint8_t bacnet_plugin_send_read_range_request(
     BACNET_READ_RANGE_DATA *read_range_data)
 {
     uint8_t result = 0;
-    __try {
+    PLUGIN_TRY {
         g_jmp_active = true;
         if (setjmp(g_exit_jmp) == 0) {
             result = Send_ReadRange_Request(device_id, read_range_data);
+            if (result) {
+                Realtime_Last_Send_Us = realtime_now_us();
+            }
         } else {
-            OutputDebugStringA("BACnet ReadRange: Intercepted exit()\n");
+            plugin_debug_log("BACnet ReadRange: Intercepted exit()\n");
             result = 0;
         }
-    } __except(EXCEPTION_EXECUTE_HANDLER) {
-        OutputDebugStringA("BACnet ReadRange: Caught Access Violation/Crash!\n");
+    } PLUGIN_EXCEPT {
+        plugin_debug_log("BACnet ReadRange: Caught Access Violation/Crash!\n");
         result = 0;
     }
     g_jmp_active = false;
@@ -75,16 +149,19 @@ uint8_t bacnet_plugin_send_read_range_request(
 bool bacnet_plugin_safe_bip_init(char *ifname)
 {
     bool result = false;
-    __try {
+    PLUGIN_TRY {
         g_jmp_active = true;
         if (setjmp(g_exit_jmp) == 0) {
+#if defined(BACDL_MULTIPLE)
+            datalink_set("bip");
+#endif
             result = bip_init(ifname);
         } else {
-            OutputDebugStringA("BACnet safe_bip_init: Intercepted exit()\n");
+            plugin_debug_log("BACnet safe_bip_init: Intercepted exit()\n");
             result = false;
         }
-    } __except(EXCEPTION_EXECUTE_HANDLER) {
-        OutputDebugStringA("BACnet safe_bip_init: Caught Access Violation/Crash!\n");
+    } PLUGIN_EXCEPT {
+        plugin_debug_log("BACnet safe_bip_init: Caught Access Violation/Crash!\n");
         result = false;
     }
     g_jmp_active = false;
@@ -94,16 +171,16 @@ bool bacnet_plugin_safe_bip_init(char *ifname)
 bool bacnet_plugin_safe_datalink_init(char *ifname)
 {
     bool result = false;
-    __try {
+    PLUGIN_TRY {
         g_jmp_active = true;
         if (setjmp(g_exit_jmp) == 0) {
             result = datalink_init(ifname);
         } else {
-            OutputDebugStringA("BACnet safe_datalink_init: Intercepted exit()\n");
+            plugin_debug_log("BACnet safe_datalink_init: Intercepted exit()\n");
             result = false;
         }
-    } __except(EXCEPTION_EXECUTE_HANDLER) {
-        OutputDebugStringA("BACnet safe_datalink_init: Caught Access Violation/Crash!\n");
+    } PLUGIN_EXCEPT {
+        plugin_debug_log("BACnet safe_datalink_init: Caught Access Violation/Crash!\n");
         result = false;
     }
     g_jmp_active = false;
@@ -117,16 +194,29 @@ int bacnet_plugin_safe_bip_receive(
     unsigned timeout)
 {
     int result = 0;
-    __try {
+    PLUGIN_TRY {
         g_jmp_active = true;
         if (setjmp(g_exit_jmp) == 0) {
+#if defined(BACDL_MSTP)
+            result = Datalink_Mstp_Active ?
+                dlmstp_receive(src, npdu, max_npdu, timeout) :
+                bip_receive(src, npdu, max_npdu, timeout);
+#else
             result = bip_receive(src, npdu, max_npdu, timeout);
+#endif
+            if (result > 0 &&
+                !bacnet_plugin_filter_accept(src, npdu, (uint16_t)result)) {
+                result = 0;
+            }
+            if (result > 0) {
+                Realtime_Last_Receive_Us = realtime_now_us();
+            }
         } else {
-            OutputDebugStringA("BACnet safe_bip_receive: Intercepted exit()\n");
+            plugin_debug_log("BACnet safe_bip_receive: Intercepted exit()\n");
             result = -1;
         }
-    } __except(EXCEPTION_EXECUTE_HANDLER) {
-        OutputDebugStringA("BACnet safe_bip_receive: Caught Access Violation/Crash!\n");
+    } PLUGIN_EXCEPT {
+        plugin_debug_log("BACnet safe_bip_receive: Caught Access Violation/Crash!\n");
         result = -1;
     }
     g_jmp_active = false;
@@ -138,15 +228,3410 @@ void bacnet_plugin_safe_npdu_handler(
     uint8_t *npdu,
     uint16_t pdu_len)
 {
-    __try {
+    PLUGIN_TRY {
         g_jmp_active = true;
         if (setjmp(g_exit_jmp) == 0) {
-            npdu_handler(src, npdu, pdu_len);
+            if (!client_apdu_handler(src, npdu, pdu_len)) {
+                npdu_handler(src, npdu, pdu_len);
+            }
         } else {
-            OutputDebugStringA("BACnet safe_npdu_handler: Intercepted exit()\n");
+            plugin_debug_log("BACnet safe_npdu_handler: Intercepted exit()\n");
+            client_recover();
         }
-    } __except(EXCEPTION_EXECUTE_HANDLER) {
-        OutputDebugStringA("BACnet safe_npdu_handler: Caught Access Violation/Crash!\n");
+    } PLUGIN_EXCEPT {
+        plugin_debug_log("BACnet safe_npdu_handler: Caught Access Violation/Crash!\n");
+        client_recover();
     }
     g_jmp_active = false;
 }
+
+
+/*
+ * Flat entry points for the Dart hot path.
+ *
+ * These take scalar arguments only, so the Dart side calls them without
+ * allocating and filling structs in native memory per request. None of them
+ * block or call back into Dart; those that do not transmit are bound as
+ * leaf calls.
+ */
+void bacnet_plugin_address_add_ipv4(
+    uint32_t device_id,
+    uint32_t ipv4,
+    uint16_t port)
+{
+    BACNET_ADDRESS addr = { 0 };
+
+    addr.mac_len = 6;
+    addr.mac[0] = (uint8_t)(ipv4 >> 24);
+    addr.mac[1] = (uint8_t)(ipv4 >> 16);
+    addr.mac[2] = (uint8_t)(ipv4 >> 8);
+    addr.mac[3] = (uint8_t)ipv4;
+    addr.mac[4] = (uint8_t)(port >> 8);
+    addr.mac[5] = (uint8_t)port;
+    addr.net = 0;
+    addr.len = 0;
+    address_add(device_id, MAX_APDU, &addr);
+}
+
+/*
+ * Sends Who-Is with low = high = device_id to the device's cached address
+ * only. Returns false, without sending, if no address is bound.
+ */
+bool bacnet_plugin_send_who_is_directed(uint32_t device_id)
+{
+    BACNET_ADDRESS dest;
+    unsigned max_apdu = 0;
+
+    if (!address_get_by_device(device_id, &max_apdu, &dest)) {
+        return false;
+    }
+    Send_WhoIs_To_Network(&dest, (int32_t)device_id, (int32_t)device_id);
+    return true;
+}
+
+uint8_t bacnet_plugin_send_read_property(
+    uint32_t device_id,
+    uint32_t object_type,
+    uint32_t object_instance,
+    uint32_t object_property,
+    uint32_t array_index)
+{
+    uint8_t invoke_id = Send_Read_Property_Request(
+        device_id, (BACNET_OBJECT_TYPE)object_type, object_instance,
+        (BACNET_PROPERTY_ID)object_property, array_index);
+
+    if (invoke_id) {
+        Realtime_Last_Send_Us = realtime_now_us();
+    }
+    return invoke_id;
+}
+
+uint8_t bacnet_plugin_send_cov_subscribe(
+    uint32_t device_id,
+    uint32_t object_type,
+    uint32_t object_instance,
+    uint32_t object_property,
+    bool confirmed,
+    uint32_t lifetime,
+    bool cancel,
+    bool increment_present,
+    float increment)
+{
+    BACNET_SUBSCRIBE_COV_DATA cov_data = { 0 };
+    uint8_t invoke_id;
+
+    cov_data.monitoredObjectIdentifier.type = (BACNET_OBJECT_TYPE)object_type;
+    cov_data.monitoredObjectIdentifier.instance = object_instance;
+    cov_data.monitoredProperty.property_identifier =
+        (BACNET_PROPERTY_ID)object_property;
+    cov_data.monitoredProperty.property_array_index = BACNET_ARRAY_ALL;
+    cov_data.issueConfirmedNotifications = confirmed;
+    cov_data.lifetime = lifetime;
+    cov_data.cancellationRequest = cancel;
+    cov_data.covSubscribeToProperty = true;
+    cov_data.covIncrementPresent = increment_present;
+    cov_data.covIncrement = increment;
+
+    invoke_id = Send_COV_Subscribe(device_id, &cov_data);
+    if (invoke_id) {
+        Realtime_Last_Send_Us = realtime_now_us();
+    }
+    return invoke_id;
+}
+
+/*
+ * Converts double-byte character set text to UTF-16 code units.
+ * code_page is the Windows code page carried in a BACnet DBCS string
+ * (e.g. 932 for Shift-JIS); 20932 selects EUC-JP, used for JIS X 0208.
+ * Returns the number of code units written, or -1 on failure.
+ * Leaf call: no allocation that outlives the call, no callbacks.
+ */
+int32_t bacnet_plugin_decode_dbcs(
+    uint16_t code_page,
+    const uint8_t *src,
+    uint32_t src_len,
+    uint16_t *dst,
+    uint32_t dst_capacity)
+{
+#ifdef _WIN32
+    int count = MultiByteToWideChar(code_page, 0, (LPCCH)src, (int)src_len,
+        (LPWSTR)dst, (int)dst_capacity);
+    return count > 0 ? count : -1;
+#else
+    char name[16];
+    iconv_t cd;
+    char *in = (char *)src;
+    char *out = (char *)dst;
+    size_t in_left = src_len;
+    size_t out_left = (size_t)dst_capacity * 2;
+
+    if (code_page == 20932) {
+        snprintf(name, sizeof(name), "EUC-JP");
+    } else {
+        snprintf(name, sizeof(name), "CP%u", (unsigned)code_page);
+    }
+    cd = iconv_open("UTF-16LE", name);
+    if (cd == (iconv_t)-1) {
+        return -1;
+    }
+    if (iconv(cd, &in, &in_left, &out, &out_left) == (size_t)-1) {
+        iconv_close(cd);
+        return -1;
+    }
+    iconv_close(cd);
+    return (int32_t)(((size_t)dst_capacity * 2 - out_left) / 2);
+#endif
+}
+
+/*
+ * Native COV notification handling.
+ *
+ * Confirmed notifications are decoded, queued and acknowledged inside
+ * npdu_handler, so the SimpleAck never waits on Dart. The worker drains the
+ * queue after each receive. Everything runs on the worker thread; the ring
+ * needs no locking.
+ */
+#define COV_MAX_VALUES 4
+#define COV_RECENT_SIZE 16
+
+static BACNET_PLUGIN_COV_EVENT Cov_Ring[BACNET_PLUGIN_COV_RING_SIZE];
+static unsigned Cov_Ring_Head;
+static unsigned Cov_Ring_Count;
+static BACNET_PLUGIN_COV_STATS Cov_Stats;
+
+/* Defined with the write journal */
+static uint32_t journal_crc32(const uint8_t *data, size_t len);
+
+/*
+ * Recently acked notifications, to spot retransmissions. A sender retries
+ * with the same invoke ID and body for at most its APDU timeout times its
+ * retries; after that, or with a different body, the invoke ID has been
+ * reused for a new notification. The local APDU settings stand in for the
+ * sender's.
+ */
+static struct {
+    uint8_t mac[MAX_MAC_LEN];
+    uint8_t mac_len;
+    uint8_t invoke_id;
+    uint16_t service_len;
+    uint32_t crc; /* of the service request */
+    uint64_t acked_us;
+    bool used;
+} Cov_Recent[COV_RECENT_SIZE];
+static unsigned Cov_Recent_Next;
+
+static bool cov_seen_recently(
+    BACNET_ADDRESS *src,
+    uint8_t invoke_id,
+    uint8_t *service_request,
+    uint16_t service_len)
+{
+    uint64_t now = realtime_now_us();
+    uint64_t window =
+        (uint64_t)apdu_timeout() * (apdu_retries() + 1u) * 1000u;
+    uint32_t crc = journal_crc32(service_request, service_len);
+    unsigned i;
+
+    for (i = 0; i < COV_RECENT_SIZE; i++) {
+        if (Cov_Recent[i].used && Cov_Recent[i].invoke_id == invoke_id &&
+            Cov_Recent[i].mac_len == src->mac_len &&
+            memcmp(Cov_Recent[i].mac, src->mac, src->mac_len) == 0) {
+            if (now - Cov_Recent[i].acked_us <= window &&
+                Cov_Recent[i].service_len == service_len &&
+                Cov_Recent[i].crc == crc) {
+                return true;
+            }
+            /* The invoke ID was reused; this entry is stale */
+            Cov_Recent[i].used = false;
+        }
+    }
+    i = Cov_Recent_Next;
+    Cov_Recent_Next = (Cov_Recent_Next + 1) % COV_RECENT_SIZE;
+    memcpy(Cov_Recent[i].mac, src->mac, src->mac_len);
+    Cov_Recent[i].mac_len = src->mac_len;
+    Cov_Recent[i].invoke_id = invoke_id;
+    Cov_Recent[i].service_len = service_len;
+    Cov_Recent[i].crc = crc;
+    Cov_Recent[i].acked_us = now;
+    Cov_Recent[i].used = true;
+    return false;
+}
+
+static void cov_enqueue(BACNET_COV_DATA *cov_data, bool confirmed)
+{
+    BACNET_PLUGIN_COV_EVENT *event;
+    BACNET_PROPERTY_VALUE *pv;
+    unsigned slot;
+    unsigned bit;
+
+    if (Cov_Ring_Count == BACNET_PLUGIN_COV_RING_SIZE) {
+        /* Drop the oldest event; the newest value matters most */
+        Cov_Ring_Head = (Cov_Ring_Head + 1) % BACNET_PLUGIN_COV_RING_SIZE;
+        Cov_Ring_Count--;
+        Cov_Stats.dropped++;
+    }
+    slot = (Cov_Ring_Head + Cov_Ring_Count) % BACNET_PLUGIN_COV_RING_SIZE;
+    event = &Cov_Ring[slot];
+    memset(event, 0, sizeof(*event));
+    event->device_id = cov_data->initiatingDeviceIdentifier;
+    event->object_type = cov_data->monitoredObjectIdentifier.type;
+    event->object_instance = cov_data->monitoredObjectIdentifier.instance;
+    event->time_remaining = cov_data->timeRemaining;
+    event->property_id = BACNET_PLUGIN_COV_NO_PROPERTY;
+    event->confirmed = confirmed;
+
+    for (pv = cov_data->listOfValues; pv; pv = pv->next) {
+        if (pv->propertyIdentifier == PROP_STATUS_FLAGS &&
+            pv->value.tag == BACNET_APPLICATION_TAG_BIT_STRING) {
+            for (bit = 0; bit < 4; bit++) {
+                if (bitstring_bit(&pv->value.type.Bit_String, (uint8_t)bit)) {
+                    event->status_flags |= (uint8_t)(1u << bit);
+                }
+            }
+            event->has_status_flags = true;
+        } else if (event->property_id == BACNET_PLUGIN_COV_NO_PROPERTY) {
+            event->property_id = pv->propertyIdentifier;
+            event->value_tag = pv->value.tag;
+            switch (pv->value.tag) {
+                case BACNET_APPLICATION_TAG_BOOLEAN:
+                    event->value = pv->value.type.Boolean ? 1.0 : 0.0;
+                    break;
+                case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+                    event->value = (double)pv->value.type.Unsigned_Int;
+                    break;
+                case BACNET_APPLICATION_TAG_SIGNED_INT:
+                    event->value = (double)pv->value.type.Signed_Int;
+                    break;
+                case BACNET_APPLICATION_TAG_REAL:
+                    event->value = pv->value.type.Real;
+                    break;
+                case BACNET_APPLICATION_TAG_DOUBLE:
+                    event->value = pv->value.type.Double;
+                    break;
+                case BACNET_APPLICATION_TAG_ENUMERATED:
+                    event->value = (double)pv->value.type.Enumerated;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    Cov_Ring_Count++;
+}
+
+static int cov_decode(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_COV_DATA *cov_data,
+    BACNET_PROPERTY_VALUE *values)
+{
+    bacapp_property_value_list_init(values, COV_MAX_VALUES);
+    cov_data->listOfValues = values;
+    return cov_notify_decode_service_request(
+        service_request, service_len, cov_data);
+}
+
+static void bacnet_plugin_ccov_handler(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_DATA *service_data)
+{
+    BACNET_NPDU_DATA npdu_data;
+    BACNET_ADDRESS my_address;
+    BACNET_COV_DATA cov_data;
+    BACNET_PROPERTY_VALUE values[COV_MAX_VALUES];
+    uint8_t buffer[MAX_PDU];
+    int pdu_len;
+    int len;
+
+    Cov_Stats.received++;
+    datalink_get_my_address(&my_address);
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    pdu_len = npdu_encode_pdu(buffer, src, &my_address, &npdu_data);
+
+    if (service_data->segmented_message) {
+        len = abort_encode_apdu(&buffer[pdu_len], service_data->invoke_id,
+            ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, true);
+        Cov_Stats.rejected++;
+    } else if (cov_decode(service_request, service_len, &cov_data, values) <
+        0) {
+        len = reject_encode_apdu(&buffer[pdu_len], service_data->invoke_id,
+            REJECT_REASON_MISSING_REQUIRED_PARAMETER);
+        Cov_Stats.rejected++;
+    } else {
+        if (cov_seen_recently(src, service_data->invoke_id,
+                service_request, service_len)) {
+            /* Our earlier ack was lost; ack again but don't re-queue */
+            Cov_Stats.retransmits++;
+        } else {
+            cov_enqueue(&cov_data, true);
+        }
+        len = encode_simple_ack(&buffer[pdu_len], service_data->invoke_id,
+            SERVICE_CONFIRMED_COV_NOTIFICATION);
+        Cov_Stats.acked++;
+    }
+    datalink_send_pdu(src, &npdu_data, &buffer[0], pdu_len + len);
+}
+
+static void bacnet_plugin_ucov_handler(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src)
+{
+    BACNET_COV_DATA cov_data;
+    BACNET_PROPERTY_VALUE values[COV_MAX_VALUES];
+
+    (void)src;
+    Cov_Stats.received++;
+    if (cov_decode(service_request, service_len, &cov_data, values) > 0) {
+        cov_enqueue(&cov_data, false);
+    }
+}
+
+void bacnet_plugin_cov_handlers_init(void)
+{
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_COV_NOTIFICATION, bacnet_plugin_ccov_handler);
+    apdu_set_unconfirmed_handler(
+        SERVICE_UNCONFIRMED_COV_NOTIFICATION, bacnet_plugin_ucov_handler);
+}
+
+bool bacnet_plugin_cov_event_pop(BACNET_PLUGIN_COV_EVENT *event)
+{
+    if (Cov_Ring_Count == 0) {
+        return false;
+    }
+    *event = Cov_Ring[Cov_Ring_Head];
+    Cov_Ring_Head = (Cov_Ring_Head + 1) % BACNET_PLUGIN_COV_RING_SIZE;
+    Cov_Ring_Count--;
+    return true;
+}
+
+void bacnet_plugin_cov_stats(BACNET_PLUGIN_COV_STATS *stats)
+{
+    *stats = Cov_Stats;
+}
+
+/*
+ * Receive pre-filter.
+ *
+ * Runs on every packet bip_receive returns, before npdu_handler, so
+ * unwanted broadcast traffic never reaches the service handlers or Dart.
+ * Service rules are two 256-bit deny bitmaps (confirmed and unconfirmed
+ * service choices); source rules are an open-addressing hash of IPv4
+ * address/port keys. Replies to our own requests are not service-filtered.
+ * Configured and consulted on the worker thread only; no locking.
+ */
+static uint8_t Filter_Deny_Confirmed[32];
+static uint8_t Filter_Deny_Unconfirmed[32];
+static bool Filter_Deny_Network;
+static uint8_t Filter_Source_Mode;
+static uint64_t Filter_Sources[BACNET_PLUGIN_FILTER_MAX_SOURCES];
+static unsigned Filter_Source_Count;
+static BACNET_PLUGIN_FILTER_STATS Filter_Stats;
+
+/* Keys are ipv4 << 16 | port, offset by one so that 0 marks a free slot */
+static uint64_t filter_source_key(uint32_t ipv4, uint16_t port)
+{
+    return (((uint64_t)ipv4 << 16) | port) + 1;
+}
+
+static unsigned filter_source_slot(uint64_t key)
+{
+    return (unsigned)((key * 0x9E3779B97F4A7C15ull) >> 56);
+}
+
+static bool filter_source_contains(uint64_t key)
+{
+    unsigned slot = filter_source_slot(key);
+    unsigned probes;
+
+    for (probes = 0; probes < BACNET_PLUGIN_FILTER_MAX_SOURCES; probes++) {
+        if (Filter_Sources[slot] == key) {
+            return true;
+        }
+        if (Filter_Sources[slot] == 0) {
+            return false;
+        }
+        slot = (slot + 1) % BACNET_PLUGIN_FILTER_MAX_SOURCES;
+    }
+    return false;
+}
+
+void bacnet_plugin_filter_reset(void)
+{
+    memset(Filter_Deny_Confirmed, 0, sizeof(Filter_Deny_Confirmed));
+    memset(Filter_Deny_Unconfirmed, 0, sizeof(Filter_Deny_Unconfirmed));
+    memset(Filter_Sources, 0, sizeof(Filter_Sources));
+    Filter_Source_Count = 0;
+    Filter_Deny_Network = false;
+    Filter_Source_Mode = BACNET_PLUGIN_FILTER_SOURCES_OFF;
+}
+
+void bacnet_plugin_filter_set_service(
+    bool confirmed, uint8_t service_choice, bool deny)
+{
+    uint8_t *bitmap =
+        confirmed ? Filter_Deny_Confirmed : Filter_Deny_Unconfirmed;
+    uint8_t mask = (uint8_t)(1u << (service_choice & 7));
+
+    if (deny) {
+        bitmap[service_choice >> 3] |= mask;
+    } else {
+        bitmap[service_choice >> 3] &= (uint8_t)~mask;
+    }
+}
+
+void bacnet_plugin_filter_set_network_messages(bool deny)
+{
+    Filter_Deny_Network = deny;
+}
+
+void bacnet_plugin_filter_set_source_mode(uint8_t mode)
+{
+    Filter_Source_Mode = mode;
+}
+
+/* port 0 matches any port of ipv4. Returns false when the table is full. */
+bool bacnet_plugin_filter_add_source(uint32_t ipv4, uint16_t port)
+{
+    uint64_t key = filter_source_key(ipv4, port);
+    unsigned slot = filter_source_slot(key);
+
+    if (filter_source_contains(key)) {
+        return true;
+    }
+    /* Keep the table at most 3/4 full so probes stay short */
+    if (Filter_Source_Count >= BACNET_PLUGIN_FILTER_MAX_SOURCES * 3 / 4) {
+        return false;
+    }
+    while (Filter_Sources[slot] != 0) {
+        slot = (slot + 1) % BACNET_PLUGIN_FILTER_MAX_SOURCES;
+    }
+    Filter_Sources[slot] = key;
+    Filter_Source_Count++;
+    return true;
+}
+
+static bool filter_source_listed(BACNET_ADDRESS *src)
+{
+    uint32_t ipv4;
+    uint16_t port;
+
+    if (src->mac_len != 6) {
+        return false;
+    }
+    ipv4 = ((uint32_t)src->mac[0] << 24) | ((uint32_t)src->mac[1] << 16) |
+        ((uint32_t)src->mac[2] << 8) | src->mac[3];
+    port = (uint16_t)((src->mac[4] << 8) | src->mac[5]);
+    return filter_source_contains(filter_source_key(ipv4, port)) ||
+        filter_source_contains(filter_source_key(ipv4, 0));
+}
+
+bool bacnet_plugin_filter_accept(
+    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t pdu_len)
+{
+    BACNET_ADDRESS npdu_src = { 0 };
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    uint8_t *apdu;
+    uint8_t service;
+    int offset;
+
+    if (Filter_Source_Mode != BACNET_PLUGIN_FILTER_SOURCES_OFF) {
+        bool allow_list =
+            Filter_Source_Mode == BACNET_PLUGIN_FILTER_SOURCES_ALLOW;
+        if (filter_source_listed(src) != allow_list) {
+            Filter_Stats.dropped_source++;
+            return false;
+        }
+    }
+
+    offset = bacnet_npdu_decode(npdu, pdu_len, &dest, &npdu_src, &npdu_data);
+    if (offset <= 0 || offset >= pdu_len) {
+        /* Let npdu_handler deal with malformed packets as before */
+        Filter_Stats.passed++;
+        return true;
+    }
+    if (npdu_data.network_layer_message) {
+        if (Filter_Deny_Network) {
+            Filter_Stats.dropped_network++;
+            return false;
+        }
+        Filter_Stats.passed++;
+        return true;
+    }
+
+    apdu = &npdu[offset];
+    switch (apdu[0] & 0xF0) {
+        case PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST:
+            if (pdu_len - offset < 2) {
+                break;
+            }
+            service = apdu[1];
+            if (Filter_Deny_Unconfirmed[service >> 3] &
+                (1u << (service & 7))) {
+                if (service < 16) {
+                    Filter_Stats.dropped_unconfirmed[service]++;
+                }
+                Filter_Stats.dropped_service++;
+                return false;
+            }
+            break;
+        case PDU_TYPE_CONFIRMED_SERVICE_REQUEST:
+            /* Segmented requests carry sequence and window bytes first */
+            offset += (apdu[0] & 0x08) ? 5 : 3;
+            if (offset >= pdu_len) {
+                break;
+            }
+            service = npdu[offset];
+            if (Filter_Deny_Confirmed[service >> 3] & (1u << (service & 7))) {
+                Filter_Stats.dropped_service++;
+                return false;
+            }
+            break;
+        default:
+            /* Acks, errors, rejects and aborts answer our own requests */
+            break;
+    }
+    Filter_Stats.passed++;
+    return true;
+}
+
+void bacnet_plugin_filter_stats(BACNET_PLUGIN_FILTER_STATS *stats)
+{
+    *stats = Filter_Stats;
+}
+
+/*
+ * Server-side COV.
+ * Analog objects flag a change only when Present_Value moves by at least
+ * their COV_Increment since the last notification, so the increment set
+ * here (or written by a client) directly bounds the notification rate.
+ * handler_cov_task sends notifications for flagged objects to every
+ * active subscriber; lifetimes count down once per accumulated second.
+ */
+static bool Server_COV_Enabled = false;
+static uint32_t Server_COV_Milliseconds = 0;
+
+/*
+ * The stack keeps its subscription list private, so accepted
+ * subscriptions are mirrored here for bacnet_plugin_server_snapshot.
+ *
+ * Subscriptions restored from an image cannot be handed to the stack
+ * without its handler acknowledging them on the wire, so they stay here,
+ * marked restored, and server_cov_restored_task notifies their subscribers
+ * until the subscription lapses or the subscriber renews it, at which
+ * point the stack takes it over.
+ */
+typedef struct {
+    bool used;
+    bool restored;
+    /* Restored only: this change was already notified */
+    bool notified;
+    /* Restored only: confirmed notification awaiting its ack */
+    uint8_t invoke_id;
+    BACNET_ADDRESS src;
+    BACNET_SUBSCRIBE_COV_DATA data;
+    time_t start;
+} SERVER_COV_RECORD;
+
+static SERVER_COV_RECORD Server_COV_Records[BACNET_PLUGIN_SERVER_COV_RECORDS];
+
+static void server_cov_release(SERVER_COV_RECORD *record)
+{
+    if (record->invoke_id) {
+        tsm_free_invoke_id(record->invoke_id);
+        record->invoke_id = 0;
+    }
+}
+
+static bool server_cov_track(
+    BACNET_ADDRESS *src, BACNET_SUBSCRIBE_COV_DATA *data, bool restored)
+{
+    SERVER_COV_RECORD *free_record = NULL;
+    SERVER_COV_RECORD *record;
+    unsigned i;
+
+    for (i = 0; i < BACNET_PLUGIN_SERVER_COV_RECORDS; i++) {
+        record = &Server_COV_Records[i];
+        if (!record->used) {
+            if (!free_record) {
+                free_record = record;
+            }
+            continue;
+        }
+        if (bacnet_address_same(&record->src, src) &&
+            record->data.subscriberProcessIdentifier ==
+                data->subscriberProcessIdentifier &&
+            record->data.monitoredObjectIdentifier.type ==
+                data->monitoredObjectIdentifier.type &&
+            record->data.monitoredObjectIdentifier.instance ==
+                data->monitoredObjectIdentifier.instance) {
+            free_record = record;
+            break;
+        }
+    }
+    if (!free_record) {
+        return false;
+    }
+    server_cov_release(free_record);
+    if (data->cancellationRequest) {
+        free_record->used = false;
+        return false;
+    }
+    free_record->used = true;
+    free_record->restored = restored;
+    free_record->notified = false;
+    free_record->src = *src;
+    free_record->data = *data;
+    free_record->data.next = NULL;
+    free_record->start = time(NULL);
+    return true;
+}
+
+static bool server_cov_expired(const SERVER_COV_RECORD *record, time_t now)
+{
+    return record->data.lifetime > 0 && now > record->start &&
+        (uint32_t)(now - record->start) >= record->data.lifetime;
+}
+
+static bool server_cov_same_object(
+    const SERVER_COV_RECORD *record, const BACNET_OBJECT_ID *object)
+{
+    return record->data.monitoredObjectIdentifier.type == object->type &&
+        record->data.monitoredObjectIdentifier.instance == object->instance;
+}
+
+/* Sends a restored subscriber the object's current values */
+static bool server_cov_notify(SERVER_COV_RECORD *record, time_t now)
+{
+    BACNET_NPDU_DATA npdu_data;
+    BACNET_ADDRESS my_address;
+    BACNET_COV_DATA cov_data;
+    BACNET_PROPERTY_VALUE values[COV_MAX_VALUES];
+    BACNET_OBJECT_ID *object = &record->data.monitoredObjectIdentifier;
+    bool confirmed = record->data.issueConfirmedNotifications;
+    uint8_t buffer[MAX_PDU];
+    uint8_t invoke_id = 0;
+    int pdu_len;
+    int len;
+
+    if (confirmed) {
+        /* One notification in flight per subscriber, as the stack does */
+        if (record->invoke_id) {
+            return false;
+        }
+        invoke_id = tsm_next_free_invokeID();
+        if (!invoke_id) {
+            return false;
+        }
+    }
+    bacapp_property_value_list_init(values, COV_MAX_VALUES);
+    if (!Device_Encode_Value_List(object->type, object->instance, values)) {
+        if (invoke_id) {
+            tsm_free_invoke_id(invoke_id);
+        }
+        return false;
+    }
+    cov_data.subscriberProcessIdentifier =
+        record->data.subscriberProcessIdentifier;
+    cov_data.initiatingDeviceIdentifier = Device_Object_Instance_Number();
+    cov_data.monitoredObjectIdentifier = *object;
+    cov_data.timeRemaining = record->data.lifetime > 0 && now > record->start ?
+        record->data.lifetime - (uint32_t)(now - record->start) :
+        record->data.lifetime;
+    cov_data.listOfValues = values;
+
+    datalink_get_my_address(&my_address);
+    npdu_encode_npdu_data(&npdu_data, confirmed, MESSAGE_PRIORITY_NORMAL);
+    pdu_len = npdu_encode_pdu(buffer, &record->src, &my_address, &npdu_data);
+    if (confirmed) {
+        len = ccov_notify_encode_apdu(&buffer[pdu_len],
+            sizeof(buffer) - pdu_len, invoke_id, &cov_data);
+    } else {
+        len = ucov_notify_encode_apdu(
+            &buffer[pdu_len], sizeof(buffer) - pdu_len, &cov_data);
+    }
+    if (len <= 0) {
+        if (invoke_id) {
+            tsm_free_invoke_id(invoke_id);
+        }
+        return false;
+    }
+    if (confirmed) {
+        /* The TSM retries it and frees the ID when the ack arrives */
+        tsm_set_confirmed_unsegmented_transaction(invoke_id, &record->src,
+            &npdu_data, buffer, (uint16_t)(pdu_len + len));
+        record->invoke_id = invoke_id;
+    }
+    datalink_send_pdu(&record->src, &npdu_data, buffer, pdu_len + len);
+    return true;
+}
+
+/* True if the object's change flag must be cleared here: every restored
+ * subscriber was notified and no subscription the stack holds, whose COV
+ * task would clear it, watches the object */
+static bool server_cov_restored_clear(const BACNET_OBJECT_ID *object,
+    time_t now)
+{
+    const SERVER_COV_RECORD *record;
+    unsigned i;
+
+    for (i = 0; i < BACNET_PLUGIN_SERVER_COV_RECORDS; i++) {
+        record = &Server_COV_Records[i];
+        if (!record->used || !server_cov_same_object(record, object)) {
+            continue;
+        }
+        if (record->restored ? !record->notified :
+                !server_cov_expired(record, now)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void server_cov_restored_task(void)
+{
+    SERVER_COV_RECORD *record;
+    BACNET_OBJECT_ID *object;
+    time_t now = time(NULL);
+    unsigned i;
+
+    for (i = 0; i < BACNET_PLUGIN_SERVER_COV_RECORDS; i++) {
+        record = &Server_COV_Records[i];
+        if (!record->used || !record->restored) {
+            continue;
+        }
+        if (record->invoke_id) {
+            if (tsm_invoke_id_failed(record->invoke_id)) {
+                tsm_free_invoke_id(record->invoke_id);
+                record->invoke_id = 0;
+            } else if (tsm_invoke_id_free(record->invoke_id)) {
+                record->invoke_id = 0;
+            }
+        }
+        if (server_cov_expired(record, now)) {
+            server_cov_release(record);
+            record->used = false;
+            continue;
+        }
+        object = &record->data.monitoredObjectIdentifier;
+        if (!Device_COV(object->type, object->instance)) {
+            record->notified = false;
+        } else if (!record->notified) {
+            record->notified = server_cov_notify(record, now);
+        }
+    }
+    for (i = 0; i < BACNET_PLUGIN_SERVER_COV_RECORDS; i++) {
+        record = &Server_COV_Records[i];
+        if (!record->used || !record->restored || !record->notified) {
+            continue;
+        }
+        object = &record->data.monitoredObjectIdentifier;
+        if (server_cov_restored_clear(object, now)) {
+            Device_COV_Clear(object->type, object->instance);
+        }
+    }
+}
+
+static void bacnet_plugin_cov_subscribe_handler(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_DATA *service_data)
+{
+    BACNET_SUBSCRIBE_COV_DATA data = { 0 };
+
+    handler_cov_subscribe(service_request, service_len, src, service_data);
+    if (cov_subscribe_decode_service_request(
+            service_request, service_len, &data) > 0 &&
+        Device_Valid_Object_Id(data.monitoredObjectIdentifier.type,
+            data.monitoredObjectIdentifier.instance)) {
+        server_cov_track(src, &data, false);
+    }
+}
+
+void bacnet_plugin_server_cov_init(void)
+{
+    if (Server_COV_Enabled) {
+        return;
+    }
+    handler_cov_init();
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_SUBSCRIBE_COV, bacnet_plugin_cov_subscribe_handler);
+    Server_COV_Enabled = true;
+}
+
+void bacnet_plugin_server_cov_task(uint16_t elapsed_milliseconds)
+{
+    if (!Server_COV_Enabled) {
+        return;
+    }
+    Server_COV_Milliseconds += elapsed_milliseconds;
+    if (Server_COV_Milliseconds >= 1000) {
+        handler_cov_timer_seconds(Server_COV_Milliseconds / 1000);
+        Server_COV_Milliseconds %= 1000;
+    }
+    server_cov_restored_task();
+    handler_cov_task();
+}
+
+bool bacnet_plugin_set_cov_increment(
+    uint32_t object_type, uint32_t object_instance, float increment)
+{
+    if (increment < 0.0f) {
+        return false;
+    }
+    switch (object_type) {
+        case OBJECT_ANALOG_INPUT:
+            if (!Analog_Input_Valid_Instance(object_instance)) {
+                return false;
+            }
+            Analog_Input_COV_Increment_Set(object_instance, increment);
+            return true;
+        case OBJECT_ANALOG_VALUE:
+            if (!Analog_Value_Valid_Instance(object_instance)) {
+                return false;
+            }
+            Analog_Value_COV_Increment_Set(object_instance, increment);
+            return true;
+        default:
+            /* Other object types report every change of state */
+            return false;
+    }
+}
+
+/*
+ * Server object database image.
+ *
+ * Layout (all integers big-endian):
+ *   header   "BNSI", u16 version, u16 name length, u32 device instance,
+ *            u32 object count, u32 subscription count, u32 file length,
+ *            then the device name bytes
+ *   object   u16 type, u8 flags, u8 record count, u32 instance,
+ *            then the records; flag 0x01 means Out_Of_Service was TRUE
+ *   record   u32 property, u8 priority (0 for none), u16 length,
+ *            then the application-encoded value
+ *   cov      address (u8 mac_len, mac[7], u16 net, u8 len, adr[7]),
+ *            u16 length, then a SubscribeCOV service request whose
+ *            lifetime is the time that was remaining at snapshot time;
+ *            restored without a reply to the subscriber
+ *
+ * Values are read with Device_Read_Property and restored with
+ * Device_Write_Property, so every object type the stack hosts round-trips
+ * through the same code path a client write takes. Commandable objects
+ * store their priority array slots instead of Present_Value. An object
+ * that was out of service is put out of service before its records are
+ * written, so an input's Present_Value can be restored. The image is
+ * memory-mapped on restore and decoded in a single pass.
+ */
+#define IMAGE_MAGIC "BNSI"
+#define IMAGE_VERSION 1
+#define IMAGE_HEADER_LEN 24
+#define IMAGE_OBJECT_LEN 8
+#define IMAGE_RECORD_LEN 7
+#define IMAGE_ADDRESS_LEN 18
+#define IMAGE_FLAG_OUT_OF_SERVICE 0x01
+#define IMAGE_OBJECT_BUFFER 16384
+
+static const BACNET_PROPERTY_ID Image_Properties[] = {
+    PROP_OBJECT_NAME, PROP_DESCRIPTION, PROP_UNITS, PROP_COV_INCREMENT,
+    PROP_RELINQUISH_DEFAULT
+};
+
+static char Image_Device_Name[MAX_DEV_NAME_LEN + 1];
+static uint8_t Image_Object_Buffer[IMAGE_OBJECT_BUFFER];
+
+static int image_read_property(
+    BACNET_OBJECT_TYPE type,
+    uint32_t instance,
+    BACNET_PROPERTY_ID property,
+    BACNET_ARRAY_INDEX array_index,
+    uint8_t *value,
+    int max_len)
+{
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+
+    rpdata.object_type = type;
+    rpdata.object_instance = instance;
+    rpdata.object_property = property;
+    rpdata.array_index = array_index;
+    rpdata.application_data = value;
+    rpdata.application_data_len = max_len;
+    return Device_Read_Property(&rpdata);
+}
+
+static int image_add_record(
+    uint8_t *buffer,
+    int offset,
+    BACNET_OBJECT_TYPE type,
+    uint32_t instance,
+    BACNET_PROPERTY_ID property,
+    BACNET_ARRAY_INDEX array_index,
+    uint8_t priority)
+{
+    uint8_t *record = &buffer[offset];
+    int max_len = IMAGE_OBJECT_BUFFER - offset - IMAGE_RECORD_LEN;
+    int len;
+
+    if (max_len <= 0) {
+        return 0;
+    }
+    if (max_len > MAX_APDU) {
+        max_len = MAX_APDU;
+    }
+    len = image_read_property(type, instance, property, array_index,
+        &record[IMAGE_RECORD_LEN], max_len);
+    if (len <= 0) {
+        return 0;
+    }
+    if (priority && record[IMAGE_RECORD_LEN] == BACNET_APPLICATION_TAG_NULL) {
+        /* Relinquished slot */
+        return 0;
+    }
+    encode_unsigned32(&record[0], (uint32_t)property);
+    record[4] = priority;
+    encode_unsigned16(&record[5], (uint16_t)len);
+    return IMAGE_RECORD_LEN + len;
+}
+
+static bool image_write_object(
+    FILE *file,
+    BACNET_OBJECT_TYPE type,
+    uint32_t instance,
+    BACNET_PLUGIN_IMAGE_STATS *stats)
+{
+    uint8_t *buffer = Image_Object_Buffer;
+    uint8_t value[MAX_APDU];
+    BACNET_APPLICATION_DATA_VALUE out_of_service;
+    int offset = IMAGE_OBJECT_LEN;
+    int len;
+    uint8_t flags = 0;
+    uint8_t count = 0;
+    uint8_t priority;
+    unsigned i;
+    bool commandable;
+
+    for (i = 0; i < sizeof(Image_Properties) / sizeof(Image_Properties[0]);
+         i++) {
+        len = image_add_record(buffer, offset, type, instance,
+            Image_Properties[i], BACNET_ARRAY_ALL, 0);
+        if (len > 0) {
+            offset += len;
+            count++;
+        }
+    }
+    commandable = image_read_property(type, instance, PROP_PRIORITY_ARRAY, 0,
+                      value, sizeof(value)) > 0;
+    if (commandable) {
+        for (priority = 1; priority <= BACNET_MAX_PRIORITY; priority++) {
+            len = image_add_record(buffer, offset, type, instance,
+                PROP_PRIORITY_ARRAY, priority, priority);
+            if (len > 0) {
+                /* Slots are read from Priority_Array but restored as
+                 * Present_Value writes at their priority */
+                encode_unsigned32(&buffer[offset], PROP_PRESENT_VALUE);
+                offset += len;
+                count++;
+            }
+        }
+    } else {
+        len = image_add_record(buffer, offset, type, instance,
+            PROP_PRESENT_VALUE, BACNET_ARRAY_ALL, 0);
+        if (len > 0) {
+            offset += len;
+            count++;
+        }
+    }
+    /* Out_Of_Service goes last: restore forces it on while writing */
+    len = image_add_record(buffer, offset, type, instance,
+        PROP_OUT_OF_SERVICE, BACNET_ARRAY_ALL, 0);
+    if (len > 0) {
+        if (bacapp_decode_application_data(&buffer[offset + IMAGE_RECORD_LEN],
+                (unsigned)(len - IMAGE_RECORD_LEN), &out_of_service) > 0 &&
+            out_of_service.tag == BACNET_APPLICATION_TAG_BOOLEAN &&
+            out_of_service.type.Boolean) {
+            flags |= IMAGE_FLAG_OUT_OF_SERVICE;
+        }
+        offset += len;
+        count++;
+    }
+
+    encode_unsigned16(&buffer[0], (uint16_t)type);
+    buffer[2] = flags;
+    buffer[3] = count;
+    encode_unsigned32(&buffer[4], instance);
+    stats->objects++;
+    stats->properties += count;
+    return fwrite(buffer, 1, (size_t)offset, file) == (size_t)offset;
+}
+
+static void image_encode_address(uint8_t *out, BACNET_ADDRESS *address)
+{
+    out[0] = address->mac_len;
+    memcpy(&out[1], address->mac, 7);
+    encode_unsigned16(&out[8], address->net);
+    out[10] = address->len;
+    memcpy(&out[11], address->adr, 7);
+}
+
+static void image_decode_address(const uint8_t *in, BACNET_ADDRESS *address)
+{
+    memset(address, 0, sizeof(*address));
+    address->mac_len = in[0] > 7 ? 7 : in[0];
+    memcpy(address->mac, &in[1], 7);
+    decode_unsigned16(&in[8], &address->net);
+    address->len = in[10] > 7 ? 7 : in[10];
+    memcpy(address->adr, &in[11], 7);
+}
+
+static bool image_write_subscriptions(
+    FILE *file, BACNET_PLUGIN_IMAGE_STATS *stats)
+{
+    uint8_t record[IMAGE_ADDRESS_LEN + 2 + MAX_APDU];
+    BACNET_SUBSCRIBE_COV_DATA data;
+    SERVER_COV_RECORD *entry;
+    time_t now = time(NULL);
+    int len;
+    unsigned i;
+
+    for (i = 0; i < BACNET_PLUGIN_SERVER_COV_RECORDS; i++) {
+        entry = &Server_COV_Records[i];
+        if (!entry->used) {
+            continue;
+        }
+        if (server_cov_expired(entry, now)) {
+            server_cov_release(entry);
+            entry->used = false;
+            continue;
+        }
+        data = entry->data;
+        if (data.lifetime > 0 && now > entry->start) {
+            data.lifetime -= (uint32_t)(now - entry->start);
+        }
+        /* Encoded as a full APDU; the 4-byte confirmed header is dropped */
+        len = cov_subscribe_encode_apdu(&record[IMAGE_ADDRESS_LEN + 2 - 4],
+            MAX_APDU + 4, 0, &data);
+        if (len <= 4) {
+            continue;
+        }
+        image_encode_address(record, &entry->src);
+        encode_unsigned16(&record[IMAGE_ADDRESS_LEN], (uint16_t)(len - 4));
+        if (fwrite(record, 1, IMAGE_ADDRESS_LEN + 2 + (size_t)(len - 4),
+                file) != IMAGE_ADDRESS_LEN + 2 + (size_t)(len - 4)) {
+            return false;
+        }
+        stats->subscriptions++;
+    }
+    return true;
+}
+
+int32_t bacnet_plugin_server_snapshot(
+    const char *path, BACNET_PLUGIN_IMAGE_STATS *stats)
+{
+    char tmp_path[1100];
+    uint8_t header[IMAGE_HEADER_LEN];
+    BACNET_CHARACTER_STRING name;
+    BACNET_OBJECT_TYPE type;
+    uint32_t instance;
+    unsigned count;
+    unsigned i;
+    uint16_t name_len = 0;
+    long length;
+    FILE *file;
+    bool ok = true;
+
+    memset(stats, 0, sizeof(*stats));
+    if (strlen(path) > 1024) {
+        return BACNET_PLUGIN_IMAGE_ERROR_IO;
+    }
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    file = fopen(tmp_path, "wb");
+    if (!file) {
+        return BACNET_PLUGIN_IMAGE_ERROR_IO;
+    }
+    if (Device_Object_Name(Device_Object_Instance_Number(), &name)) {
+        name_len = (uint16_t)characterstring_length(&name);
+    }
+    memset(header, 0, sizeof(header));
+    ok = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+        (name_len == 0 ||
+            fwrite(characterstring_value(&name), 1, name_len, file) ==
+                name_len);
+
+    count = Device_Object_List_Count();
+    for (i = 1; ok && i <= count; i++) {
+        if (!Device_Object_List_Identifier(i, &type, &instance) ||
+            type == OBJECT_DEVICE) {
+            continue;
+        }
+        ok = image_write_object(file, type, instance, stats);
+    }
+    ok = ok && image_write_subscriptions(file, stats);
+
+    length = ok ? ftell(file) : -1;
+    if (length > 0) {
+        memcpy(header, IMAGE_MAGIC, 4);
+        encode_unsigned16(&header[4], IMAGE_VERSION);
+        encode_unsigned16(&header[6], name_len);
+        encode_unsigned32(&header[8], Device_Object_Instance_Number());
+        encode_unsigned32(&header[12], stats->objects);
+        encode_unsigned32(&header[16], stats->subscriptions);
+        encode_unsigned32(&header[20], (uint32_t)length);
+        ok = fseek(file, 0, SEEK_SET) == 0 &&
+            fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    } else {
+        ok = false;
+    }
+    ok = fflush(file) == 0 && ok;
+    fclose(file);
+    if (ok) {
+#ifdef _WIN32
+        ok = MoveFileExA(tmp_path, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        ok = rename(tmp_path, path) == 0;
+#endif
+    }
+    if (!ok) {
+        remove(tmp_path);
+        return BACNET_PLUGIN_IMAGE_ERROR_IO;
+    }
+    stats->bytes = (uint32_t)length;
+    return BACNET_PLUGIN_IMAGE_OK;
+}
+
+static bool image_write_value(
+    BACNET_OBJECT_TYPE type,
+    uint32_t instance,
+    BACNET_PROPERTY_ID property,
+    uint8_t priority,
+    const uint8_t *value,
+    uint16_t len)
+{
+    BACNET_WRITE_PROPERTY_DATA wpdata = { 0 };
+
+    if (len > sizeof(wpdata.application_data)) {
+        return false;
+    }
+    wpdata.object_type = type;
+    wpdata.object_instance = instance;
+    wpdata.object_property = property;
+    wpdata.array_index = BACNET_ARRAY_ALL;
+    wpdata.priority = priority ? priority : BACNET_NO_PRIORITY;
+    memcpy(wpdata.application_data, value, len);
+    wpdata.application_data_len = len;
+    return Device_Write_Property(&wpdata);
+}
+
+static const uint8_t *image_map(const char *path, size_t *size)
+{
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+    LARGE_INTEGER file_size;
+    const uint8_t *view = NULL;
+
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        *size = (size_t)file_size.QuadPart;
+    }
+    CloseHandle(file);
+    return view;
+#else
+    struct stat st;
+    void *view;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        return NULL;
+    }
+    *size = (size_t)st.st_size;
+    return (const uint8_t *)view;
+#endif
+}
+
+static void image_unmap(const uint8_t *view, size_t size)
+{
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(view);
+#else
+    munmap((void *)view, size);
+#endif
+}
+
+static int32_t image_restore(
+    const uint8_t *image, size_t size, BACNET_PLUGIN_IMAGE_STATS *stats)
+{
+    static const uint8_t out_of_service_true[] = { 0x11 };
+    BACNET_CREATE_OBJECT_DATA create;
+    BACNET_SUBSCRIBE_COV_DATA data;
+    BACNET_ADDRESS src;
+    BACNET_OBJECT_TYPE type;
+    BACNET_PROPERTY_ID property;
+    uint32_t u32;
+    uint32_t instance;
+    uint32_t object_instance;
+    uint32_t objects;
+    uint32_t subscriptions;
+    uint32_t length;
+    uint16_t u16;
+    uint16_t name_len;
+    uint16_t value_len;
+    uint8_t flags;
+    uint8_t count;
+    uint8_t priority;
+    size_t offset;
+    uint32_t i;
+
+    if (size < IMAGE_HEADER_LEN || memcmp(image, IMAGE_MAGIC, 4) != 0) {
+        return BACNET_PLUGIN_IMAGE_ERROR_FORMAT;
+    }
+    decode_unsigned16(&image[4], &u16);
+    if (u16 != IMAGE_VERSION) {
+        return BACNET_PLUGIN_IMAGE_ERROR_VERSION;
+    }
+    decode_unsigned16(&image[6], &name_len);
+    decode_unsigned32(&image[8], &instance);
+    decode_unsigned32(&image[12], &objects);
+    decode_unsigned32(&image[16], &subscriptions);
+    decode_unsigned32(&image[20], &length);
+    if (length != size || IMAGE_HEADER_LEN + (size_t)name_len > size ||
+        name_len > MAX_DEV_NAME_LEN) {
+        return BACNET_PLUGIN_IMAGE_ERROR_FORMAT;
+    }
+
+    /* The same steps as InitServer, from the image */
+    memcpy(Image_Device_Name, &image[IMAGE_HEADER_LEN], name_len);
+    Image_Device_Name[name_len] = '\0';
+    Device_Set_Object_Instance_Number(instance);
+    Device_Object_Name_ANSI_Init(Image_Device_Name);
+    Device_Init(NULL);
+    bacnet_plugin_server_cov_init();
+    bacnet_plugin_server_iam_init();
+
+    offset = IMAGE_HEADER_LEN + name_len;
+    for (i = 0; i < objects; i++) {
+        if (offset + IMAGE_OBJECT_LEN > size) {
+            return BACNET_PLUGIN_IMAGE_ERROR_FORMAT;
+        }
+        decode_unsigned16(&image[offset], &u16);
+        type = (BACNET_OBJECT_TYPE)u16;
+        flags = image[offset + 2];
+        count = image[offset + 3];
+        decode_unsigned32(&image[offset + 4], &object_instance);
+        offset += IMAGE_OBJECT_LEN;
+
+        if (!Device_Valid_Object_Id(type, object_instance)) {
+            memset(&create, 0, sizeof(create));
+            create.object_type = type;
+            create.object_instance = object_instance;
+            Device_Create_Object(&create);
+        }
+        if (flags & IMAGE_FLAG_OUT_OF_SERVICE) {
+            /* Lets Present_Value be written; the stored value comes last
+             * and is TRUE as well */
+            image_write_value(type, object_instance, PROP_OUT_OF_SERVICE, 0,
+                out_of_service_true, sizeof(out_of_service_true));
+        }
+        for (; count > 0; count--) {
+            if (offset + IMAGE_RECORD_LEN > size) {
+                return BACNET_PLUGIN_IMAGE_ERROR_FORMAT;
+            }
+            decode_unsigned32(&image[offset], &u32);
+            property = (BACNET_PROPERTY_ID)u32;
+            priority = image[offset + 4];
+            decode_unsigned16(&image[offset + 5], &value_len);
+            offset += IMAGE_RECORD_LEN;
+            if (offset + value_len > size) {
+                return BACNET_PLUGIN_IMAGE_ERROR_FORMAT;
+            }
+            if (image_write_value(type, object_instance, property,
+                    priority, &image[offset], value_len)) {
+                stats->properties++;
+            } else {
+                stats->skipped++;
+            }
+            offset += value_len;
+        }
+        stats->objects++;
+    }
+
+    for (i = 0; i < subscriptions; i++) {
+        if (offset + IMAGE_ADDRESS_LEN + 2 > size) {
+            return BACNET_PLUGIN_IMAGE_ERROR_FORMAT;
+        }
+        image_decode_address(&image[offset], &src);
+        decode_unsigned16(&image[offset + IMAGE_ADDRESS_LEN], &value_len);
+        offset += IMAGE_ADDRESS_LEN + 2;
+        if (offset + value_len > size || value_len > MAX_APDU) {
+            return BACNET_PLUGIN_IMAGE_ERROR_FORMAT;
+        }
+        /* Kept off the stack's handler, which would acknowledge it to
+         * the subscriber; see server_cov_restored_task */
+        memcpy(Image_Object_Buffer, &image[offset], value_len);
+        memset(&data, 0, sizeof(data));
+        if (cov_subscribe_decode_service_request(
+                Image_Object_Buffer, value_len, &data) > 0 &&
+            Device_Valid_Object_Id(data.monitoredObjectIdentifier.type,
+                data.monitoredObjectIdentifier.instance) &&
+            server_cov_track(&src, &data, true)) {
+            stats->subscriptions++;
+        }
+        offset += value_len;
+    }
+    stats->bytes = (uint32_t)size;
+    return BACNET_PLUGIN_IMAGE_OK;
+}
+
+int32_t bacnet_plugin_server_restore(
+    const char *path, BACNET_PLUGIN_IMAGE_STATS *stats)
+{
+    const uint8_t *image;
+    size_t size = 0;
+    int32_t status;
+
+    memset(stats, 0, sizeof(*stats));
+    image = image_map(path, &size);
+    if (!image) {
+        return BACNET_PLUGIN_IMAGE_ERROR_IO;
+    }
+    status = image_restore(image, size, stats);
+    image_unmap(image, size);
+    return status;
+}
+
+/*
+ * Server I-Am pacing.
+ *
+ * Who-Is requests for the hosted device are answered after a random delay
+ * of up to Server_IAm_Max_Delay_Ms, so that devices answering the same
+ * broadcast spread out instead of replying in the same instant. Only one
+ * I-Am is pending at a time; further matching Who-Is requests are folded
+ * into it. A token bucket caps the I-Am rate of the port, and requests
+ * arriving while it is empty are dropped. The delay is driven by
+ * bacnet_plugin_server_iam_task from the worker's poll tick.
+ */
+static bool Server_IAm_Enabled = false;
+static bool Server_IAm_Pending = false;
+static uint16_t Server_IAm_Max_Delay_Ms = 500;
+static uint16_t Server_IAm_Max_Per_Second = 5;
+static uint32_t Server_IAm_Due_Ms;
+static uint32_t Server_IAm_Waited_Ms;
+static uint32_t Server_IAm_Tokens_Ms; /* tokens scaled by 1000 */
+static BACNET_PLUGIN_IAM_STATS Server_IAm_Stats;
+static uint8_t Server_IAm_Buffer[MAX_PDU];
+
+static uint32_t server_iam_random_delay(void)
+{
+    if (Server_IAm_Max_Delay_Ms == 0) {
+        return 0;
+    }
+    return (uint32_t)rand() % ((uint32_t)Server_IAm_Max_Delay_Ms + 1);
+}
+
+static void server_iam_send(void)
+{
+    BACNET_ADDRESS dest;
+    BACNET_NPDU_DATA npdu_data;
+    int pdu_len;
+    int sent;
+
+    datalink_get_broadcast_address(&dest);
+    pdu_len = iam_encode_pdu(Server_IAm_Buffer, &dest, &npdu_data);
+    sent = pdu_len > 0 ?
+        datalink_send_pdu(&dest, &npdu_data, Server_IAm_Buffer, pdu_len) :
+        -1;
+    if (sent <= 0) {
+        Server_IAm_Stats.send_failed++;
+        return;
+    }
+    Server_IAm_Stats.sent++;
+    Server_IAm_Stats.delay_total_ms += Server_IAm_Waited_Ms;
+    if (Server_IAm_Stats.sent == 1 ||
+        Server_IAm_Waited_Ms < Server_IAm_Stats.delay_min_ms) {
+        Server_IAm_Stats.delay_min_ms = Server_IAm_Waited_Ms;
+    }
+    if (Server_IAm_Waited_Ms > Server_IAm_Stats.delay_max_ms) {
+        Server_IAm_Stats.delay_max_ms = Server_IAm_Waited_Ms;
+    }
+}
+
+static void bacnet_plugin_who_is_handler(
+    uint8_t *service_request, uint16_t service_len, BACNET_ADDRESS *src)
+{
+    int32_t low_limit = 0;
+    int32_t high_limit = 0;
+    uint32_t instance = Device_Object_Instance_Number();
+    int len;
+
+    (void)src;
+    Server_IAm_Stats.who_is_received++;
+    len = whois_decode_service_request(
+        service_request, service_len, &low_limit, &high_limit);
+    if (len < 0) {
+        return;
+    }
+    if (len > 0 &&
+        (instance < (uint32_t)low_limit || instance > (uint32_t)high_limit)) {
+        return;
+    }
+    if (Server_IAm_Pending) {
+        Server_IAm_Stats.coalesced++;
+        return;
+    }
+    if (Server_IAm_Tokens_Ms < 1000) {
+        Server_IAm_Stats.dropped++;
+        return;
+    }
+    Server_IAm_Tokens_Ms -= 1000;
+    Server_IAm_Pending = true;
+    Server_IAm_Waited_Ms = 0;
+    Server_IAm_Due_Ms = server_iam_random_delay();
+    if (Server_IAm_Due_Ms == 0) {
+        Server_IAm_Pending = false;
+        server_iam_send();
+    }
+}
+
+void bacnet_plugin_server_iam_init(void)
+{
+    if (Server_IAm_Enabled) {
+        return;
+    }
+    srand((unsigned)time(NULL) ^ Device_Object_Instance_Number());
+    Server_IAm_Tokens_Ms = (uint32_t)Server_IAm_Max_Per_Second * 1000;
+    apdu_set_unconfirmed_handler(
+        SERVICE_UNCONFIRMED_WHO_IS, bacnet_plugin_who_is_handler);
+    Server_IAm_Enabled = true;
+}
+
+void bacnet_plugin_server_iam_configure(
+    uint16_t max_delay_ms, uint16_t max_per_second)
+{
+    Server_IAm_Max_Delay_Ms = max_delay_ms;
+    Server_IAm_Max_Per_Second = max_per_second ? max_per_second : 1;
+    if (Server_IAm_Tokens_Ms > (uint32_t)Server_IAm_Max_Per_Second * 1000) {
+        Server_IAm_Tokens_Ms = (uint32_t)Server_IAm_Max_Per_Second * 1000;
+    }
+}
+
+void bacnet_plugin_server_iam_task(uint16_t elapsed_milliseconds)
+{
+    uint32_t capacity;
+
+    if (!Server_IAm_Enabled) {
+        return;
+    }
+    /* Refill max_per_second tokens per second, up to one second's worth */
+    capacity = (uint32_t)Server_IAm_Max_Per_Second * 1000;
+    Server_IAm_Tokens_Ms +=
+        (uint32_t)elapsed_milliseconds * Server_IAm_Max_Per_Second;
+    if (Server_IAm_Tokens_Ms > capacity) {
+        Server_IAm_Tokens_Ms = capacity;
+    }
+    if (!Server_IAm_Pending) {
+        return;
+    }
+    Server_IAm_Waited_Ms += elapsed_milliseconds;
+    if (Server_IAm_Waited_Ms >= Server_IAm_Due_Ms) {
+        Server_IAm_Pending = false;
+        server_iam_send();
+    }
+}
+
+void bacnet_plugin_server_iam_stats(BACNET_PLUGIN_IAM_STATS *stats)
+{
+    *stats = Server_IAm_Stats;
+}
+
+
+/*
+ * MS/TP datalink.
+ *
+ * Builds with BACDL_MSTP (Linux, see linux/CMakeLists.txt) link the stack's
+ * MS/TP master node and serial driver next to BACnet/IP; BACDL_MULTIPLE
+ * routes datalink_send_pdu to whichever one was initialized last. The node
+ * state machine runs on the driver's own thread, so the worker only queues
+ * PDUs and polls bacnet_plugin_safe_bip_receive as it does for BACnet/IP.
+ *
+ * With the stack's default Nmax_info_frames of 1 a node sends one frame
+ * per token and every other queued PDU waits a full token rotation. The
+ * worker issues requests in bursts (RPM batches, polls), so
+ * max_info_frames lets one token hold drain up to that many queued PDUs;
+ * the queue itself is MSTP_PDU_PACKET_COUNT deep.
+ */
+bool bacnet_plugin_mstp_init(
+    const char *port,
+    uint32_t baud_rate,
+    uint8_t mac_address,
+    uint8_t max_master,
+    uint8_t max_info_frames)
+{
+#if defined(BACDL_MSTP)
+    bool result = false;
+
+    if (!port || mac_address > 127 || max_master > 127 ||
+        mac_address > max_master || max_info_frames == 0) {
+        return false;
+    }
+    bacnet_plugin_datalink_cleanup();
+    /* The driver applies the rate when dlmstp_init opens the port */
+    dlmstp_set_baud_rate(baud_rate);
+    PLUGIN_TRY {
+        g_jmp_active = true;
+        if (setjmp(g_exit_jmp) == 0) {
+            datalink_set("mstp");
+            result = dlmstp_init((char *)port);
+        } else {
+            plugin_debug_log("BACnet mstp_init: Intercepted exit()\n");
+            result = false;
+        }
+    } PLUGIN_EXCEPT {
+        plugin_debug_log("BACnet mstp_init: Caught Access Violation/Crash!\n");
+        result = false;
+    }
+    g_jmp_active = false;
+    if (result) {
+        /* Set after init: MSTP_Init resets the node to the defaults */
+        dlmstp_set_mac_address(mac_address);
+        dlmstp_set_max_master(max_master);
+        dlmstp_set_max_info_frames(max_info_frames);
+        Datalink_Mstp_Active = true;
+    }
+    return result;
+#else
+    (void)port;
+    (void)baud_rate;
+    (void)mac_address;
+    (void)max_master;
+    (void)max_info_frames;
+    return false;
+#endif
+}
+
+void bacnet_plugin_datalink_cleanup(void)
+{
+#if defined(BACDL_MSTP)
+    if (Datalink_Mstp_Active) {
+        dlmstp_cleanup();
+        Datalink_Mstp_Active = false;
+        return;
+    }
+#endif
+    bip_cleanup();
+}
+
+bool bacnet_plugin_mstp_stats(BACNET_PLUGIN_MSTP_STATS *stats)
+{
+#if defined(BACDL_MSTP)
+    struct dlmstp_statistics counters = { 0 };
+
+    memset(stats, 0, sizeof(*stats));
+    if (!Datalink_Mstp_Active) {
+        return false;
+    }
+    dlmstp_fill_statistics(&counters);
+    stats->baud_rate = dlmstp_baud_rate();
+    stats->mac_address = dlmstp_mac_address();
+    stats->max_info_frames = dlmstp_max_info_frames();
+    stats->transmit_frames = counters.transmit_frame_counter;
+    stats->receive_valid_frames = counters.receive_valid_frame_counter;
+    stats->receive_invalid_frames = counters.receive_invalid_frame_counter;
+    stats->transmit_pdus = counters.transmit_pdu_counter;
+    stats->receive_pdus = counters.receive_pdu_counter;
+    stats->lost_tokens = counters.lost_token_counter;
+    return true;
+#else
+    memset(stats, 0, sizeof(*stats));
+    return false;
+#endif
+}
+
+/*
+ * Write journal: an append-only, group-committed record of every write the
+ * server accepts and every write the client sends.
+ *
+ * Records are appended to an in-memory batch on the stack thread and never
+ * wait on the disk. A committer thread takes the batch every commit
+ * interval, or as soon as it is half full, writes it with one fwrite and
+ * makes it durable with one fdatasync, so a burst of writes shares a single
+ * flush. When the batch is full the stack thread waits for the committer
+ * to swap batches rather than lose the record, and counts the stall. A
+ * write that cannot be journaled at all is refused: an outgoing write is
+ * not sent and an incoming one is answered with an error. Room for an
+ * outgoing write is made before it is sent, so the record appended once
+ * its invoke ID is known always fits. Files rotate to path.1 ... path.N once they
+ * pass max_file_bytes. A batch that cannot be written or synced is not
+ * retried: its records are counted as lost and bacnet_plugin_journal_sync
+ * returns false from then on, until the journal is reopened.
+ *
+ * File: "BPWJ", version (u16), record header length (u16). Record, all
+ * fields big-endian: length (u16, whole record), kind (u8), priority (u8),
+ * UTC seconds (u32), milliseconds (u16), invoke ID (u8), reserved (u8),
+ * device (u32), object type (u16), instance (u32), property (u32), array
+ * index (u32), value length (u16), application-encoded value, then the
+ * CRC-32 of everything before it (u32).
+ */
+#ifdef _WIN32
+#include <io.h>
+#endif
+
+#define JOURNAL_MAGIC "BPWJ"
+#define JOURNAL_VERSION 1
+#define JOURNAL_FILE_HEADER_LEN 8
+#define JOURNAL_RECORD_HEADER_LEN 32
+#define JOURNAL_RECORD_LEN(value_len) \
+    (JOURNAL_RECORD_HEADER_LEN + (uint32_t)(value_len) + 4)
+#define JOURNAL_RECORD_MAX JOURNAL_RECORD_LEN(MAX_APDU)
+#define JOURNAL_PATH_MAX 512
+
+static FILE *Journal_File;
+static char Journal_Path[JOURNAL_PATH_MAX];
+static uint32_t Journal_Max_File_Bytes;
+static uint8_t Journal_Keep_Files;
+static uint16_t Journal_Commit_Interval_Ms;
+static uint32_t Journal_File_Bytes;
+
+/* Batch being filled by the stack thread and the one being committed */
+static uint8_t *Journal_Active;
+static uint8_t *Journal_Committing;
+static uint32_t Journal_Capacity;
+static uint32_t Journal_Active_Len;
+static uint32_t Journal_Active_Records;
+static uint64_t Journal_Appended;
+/* Last record of the last batch committed, whether or not it reached disk */
+static uint64_t Journal_Committed;
+/* Last record of the last batch that failed; sticky until reopened */
+static uint64_t Journal_Lost;
+static bool Journal_Open;
+static bool Journal_Stopping;
+static bool Journal_Sync_Requested;
+static BACNET_PLUGIN_JOURNAL_STATS Journal_Stats;
+
+#ifdef _WIN32
+static CRITICAL_SECTION Journal_Lock;
+static CONDITION_VARIABLE Journal_Wake;
+static CONDITION_VARIABLE Journal_Done;
+static HANDLE Journal_Thread;
+static INIT_ONCE Journal_Lock_Once = INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK journal_lock_init(PINIT_ONCE once, PVOID arg, PVOID *ctx)
+{
+    (void)once;
+    (void)arg;
+    (void)ctx;
+    InitializeCriticalSection(&Journal_Lock);
+    InitializeConditionVariable(&Journal_Wake);
+    InitializeConditionVariable(&Journal_Done);
+    return TRUE;
+}
+
+static void journal_lock(void)
+{
+    InitOnceExecuteOnce(&Journal_Lock_Once, journal_lock_init, NULL, NULL);
+    EnterCriticalSection(&Journal_Lock);
+}
+
+static void journal_unlock(void)
+{
+    LeaveCriticalSection(&Journal_Lock);
+}
+
+/* Waits on cv with the lock held; 0 ms waits until signalled */
+static void journal_wait(CONDITION_VARIABLE *cv, unsigned ms)
+{
+    SleepConditionVariableCS(&Journal_Lock, cv, ms ? ms : INFINITE);
+}
+
+static void journal_signal(CONDITION_VARIABLE *cv)
+{
+    WakeAllConditionVariable(cv);
+}
+
+static int journal_sync_file(FILE *file)
+{
+    return _commit(_fileno(file));
+}
+#else
+static pthread_mutex_t Journal_Lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t Journal_Wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t Journal_Done = PTHREAD_COND_INITIALIZER;
+static pthread_t Journal_Thread;
+
+static void journal_lock(void)
+{
+    pthread_mutex_lock(&Journal_Lock);
+}
+
+static void journal_unlock(void)
+{
+    pthread_mutex_unlock(&Journal_Lock);
+}
+
+/* Waits on cv with the lock held; 0 ms waits until signalled */
+static void journal_wait(pthread_cond_t *cv, unsigned ms)
+{
+    struct timespec deadline;
+
+    if (ms == 0) {
+        pthread_cond_wait(cv, &Journal_Lock);
+        return;
+    }
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(cv, &Journal_Lock, &deadline);
+}
+
+static void journal_signal(pthread_cond_t *cv)
+{
+    pthread_cond_broadcast(cv);
+}
+
+static int journal_sync_file(FILE *file)
+{
+#if defined(__APPLE__)
+    return fsync(fileno(file));
+#else
+    return fdatasync(fileno(file));
+#endif
+}
+#endif
+
+static uint32_t journal_crc32(const uint8_t *data, size_t len)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    size_t i;
+    int bit;
+
+    for (i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+static uint64_t journal_now_us(void)
+{
+    struct timespec now;
+
+    timespec_get(&now, TIME_UTC);
+    return (uint64_t)now.tv_sec * 1000000u + (uint64_t)now.tv_nsec / 1000u;
+}
+
+/* Opens Journal_Path for appending, writing the header to a new file */
+static bool journal_open_file(void)
+{
+    uint8_t header[JOURNAL_FILE_HEADER_LEN];
+    long size;
+
+    Journal_File = fopen(Journal_Path, "ab");
+    if (!Journal_File) {
+        return false;
+    }
+    fseek(Journal_File, 0, SEEK_END);
+    size = ftell(Journal_File);
+    Journal_File_Bytes = size > 0 ? (uint32_t)size : 0;
+    if (Journal_File_Bytes == 0) {
+        memcpy(header, JOURNAL_MAGIC, 4);
+        encode_unsigned16(&header[4], JOURNAL_VERSION);
+        encode_unsigned16(&header[6], JOURNAL_RECORD_HEADER_LEN);
+        if (fwrite(header, 1, sizeof(header), Journal_File) !=
+            sizeof(header)) {
+            fclose(Journal_File);
+            Journal_File = NULL;
+            return false;
+        }
+        Journal_File_Bytes = sizeof(header);
+    }
+    return true;
+}
+
+/* Shifts path.N-1 .. path to path.N .. path.1 and starts a new file */
+static bool journal_rotate(void)
+{
+    char from[JOURNAL_PATH_MAX + 8];
+    char to[JOURNAL_PATH_MAX + 8];
+    unsigned i;
+
+    fclose(Journal_File);
+    Journal_File = NULL;
+    for (i = Journal_Keep_Files; i > 0; i--) {
+        if (i == 1) {
+            snprintf(from, sizeof(from), "%s", Journal_Path);
+        } else {
+            snprintf(from, sizeof(from), "%s.%u", Journal_Path, i - 1);
+        }
+        snprintf(to, sizeof(to), "%s.%u", Journal_Path, i);
+        remove(to);
+        rename(from, to);
+    }
+    if (Journal_Keep_Files == 0) {
+        remove(Journal_Path);
+    }
+    return journal_open_file();
+}
+
+#ifdef _WIN32
+static DWORD WINAPI journal_committer(LPVOID arg)
+#else
+static void *journal_committer(void *arg)
+#endif
+{
+    uint8_t *batch;
+    uint32_t len;
+    uint32_t records;
+    uint64_t sequence;
+    uint64_t started;
+    uint32_t elapsed;
+    bool rotated;
+    bool ok;
+
+    (void)arg;
+    journal_lock();
+    for (;;) {
+        while (Journal_Active_Len == 0 && !Journal_Stopping) {
+            journal_wait(&Journal_Wake, 0);
+        }
+        if (Journal_Active_Len == 0) {
+            break;
+        }
+        /* Let the batch grow for one interval unless someone is waiting */
+        if (!Journal_Stopping && !Journal_Sync_Requested &&
+            Journal_Active_Len < Journal_Capacity / 2) {
+            journal_wait(&Journal_Wake, Journal_Commit_Interval_Ms);
+        }
+        batch = Journal_Active;
+        len = Journal_Active_Len;
+        records = Journal_Active_Records;
+        sequence = Journal_Appended;
+        Journal_Active = Journal_Committing;
+        Journal_Committing = batch;
+        Journal_Active_Len = 0;
+        Journal_Active_Records = 0;
+        Journal_Sync_Requested = false;
+        /* The new active batch is empty: a stalled append need not wait
+         * for this one to reach disk */
+        journal_signal(&Journal_Done);
+        journal_unlock();
+
+        started = journal_now_us();
+        /* Retry a file that could not be reopened after rotation */
+        ok = (Journal_File || journal_open_file()) &&
+            fwrite(batch, 1, len, Journal_File) == len &&
+            fflush(Journal_File) == 0 &&
+            journal_sync_file(Journal_File) == 0;
+        elapsed = (uint32_t)(journal_now_us() - started);
+        rotated = false;
+        if (ok) {
+            Journal_File_Bytes += len;
+            if (Journal_Max_File_Bytes &&
+                Journal_File_Bytes >= Journal_Max_File_Bytes) {
+                rotated = true;
+                ok = journal_rotate();
+            }
+        }
+
+        journal_lock();
+        if (rotated) {
+            Journal_Stats.rotations++;
+        }
+        if (ok) {
+            Journal_Stats.bytes += len;
+        } else {
+            Journal_Stats.write_errors++;
+            Journal_Stats.lost_records += records;
+            Journal_Lost = sequence;
+        }
+        Journal_Stats.commits++;
+        Journal_Stats.last_commit_us = elapsed;
+        if (elapsed > Journal_Stats.max_commit_us) {
+            Journal_Stats.max_commit_us = elapsed;
+        }
+        if (records > Journal_Stats.max_batch_records) {
+            Journal_Stats.max_batch_records = records;
+        }
+        /* Failed batches are released too, so waiters never hang; they
+         * learn of the loss from Journal_Lost */
+        Journal_Committed = sequence;
+        journal_signal(&Journal_Done);
+    }
+    journal_unlock();
+#ifdef _WIN32
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+bool bacnet_plugin_journal_open(
+    const char *path,
+    uint32_t max_file_bytes,
+    uint8_t keep_files,
+    uint16_t commit_interval_ms,
+    uint32_t buffer_bytes)
+{
+    bool started;
+
+    if (!path || strlen(path) >= JOURNAL_PATH_MAX ||
+        buffer_bytes < 2 * JOURNAL_RECORD_MAX) {
+        return false;
+    }
+    /* Reopening, e.g. after a worker restart, commits the old file first */
+    bacnet_plugin_journal_close();
+
+    snprintf(Journal_Path, sizeof(Journal_Path), "%s", path);
+    Journal_Max_File_Bytes = max_file_bytes;
+    Journal_Keep_Files = keep_files;
+    Journal_Commit_Interval_Ms = commit_interval_ms ? commit_interval_ms : 1;
+    Journal_Active = malloc(buffer_bytes);
+    Journal_Committing = malloc(buffer_bytes);
+    if (!Journal_Active || !Journal_Committing || !journal_open_file()) {
+        free(Journal_Active);
+        free(Journal_Committing);
+        Journal_Active = NULL;
+        Journal_Committing = NULL;
+        return false;
+    }
+
+    journal_lock();
+    Journal_Capacity = buffer_bytes;
+    Journal_Active_Len = 0;
+    Journal_Active_Records = 0;
+    Journal_Appended = 0;
+    Journal_Committed = 0;
+    Journal_Lost = 0;
+    Journal_Stopping = false;
+    Journal_Sync_Requested = false;
+    memset(&Journal_Stats, 0, sizeof(Journal_Stats));
+    journal_unlock();
+
+#ifdef _WIN32
+    Journal_Thread = CreateThread(NULL, 0, journal_committer, NULL, 0, NULL);
+    started = Journal_Thread != NULL;
+#else
+    started = pthread_create(
+        &Journal_Thread, NULL, journal_committer, NULL) == 0;
+#endif
+    if (!started) {
+        fclose(Journal_File);
+        Journal_File = NULL;
+        free(Journal_Active);
+        free(Journal_Committing);
+        Journal_Active = NULL;
+        Journal_Committing = NULL;
+        return false;
+    }
+    Journal_Open = true;
+    return true;
+}
+
+bool bacnet_plugin_journal_sync(uint32_t timeout_ms)
+{
+    uint64_t target;
+    uint64_t deadline;
+    bool durable;
+
+    if (!Journal_Open) {
+        return false;
+    }
+    deadline = journal_now_us() + (uint64_t)timeout_ms * 1000u;
+    journal_lock();
+    target = Journal_Appended;
+    if (Journal_Committed < target) {
+        Journal_Sync_Requested = true;
+        journal_signal(&Journal_Wake);
+    }
+    while (Journal_Committed < target && journal_now_us() < deadline) {
+        journal_wait(&Journal_Done,
+            (unsigned)((deadline - journal_now_us()) / 1000u) + 1);
+    }
+    /* A lost batch means not everything appended so far is on disk */
+    durable = Journal_Committed >= target && Journal_Lost == 0;
+    journal_unlock();
+    return durable;
+}
+
+void bacnet_plugin_journal_close(void)
+{
+    if (!Journal_Open) {
+        return;
+    }
+    journal_lock();
+    Journal_Open = false;
+    Journal_Stopping = true;
+    journal_signal(&Journal_Wake);
+    journal_unlock();
+    /* The committer drains what is left before it returns */
+#ifdef _WIN32
+    WaitForSingleObject(Journal_Thread, INFINITE);
+    CloseHandle(Journal_Thread);
+#else
+    pthread_join(Journal_Thread, NULL);
+#endif
+    if (Journal_File) {
+        fclose(Journal_File);
+        Journal_File = NULL;
+    }
+    free(Journal_Active);
+    free(Journal_Committing);
+    Journal_Active = NULL;
+    Journal_Committing = NULL;
+}
+
+/*
+ * Waits, with the lock held, until the active batch has room for len
+ * bytes. Returns false if it never will: len is more than a whole batch,
+ * or the journal was closed while waiting.
+ */
+static bool journal_wait_for_room(uint32_t len)
+{
+    if (len > Journal_Capacity) {
+        return false;
+    }
+    if (Journal_Open && Journal_Active_Len + len > Journal_Capacity) {
+        Journal_Stats.stalls++;
+    }
+    while (Journal_Open && Journal_Active_Len + len > Journal_Capacity) {
+        /* Have the committer swap now instead of after its interval */
+        Journal_Sync_Requested = true;
+        journal_signal(&Journal_Wake);
+        journal_wait(&Journal_Done, 0);
+    }
+    return Journal_Open;
+}
+
+/*
+ * Makes room for bytes of records before the write they describe is sent.
+ * Returns false, counting the write as refused, if the journal is open but
+ * can never hold them.
+ */
+static bool journal_make_room(uint32_t bytes)
+{
+    bool ok;
+
+    if (!Journal_Open) {
+        return true;
+    }
+    journal_lock();
+    /* Closing while waiting leaves nothing to record */
+    ok = journal_wait_for_room(bytes) || !Journal_Open;
+    if (!ok) {
+        Journal_Stats.refused++;
+    }
+    journal_unlock();
+    return ok;
+}
+
+bool bacnet_plugin_journal_append(
+    uint8_t kind,
+    uint8_t invoke_id,
+    uint32_t device_id,
+    uint16_t object_type,
+    uint32_t object_instance,
+    uint32_t property,
+    uint32_t array_index,
+    uint8_t priority,
+    const uint8_t *value,
+    uint16_t value_len)
+{
+    struct timespec now;
+    uint8_t *record;
+    uint32_t len;
+
+    if (!Journal_Open) {
+        return false;
+    }
+    len = JOURNAL_RECORD_LEN(value_len);
+    journal_lock();
+    if (!Journal_Open) {
+        journal_unlock();
+        return false;
+    }
+    if (value_len > MAX_APDU || !journal_wait_for_room(len)) {
+        Journal_Stats.refused++;
+        journal_unlock();
+        return false;
+    }
+    /* Stamped after any wait, so the time is when the write was recorded */
+    timespec_get(&now, TIME_UTC);
+    record = &Journal_Active[Journal_Active_Len];
+    encode_unsigned16(&record[0], (uint16_t)len);
+    record[2] = kind;
+    record[3] = priority;
+    encode_unsigned32(&record[4], (uint32_t)now.tv_sec);
+    encode_unsigned16(&record[8], (uint16_t)(now.tv_nsec / 1000000L));
+    record[10] = invoke_id;
+    record[11] = 0;
+    encode_unsigned32(&record[12], device_id);
+    encode_unsigned16(&record[16], object_type);
+    encode_unsigned32(&record[18], object_instance);
+    encode_unsigned32(&record[22], property);
+    encode_unsigned32(&record[26], array_index);
+    encode_unsigned16(&record[30], value_len);
+    if (value_len) {
+        memcpy(&record[JOURNAL_RECORD_HEADER_LEN], value, value_len);
+    }
+    encode_unsigned32(&record[len - 4], journal_crc32(record, len - 4));
+    Journal_Active_Len += len;
+    Journal_Active_Records++;
+    Journal_Appended++;
+    Journal_Stats.records++;
+    if (Journal_Active_Len >= Journal_Capacity / 2 ||
+        Journal_Active_Records == 1) {
+        journal_signal(&Journal_Wake);
+    }
+    journal_unlock();
+    return true;
+}
+
+void bacnet_plugin_journal_stats(BACNET_PLUGIN_JOURNAL_STATS *stats)
+{
+    journal_lock();
+    *stats = Journal_Stats;
+    stats->open = Journal_Open;
+    journal_unlock();
+}
+
+/* Encodes value for the journal; an unencodable value is recorded empty */
+static uint16_t journal_encode(
+    uint8_t *encoded,
+    BACNET_APPLICATION_DATA_VALUE *value)
+{
+    int len = bacapp_encode_application_data(encoded, value);
+
+    return len > 0 ? (uint16_t)len : 0;
+}
+
+static void journal_value(
+    uint8_t kind,
+    uint8_t invoke_id,
+    uint32_t device_id,
+    uint16_t object_type,
+    uint32_t object_instance,
+    uint32_t property,
+    uint32_t array_index,
+    uint8_t priority,
+    BACNET_APPLICATION_DATA_VALUE *value)
+{
+    uint8_t encoded[MAX_APDU];
+
+    if (!Journal_Open) {
+        return;
+    }
+    bacnet_plugin_journal_append(kind, invoke_id, device_id, object_type,
+        object_instance, property, array_index, priority, encoded,
+        journal_encode(encoded, value));
+}
+
+static uint32_t journal_write_access_len(
+    BACNET_WRITE_ACCESS_DATA *write_access_data)
+{
+    uint8_t encoded[MAX_APDU];
+    BACNET_WRITE_ACCESS_DATA *object;
+    BACNET_PROPERTY_VALUE *pv;
+    uint32_t total = 0;
+
+    if (!Journal_Open) {
+        return 0;
+    }
+    for (object = write_access_data; object; object = object->next) {
+        for (pv = object->listOfProperties; pv; pv = pv->next) {
+            total += JOURNAL_RECORD_LEN(journal_encode(encoded, &pv->value));
+        }
+    }
+    return total;
+}
+
+static void journal_write_access(
+    uint8_t invoke_id,
+    uint32_t device_id,
+    BACNET_WRITE_ACCESS_DATA *write_access_data)
+{
+    BACNET_WRITE_ACCESS_DATA *object;
+    BACNET_PROPERTY_VALUE *pv;
+
+    for (object = write_access_data; object; object = object->next) {
+        for (pv = object->listOfProperties; pv; pv = pv->next) {
+            journal_value(BACNET_PLUGIN_JOURNAL_OUTGOING_WPM, invoke_id,
+                device_id, (uint16_t)object->object_type,
+                object->object_instance, pv->propertyIdentifier,
+                pv->propertyArrayIndex, pv->priority, &pv->value);
+        }
+    }
+}
+
+/* Journals each accepted server write before handing it to Dart */
+static write_property_function Write_Store_Next;
+
+static bool bacnet_plugin_write_store_hook(
+    BACNET_WRITE_PROPERTY_DATA *wp_data)
+{
+    if (Journal_Open &&
+        !bacnet_plugin_journal_append(BACNET_PLUGIN_JOURNAL_INCOMING_WRITE, 0,
+            Device_Object_Instance_Number(), (uint16_t)wp_data->object_type,
+            wp_data->object_instance, wp_data->object_property,
+            wp_data->array_index, wp_data->priority,
+            wp_data->application_data,
+            (uint16_t)wp_data->application_data_len)) {
+        /* Answer with an error rather than accept a write not recorded */
+        wp_data->error_class = ERROR_CLASS_RESOURCES;
+        wp_data->error_code = ERROR_CODE_NO_SPACE_TO_WRITE_PROPERTY;
+        return false;
+    }
+    return Write_Store_Next ? Write_Store_Next(wp_data) : true;
+}
+
+void bacnet_plugin_write_store_callback_set(write_property_function callback)
+{
+    Write_Store_Next = callback;
+    Device_Write_Property_Store_Callback_Set(
+        callback ? bacnet_plugin_write_store_hook : NULL);
+}
+
+uint8_t bacnet_plugin_send_write_property(
+    uint32_t device_id,
+    uint32_t object_type,
+    uint32_t object_instance,
+    uint32_t property,
+    BACNET_APPLICATION_DATA_VALUE *value,
+    uint8_t priority,
+    uint32_t array_index)
+{
+    uint8_t encoded[MAX_APDU];
+    uint16_t len = 0;
+    uint8_t invoke_id;
+
+    if (Journal_Open) {
+        /* Refuse the write rather than send one the journal cannot hold */
+        len = journal_encode(encoded, value);
+        if (!journal_make_room(JOURNAL_RECORD_LEN(len))) {
+            return 0;
+        }
+    }
+    invoke_id = Send_Write_Property_Request(device_id,
+        (BACNET_OBJECT_TYPE)object_type, object_instance,
+        (BACNET_PROPERTY_ID)property, value, priority, array_index);
+    if (invoke_id) {
+        Realtime_Last_Send_Us = realtime_now_us();
+        if (Journal_Open) {
+            bacnet_plugin_journal_append(BACNET_PLUGIN_JOURNAL_OUTGOING_WRITE,
+                invoke_id, device_id, (uint16_t)object_type,
+                object_instance, property, array_index, priority, encoded,
+                len);
+        }
+    }
+    return invoke_id;
+}
+
+/*
+ * Real-time profile for the thread that runs the stack.
+ *
+ * The worker polls the datalink from a Dart isolate, and an isolate may
+ * move to another VM thread whenever it goes idle. The profile is therefore
+ * applied lazily: bacnet_plugin_realtime_enter, called at the top of every
+ * poll, pins the calling thread to a CPU and raises it to SCHED_FIFO unless
+ * it already holds the profile, and first restores the previous holder, so
+ * at most one thread runs at real-time priority. A busy-polling worker never
+ * goes idle and so stays on one thread; the check is then a single
+ * comparison. Memory locking is process-wide (mlockall) but covers only
+ * what is mapped when the profile is applied: MCL_FUTURE would make every
+ * later mapping, including the VM's large address-space reservations,
+ * fail once the memlock limit is reached. The calling thread's stack is
+ * touched to the depth of the hot path first, so the stack's static
+ * buffers and the hot path's stack frames cannot page-fault. Memory
+ * mapped later, such as new Dart heap pages or a journal opened after the
+ * profile, is not locked.
+ *
+ * Each step is best effort: SCHED_FIFO needs CAP_SYS_NICE or an rtprio
+ * limit, mlockall a large enough memlock limit. What took effect is
+ * reported by bacnet_plugin_realtime_stats.
+ */
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+static int32_t Realtime_Cpu = -1;
+static uint8_t Realtime_Priority;
+static bool Realtime_Active;
+static bool Realtime_Held;
+static bool Realtime_Affinity_Applied;
+static bool Realtime_Fifo_Applied;
+static bool Realtime_Memory_Locked;
+static uint32_t Realtime_Thread_Changes;
+
+#ifdef _WIN32
+static DWORD Realtime_Holder;
+static DWORD_PTR Realtime_Saved_Mask;
+static int Realtime_Saved_Priority;
+
+static uint64_t realtime_now_us(void)
+{
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart / frequency.QuadPart) * 1000000u +
+        (uint64_t)(now.QuadPart % frequency.QuadPart) * 1000000u /
+        (uint64_t)frequency.QuadPart;
+}
+
+static void realtime_release(void)
+{
+    HANDLE thread;
+
+    if (!Realtime_Held) {
+        return;
+    }
+    thread = OpenThread(THREAD_SET_INFORMATION | THREAD_QUERY_INFORMATION,
+        FALSE, Realtime_Holder);
+    if (thread) {
+        if (Realtime_Affinity_Applied) {
+            SetThreadAffinityMask(thread, Realtime_Saved_Mask);
+        }
+        if (Realtime_Fifo_Applied) {
+            SetThreadPriority(thread, Realtime_Saved_Priority);
+        }
+        CloseHandle(thread);
+    }
+    Realtime_Held = false;
+    Realtime_Affinity_Applied = false;
+    Realtime_Fifo_Applied = false;
+}
+
+static void realtime_apply(void)
+{
+    HANDLE thread = GetCurrentThread();
+
+    Realtime_Holder = GetCurrentThreadId();
+    Realtime_Held = true;
+    if (Realtime_Cpu >= 0 && Realtime_Cpu < (int32_t)(8 * sizeof(DWORD_PTR))) {
+        Realtime_Saved_Mask =
+            SetThreadAffinityMask(thread, (DWORD_PTR)1 << Realtime_Cpu);
+        Realtime_Affinity_Applied = Realtime_Saved_Mask != 0;
+    }
+    if (Realtime_Priority > 0) {
+        Realtime_Saved_Priority = GetThreadPriority(thread);
+        Realtime_Fifo_Applied =
+            SetThreadPriority(thread, THREAD_PRIORITY_TIME_CRITICAL) != 0;
+    }
+}
+
+static bool realtime_holds_current(void)
+{
+    return Realtime_Held && Realtime_Holder == GetCurrentThreadId();
+}
+
+/* Windows has no process-wide page locking */
+static bool realtime_lock_memory(bool lock)
+{
+    (void)lock;
+    return false;
+}
+#else
+static pthread_t Realtime_Holder;
+static int Realtime_Saved_Policy;
+static struct sched_param Realtime_Saved_Param;
+#if defined(__linux__)
+static cpu_set_t Realtime_Saved_Cpus;
+#endif
+
+static uint64_t realtime_now_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000u + (uint64_t)now.tv_nsec / 1000u;
+}
+
+static void realtime_release(void)
+{
+    if (!Realtime_Held) {
+        return;
+    }
+#if defined(__linux__)
+    if (Realtime_Affinity_Applied) {
+        pthread_setaffinity_np(
+            Realtime_Holder, sizeof(Realtime_Saved_Cpus), &Realtime_Saved_Cpus);
+    }
+#endif
+    if (Realtime_Fifo_Applied) {
+        pthread_setschedparam(
+            Realtime_Holder, Realtime_Saved_Policy, &Realtime_Saved_Param);
+    }
+    Realtime_Held = false;
+    Realtime_Affinity_Applied = false;
+    Realtime_Fifo_Applied = false;
+}
+
+static void realtime_apply(void)
+{
+    struct sched_param param = { 0 };
+    pthread_t thread = pthread_self();
+
+    Realtime_Holder = thread;
+    Realtime_Held = true;
+#if defined(__linux__)
+    if (Realtime_Cpu >= 0 && Realtime_Cpu < CPU_SETSIZE &&
+        pthread_getaffinity_np(
+            thread, sizeof(Realtime_Saved_Cpus), &Realtime_Saved_Cpus) == 0) {
+        cpu_set_t cpus;
+
+        CPU_ZERO(&cpus);
+        CPU_SET(Realtime_Cpu, &cpus);
+        Realtime_Affinity_Applied =
+            pthread_setaffinity_np(thread, sizeof(cpus), &cpus) == 0;
+    }
+#endif
+    if (Realtime_Priority > 0 &&
+        pthread_getschedparam(
+            thread, &Realtime_Saved_Policy, &Realtime_Saved_Param) == 0) {
+        param.sched_priority = Realtime_Priority;
+        Realtime_Fifo_Applied =
+            pthread_setschedparam(thread, SCHED_FIFO, &param) == 0;
+    }
+}
+
+static bool realtime_holds_current(void)
+{
+    return Realtime_Held && pthread_equal(Realtime_Holder, pthread_self());
+}
+
+/* Stack the hot path may use below the poll loop, touched before locking
+ * so that its pages are mapped and locked too */
+#define REALTIME_STACK_PREFAULT (128 * 1024)
+
+static void realtime_prefault_stack(void)
+{
+    volatile uint8_t stack[REALTIME_STACK_PREFAULT];
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t i;
+
+    for (i = 0; i < sizeof(stack); i += page) {
+        stack[i] = 0;
+    }
+}
+
+static bool realtime_lock_memory(bool lock)
+{
+    if (!lock) {
+        munlockall();
+        return false;
+    }
+    realtime_prefault_stack();
+    return mlockall(MCL_CURRENT) == 0;
+}
+#endif
+
+void bacnet_plugin_realtime_configure(
+    int32_t cpu,
+    uint8_t priority,
+    bool lock_memory)
+{
+    realtime_release();
+    Realtime_Cpu = cpu;
+    Realtime_Priority = priority;
+    Realtime_Active = cpu >= 0 || priority > 0;
+    if (lock_memory != Realtime_Memory_Locked) {
+        Realtime_Memory_Locked = realtime_lock_memory(lock_memory);
+    }
+}
+
+void bacnet_plugin_realtime_enter(void)
+{
+    if (!Realtime_Active || realtime_holds_current()) {
+        return;
+    }
+    if (Realtime_Held) {
+        Realtime_Thread_Changes++;
+    }
+    realtime_release();
+    realtime_apply();
+}
+
+uint64_t bacnet_plugin_monotonic_us(void)
+{
+    return realtime_now_us();
+}
+
+void bacnet_plugin_realtime_stats(BACNET_PLUGIN_REALTIME_STATS *stats)
+{
+    stats->last_send_us = Realtime_Last_Send_Us;
+    stats->last_receive_us = Realtime_Last_Receive_Us;
+    stats->cpu = Realtime_Cpu;
+    stats->thread_changes = Realtime_Thread_Changes;
+    stats->priority = Realtime_Priority;
+    stats->affinity_applied = Realtime_Affinity_Applied;
+    stats->fifo_applied = Realtime_Fifo_Applied;
+    stats->memory_locked = Realtime_Memory_Locked;
+}
+
+/*
+ * Native client: ReadProperty, ReadPropertyMultiple and WriteProperty for
+ * C callers, with correlation and decoding done here instead of in Dart.
+ *
+ * Submit calls may come from any thread. They copy the request into one of
+ * BACNET_PLUGIN_CLIENT_MAX_PENDING slots and return its handle; the stack
+ * thread sends it from bacnet_plugin_client_task on its next poll, since
+ * the stack itself is not thread-safe. Answers are caught in
+ * bacnet_plugin_safe_npdu_handler before the stack's APDU handlers see
+ * them, by invoke ID, so the Dart handlers never learn of native requests
+ * and the two share the TSM without conflict. Acks are decoded straight
+ * into the caller's flat buffers, outside the lock: the slot is marked
+ * CLIENT_DECODING first, which cancel leaves alone, so a decoder that
+ * crashes or calls exit() never leaves the lock held; the recovery path
+ * completes such a request as a bad reply. A completion goes to the
+ * request's callback on the stack thread, or without one to a queue
+ * drained by bacnet_plugin_client_next from any thread.
+ */
+#define CLIENT_FREE 0
+#define CLIENT_QUEUED 1
+#define CLIENT_SENT 2
+#define CLIENT_DONE 3
+#define CLIENT_DECODING 4
+
+typedef struct {
+    uint32_t handle;
+    uint8_t state;
+    uint8_t priority;
+    bool cancelled;
+    uint16_t ref_count;
+    uint16_t capacity;
+    uint64_t sent_us;
+    BACNET_PLUGIN_PROPERTY_REF refs[BACNET_PLUGIN_CLIENT_MAX_REFS];
+    BACNET_PLUGIN_VALUE write_value;
+    bacnet_plugin_client_callback callback;
+    BACNET_PLUGIN_CLIENT_RESULT result;
+} CLIENT_SLOT;
+
+static CLIENT_SLOT Client_Slots[BACNET_PLUGIN_CLIENT_MAX_PENDING];
+static uint32_t Client_Next_Handle;
+static bool Client_Running;
+/* Slots waiting to be sent; read by the stack thread to skip idle polls */
+static unsigned Client_Queued;
+/* Slots awaiting an answer; only the stack thread touches it */
+static unsigned Client_Sent;
+/* The slot whose answer is being decoded, for client_recover */
+static CLIENT_SLOT *Client_Decoding;
+/* Completed slots without a callback, oldest first */
+static uint8_t Client_Done[BACNET_PLUGIN_CLIENT_MAX_PENDING];
+static unsigned Client_Done_Head;
+static unsigned Client_Done_Count;
+
+#ifdef _WIN32
+static SRWLOCK Client_Lock = SRWLOCK_INIT;
+static CONDITION_VARIABLE Client_Ready = CONDITION_VARIABLE_INIT;
+
+static void client_lock(void)
+{
+    AcquireSRWLockExclusive(&Client_Lock);
+}
+
+static void client_unlock(void)
+{
+    ReleaseSRWLockExclusive(&Client_Lock);
+}
+
+static void client_wait(unsigned ms)
+{
+    SleepConditionVariableSRW(&Client_Ready, &Client_Lock, ms, 0);
+}
+
+static void client_signal(void)
+{
+    WakeAllConditionVariable(&Client_Ready);
+}
+#else
+static pthread_mutex_t Client_Lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t Client_Ready = PTHREAD_COND_INITIALIZER;
+
+static void client_lock(void)
+{
+    pthread_mutex_lock(&Client_Lock);
+}
+
+static void client_unlock(void)
+{
+    pthread_mutex_unlock(&Client_Lock);
+}
+
+static void client_wait(unsigned ms)
+{
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&Client_Ready, &Client_Lock, &deadline);
+}
+
+static void client_signal(void)
+{
+    pthread_cond_broadcast(&Client_Ready);
+}
+#endif
+
+/* Takes a free slot for a new request; NULL if none. Lock held. */
+static CLIENT_SLOT *client_alloc(
+    uint8_t service,
+    uint32_t device_id,
+    bacnet_plugin_client_callback callback,
+    void *context)
+{
+    CLIENT_SLOT *slot;
+    unsigned i;
+
+    if (!Client_Running) {
+        return NULL;
+    }
+    for (i = 0; i < BACNET_PLUGIN_CLIENT_MAX_PENDING; i++) {
+        slot = &Client_Slots[i];
+        if (slot->state != CLIENT_FREE) {
+            continue;
+        }
+        memset(slot, 0, sizeof(*slot));
+        if (++Client_Next_Handle == 0) {
+            Client_Next_Handle = 1;
+        }
+        slot->handle = Client_Next_Handle;
+        slot->state = CLIENT_QUEUED;
+        slot->callback = callback;
+        slot->result.handle = slot->handle;
+        slot->result.device_id = device_id;
+        slot->result.service = service;
+        slot->result.context = context;
+        Client_Queued++;
+        return slot;
+    }
+    return NULL;
+}
+
+/* Hands a finished request to its callback or to the completion queue */
+static void client_complete(CLIENT_SLOT *slot, uint8_t status)
+{
+    bacnet_plugin_client_callback callback;
+
+    client_lock();
+    if (slot->state == CLIENT_SENT || slot->state == CLIENT_DECODING) {
+        Client_Sent--;
+        slot->result.elapsed_us =
+            (uint32_t)(realtime_now_us() - slot->sent_us);
+    } else if (slot->state == CLIENT_QUEUED) {
+        Client_Queued--;
+    }
+    slot->state = CLIENT_DONE;
+    slot->result.status = slot->cancelled ?
+        BACNET_PLUGIN_CLIENT_CANCELLED : status;
+    slot->result.values = slot->cancelled ? NULL : slot->result.values;
+    if (slot->result.status != BACNET_PLUGIN_CLIENT_OK) {
+        slot->result.value_count = 0;
+        slot->result.truncated = false;
+    }
+    callback = slot->callback;
+    if (!callback) {
+        Client_Done[(Client_Done_Head + Client_Done_Count) %
+            BACNET_PLUGIN_CLIENT_MAX_PENDING] =
+            (uint8_t)(slot - Client_Slots);
+        Client_Done_Count++;
+        client_signal();
+        client_unlock();
+        return;
+    }
+    client_unlock();
+    /* Outside the lock, so the callback may submit the next request */
+    callback(&slot->result);
+    client_lock();
+    slot->state = CLIENT_FREE;
+    client_unlock();
+}
+
+static void client_copy(BACNET_PLUGIN_VALUE *out, const uint8_t *data,
+    size_t len)
+{
+    out->truncated = len > BACNET_PLUGIN_VALUE_DATA_SIZE;
+    out->length = (uint16_t)(out->truncated ?
+        BACNET_PLUGIN_VALUE_DATA_SIZE : len);
+    memcpy(out->data, data, out->length);
+}
+
+/* Flattens the value(s) in apdu; anything but a single application value
+ * is kept encoded */
+static void client_store_value(
+    BACNET_PLUGIN_VALUE *out, uint8_t *apdu, int apdu_len)
+{
+    BACNET_APPLICATION_DATA_VALUE value;
+    int len;
+    int i;
+
+    memset(out, 0, sizeof(*out));
+    len = apdu_len > 0 ?
+        bacapp_decode_application_data(apdu, (unsigned)apdu_len, &value) : 0;
+    if (len <= 0 || len != apdu_len) {
+        out->tag = BACNET_PLUGIN_VALUE_ENCODED;
+        client_copy(out, apdu, apdu_len > 0 ? (size_t)apdu_len : 0);
+        return;
+    }
+    out->tag = value.tag;
+    switch (value.tag) {
+        case BACNET_APPLICATION_TAG_NULL:
+            break;
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            out->integer = value.type.Boolean ? 1 : 0;
+            break;
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            out->integer = (int64_t)value.type.Unsigned_Int;
+            break;
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            out->integer = value.type.Signed_Int;
+            break;
+        case BACNET_APPLICATION_TAG_REAL:
+            out->real = value.type.Real;
+            break;
+        case BACNET_APPLICATION_TAG_DOUBLE:
+            out->real = value.type.Double;
+            break;
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            out->integer = value.type.Enumerated;
+            break;
+        case BACNET_APPLICATION_TAG_OCTET_STRING:
+            client_copy(out, octetstring_value(&value.type.Octet_String),
+                octetstring_length(&value.type.Octet_String));
+            break;
+        case BACNET_APPLICATION_TAG_CHARACTER_STRING:
+            out->encoding =
+                characterstring_encoding(&value.type.Character_String);
+            client_copy(out,
+                (const uint8_t *)characterstring_value(
+                    &value.type.Character_String),
+                characterstring_length(&value.type.Character_String));
+            break;
+        case BACNET_APPLICATION_TAG_BIT_STRING:
+            out->integer = bitstring_bits_used(&value.type.Bit_String);
+            for (i = 0; i < bitstring_bytes_used(&value.type.Bit_String) &&
+                 i < BACNET_PLUGIN_VALUE_DATA_SIZE; i++) {
+                out->data[i] =
+                    bitstring_octet(&value.type.Bit_String, (uint8_t)i);
+            }
+            out->length = (uint16_t)i;
+            break;
+        case BACNET_APPLICATION_TAG_DATE:
+            out->data[0] = (uint8_t)(value.type.Date.year >> 8);
+            out->data[1] = (uint8_t)value.type.Date.year;
+            out->data[2] = value.type.Date.month;
+            out->data[3] = value.type.Date.day;
+            out->data[4] = value.type.Date.wday;
+            out->length = 5;
+            break;
+        case BACNET_APPLICATION_TAG_TIME:
+            out->data[0] = value.type.Time.hour;
+            out->data[1] = value.type.Time.min;
+            out->data[2] = value.type.Time.sec;
+            out->data[3] = value.type.Time.hundredths;
+            out->length = 4;
+            break;
+        case BACNET_APPLICATION_TAG_OBJECT_ID:
+            out->object_type = value.type.Object_Id.type;
+            out->object_instance = value.type.Object_Id.instance;
+            break;
+        default:
+            out->tag = BACNET_PLUGIN_VALUE_ENCODED;
+            client_copy(out, apdu, (size_t)apdu_len);
+            break;
+    }
+}
+
+/* Builds the stack's value from a flat one; false for unsupported tags */
+static bool client_load_value(
+    const BACNET_PLUGIN_VALUE *in, BACNET_APPLICATION_DATA_VALUE *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->tag = in->tag;
+    switch (in->tag) {
+        case BACNET_APPLICATION_TAG_NULL:
+            return true;
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            out->type.Boolean = in->integer != 0;
+            return true;
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            out->type.Unsigned_Int = (BACNET_UNSIGNED_INTEGER)in->integer;
+            return true;
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            out->type.Signed_Int = (int32_t)in->integer;
+            return true;
+        case BACNET_APPLICATION_TAG_REAL:
+            out->type.Real = (float)in->real;
+            return true;
+        case BACNET_APPLICATION_TAG_DOUBLE:
+            out->type.Double = in->real;
+            return true;
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            out->type.Enumerated = (uint32_t)in->integer;
+            return true;
+        case BACNET_APPLICATION_TAG_OCTET_STRING:
+            return octetstring_init(
+                &out->type.Octet_String, (uint8_t *)in->data, in->length);
+        case BACNET_APPLICATION_TAG_CHARACTER_STRING:
+            return characterstring_init(&out->type.Character_String,
+                in->encoding, (const char *)in->data, in->length);
+        case BACNET_APPLICATION_TAG_OBJECT_ID:
+            out->type.Object_Id.type = (BACNET_OBJECT_TYPE)in->object_type;
+            out->type.Object_Id.instance = in->object_instance;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static uint8_t client_decode_rp(
+    CLIENT_SLOT *slot, uint8_t *service_data, int len)
+{
+    BACNET_READ_PROPERTY_DATA data = { 0 };
+    BACNET_PLUGIN_PROPERTY_VALUE *out = slot->result.values;
+
+    if (rp_ack_decode_service_request(service_data, len, &data) <= 0) {
+        return BACNET_PLUGIN_CLIENT_BAD_REPLY;
+    }
+    if (out) {
+        memset(out, 0, sizeof(*out));
+        out->object_type = data.object_type;
+        out->object_instance = data.object_instance;
+        out->property = data.object_property;
+        out->array_index = data.array_index;
+        client_store_value(
+            &out->value, data.application_data, data.application_data_len);
+    }
+    slot->result.value_count = 1;
+    return BACNET_PLUGIN_CLIENT_OK;
+}
+
+static uint8_t client_decode_rpm(
+    CLIENT_SLOT *slot, uint8_t *apdu, unsigned apdu_len)
+{
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    BACNET_PROPERTY_ID property;
+    BACNET_ARRAY_INDEX array_index;
+    BACNET_ERROR_CLASS error_class;
+    BACNET_ERROR_CODE error_code;
+    BACNET_PLUGIN_PROPERTY_VALUE *out;
+    unsigned count = 0;
+    int len;
+
+    while (apdu_len > 0) {
+        len = rpm_ack_decode_object_id(
+            apdu, apdu_len, &object_type, &object_instance);
+        if (len <= 0) {
+            return BACNET_PLUGIN_CLIENT_BAD_REPLY;
+        }
+        apdu += len;
+        apdu_len -= len;
+        for (;;) {
+            len = rpm_ack_decode_object_end(apdu, apdu_len);
+            if (len > 0) {
+                apdu += len;
+                apdu_len -= len;
+                break;
+            }
+            len = rpm_ack_decode_object_property(
+                apdu, apdu_len, &property, &array_index);
+            if (len <= 0 || (unsigned)len >= apdu_len) {
+                return BACNET_PLUGIN_CLIENT_BAD_REPLY;
+            }
+            apdu += len;
+            apdu_len -= len;
+            out = slot->result.values && count < slot->capacity ?
+                &slot->result.values[count] : NULL;
+            if (out) {
+                memset(out, 0, sizeof(*out));
+                out->object_type = object_type;
+                out->object_instance = object_instance;
+                out->property = property;
+                out->array_index = array_index;
+            }
+            if (decode_is_opening_tag_number(apdu, 4)) {
+                len = bacapp_data_len(apdu, apdu_len, property);
+                if (len < 0 || (unsigned)len + 2 > apdu_len) {
+                    return BACNET_PLUGIN_CLIENT_BAD_REPLY;
+                }
+                if (out) {
+                    client_store_value(&out->value, apdu + 1, len);
+                }
+            } else if (decode_is_opening_tag_number(apdu, 5)) {
+                len = bacerror_decode_error_class_and_code(
+                    apdu + 1, apdu_len - 1, &error_class, &error_code);
+                if (len <= 0 || (unsigned)len + 2 > apdu_len) {
+                    return BACNET_PLUGIN_CLIENT_BAD_REPLY;
+                }
+                if (out) {
+                    out->has_error = true;
+                    out->error_class = error_class;
+                    out->error_code = error_code;
+                }
+            } else {
+                return BACNET_PLUGIN_CLIENT_BAD_REPLY;
+            }
+            /* Opening and closing tags around the value or error */
+            apdu += len + 2;
+            apdu_len -= len + 2;
+            count++;
+        }
+    }
+    slot->result.truncated = count > slot->capacity;
+    slot->result.value_count =
+        (uint16_t)(slot->result.truncated ? slot->capacity : count);
+    return BACNET_PLUGIN_CLIENT_OK;
+}
+
+static CLIENT_SLOT *client_find_sent(uint8_t invoke_id)
+{
+    unsigned i;
+
+    for (i = 0; i < BACNET_PLUGIN_CLIENT_MAX_PENDING; i++) {
+        if (Client_Slots[i].state == CLIENT_SENT &&
+            Client_Slots[i].result.invoke_id == invoke_id) {
+            return &Client_Slots[i];
+        }
+    }
+    return NULL;
+}
+
+/* Tells a server we cannot take its segmented ComplexAck, as the stack's
+ * own APDU handler does */
+static void client_send_abort(BACNET_ADDRESS *dest, uint8_t invoke_id)
+{
+    BACNET_NPDU_DATA npdu_data;
+    BACNET_ADDRESS my_address;
+    uint8_t buffer[MAX_PDU];
+    int pdu_len;
+
+    datalink_get_my_address(&my_address);
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    pdu_len = npdu_encode_pdu(buffer, dest, &my_address, &npdu_data);
+    pdu_len += abort_encode_apdu(&buffer[pdu_len], invoke_id,
+        ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, false);
+    datalink_send_pdu(dest, &npdu_data, buffer, pdu_len);
+}
+
+static bool client_apdu_handler(
+    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t pdu_len)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS reply_to = *src;
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ERROR_CLASS error_class = ERROR_CLASS_SERVICES;
+    BACNET_ERROR_CODE error_code = ERROR_CODE_OTHER;
+    CLIENT_SLOT *slot;
+    uint8_t *apdu;
+    unsigned apdu_len;
+    uint8_t status = BACNET_PLUGIN_CLIENT_OK;
+    bool segmented;
+    int offset;
+
+    /* Dart's requests pay only this check */
+    if (Client_Sent == 0) {
+        return false;
+    }
+    offset = bacnet_npdu_decode(npdu, pdu_len, &dest, &reply_to, &npdu_data);
+    if (offset <= 0 || offset + 3 > pdu_len ||
+        npdu_data.network_layer_message) {
+        return false;
+    }
+    apdu = &npdu[offset];
+    apdu_len = pdu_len - (unsigned)offset;
+    segmented = (apdu[0] & 0xF0) == PDU_TYPE_COMPLEX_ACK &&
+        (apdu[0] & 0x08);
+    switch (apdu[0] & 0xF0) {
+        case PDU_TYPE_SIMPLE_ACK:
+        case PDU_TYPE_COMPLEX_ACK:
+        case PDU_TYPE_ERROR:
+        case PDU_TYPE_REJECT:
+            break;
+        case PDU_TYPE_ABORT:
+            /* Only a server's abort answers one of our requests */
+            if (apdu[0] & 0x01) {
+                break;
+            }
+            return false;
+        default:
+            return false;
+    }
+
+    client_lock();
+    slot = client_find_sent(apdu[1]);
+    /* Acks and errors name their service; a segment's third octet is its
+     * sequence number instead */
+    if (slot && (apdu[0] & 0xF0) != PDU_TYPE_REJECT &&
+        (apdu[0] & 0xF0) != PDU_TYPE_ABORT && !segmented &&
+        apdu[2] != slot->result.service) {
+        slot = NULL;
+    }
+    if (slot) {
+        slot->state = CLIENT_DECODING;
+    }
+    client_unlock();
+    if (!slot) {
+        return false;
+    }
+
+    Client_Decoding = slot;
+    switch (apdu[0] & 0xF0) {
+        case PDU_TYPE_SIMPLE_ACK:
+            break;
+        case PDU_TYPE_ERROR:
+            status = BACNET_PLUGIN_CLIENT_ERROR;
+            bacerror_decode_error_class_and_code(
+                &apdu[3], apdu_len - 3, &error_class, &error_code);
+            slot->result.error_class = error_class;
+            slot->result.error_code = error_code;
+            break;
+        case PDU_TYPE_COMPLEX_ACK:
+            if (segmented) {
+                /* Segmentation is not supported by this stack */
+                status = BACNET_PLUGIN_CLIENT_ABORT;
+                slot->result.error_code =
+                    ABORT_REASON_SEGMENTATION_NOT_SUPPORTED;
+                client_send_abort(&reply_to, apdu[1]);
+            } else if (slot->result.service ==
+                SERVICE_CONFIRMED_READ_PROPERTY) {
+                status = client_decode_rp(slot, &apdu[3], (int)apdu_len - 3);
+            } else {
+                status = client_decode_rpm(slot, &apdu[3], apdu_len - 3);
+            }
+            break;
+        default:
+            status = (apdu[0] & 0xF0) == PDU_TYPE_REJECT ?
+                BACNET_PLUGIN_CLIENT_REJECT : BACNET_PLUGIN_CLIENT_ABORT;
+            slot->result.error_code = apdu[2];
+            break;
+    }
+    Client_Decoding = NULL;
+    tsm_free_invoke_id(slot->result.invoke_id);
+    client_complete(slot, status);
+    return true;
+}
+
+static void client_recover(void)
+{
+    CLIENT_SLOT *slot = Client_Decoding;
+
+    if (!slot) {
+        return;
+    }
+    Client_Decoding = NULL;
+    tsm_free_invoke_id(slot->result.invoke_id);
+    client_complete(slot, BACNET_PLUGIN_CLIENT_BAD_REPLY);
+}
+
+/* Sends a queued request on the stack thread; returns its invoke ID */
+static uint8_t client_send(CLIENT_SLOT *slot)
+{
+    BACNET_READ_ACCESS_DATA objects[BACNET_PLUGIN_CLIENT_MAX_REFS];
+    BACNET_PROPERTY_REFERENCE properties[BACNET_PLUGIN_CLIENT_MAX_REFS];
+    BACNET_APPLICATION_DATA_VALUE value;
+    uint8_t pdu[MAX_PDU];
+    BACNET_PLUGIN_PROPERTY_REF *ref = &slot->refs[0];
+    unsigned object = 0;
+    uint8_t invoke_id;
+    unsigned i;
+
+    switch (slot->result.service) {
+        case SERVICE_CONFIRMED_READ_PROPERTY:
+            return bacnet_plugin_send_read_property(slot->result.device_id,
+                ref->object_type, ref->object_instance, ref->property,
+                ref->array_index);
+        case SERVICE_CONFIRMED_WRITE_PROPERTY:
+            if (!client_load_value(&slot->write_value, &value)) {
+                return 0;
+            }
+            return bacnet_plugin_send_write_property(slot->result.device_id,
+                ref->object_type, ref->object_instance, ref->property,
+                &value, slot->priority, ref->array_index);
+        default:
+            break;
+    }
+
+    /* Consecutive references to one object share its access spec */
+    memset(objects, 0, sizeof(objects));
+    memset(properties, 0, sizeof(properties));
+    for (i = 0; i < slot->ref_count; i++) {
+        ref = &slot->refs[i];
+        if (i > 0 &&
+            (ref->object_type != slot->refs[i - 1].object_type ||
+             ref->object_instance != slot->refs[i - 1].object_instance)) {
+            objects[object].next = &objects[object + 1];
+            object++;
+        }
+        if (objects[object].listOfProperties == NULL) {
+            objects[object].object_type = (BACNET_OBJECT_TYPE)ref->object_type;
+            objects[object].object_instance = ref->object_instance;
+            objects[object].listOfProperties = &properties[i];
+        } else {
+            properties[i - 1].next = &properties[i];
+        }
+        properties[i].propertyIdentifier = (BACNET_PROPERTY_ID)ref->property;
+        properties[i].propertyArrayIndex = ref->array_index;
+    }
+    invoke_id = Send_Read_Property_Multiple_Request(
+        pdu, sizeof(pdu), slot->result.device_id, objects);
+    if (invoke_id) {
+        Realtime_Last_Send_Us = realtime_now_us();
+    }
+    return invoke_id;
+}
+
+/* Queues a request; returns its handle, or 0 if it cannot be taken */
+static uint32_t client_submit(
+    uint8_t service,
+    uint32_t device_id,
+    const BACNET_PLUGIN_PROPERTY_REF *refs,
+    uint16_t ref_count,
+    BACNET_PLUGIN_PROPERTY_VALUE *values,
+    uint16_t capacity,
+    const BACNET_PLUGIN_VALUE *write_value,
+    uint8_t priority,
+    bacnet_plugin_client_callback callback,
+    void *context)
+{
+    CLIENT_SLOT *slot;
+    uint32_t handle = 0;
+
+    if (!refs || ref_count == 0 ||
+        ref_count > BACNET_PLUGIN_CLIENT_MAX_REFS || priority > 16) {
+        return 0;
+    }
+    client_lock();
+    slot = client_alloc(service, device_id, callback, context);
+    if (slot) {
+        memcpy(slot->refs, refs, ref_count * sizeof(*refs));
+        slot->ref_count = ref_count;
+        slot->result.values = values;
+        slot->capacity = values ? capacity : 0;
+        slot->priority = priority;
+        if (write_value) {
+            slot->write_value = *write_value;
+        }
+        handle = slot->handle;
+    }
+    client_unlock();
+    return handle;
+}
+
+uint32_t bacnet_plugin_client_read_property(
+    uint32_t device_id,
+    const BACNET_PLUGIN_PROPERTY_REF *ref,
+    BACNET_PLUGIN_PROPERTY_VALUE *value,
+    bacnet_plugin_client_callback callback,
+    void *context)
+{
+    return client_submit(SERVICE_CONFIRMED_READ_PROPERTY, device_id, ref, 1,
+        value, 1, NULL, 0, callback, context);
+}
+
+uint32_t bacnet_plugin_client_read_property_multiple(
+    uint32_t device_id,
+    const BACNET_PLUGIN_PROPERTY_REF *refs,
+    uint16_t ref_count,
+    BACNET_PLUGIN_PROPERTY_VALUE *values,
+    uint16_t capacity,
+    bacnet_plugin_client_callback callback,
+    void *context)
+{
+    return client_submit(SERVICE_CONFIRMED_READ_PROP_MULTIPLE, device_id,
+        refs, ref_count, values, capacity, NULL, 0, callback, context);
+}
+
+uint32_t bacnet_plugin_client_write_property(
+    uint32_t device_id,
+    const BACNET_PLUGIN_PROPERTY_REF *ref,
+    const BACNET_PLUGIN_VALUE *value,
+    uint8_t priority,
+    bacnet_plugin_client_callback callback,
+    void *context)
+{
+    BACNET_APPLICATION_DATA_VALUE check;
+
+    /* Reject values the stack cannot encode now, not on the stack thread */
+    if (!value || !client_load_value(value, &check)) {
+        return 0;
+    }
+    return client_submit(SERVICE_CONFIRMED_WRITE_PROPERTY, device_id, ref, 1,
+        NULL, 0, value, priority, callback, context);
+}
+
+bool bacnet_plugin_client_cancel(uint32_t handle)
+{
+    bool found = false;
+    unsigned i;
+
+    if (handle == 0) {
+        return false;
+    }
+    client_lock();
+    for (i = 0; i < BACNET_PLUGIN_CLIENT_MAX_PENDING; i++) {
+        CLIENT_SLOT *slot = &Client_Slots[i];
+
+        if (slot->handle == handle && !slot->cancelled &&
+            (slot->state == CLIENT_QUEUED || slot->state == CLIENT_SENT)) {
+            slot->cancelled = true;
+            slot->result.values = NULL;
+            found = true;
+            break;
+        }
+    }
+    client_unlock();
+    return found;
+}
+
+bool bacnet_plugin_client_next(
+    BACNET_PLUGIN_CLIENT_RESULT *result,
+    uint32_t timeout_ms)
+{
+    uint64_t deadline = realtime_now_us() + (uint64_t)timeout_ms * 1000u;
+    uint64_t now;
+    CLIENT_SLOT *slot;
+
+    client_lock();
+    while (Client_Done_Count == 0 && timeout_ms > 0) {
+        now = realtime_now_us();
+        if (now >= deadline) {
+            break;
+        }
+        client_wait((unsigned)((deadline - now + 999u) / 1000u));
+    }
+    if (Client_Done_Count == 0) {
+        client_unlock();
+        return false;
+    }
+    slot = &Client_Slots[Client_Done[Client_Done_Head]];
+    Client_Done_Head =
+        (Client_Done_Head + 1) % BACNET_PLUGIN_CLIENT_MAX_PENDING;
+    Client_Done_Count--;
+    *result = slot->result;
+    slot->state = CLIENT_FREE;
+    client_unlock();
+    return true;
+}
+
+/* Lists the slots in state. Taken under the lock, so a slot is seen only
+ * once its submitter has filled it. */
+static unsigned client_collect(uint8_t state, uint8_t *slots)
+{
+    unsigned count = 0;
+    unsigned i;
+
+    for (i = 0; i < BACNET_PLUGIN_CLIENT_MAX_PENDING; i++) {
+        if (Client_Slots[i].state == state) {
+            slots[count++] = (uint8_t)i;
+        }
+    }
+    return count;
+}
+
+void bacnet_plugin_client_task(void)
+{
+    uint8_t queued[BACNET_PLUGIN_CLIENT_MAX_PENDING];
+    uint8_t sent[BACNET_PLUGIN_CLIENT_MAX_PENDING];
+    unsigned queued_count = 0;
+    unsigned sent_count = 0;
+    CLIENT_SLOT *slot;
+    uint8_t invoke_id;
+    bool cancelled;
+    unsigned i;
+
+    client_lock();
+    Client_Running = true;
+    if (Client_Queued > 0) {
+        queued_count = client_collect(CLIENT_QUEUED, queued);
+    }
+    if (Client_Sent > 0) {
+        sent_count = client_collect(CLIENT_SENT, sent);
+    }
+    client_unlock();
+
+    /* Only this thread moves slots out of QUEUED and SENT */
+    for (i = 0; i < sent_count; i++) {
+        slot = &Client_Slots[sent[i]];
+        invoke_id = slot->result.invoke_id;
+        if (tsm_invoke_id_failed(invoke_id) || tsm_invoke_id_free(invoke_id)) {
+            /* Out of retries; free means the stack dropped it */
+            tsm_free_invoke_id(invoke_id);
+            client_complete(slot, BACNET_PLUGIN_CLIENT_TIMEOUT);
+        }
+    }
+    for (i = 0; i < queued_count; i++) {
+        slot = &Client_Slots[queued[i]];
+        client_lock();
+        cancelled = slot->cancelled;
+        client_unlock();
+        /* A cancelled request completes as such, unsent */
+        invoke_id = cancelled ? 0 : client_send(slot);
+        if (invoke_id == 0) {
+            client_complete(slot, BACNET_PLUGIN_CLIENT_NOT_SENT);
+            continue;
+        }
+        client_lock();
+        slot->result.invoke_id = invoke_id;
+        slot->sent_us = realtime_now_us();
+        slot->state = CLIENT_SENT;
+        Client_Queued--;
+        Client_Sent++;
+        client_unlock();
+    }
+}
+
+void bacnet_plugin_client_stop(void)
+{
+    uint8_t queued[BACNET_PLUGIN_CLIENT_MAX_PENDING];
+    uint8_t sent[BACNET_PLUGIN_CLIENT_MAX_PENDING];
+    unsigned queued_count;
+    unsigned sent_count;
+    unsigned i;
+
+    client_lock();
+    Client_Running = false;
+    queued_count = client_collect(CLIENT_QUEUED, queued);
+    sent_count = client_collect(CLIENT_SENT, sent);
+    client_unlock();
+    for (i = 0; i < sent_count; i++) {
+        tsm_free_invoke_id(Client_Slots[sent[i]].result.invoke_id);
+        client_complete(&Client_Slots[sent[i]], BACNET_PLUGIN_CLIENT_STOPPED);
+    }
+    for (i = 0; i < queued_count; i++) {
+        client_complete(
+            &Client_Slots[queued[i]], BACNET_PLUGIN_CLIENT_STOPPED);
+    }
+}
@@ -18,13 +18,26 @@
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/service/s_whois.h"
 #include "bacnet/basic/service/s_iam.h"
+#include "bacnet/whois.h"
+#include "bacnet/iam.h"
+#include "bacnet/rp.h"
+#include "bacnet/rpm.h"
 #include "bacnet/basic/service/s_rp.h"
+#include "bacnet/basic/service/s_rpm.h"
+#include "bacnet/basic/tsm/tsm.h"
 #include "bacnet/basic/service/s_wp.h"
 #include "bacnet/basic/service/s_cov.h"
 #include "bacnet/basic/service/s_wpm.h"
 #include "bacnet/wpm.h"
 #include "bacnet/basic/service/s_readrange.h"
 #include "bacnet/readrange.h"
+#include "bacnet/cov.h"
+#include "bacnet/basic/service/h_cov.h"
+#include "bacnet/basic/object/ai.h"
+#include "bacnet/basic/object/av.h"
+#include "bacnet/bacaddr.h"
+#include "bacnet/bacdcode.h"
+#include "bacnet/create_object.h"
 
 /* Forward declaration for the exit handler used in macro redirection */
 #ifdef _WIN32
@@ -54,4 +67,354 @@ void bacnet_plugin_safe_npdu_handler(
     uint8_t *npdu,
     uint16_t pdu_len);
 
+/* Flat entry points for the Dart hot path (scalar arguments only) */
+void bacnet_plugin_address_add_ipv4(
+    uint32_t device_id,
+    uint32_t ipv4,
+    uint16_t port);
+bool bacnet_plugin_send_who_is_directed(uint32_t device_id);
+uint8_t bacnet_plugin_send_read_property(
+    uint32_t device_id,
+    uint32_t object_type,
+    uint32_t object_instance,
+    uint32_t object_property,
+    uint32_t array_index);
+uint8_t bacnet_plugin_send_cov_subscribe(
+    uint32_t device_id,
+    uint32_t object_type,
+    uint32_t object_instance,
+    uint32_t object_property,
+    bool confirmed,
+    uint32_t lifetime,
+    bool cancel,
+    bool increment_present,
+    float increment);
+
+/* Native COV notification handling (decode, queue, SimpleAck) */
+#define BACNET_PLUGIN_COV_RING_SIZE 256
+
+typedef struct {
+    uint32_t device_id;
+    uint32_t object_type;
+    uint32_t object_instance;
+    uint32_t time_remaining;
+    uint32_t property_id; /* BACNET_PLUGIN_COV_NO_PROPERTY if none */
+    double value;
+    uint8_t value_tag; /* BACnet application tag of value */
+    uint8_t status_flags; /* in-alarm, fault, overridden, out-of-service */
+    bool has_status_flags;
+    bool confirmed;
+} BACNET_PLUGIN_COV_EVENT;
+
+#define BACNET_PLUGIN_COV_NO_PROPERTY 0xFFFFFFFFu
+
+typedef struct {
+    uint32_t received;
+    uint32_t retransmits;
+    uint32_t acked;
+    uint32_t rejected;
+    uint32_t dropped;
+} BACNET_PLUGIN_COV_STATS;
+
+void bacnet_plugin_cov_handlers_init(void);
+bool bacnet_plugin_cov_event_pop(BACNET_PLUGIN_COV_EVENT *event);
+void bacnet_plugin_cov_stats(BACNET_PLUGIN_COV_STATS *stats);
+
+/* Character set conversion for strings Dart cannot decode itself */
+int32_t bacnet_plugin_decode_dbcs(
+    uint16_t code_page,
+    const uint8_t *src,
+    uint32_t src_len,
+    uint16_t *dst,
+    uint32_t dst_capacity);
+
+/* Receive pre-filter applied by bacnet_plugin_safe_bip_receive */
+#define BACNET_PLUGIN_FILTER_SOURCES_OFF 0
+#define BACNET_PLUGIN_FILTER_SOURCES_ALLOW 1
+#define BACNET_PLUGIN_FILTER_SOURCES_DENY 2
+#define BACNET_PLUGIN_FILTER_MAX_SOURCES 256
+
+typedef struct {
+    uint32_t passed;
+    uint32_t dropped_service;
+    uint32_t dropped_source;
+    uint32_t dropped_network;
+    uint32_t dropped_unconfirmed[16]; /* per unconfirmed service choice */
+} BACNET_PLUGIN_FILTER_STATS;
+
+void bacnet_plugin_filter_reset(void);
+void bacnet_plugin_filter_set_service(
+    bool confirmed, uint8_t service_choice, bool deny);
+void bacnet_plugin_filter_set_network_messages(bool deny);
+void bacnet_plugin_filter_set_source_mode(uint8_t mode);
+bool bacnet_plugin_filter_add_source(uint32_t ipv4, uint16_t port);
+bool bacnet_plugin_filter_accept(
+    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t pdu_len);
+void bacnet_plugin_filter_stats(BACNET_PLUGIN_FILTER_STATS *stats);
+
+/* Server-side COV: SubscribeCOV handling and change detection */
+void bacnet_plugin_server_cov_init(void);
+void bacnet_plugin_server_cov_task(uint16_t elapsed_milliseconds);
+bool bacnet_plugin_set_cov_increment(
+    uint32_t object_type, uint32_t object_instance, float increment);
+
+/* Server object database image (snapshot and memory-mapped restore) */
+#define BACNET_PLUGIN_SERVER_COV_RECORDS 128
+#define BACNET_PLUGIN_IMAGE_OK 0
+#define BACNET_PLUGIN_IMAGE_ERROR_IO (-1)
+#define BACNET_PLUGIN_IMAGE_ERROR_FORMAT (-2)
+#define BACNET_PLUGIN_IMAGE_ERROR_VERSION (-3)
+
+typedef struct {
+    uint32_t objects;
+    uint32_t properties;
+    uint32_t skipped; /* restore: records the object refused */
+    uint32_t subscriptions;
+    uint32_t bytes;
+} BACNET_PLUGIN_IMAGE_STATS;
+
+int32_t bacnet_plugin_server_snapshot(
+    const char *path, BACNET_PLUGIN_IMAGE_STATS *stats);
+int32_t bacnet_plugin_server_restore(
+    const char *path, BACNET_PLUGIN_IMAGE_STATS *stats);
+
+/* Server I-Am pacing: randomized delay and rate limit for Who-Is replies */
+typedef struct {
+    uint32_t who_is_received;
+    uint32_t sent;
+    uint32_t coalesced; /* answered by an I-Am that was already pending */
+    uint32_t dropped; /* rate limit exceeded */
+    uint32_t send_failed;
+    uint32_t delay_min_ms;
+    uint32_t delay_max_ms;
+    uint32_t delay_total_ms;
+} BACNET_PLUGIN_IAM_STATS;
+
+void bacnet_plugin_server_iam_init(void);
+void bacnet_plugin_server_iam_configure(
+    uint16_t max_delay_ms, uint16_t max_per_second);
+void bacnet_plugin_server_iam_task(uint16_t elapsed_milliseconds);
+void bacnet_plugin_server_iam_stats(BACNET_PLUGIN_IAM_STATS *stats);
+
+/* MS/TP master node datalink (builds with BACDL_MSTP) */
+typedef struct {
+    uint32_t baud_rate;
+    uint8_t mac_address;
+    uint8_t max_info_frames;
+    uint32_t transmit_frames; /* including tokens and polls */
+    uint32_t receive_valid_frames;
+    uint32_t receive_invalid_frames;
+    uint32_t transmit_pdus;
+    uint32_t receive_pdus;
+    uint32_t lost_tokens;
+} BACNET_PLUGIN_MSTP_STATS;
+
+bool bacnet_plugin_mstp_init(
+    const char *port,
+    uint32_t baud_rate,
+    uint8_t mac_address,
+    uint8_t max_master,
+    uint8_t max_info_frames);
+void bacnet_plugin_datalink_cleanup(void);
+bool bacnet_plugin_mstp_stats(BACNET_PLUGIN_MSTP_STATS *stats);
+
+/* Write journal: group-committed log of incoming and outgoing writes */
+#define BACNET_PLUGIN_JOURNAL_INCOMING_WRITE 1
+#define BACNET_PLUGIN_JOURNAL_OUTGOING_WRITE 2
+#define BACNET_PLUGIN_JOURNAL_OUTGOING_WPM 3
+
+typedef struct {
+    uint64_t bytes; /* committed to disk */
+    uint32_t records; /* appended */
+    uint32_t refused; /* writes not journaled, so not sent or accepted */
+    uint32_t stalls; /* appends that waited for a full batch to commit */
+    uint32_t commits; /* fsync batches */
+    uint32_t max_batch_records;
+    uint32_t last_commit_us; /* write and fsync of the last batch */
+    uint32_t max_commit_us;
+    uint32_t rotations;
+    uint32_t write_errors;
+    uint32_t lost_records; /* in batches that failed to reach disk */
+    bool open;
+} BACNET_PLUGIN_JOURNAL_STATS;
+
+bool bacnet_plugin_journal_open(
+    const char *path,
+    uint32_t max_file_bytes,
+    uint8_t keep_files,
+    uint16_t commit_interval_ms,
+    uint32_t buffer_bytes);
+bool bacnet_plugin_journal_append(
+    uint8_t kind,
+    uint8_t invoke_id,
+    uint32_t device_id,
+    uint16_t object_type,
+    uint32_t object_instance,
+    uint32_t property,
+    uint32_t array_index,
+    uint8_t priority,
+    const uint8_t *value,
+    uint16_t value_len);
+bool bacnet_plugin_journal_sync(uint32_t timeout_ms);
+void bacnet_plugin_journal_close(void);
+void bacnet_plugin_journal_stats(BACNET_PLUGIN_JOURNAL_STATS *stats);
+
+/* Routes server writes through the journal to callback (NULL detaches) */
+void bacnet_plugin_write_store_callback_set(write_property_function callback);
+/* Send_Write_Property_Request, journaled */
+uint8_t bacnet_plugin_send_write_property(
+    uint32_t device_id,
+    uint32_t object_type,
+    uint32_t object_instance,
+    uint32_t property,
+    BACNET_APPLICATION_DATA_VALUE *value,
+    uint8_t priority,
+    uint32_t array_index);
+
+/* Real-time profile of the thread that runs the stack */
+typedef struct {
+    uint64_t last_send_us; /* monotonic, last request sent */
+    uint64_t last_receive_us; /* monotonic, last PDU received */
+    int32_t cpu; /* pinned CPU, -1 for none */
+    uint32_t thread_changes; /* times the profile moved to another thread */
+    uint8_t priority; /* requested SCHED_FIFO priority, 0 for none */
+    bool affinity_applied;
+    bool fifo_applied;
+    bool memory_locked;
+} BACNET_PLUGIN_REALTIME_STATS;
+
+void bacnet_plugin_realtime_configure(
+    int32_t cpu,
+    uint8_t priority,
+    bool lock_memory);
+void bacnet_plugin_realtime_enter(void);
+uint64_t bacnet_plugin_monotonic_us(void);
+void bacnet_plugin_realtime_stats(BACNET_PLUGIN_REALTIME_STATS *stats);
+
+/* Native client: ReadProperty, RPM and WriteProperty with completions.
+ * Submit from any thread; requests are sent, and callbacks run, on the
+ * thread that polls the stack. Every accepted handle completes once.
+ *
+ *   BACNET_PLUGIN_PROPERTY_REF ref = { OBJECT_ANALOG_INPUT, 1,
+ *       PROP_PRESENT_VALUE, BACNET_ARRAY_ALL };
+ *   BACNET_PLUGIN_PROPERTY_VALUE value;
+ *   BACNET_PLUGIN_CLIENT_RESULT result;
+ *
+ *   if (bacnet_plugin_client_read_property(1234, &ref, &value, NULL, NULL) &&
+ *       bacnet_plugin_client_next(&result, 30000) &&
+ *       result.status == BACNET_PLUGIN_CLIENT_OK) {
+ *       use(value.value.real);
+ *   }
+ */
+#define BACNET_PLUGIN_CLIENT_MAX_PENDING 64
+#define BACNET_PLUGIN_CLIENT_MAX_REFS 32 /* properties per RPM */
+#define BACNET_PLUGIN_VALUE_DATA_SIZE 128
+
+/* BACNET_PLUGIN_CLIENT_RESULT.status */
+#define BACNET_PLUGIN_CLIENT_OK 0
+#define BACNET_PLUGIN_CLIENT_ERROR 1 /* error_class, error_code */
+#define BACNET_PLUGIN_CLIENT_REJECT 2 /* reason in error_code */
+#define BACNET_PLUGIN_CLIENT_ABORT 3 /* reason in error_code */
+#define BACNET_PLUGIN_CLIENT_TIMEOUT 4 /* all APDU retries went unanswered */
+#define BACNET_PLUGIN_CLIENT_NOT_SENT 5 /* no binding or no free invoke ID */
+#define BACNET_PLUGIN_CLIENT_BAD_REPLY 6 /* undecodable ack */
+#define BACNET_PLUGIN_CLIENT_CANCELLED 7
+#define BACNET_PLUGIN_CLIENT_STOPPED 8 /* the stack shut down */
+
+/* BACNET_PLUGIN_VALUE.tag for values that are not one application value
+ * (arrays, lists, constructed data): data holds them as encoded */
+#define BACNET_PLUGIN_VALUE_ENCODED 0xFF
+
+typedef struct {
+    uint8_t tag; /* BACNET_APPLICATION_TAG_* or BACNET_PLUGIN_VALUE_ENCODED */
+    uint8_t encoding; /* character set of a character string */
+    bool truncated; /* data was longer than BACNET_PLUGIN_VALUE_DATA_SIZE */
+    uint16_t length; /* bytes in data */
+    int64_t integer; /* boolean, unsigned, signed, enumerated; bits used of
+                        a bit string */
+    double real; /* real, double */
+    uint32_t object_type; /* object identifier */
+    uint32_t object_instance;
+    /* strings and bit strings; date as year (u16, big-endian), month, day,
+       weekday; time as hour, minute, second, hundredths */
+    uint8_t data[BACNET_PLUGIN_VALUE_DATA_SIZE];
+} BACNET_PLUGIN_VALUE;
+
+typedef struct {
+    uint32_t object_type;
+    uint32_t object_instance;
+    uint32_t property;
+    uint32_t array_index; /* BACNET_ARRAY_ALL for the whole property */
+} BACNET_PLUGIN_PROPERTY_REF;
+
+typedef struct {
+    uint32_t object_type;
+    uint32_t object_instance;
+    uint32_t property;
+    uint32_t array_index;
+    uint32_t error_class; /* set if has_error */
+    uint32_t error_code;
+    bool has_error;
+    BACNET_PLUGIN_VALUE value;
+} BACNET_PLUGIN_PROPERTY_VALUE;
+
+typedef struct {
+    uint32_t handle;
+    uint32_t device_id;
+    uint8_t service; /* SERVICE_CONFIRMED_* */
+    uint8_t status; /* BACNET_PLUGIN_CLIENT_* */
+    uint8_t invoke_id; /* 0 if never sent */
+    bool truncated; /* more values than the buffer holds */
+    uint16_t value_count; /* entries of values filled */
+    uint32_t error_class;
+    uint32_t error_code;
+    uint32_t elapsed_us; /* from send to completion */
+    BACNET_PLUGIN_PROPERTY_VALUE *values; /* the buffer given on submit */
+    void *context; /* as given on submit */
+} BACNET_PLUGIN_CLIENT_RESULT;
+
+/* Runs on the stack thread; must not block. NULL queues the result for
+ * bacnet_plugin_client_next instead. */
+typedef void (*bacnet_plugin_client_callback)(
+    const BACNET_PLUGIN_CLIENT_RESULT *result);
+
+/* Submit calls return a handle, or 0 if the stack is not running, all
+ * BACNET_PLUGIN_CLIENT_MAX_PENDING requests are in use or the arguments
+ * are invalid. Value buffers must stay valid until completion. */
+uint32_t bacnet_plugin_client_read_property(
+    uint32_t device_id,
+    const BACNET_PLUGIN_PROPERTY_REF *ref,
+    BACNET_PLUGIN_PROPERTY_VALUE *value,
+    bacnet_plugin_client_callback callback,
+    void *context);
+uint32_t bacnet_plugin_client_read_property_multiple(
+    uint32_t device_id,
+    const BACNET_PLUGIN_PROPERTY_REF *refs,
+    uint16_t ref_count,
+    BACNET_PLUGIN_PROPERTY_VALUE *values,
+    uint16_t capacity,
+    bacnet_plugin_client_callback callback,
+    void *context);
+uint32_t bacnet_plugin_client_write_property(
+    uint32_t device_id,
+    const BACNET_PLUGIN_PROPERTY_REF *ref,
+    const BACNET_PLUGIN_VALUE *value,
+    uint8_t priority, /* 1-16, or 0 for none */
+    bacnet_plugin_client_callback callback,
+    void *context);
+/* Stops writing to handle's buffer; it completes with
+ * BACNET_PLUGIN_CLIENT_CANCELLED once its invoke ID is released (on the
+ * next poll if not yet sent). False if handle is not outstanding, or its
+ * answer is already being decoded; it then completes as usual. */
+bool bacnet_plugin_client_cancel(uint32_t handle);
+/* Takes the next queued result, waiting up to timeout_ms (0: no wait) */
+bool bacnet_plugin_client_next(
+    BACNET_PLUGIN_CLIENT_RESULT *result,
+    uint32_t timeout_ms);
+/* Called by the stack thread on every poll: sends submitted requests and
+ * completes timed out ones */
+void bacnet_plugin_client_task(void);
+/* Completes everything outstanding with BACNET_PLUGIN_CLIENT_STOPPED */
+void bacnet_plugin_client_stop(void);
+
 #endif
@@ -0,0 +1,86 @@
+import 'dart:ffi' as ffi;
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:bacnet_plugin/bacnet_plugin_bindings.g.dart';
+import 'package:bacnet_plugin/src/native/worker/access_data_builders.dart';
+import 'package:bacnet_plugin/src/native/worker/accounting_allocator.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+void main() {
+  group('AccountingAllocator', () {
+    test('Tracks allocations and frees per site', () {
+      final memory = AccountingAllocator();
+      final a = memory.site('a');
+      final b = memory.site('b');
+
+      final p1 = a<ffi.Uint8>(16);
+      final p2 = a<ffi.Uint32>();
+      final p3 = b<ffi.Uint8>(100);
+
+      var stats = memory.snapshot();
+      expect(stats['a']!.allocations, equals(2));
+      expect(stats['a']!.liveBytes, equals(20));
+      expect(stats['b']!.liveBytes, equals(100));
+      expect(memory.liveBytes, equals(120));
+
+      a
+        ..free(p1)
+        ..free(p2);
+      b.free(p3);
+
+      stats = memory.snapshot();
+      expect(stats['a']!.frees, equals(2));
+      expect(stats['a']!.liveAllocations, equals(0));
+      expect(stats['a']!.peakBytes, equals(20));
+      expect(memory.liveBytes, equals(0));
+    });
+
+    test('Same site name shares counters', () {
+      final memory = AccountingAllocator();
+      final ptr = memory.site('x')<ffi.Uint8>(8);
+      memory.site('x').free(ptr);
+
+      final stats = memory.snapshot()['x']!;
+      expect(stats.allocations, equals(1));
+      expect(stats.frees, equals(1));
+    });
+
+    // The request handlers themselves are soaked against a live server in
+    // integration_test/native_memory_soak_test.dart.
+    test('RPM request structures are owned and freed', () {
+      final memory = AccountingAllocator();
+      final alloc = memory.site('handleReadPropMultiple');
+      const specs = [
+        BacnetReadAccessSpecification(
+          objectIdentifier: BacnetObject(type: 0, instance: 1),
+          properties: [
+            BacnetPropertyReference(propertyIdentifier: 85),
+            BacnetPropertyReference(propertyIdentifier: 77),
+          ],
+        ),
+        BacnetReadAccessSpecification(
+          objectIdentifier: BacnetObject(type: 2, instance: 7),
+          properties: [BacnetPropertyReference(propertyIdentifier: 85)],
+        ),
+      ];
+
+      final owned = <ffi.Pointer>[];
+      final head = buildReadAccessData(specs, alloc, owned);
+      expect(head.ref.object_instance, equals(1));
+      expect(head.ref.next.ref.object_instance, equals(7));
+      owned.forEach(alloc.free);
+
+      final stats = memory.snapshot()['handleReadPropMultiple']!;
+      expect(stats.allocations, equals(5));
+      expect(stats.frees, equals(stats.allocations));
+      expect(stats.liveBytes, equals(0));
+      expect(
+        stats.peakBytes,
+        equals(
+          2 * ffi.sizeOf<BACNET_READ_ACCESS_DATA>() +
+              3 * ffi.sizeOf<BACNET_PROPERTY_REFERENCE>(),
+        ),
+      );
+    });
+  });
+}
@@ -0,0 +1,88 @@
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+void main() {
+  group('AdmissionController', () {
+    var now = Duration.zero;
+    late AdmissionController admission;
+
+    setUp(() {
+      now = Duration.zero;
+      admission = AdmissionController(
+        maxInFlight: 2,
+        reservedInteractive: 1,
+        clock: () => now,
+      );
+    });
+
+    Future<void> flush() => Future<void>.delayed(Duration.zero);
+
+    test('Keeps a slot for interactive requests', () async {
+      const background = BacnetRequestPriority.background;
+      const interactive = BacnetRequestPriority.interactive;
+      await admission.admit(background);
+
+      var queuedBackground = false;
+      admission.admit(background).then((_) => queuedBackground = true);
+      await admission.admit(interactive);
+      await flush();
+      expect(queuedBackground, isFalse);
+
+      var queuedInteractive = false;
+      admission.admit(interactive).then((_) => queuedInteractive = true);
+      admission.release(interactive);
+      await flush();
+      expect(queuedInteractive, isTrue);
+      expect(queuedBackground, isFalse);
+
+      admission.release(background);
+      await flush();
+      expect(queuedBackground, isTrue);
+      expect(admission.stats.admitted, 4);
+    });
+
+    test('Sheds background work once the delay stays above target', () async {
+      const background = BacnetRequestPriority.background;
+      await admission.admit(background);
+      final queued = [
+        for (var i = 0; i < 4; i++)
+          admission.admit(background).then((_) => true, onError: (_) => false),
+      ];
+
+      // Above target, but not yet for a whole interval.
+      now = const Duration(milliseconds: 200);
+      admission.release(background);
+      expect(await queued[0], isTrue);
+      expect(admission.isDropping, isFalse);
+
+      now = const Duration(milliseconds: 1500);
+      admission.release(background);
+      expect(await queued[1], isFalse);
+      expect(await queued[2], isTrue);
+      expect(admission.isDropping, isTrue);
+
+      await expectLater(
+        admission.admit(background),
+        throwsA(isA<BacnetOverloadException>()),
+      );
+      // Interactive work is never shed.
+      await admission.admit(BacnetRequestPriority.interactive);
+
+      final stats = admission.stats;
+      expect(stats.shed, 1);
+      expect(stats.rejected, 1);
+      expect(stats.queued, 1);
+      expect(stats.dropping, isTrue);
+    });
+
+    test('Fails queued requests', () async {
+      await admission.admit(BacnetRequestPriority.interactive);
+      await admission.admit(BacnetRequestPriority.interactive);
+      final queued = admission.admit(BacnetRequestPriority.interactive);
+
+      admission.failQueued(const BacnetException('stopped'));
+      await expectLater(queued, throwsA(isA<BacnetException>()));
+      expect(admission.stats.queued, 0);
+    });
+  });
+}
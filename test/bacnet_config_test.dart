@@ -0,0 +1,82 @@
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+void main() {
+  group('MstpConfig', () {
+    test('Defaults batch frames per token hold', () {
+      const config = MstpConfig(serialPort: '/dev/ttyUSB0');
+      expect(config.baudRate, MstpConfig.defaultBaudRate);
+      expect(config.maxInfoFrames, greaterThan(1));
+      expect(MstpConfig.baudRates, containsAll([76800, 115200]));
+    });
+
+    test('copyWith and equality', () {
+      const config = MstpConfig(serialPort: '/dev/ttyUSB0', macAddress: 3);
+      final faster = config.copyWith(baudRate: 115200);
+      expect(faster.baudRate, 115200);
+      expect(faster.macAddress, 3);
+      expect(faster, isNot(config));
+      expect(faster.copyWith(baudRate: config.baudRate), config);
+      expect(
+        faster.copyWith(baudRate: config.baudRate).hashCode,
+        config.hashCode,
+      );
+    });
+
+    test('Rejects out of range addresses', () {
+      expect(
+        () => MstpConfig(serialPort: '/dev/ttyS0', macAddress: 128),
+        throwsA(isA<AssertionError>()),
+      );
+      expect(
+        () => MstpConfig(
+          serialPort: '/dev/ttyS0',
+          macAddress: 10,
+          maxMaster: 5,
+        ),
+        throwsA(isA<AssertionError>()),
+      );
+    });
+
+    test('BacnetConfig carries MS/TP settings', () {
+      const mstp = MstpConfig(serialPort: '/dev/ttyUSB0');
+      const config = BacnetConfig(mstp: mstp);
+      expect(config.copyWith(port: 47809).mstp, mstp);
+      expect(config.toString(), contains('/dev/ttyUSB0'));
+      expect(const BacnetConfig().mstp, isNull);
+    });
+  });
+
+  test('BacnetConfig defaults to the worker execution mode', () {
+    const config = BacnetConfig();
+    expect(config.executionMode, BacnetExecutionMode.worker);
+    final direct = config.copyWith(executionMode: BacnetExecutionMode.direct);
+    expect(direct.executionMode, BacnetExecutionMode.direct);
+    expect(direct.copyWith(port: 47809).executionMode, direct.executionMode);
+    expect(direct.toString(), contains('mode: direct'));
+    expect(config.toString(), isNot(contains('mode:')));
+  });
+
+  test('RealtimeProfile defaults and applied state', () {
+    const profile = RealtimeProfile(cpu: 3);
+    expect(profile.priority, RealtimeProfile.defaultPriority);
+    expect(profile.lockMemory, isTrue);
+    expect(profile.busyPoll, isTrue);
+    expect(profile, const RealtimeProfile(cpu: 3));
+    expect(
+      () => RealtimeProfile(priority: 100),
+      throwsA(isA<AssertionError>()),
+    );
+
+    const denied = RealtimeStats(cpu: 3, priority: 49, affinityApplied: true);
+    expect(denied.fullyApplied, isFalse);
+    expect(denied.toString(), contains('priority: 49 (not applied)'));
+    expect(const RealtimeStats().fullyApplied, isTrue);
+  });
+
+  test('MstpStats reports the share of data frames', () {
+    const stats = MstpStats(active: true, transmitFrames: 40, transmitPdus: 30);
+    expect(stats.dataFrameRatio, 0.75);
+    expect(const MstpStats().dataFrameRatio, 0);
+  });
+}
@@ -0,0 +1,75 @@
+import 'dart:async';
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:mocktail/mocktail.dart';
+
+class MockBacnetClient extends Mock implements BacnetClient {}
+
+void main() {
+  late MockBacnetClient client;
+  late StreamController<dynamic> events;
+  late Set<int> online;
+  late List<List<int>> batches;
+
+  setUp(() {
+    client = MockBacnetClient();
+    events = StreamController<dynamic>.broadcast();
+    online = {};
+    batches = [];
+    when(() => client.events).thenAnswer((_) => events.stream);
+    when(() => client.sendDirectedWhoIs(any())).thenAnswer((invocation) async {
+      final ids = invocation.positionalArguments[0] as List<int>;
+      batches.add(ids);
+      for (final id in ids.where(online.contains)) {
+        scheduleMicrotask(
+          () => events.add(
+            IAmResponse(deviceId: id, net: 0, mac: const [], len: 0),
+          ),
+        );
+      }
+      return [for (final id in ids) if (id >= 100) id];
+    });
+  });
+
+  tearDown(() => events.close());
+
+  test('Asks each device in paced batches', () async {
+    online = {for (var i = 0; i < 10; i++) i};
+    final refresher = BindingRefresher(
+      client,
+      batchSize: 4,
+      batchInterval: Duration.zero,
+    );
+
+    final report = await refresher.refresh([
+      for (var i = 0; i < 10; i++) i,
+      100,
+    ]);
+
+    expect(batches.map((b) => b.length), [4, 4, 3]);
+    expect(report.responded, hasLength(10));
+    expect(report.missed, isEmpty);
+    expect(report.unbound, {100});
+  });
+
+  test('Marks devices unreachable after consecutive misses', () async {
+    online = {1};
+    final refresher = BindingRefresher(
+      client,
+      responseTimeout: const Duration(milliseconds: 20),
+    );
+
+    var report = await refresher.refresh([1, 2]);
+    expect(report.missed, {2});
+    expect(report.unreachable, isEmpty);
+
+    report = await refresher.refresh([1, 2]);
+    expect(report.unreachable, {2});
+
+    online = {1, 2};
+    report = await refresher.refresh([1, 2]);
+    expect(report.responded, {1, 2});
+    expect(refresher.unreachable, isEmpty);
+  });
+}
@@ -0,0 +1,76 @@
+import 'dart:ffi' as ffi;
+
+import 'package:bacnet_plugin/src/native/worker/charset_decoder.dart';
+import 'package:ffi/ffi.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+String _decode(List<int> bytes) {
+  final ptr = calloc<ffi.Uint8>(bytes.length);
+  try {
+    for (var i = 0; i < bytes.length; i++) {
+      ptr[i] = bytes[i];
+    }
+    return decodeCharacterString(ptr, 0, bytes.length);
+  } finally {
+    calloc.free(ptr);
+  }
+}
+
+void main() {
+  group('decodeCharacterString', () {
+    test('Decodes UTF-8', () {
+      expect(
+        _decode([BacnetCharacterSet.utf8, 0x52, 0xC3, 0xA4, 0x75, 0x6D]),
+        equals('Räum'),
+      );
+    });
+
+    test('Decodes ISO 8859-1', () {
+      expect(
+        _decode([BacnetCharacterSet.latin1, 0x52, 0xE4, 0x75, 0x6D]),
+        equals('Räum'),
+      );
+    });
+
+    test('Decodes UCS-2 big-endian', () {
+      expect(
+        _decode([BacnetCharacterSet.ucs2, 0x00, 0x41, 0x00, 0xE4, 0x65, 0xE5]),
+        equals('Aä日'),
+      );
+    });
+
+    test('Decodes UCS-4 including astral code points', () {
+      expect(
+        _decode([
+          BacnetCharacterSet.ucs4,
+          0x00, 0x00, 0x00, 0x41, //
+          0x00, 0x01, 0xF5, 0x25,
+        ]),
+        equals('A\u{1F525}'),
+      );
+    });
+
+    test('Interns repeated strings', () {
+      final first = _decode([BacnetCharacterSet.utf8, 0x41, 0x48, 0x55]);
+      final second = _decode([BacnetCharacterSet.latin1, 0x41, 0x48, 0x55]);
+      expect(identical(first, second), isTrue);
+    });
+  });
+
+  group('StringInterner', () {
+    test('Skips long strings and resets when full', () {
+      final interner = StringInterner(maxEntries: 2, maxLength: 4);
+      expect(interner.intern('toolong'), equals('toolong'));
+      expect(interner.length, equals(0));
+
+      interner
+        ..intern('a')
+        ..intern('b')
+        ..intern('a');
+      expect(interner.hits, equals(1));
+
+      interner.intern('c');
+      expect(interner.length, equals(1));
+    });
+  });
+}
@@ -11,6 +11,10 @@ void main() {
   late DeviceScanner scanner;
   late StreamController<WorkerResponse> eventController;
 
+  setUpAll(() {
+    registerFallbackValue(BacnetRequestPriority.interactive);
+  });
+
   setUp(() {
     mockClient = MockBacnetClient();
     eventController = StreamController<WorkerResponse>.broadcast();
@@ -158,9 +162,13 @@ void main() {
           () => mockClient.scanDevice(deviceId),
         ).thenAnswer((_) async => [obj1, obj2]);
 
-        when(() => mockClient.readMultiple(deviceId, any())).thenAnswer((
-          invocation,
-        ) async {
+        when(
+          () => mockClient.readMultiple(
+            deviceId,
+            any(),
+            priority: any(named: 'priority'),
+          ),
+        ).thenAnswer((invocation) async {
           // Verify batching logic via invocation arguments if needed
           // Return mock results
           return {
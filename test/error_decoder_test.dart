@@ -0,0 +1,48 @@
+import 'dart:ffi' as ffi;
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:bacnet_plugin/src/native/worker/error_decoder.dart';
+import 'package:ffi/ffi.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+(int, int)? _decode(List<int> bytes) {
+  final ptr = calloc<ffi.Uint8>(bytes.length);
+  try {
+    for (var i = 0; i < bytes.length; i++) {
+      ptr[i] = bytes[i];
+    }
+    return decodeComplexError(ptr, bytes.length);
+  } finally {
+    calloc.free(ptr);
+  }
+}
+
+void main() {
+  group('decodeComplexError', () {
+    test('Decodes a WritePropertyMultiple-Error', () {
+      final decoded = _decode([
+        0x0E, 0x91, 0x02, 0x91, 0x28, 0x0F, // write-access-denied
+        0x1E, 0x0C, 0x00, 0x40, 0x00, 0x01, 0x19, 0x55, 0x1F,
+      ]);
+      expect(decoded, equals((BacnetErrorClass.property, 40)));
+    });
+
+    test('Rejects malformed payloads', () {
+      expect(_decode([]), isNull);
+      expect(_decode([0x0E, 0x91, 0x02]), isNull);
+      expect(_decode([0x0E, 0x91, 0x02, 0x21, 0x01]), isNull);
+    });
+  });
+
+  group('BacnetProtocolException', () {
+    test('Exposes a typed error and readable names', () {
+      const e = BacnetProtocolException(
+        'Device returned an error',
+        errorClass: BacnetErrorClass.property,
+        errorCode: BacnetErrorCode.unknownProperty,
+      );
+      expect(e.error.errorCode, equals(BacnetErrorCode.unknownProperty));
+      expect(e.toString(), contains('Unknown Property'));
+    });
+  });
+}
@@ -0,0 +1,226 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:mocktail/mocktail.dart';
+
+class MockBacnetClient extends Mock implements BacnetClient {}
+
+void main() {
+  late MockBacnetClient client;
+  late Directory dir;
+  late String path;
+  late List<int> listIndexes;
+
+  void stubObjectList(int deviceId, int count) {
+    when(
+      () => client.readProperty(
+        deviceId,
+        BacnetObjectType.device,
+        deviceId,
+        BacnetPropertyId.objectList,
+        arrayIndex: any(named: 'arrayIndex'),
+        priority: any(named: 'priority'),
+      ),
+    ).thenAnswer((invocation) async {
+      final index = invocation.namedArguments[#arrayIndex] as int;
+      return index == 0 ? count : {'type': 0, 'instance': index};
+    });
+    when(
+      () => client.readMultiple(
+        deviceId,
+        any(),
+        priority: any(named: 'priority'),
+      ),
+    ).thenAnswer((
+      invocation,
+    ) async {
+      final specs =
+          invocation.positionalArguments[1]
+              as List<BacnetReadAccessSpecification>;
+      final device = specs.first.objectIdentifier;
+      if (device.type == BacnetObjectType.device) {
+        final indexes = [
+          for (final p in specs.first.properties) p.propertyArrayIndex,
+        ];
+        listIndexes.addAll(indexes);
+        final entries = {
+          for (final i in indexes) i: {'type': 0, 'instance': i},
+        };
+        return {
+          '${device.type}:${device.instance}': {
+            BacnetPropertyId.objectList: indexes.length == 1
+                ? entries.values.single
+                : entries,
+          },
+        };
+      }
+      return {
+        for (final spec in specs)
+          '${spec.objectIdentifier.type}:${spec.objectIdentifier.instance}': {
+            BacnetPropertyId.objectName: 'AI ${spec.objectIdentifier.instance}',
+          },
+      };
+    });
+  }
+
+  setUpAll(() {
+    registerFallbackValue(BacnetRequestPriority.interactive);
+  });
+
+  setUp(() {
+    client = MockBacnetClient();
+    listIndexes = [];
+    dir = Directory.systemTemp.createTempSync('inventory');
+    path = '${dir.path}/site.json';
+  });
+
+  tearDown(() => dir.deleteSync(recursive: true));
+
+  group('InventoryJob', () {
+    test('Inventories every object and checkpoints the result', () async {
+      stubObjectList(1, 5);
+      final job = InventoryJob(
+        scanner: DeviceScanner(client),
+        checkpointPath: path,
+        deviceIds: const [1],
+        pageSize: 2,
+      );
+      final reports = <InventoryProgress>[];
+      job.progress.listen(reports.add);
+
+      final result = await job.run();
+      final device = result.devices[1]!;
+
+      expect(device.status, InventoryStatus.done);
+      expect(device.objects, hasLength(5));
+      expect(device.properties['0:5']?[BacnetPropertyId.objectName], 'AI 5');
+      expect(reports.last.objectsRead, 5);
+      expect(reports.last.eta, Duration.zero);
+
+      final saved = InventoryCheckpoint.fromJson(
+        jsonDecode(File(path).readAsStringSync()) as Map<String, dynamic>,
+      );
+      expect(saved.devices[1]!.objectsRead, 5);
+      // Three list pages, one RPM each.
+      expect(listIndexes, [1, 2, 3, 4, 5]);
+      expect(File(path).readAsLinesSync(), hasLength(1));
+      await job.dispose();
+    });
+
+    test('Resumes from the last appended object-list page', () async {
+      final partial = InventoryCheckpoint()..discovered = true;
+      partial.devices[1] = DeviceInventory(1)
+        ..status = InventoryStatus.listing
+        ..objectCount = 5
+        ..objects.add(const BacnetObject(type: 0, instance: 1));
+      final page = {
+        ...partial.devices[1]!.toJson(),
+        'objects': ['0:2'],
+      };
+      File(path).writeAsStringSync(
+        '${jsonEncode(partial.toJson())}\n'
+        '${jsonEncode(page)}\n'
+        // Torn by a crash mid-append.
+        '{"deviceId":1,"status":"listing","objects":["0:3"',
+      );
+      stubObjectList(1, 5);
+
+      final job = InventoryJob(
+        scanner: DeviceScanner(client),
+        checkpointPath: path,
+        pageSize: 2,
+      );
+      final result = await job.run();
+
+      expect(result.devices[1]!.status, InventoryStatus.done);
+      expect(result.devices[1]!.objects, hasLength(5));
+      expect(result.devices[1]!.objects[2].instance, 3);
+      expect(listIndexes, [3, 4, 5]);
+      verifyNever(
+        () => client.readProperty(
+          1,
+          BacnetObjectType.device,
+          1,
+          BacnetPropertyId.objectList,
+          arrayIndex: any(named: 'arrayIndex'),
+          priority: any(named: 'priority'),
+        ),
+      );
+      await job.dispose();
+    });
+
+    test('Marks a failing device and keeps the others', () async {
+      stubObjectList(1, 1);
+      when(
+        () => client.readProperty(
+          2,
+          any(),
+          any(),
+          any(),
+          arrayIndex: any(named: 'arrayIndex'),
+          priority: any(named: 'priority'),
+        ),
+      ).thenThrow(const BacnetTimeoutException('ReadProperty timed out'));
+
+      final job = InventoryJob(
+        scanner: DeviceScanner(client),
+        checkpointPath: path,
+        deviceIds: const [1, 2],
+      );
+      final result = await job.run();
+
+      expect(result.devices[1]!.status, InventoryStatus.done);
+      expect(result.devices[2]!.status, InventoryStatus.failed);
+      expect(result.devices[2]!.error, contains('timed out'));
+      await job.dispose();
+    });
+  });
+
+  group('InventoryJob checkpoint', () {
+    test('Reports a failed write and keeps saving afterwards', () async {
+      stubObjectList(1, 3);
+      final missing = Directory('${dir.path}/missing');
+      final job = InventoryJob(
+        scanner: DeviceScanner(client),
+        checkpointPath: '${missing.path}/site.json',
+        deviceIds: const [1],
+      );
+      final reports = <InventoryProgress>[];
+      job.progress.listen(reports.add);
+
+      await expectLater(job.run(), throwsA(isA<FileSystemException>()));
+      await Future<void>.delayed(Duration.zero);
+      expect(reports.last.checkpointError, isA<FileSystemException>());
+
+      missing.createSync();
+      final result = await job.run();
+      await Future<void>.delayed(Duration.zero);
+      expect(result.devices[1]!.status, InventoryStatus.done);
+      expect(File('${missing.path}/site.json').existsSync(), isTrue);
+      expect(reports.last.checkpointError, isNull);
+      await job.dispose();
+    });
+  });
+
+  group('RequestBudget', () {
+    test('Never runs more than maxConcurrent requests', () async {
+      final budget = RequestBudget(2);
+      var running = 0;
+      var peak = 0;
+      await Future.wait([
+        for (var i = 0; i < 10; i++)
+          budget.run(() async {
+            running++;
+            if (running > peak) peak = running;
+            await Future<void>.delayed(const Duration(milliseconds: 1));
+            running--;
+          }),
+      ]);
+      expect(peak, 2);
+      expect(budget.active, 0);
+    });
+  });
+}
@@ -0,0 +1,45 @@
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+void main() {
+  group('MetricsResponse', () {
+    test('Carries every worker counter into BacnetMetrics', () {
+      const realtime = RealtimeStats(
+        cpu: 3,
+        priority: 80,
+        affinityApplied: true,
+        fifoApplied: true,
+        memoryLocked: true,
+        busyPoll: true,
+        threadChanges: 2,
+      );
+      const journal = WriteJournalStats(open: true, records: 7);
+      const response = MetricsResponse(
+        trackingId: 1,
+        nativeMemory: {},
+        internedStrings: 4,
+        internHits: 9,
+        journal: journal,
+        realtime: realtime,
+      );
+
+      final metrics = response.toMetrics(
+        admission: const AdmissionStats(shed: 5),
+      );
+      expect(metrics.realtime, same(realtime));
+      expect(metrics.realtime.fifoApplied, isTrue);
+      expect(metrics.realtime.cpu, 3);
+      expect(metrics.journal, same(journal));
+      expect(metrics.internedStrings, 4);
+      expect(metrics.internHits, 9);
+      expect(metrics.admission.shed, 5);
+    });
+
+    test('Defaults to an unapplied profile', () {
+      const response = MetricsResponse(trackingId: 1, nativeMemory: {});
+      final realtime = response.toMetrics().realtime;
+      expect(realtime.cpu, isNull);
+      expect(realtime.fifoApplied, isFalse);
+    });
+  });
+}
@@ -0,0 +1,119 @@
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:mocktail/mocktail.dart';
+
+class MockBacnetClient extends Mock implements BacnetClient {}
+
+void main() {
+  late MockBacnetClient client;
+  late List<List<BacnetReadAccessSpecification>> sent;
+
+  /// Answers RPMs like a device holding [count] analog inputs.
+  void stubDevice(int count) {
+    when(
+      () => client.readMultiple(1234, any(), priority: any(named: 'priority')),
+    ).thenAnswer((invocation) async {
+      final specs =
+          invocation.positionalArguments[1]
+              as List<BacnetReadAccessSpecification>;
+      sent.add(specs);
+      final first = specs.first;
+      if (first.objectIdentifier.type == BacnetObjectType.device) {
+        final list = <int, dynamic>{
+          for (final ref in first.properties)
+            ref.propertyArrayIndex: ref.propertyArrayIndex == 0
+                ? count
+                : ref.propertyArrayIndex <= count
+                ? {'type': 0, 'instance': ref.propertyArrayIndex}
+                : const BacnetError(2, 42),
+        };
+        return {
+          '8:1234': {
+            BacnetPropertyId.objectList: list.length == 1
+                ? list.values.single
+                : list,
+          },
+        };
+      }
+      return {
+        for (final spec in specs)
+          '0:${spec.objectIdentifier.instance}': {
+            BacnetPropertyId.objectName: 'AI ${spec.objectIdentifier.instance}',
+            BacnetPropertyId.presentValue: 20.5,
+            BacnetPropertyId.units: 62,
+          },
+      };
+    });
+  }
+
+  setUpAll(() {
+    registerFallbackValue(BacnetRequestPriority.interactive);
+  });
+
+  setUp(() {
+    client = MockBacnetClient();
+    sent = [];
+  });
+
+  test('First page takes two round trips and prefetches the next', () async {
+    stubDevice(45);
+    final browser = ObjectBrowser(client, 1234, pageSize: 20);
+
+    final page = await browser.page(0);
+    expect(page.objectCount, 45);
+    expect(page.objects, hasLength(20));
+    expect(
+      page.objects.first,
+      const BrowsedObject(
+        object: BacnetObject(type: 0, instance: 1),
+        name: 'AI 1',
+        presentValue: 20.5,
+        units: 62,
+      ),
+    );
+    expect(sent, hasLength(2));
+    // Count and the first slice in one request.
+    expect(sent.first.single.properties.first.propertyArrayIndex, 0);
+    expect(browser.pageCount, 3);
+
+    await pumpEventQueue();
+    expect(browser.cachedPage(1)?.objects.first.name, 'AI 21');
+    expect(browser.requests, 4);
+
+    final last = await browser.page(2);
+    expect(last.objects.map((o) => o.object.instance), [41, 42, 43, 44, 45]);
+    await pumpEventQueue();
+    expect(browser.requests, 6);
+  });
+
+  test('Serves cached pages without new requests', () async {
+    stubDevice(10);
+    final browser = ObjectBrowser(client, 1234, pageSize: 20);
+    await browser.page(0);
+    await browser.page(0);
+    expect(sent, hasLength(2));
+    expect(() => browser.page(1), throwsRangeError);
+
+    browser.clear();
+    await browser.page(0);
+    expect(sent, hasLength(4));
+  });
+
+  test('Evicts the least recently used page', () async {
+    stubDevice(100);
+    final browser = ObjectBrowser(
+      client,
+      1234,
+      pageSize: 10,
+      prefetchPages: 0,
+      maxCachedPages: 2,
+    );
+    await browser.page(0);
+    await browser.page(1);
+    await browser.page(0);
+    await browser.page(2);
+    expect(browser.cachedPage(0), isNotNull);
+    expect(browser.cachedPage(1), isNull);
+    expect(browser.cachedPage(2), isNotNull);
+  });
+}
@@ -0,0 +1,50 @@
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+void main() {
+  group('BacnetPacketFilter', () {
+    test('Parses sources with and without a port', () {
+      expect(
+        BacnetPacketFilter.parseSource('192.168.1.20'),
+        equals((0xC0A80114, 0)),
+      );
+      expect(
+        BacnetPacketFilter.parseSource('10.0.0.1:47809'),
+        equals((0x0A000001, 47809)),
+      );
+    });
+
+    test('Rejects sources that are not IPv4', () {
+      expect(
+        () => BacnetPacketFilter.parseSource('fe80::1'),
+        throwsFormatException,
+      );
+      expect(
+        () => BacnetPacketFilter.parseSource('10.0.0.1:70000'),
+        throwsFormatException,
+      );
+      expect(
+        () => BacnetPacketFilter.parseSource('controller'),
+        throwsFormatException,
+      );
+    });
+
+    test('Compares service sets regardless of order', () {
+      const a = BacnetPacketFilter(
+        deniedUnconfirmedServices: {
+          BacnetUnconfirmedService.whoHas,
+          BacnetUnconfirmedService.timeSynchronization,
+        },
+      );
+      const b = BacnetPacketFilter(
+        deniedUnconfirmedServices: {
+          BacnetUnconfirmedService.timeSynchronization,
+          BacnetUnconfirmedService.whoHas,
+        },
+      );
+      expect(a, equals(b));
+      expect(a.hashCode, equals(b.hashCode));
+      expect(a, isNot(equals(BacnetPacketFilter.allowAll)));
+    });
+  });
+}
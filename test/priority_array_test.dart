@@ -0,0 +1,52 @@
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+void main() {
+  const ao1 = BacnetObject(type: BacnetObjectType.analogOutput, instance: 1);
+
+  group('BacnetPriorityArray', () {
+    test('Computes the active priority from decoded slots', () {
+      final decoded = List<Object?>.filled(16, null)
+        ..[7] = 55.0
+        ..[15] = 20.0;
+      final pa = BacnetPriorityArray.fromDecoded(ao1, decoded, 0.0);
+
+      expect(pa.activePriority, equals(8));
+      expect(pa.activeValue, equals(55.0));
+      expect(pa.commandedPriorities, equals([8, 16]));
+      expect(pa[16], equals(20.0));
+      expect(pa.error, isNull);
+    });
+
+    test('Falls back to relinquish default when nothing is commanded', () {
+      final pa = BacnetPriorityArray.fromDecoded(
+        ao1,
+        List<Object?>.filled(16, null),
+        true,
+      );
+
+      expect(pa.activePriority, isNull);
+      expect(pa.activeValue, isTrue);
+      expect(pa.commandedPriorities, isEmpty);
+    });
+
+    test('Pads short arrays and keeps property errors', () {
+      final short = BacnetPriorityArray.fromDecoded(ao1, [null, 1], null);
+      expect(short.slots, hasLength(16));
+      expect(short.activePriority, equals(2));
+
+      final failed = BacnetPriorityArray.fromDecoded(
+        ao1,
+        const BacnetError(BacnetErrorClass.property, 32),
+        null,
+      );
+      expect(failed.error?.errorCode, equals(32));
+      expect(failed.activePriority, isNull);
+    });
+
+    test('Parses object keys from RPM results', () {
+      expect(BacnetObject.fromKey('1:1'), equals(ao1));
+      expect(() => BacnetObject.fromKey('bad'), throwsFormatException);
+    });
+  });
+}
@@ -11,6 +11,10 @@ void main() {
   late StreamController<dynamic> eventController;
   late PropertyMonitor monitor;
 
+  setUpAll(() {
+    registerFallbackValue(BacnetRequestPriority.interactive);
+  });
+
   setUp(() {
     mockClient = MockBacnetClient();
     eventController = StreamController<dynamic>.broadcast();
@@ -64,7 +68,13 @@ void main() {
       const polledValue = 200.0;
 
       when(
-        () => mockClient.readProperty(deviceId, 0, 1, 85),
+        () => mockClient.readProperty(
+          deviceId,
+          0,
+          1,
+          85,
+          priority: any(named: 'priority'),
+        ),
       ).thenAnswer((_) async => polledValue);
 
       // Act
@@ -109,9 +119,15 @@ void main() {
 
       // Setup readProperty to return initial then new value
       var callCount = 0;
-      when(() => mockClient.readProperty(deviceId, 0, 1, 85)).thenAnswer((
-        _,
-      ) async {
+      when(
+        () => mockClient.readProperty(
+          deviceId,
+          0,
+          1,
+          85,
+          priority: any(named: 'priority'),
+        ),
+      ).thenAnswer((_) async {
         callCount++;
         return callCount == 1 ? initialValue : newValue;
       });
@@ -163,5 +179,139 @@ void main() {
         );
       });
     });
+
+    test('monitor passes COV filtering parameters', () async {
+      const deviceId = 1234;
+      const object = BacnetObject(type: 0, instance: 1);
+
+      when(
+        () => mockClient.readProperty(deviceId, 0, 1, 85),
+      ).thenAnswer((_) async => 100.0);
+      when(
+        () => mockClient.subscribeCOV(
+          any(),
+          any(),
+          any(),
+          propId: any(named: 'propId'),
+          confirmed: any(named: 'confirmed'),
+          lifetime: any(named: 'lifetime'),
+          covIncrement: any(named: 'covIncrement'),
+        ),
+      ).thenAnswer((_) async {});
+
+      final subscription = monitor
+          .monitor(
+            deviceId: deviceId,
+            object: object,
+            propertyId: 85,
+            covIncrement: 0.5,
+            confirmedCov: true,
+            covLifetime: const Duration(minutes: 10),
+          )
+          .listen((_) {});
+      await Future<void>.delayed(const Duration(milliseconds: 20));
+
+      verify(
+        () => mockClient.subscribeCOV(
+          deviceId,
+          0,
+          1,
+          propId: 85,
+          confirmed: true,
+          lifetime: 600,
+          covIncrement: 0.5,
+        ),
+      ).called(1);
+      await subscription.cancel();
+    });
+
+    test('monitor cancels the COV subscription on cancel', () async {
+      const deviceId = 1234;
+      const object = BacnetObject(type: 0, instance: 1);
+
+      when(
+        () => mockClient.readProperty(deviceId, 0, 1, 85),
+      ).thenAnswer((_) async => 100.0);
+      when(
+        () => mockClient.subscribeCOV(
+          any(),
+          any(),
+          any(),
+          propId: any(named: 'propId'),
+          confirmed: any(named: 'confirmed'),
+          lifetime: any(named: 'lifetime'),
+          covIncrement: any(named: 'covIncrement'),
+        ),
+      ).thenAnswer((_) async {});
+      when(
+        () => mockClient.unsubscribeCOV(
+          any(),
+          any(),
+          any(),
+          propId: any(named: 'propId'),
+        ),
+      ).thenAnswer((_) async {});
+
+      final subscription = monitor
+          .monitor(deviceId: deviceId, object: object, propertyId: 85)
+          .listen((_) {});
+      await Future<void>.delayed(const Duration(milliseconds: 20));
+      verifyNever(
+        () => mockClient.unsubscribeCOV(
+          any(),
+          any(),
+          any(),
+          propId: any(named: 'propId'),
+        ),
+      );
+
+      await subscription.cancel();
+      verify(
+        () => mockClient.unsubscribeCOV(deviceId, 0, 1, propId: 85),
+      ).called(1);
+    });
+
+    test('monitor uses the value carried by a COV notification', () async {
+      const deviceId = 1234;
+      const object = BacnetObject(type: 0, instance: 1);
+      const propertyId = 85;
+
+      when(
+        () => mockClient.readProperty(deviceId, 0, 1, 85),
+      ).thenAnswer((_) async => 100.0);
+      when(
+        () => mockClient.subscribeCOV(
+          any(),
+          any(),
+          any(),
+          propId: any(named: 'propId'),
+        ),
+      ).thenAnswer((_) async {});
+
+      final stream = monitor.monitor(
+        deviceId: deviceId,
+        object: object,
+        propertyId: propertyId,
+      );
+
+      Future.delayed(const Duration(milliseconds: 50), () {
+        eventController.add(
+          const COVNotificationResponse(
+            deviceId: deviceId,
+            objectType: 0,
+            instance: 1,
+            timestamp: 'now',
+            propertyId: propertyId,
+            value: 42.5,
+            confirmed: true,
+          ),
+        );
+      });
+
+      final list = await stream.take(2).toList();
+      expect(list[1].value, equals(42.5));
+      expect(list[1].source, UpdateSource.cov);
+      verify(() => mockClient.readProperty(deviceId, 0, 1, 85)).called(1);
+    });
   });
 }
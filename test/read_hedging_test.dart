@@ -0,0 +1,203 @@
+import 'dart:async';
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+void main() {
+  group('ReadHedger', () {
+    var now = Duration.zero;
+    late List<_FakeTimer> timers;
+    late List<Completer<int>> sent;
+
+    ReadHedger hedger(
+      ReadHedgingPolicy policy, {
+      bool Function()? canHedge,
+    }) => ReadHedger(
+      policy,
+      canHedge: canHedge,
+      clock: () => now,
+      timer: (delay, callback) {
+        final timer = _FakeTimer(delay, callback);
+        timers.add(timer);
+        return timer;
+      },
+    );
+
+    Future<int> attempt() {
+      final completer = Completer<int>();
+      sent.add(completer);
+      return completer.future;
+    }
+
+    /// Teaches [h] that device 1 answers in 10 ms.
+    Future<void> warmUp(ReadHedger h, int reads) async {
+      for (var i = 0; i < reads; i++) {
+        final read = h.run(1, attempt);
+        now += const Duration(milliseconds: 10);
+        sent.last.complete(i);
+        await read;
+      }
+    }
+
+    setUp(() {
+      now = Duration.zero;
+      timers = [];
+      sent = [];
+    });
+
+    test('Hedges only once the device has a p95', () async {
+      final h = hedger(const ReadHedgingPolicy(minSamples: 4, window: 8));
+      await warmUp(h, 4);
+      expect(timers.where((t) => t.isActive), isEmpty);
+      expect(h.hedgeDelay(1), const Duration(milliseconds: 10));
+      expect(h.hedgeDelay(2), isNull);
+
+      h.run(1, attempt);
+      expect(timers.last.delay, const Duration(milliseconds: 10));
+    });
+
+    test('Returns the first answer and reports the tail saved', () async {
+      final h = hedger(
+        const ReadHedgingPolicy(
+          minSamples: 4,
+          window: 8,
+          deviceBudget: 1,
+          globalBudget: 1,
+        ),
+      );
+      await warmUp(h, 4);
+
+      final read = h.run(1, attempt);
+      final primary = sent.last;
+      now += const Duration(milliseconds: 10);
+      timers.last.fire();
+      expect(sent, hasLength(6));
+
+      now += const Duration(milliseconds: 5);
+      sent.last.complete(42);
+      expect(await read, 42);
+
+      // The slow first copy still counts towards the unhedged latency.
+      now += const Duration(seconds: 3);
+      primary.complete(42);
+      await Future<void>.delayed(Duration.zero);
+
+      final stats = h.stats;
+      expect(stats.reads, 5);
+      expect(stats.hedged, 1);
+      expect(stats.hedgeWins, 1);
+      expect(stats.inFlight, 0);
+      expect(stats.p99, const Duration(milliseconds: 15));
+      expect(stats.unhedgedP99, const Duration(milliseconds: 3015));
+      expect(stats.p99Saved, const Duration(seconds: 3));
+    });
+
+    test('Caps hedges with the device and global budgets', () async {
+      final h = hedger(
+        const ReadHedgingPolicy(
+          minSamples: 4,
+          window: 8,
+          deviceBudget: 0.25,
+          globalBudget: 1,
+        ),
+      );
+      await warmUp(h, 4);
+      // One token after the warm-up reads, then a quarter per read.
+      for (var i = 0; i < 3; i++) {
+        h.run(1, attempt);
+        timers.last.fire();
+      }
+      expect(h.stats.hedged, 1);
+      expect(h.stats.suppressed, 2);
+      h.run(1, attempt);
+      timers.last.fire();
+      expect(h.stats.hedged, 2);
+
+      final global = hedger(
+        const ReadHedgingPolicy(
+          minSamples: 4,
+          window: 8,
+          deviceBudget: 1,
+          globalBudget: 0.25,
+        ),
+      );
+      await warmUp(global, 4);
+      global.run(1, attempt);
+      timers.last.fire();
+      global.run(1, attempt);
+      timers.last.fire();
+      expect(global.stats.hedged, 1);
+      expect(global.stats.suppressed, 1);
+    });
+
+    test('Does not hedge while load is being shed', () async {
+      var shedding = false;
+      final h = hedger(
+        const ReadHedgingPolicy(
+          minSamples: 4,
+          window: 8,
+          deviceBudget: 1,
+          globalBudget: 1,
+        ),
+        canHedge: () => !shedding,
+      );
+      await warmUp(h, 4);
+      shedding = true;
+      h.run(1, attempt);
+      timers.last.fire();
+      expect(h.stats.hedged, 0);
+      expect(h.stats.suppressed, 1);
+    });
+
+    test('Device errors are answers; timeouts wait for the hedge', () async {
+      final h = hedger(
+        const ReadHedgingPolicy(
+          minSamples: 4,
+          window: 8,
+          deviceBudget: 1,
+          globalBudget: 1,
+        ),
+      );
+      await warmUp(h, 4);
+
+      final timedOut = h.run(1, attempt);
+      timers.last.fire();
+      sent[sent.length - 2].completeError(
+        const BacnetTimeoutException('ReadProperty timed out'),
+      );
+      sent.last.complete(7);
+      expect(await timedOut, 7);
+
+      final rejected = h.run(1, attempt);
+      timers.last.fire();
+      sent[sent.length - 2].completeError(
+        const BacnetRejectException('Request rejected by device', reason: 0),
+      );
+      await expectLater(rejected, throwsA(isA<BacnetRejectException>()));
+      sent.last.complete(7);
+    });
+  });
+}
+
+class _FakeTimer implements Timer {
+  _FakeTimer(this.delay, this._callback);
+
+  final Duration delay;
+  final void Function() _callback;
+  bool _active = true;
+
+  void fire() {
+    if (!_active) return;
+    _active = false;
+    _callback();
+  }
+
+  @override
+  bool get isActive => _active;
+
+  @override
+  int get tick => 0;
+
+  @override
+  void cancel() => _active = false;
+}
@@ -75,5 +75,46 @@ void main() {
         calloc.free(ptr);
       }
     });
+    test('Decodes Trend Log records', () {
+      final mockData = [
+        0x3A, 0x05, 0x20, // ResultFlags: more items
+        0x49, 0x02, // ItemCount = 2
+        0x59, 0x2A, // FirstSequenceNumber = 42
+        0x6E, // Open ItemData
+        // Record 1: 2026-03-01 12:30:15.50, real 21.5, flags in-alarm
+        0x0E, 0xA4, 0x7E, 0x03, 0x01, 0x07, 0xB4, 0x0C, 0x1E, 0x0F, 0x32,
+        0x0F,
+        0x1E, 0x2C, 0x41, 0xAC, 0x00, 0x00, 0x1F,
+        0x2A, 0x04, 0x80,
+        // Record 2: log status, buffer purged
+        0x0E, 0xA4, 0x7E, 0x03, 0x01, 0x07, 0xB4, 0x0C, 0x1F, 0x00, 0x00,
+        0x0F,
+        0x1E, 0x0A, 0x05, 0x40, 0x1F,
+        0x6F, // Close ItemData
+      ];
+
+      final ptr = calloc<ffi.Uint8>(mockData.length);
+      for (int i = 0; i < mockData.length; i++) {
+        ptr[i] = mockData[i];
+      }
+
+      try {
+        final result = ReadRangeDecoder.decode(ptr, mockData.length);
+        expect(result['flags'], equals(0x20));
+        expect(result['firstSequence'], equals(42));
+        final records = result['data'] as List<dynamic>;
+        expect(records, hasLength(2));
+        expect(
+          records[0]['timestamp'],
+          equals(DateTime(2026, 3, 1, 12, 30, 15, 500)),
+        );
+        expect(records[0]['value'], closeTo(21.5, 0.001));
+        expect(records[0]['statusFlags'], equals(1));
+        expect(records[1]['logStatus'], equals(2));
+        expect(records[1]['value'], isNull);
+      } finally {
+        calloc.free(ptr);
+      }
+    });
   });
 }
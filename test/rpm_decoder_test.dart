@@ -0,0 +1,115 @@
+import 'dart:ffi' as ffi;
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:bacnet_plugin/src/native/worker/rpm_decoder.dart';
+import 'package:ffi/ffi.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+Map<String, Map<int, dynamic>> _decode(List<int> bytes) {
+  final ptr = calloc<ffi.Uint8>(bytes.length);
+  try {
+    for (var i = 0; i < bytes.length; i++) {
+      ptr[i] = bytes[i];
+    }
+    return RPMDecoder.decode(ptr, bytes.length);
+  } finally {
+    calloc.free(ptr);
+  }
+}
+
+void main() {
+  group('RPMDecoder', () {
+    test('Decodes a wide ALL response', () {
+      final result = _decode([
+        0x0C, 0x00, 0x00, 0x00, 0x01, // Object ID: analog-input 1
+        0x1E, // Open list of results
+        0x29, 0x55, // Present Value
+        0x4E, 0x44, 0x42, 0xC8, 0x00, 0x00, 0x4F, // Real 100.0
+        0x29, 0x6F, // Status Flags
+        0x4E, 0x82, 0x04, 0x40, 0x4F, // BitString (4 bits, fault set)
+        0x29, 0x4D, // Object Name
+        0x4E, 0x75, 0x0A, 0x00, // String, extended length 10, UTF-8
+        0x41, 0x6E, 0x61, 0x6C, 0x6F, 0x67, 0x20, 0x31, 0x21, 0x4F,
+        0x2A, 0x01, 0x73, // Property List (371, two-byte ID)
+        0x4E, 0x21, 0x55, 0x21, 0x4D, 0x21, 0x6F, 0x4F,
+        0x29, 0x1C, // Description
+        0x5E, 0x91, 0x02, 0x91, 0x20, 0x5F, // Error: property/unknown
+        0x1F, // Close list of results
+      ]);
+
+      final props = result['0:1']!;
+      expect(props[BacnetPropertyId.presentValue], equals(100.0));
+      expect(
+        props[BacnetPropertyId.statusFlags],
+        equals([false, true, false, false]),
+      );
+      expect(props[BacnetPropertyId.objectName], equals('Analog 1!'));
+      expect(props[371], equals([85, 77, 111]));
+
+      final error = props[BacnetPropertyId.description] as BacnetError;
+      expect(error.errorClass, equals(BacnetErrorClass.property));
+      expect(error.errorCode, equals(32));
+    });
+
+    test('Decodes NULL elements and multiple objects', () {
+      final result = _decode([
+        0x0C, 0x00, 0x40, 0x00, 0x02, // Object ID: analog-output 2
+        0x1E,
+        0x29, 0x57, // Priority Array
+        0x4E, 0x00, 0x00, 0x44, 0x42, 0x90, 0x00, 0x00, 0x4F,
+        0x1F,
+        0x0C, 0x00, 0x80, 0x00, 0x03, // Object ID: analog-value 3
+        0x1E,
+        0x29, 0x55,
+        0x4E, 0x31, 0xFE, 0x4F, // Signed -2
+        0x1F,
+      ]);
+
+      expect(result['1:2']![BacnetPropertyId.priorityArray], [
+        null,
+        null,
+        72.0,
+      ]);
+      expect(result['2:3']![BacnetPropertyId.presentValue], equals(-2));
+    });
+
+    test('Collects a property read at several array indexes', () {
+      final result = _decode([
+        0x0C, 0x02, 0x00, 0x04, 0xD2, // Object ID: device 1234
+        0x1E,
+        0x29, 0x4C, 0x39, 0x00, // Object List [0]
+        0x4E, 0x21, 0x03, 0x4F, // Unsigned 3
+        0x29, 0x4C, 0x39, 0x01, // Object List [1]
+        0x4E, 0xC4, 0x00, 0x00, 0x00, 0x01, 0x4F, // analog-input 1
+        0x29, 0x4C, 0x39, 0x02, // Object List [2]
+        0x4E, 0xC4, 0x00, 0x40, 0x00, 0x02, 0x4F, // analog-output 2
+        0x29, 0x4C, 0x39, 0x04, // Object List [4]
+        0x5E, 0x91, 0x02, 0x91, 0x2A, 0x5F, // Error: invalid array index
+        0x29, 0x4D, 0x39, 0x01, // Object Name [1]: single, stays scalar
+        0x4E, 0x71, 0x00, 0x4F, // Empty string
+        0x1F,
+      ]);
+
+      final list = result['8:1234']![BacnetPropertyId.objectList] as Map;
+      expect(list[0], 3);
+      expect(list[1], {'type': 0, 'instance': 1});
+      expect(list[2], {'type': 1, 'instance': 2});
+      expect((list[4] as BacnetError).errorCode, 42);
+      expect(result['8:1234']![BacnetPropertyId.objectName], '');
+    });
+
+    test('Keeps properties decoded before a truncated packet', () {
+      final result = _decode([
+        0x0C, 0x00, 0x00, 0x00, 0x01,
+        0x1E,
+        0x29, 0x55,
+        0x4E, 0x44, 0x42, 0xC8, 0x00, 0x00, 0x4F,
+        0x29, 0x4D,
+        0x4E, 0x75, 0x0A, 0x00, 0x41, // Cut short
+      ]);
+
+      expect(result['0:1']![BacnetPropertyId.presentValue], equals(100.0));
+      expect(result['0:1']!.containsKey(BacnetPropertyId.objectName), isTrue);
+    });
+  });
+}
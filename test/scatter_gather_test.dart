@@ -0,0 +1,139 @@
+import 'dart:async';
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:mocktail/mocktail.dart';
+
+class MockBacnetClient extends Mock implements BacnetClient {}
+
+void main() {
+  late MockBacnetClient client;
+
+  /// Answers RPMs to [deviceId] after [delay] with `instance * 10` for
+  /// every requested property.
+  void stubDevice(int deviceId, Duration delay) {
+    when(
+      () => client.readMultiple(
+        deviceId,
+        any(),
+        priority: any(named: 'priority'),
+      ),
+    ).thenAnswer((invocation) async {
+      await Future<void>.delayed(delay);
+      final specs =
+          invocation.positionalArguments[1]
+              as List<BacnetReadAccessSpecification>;
+      return {
+        for (final spec in specs)
+          '${spec.objectIdentifier.type}:${spec.objectIdentifier.instance}': {
+            for (final p in spec.properties)
+              p.propertyIdentifier: spec.objectIdentifier.instance * 10,
+          },
+      };
+    });
+  }
+
+  setUpAll(() {
+    registerFallbackValue(BacnetRequestPriority.interactive);
+  });
+
+  setUp(() {
+    client = MockBacnetClient();
+  });
+
+  test('Streams results in completion order', () async {
+    stubDevice(1, const Duration(milliseconds: 60));
+    stubDevice(2, const Duration(milliseconds: 5));
+
+    final readings = await ScatterGatherReader(client).read([
+      const PointRef(1, BacnetObjectType.analogInput, 1),
+      const PointRef(2, BacnetObjectType.analogInput, 2),
+    ]).toList();
+
+    expect(readings.map((r) => r.point.deviceId), [2, 1]);
+    expect(readings.map((r) => r.value), [20, 10]);
+    verify(
+      () => client.readMultiple(2, any(), priority: any(named: 'priority')),
+    ).called(1);
+  });
+
+  test('Packs points into RPMs under the per-device limit', () async {
+    var inFlight = 0;
+    var maxInFlight = 0;
+    when(
+      () => client.readMultiple(1, any(), priority: any(named: 'priority')),
+    ).thenAnswer((invocation) async {
+      inFlight++;
+      maxInFlight = inFlight > maxInFlight ? inFlight : maxInFlight;
+      await Future<void>.delayed(const Duration(milliseconds: 5));
+      inFlight--;
+      final specs =
+          invocation.positionalArguments[1]
+              as List<BacnetReadAccessSpecification>;
+      return {
+        for (final spec in specs)
+          '${spec.objectIdentifier.type}:${spec.objectIdentifier.instance}': {
+            BacnetPropertyId.presentValue: 0,
+          },
+      };
+    });
+
+    final readings = await ScatterGatherReader(
+      client,
+      perDevice: 2,
+      maxPointsPerRequest: 4,
+    ).read([for (var i = 0; i < 20; i++) PointRef(1, 0, i)]).toList();
+
+    expect(readings, hasLength(20));
+    expect(readings.every((r) => r.hasValue), isTrue);
+    expect(maxInFlight, 2);
+    verify(
+      () => client.readMultiple(1, any(), priority: any(named: 'priority')),
+    ).called(5);
+  });
+
+  test('Reports per-point errors', () async {
+    when(
+      () => client.readMultiple(1, any(), priority: any(named: 'priority')),
+    ).thenAnswer(
+      (_) async => {
+        '0:1': {BacnetPropertyId.presentValue: 1.5},
+        '0:2': {BacnetPropertyId.presentValue: const BacnetError(2, 31)},
+      },
+    );
+    when(
+      () => client.readMultiple(2, any(), priority: any(named: 'priority')),
+    ).thenThrow(const BacnetTimeoutException('timed out'));
+
+    final readings = await ScatterGatherReader(client).read([
+      const PointRef(1, 0, 1),
+      const PointRef(1, 0, 2),
+      const PointRef(2, 0, 1),
+    ]).toList();
+
+    final byPoint = {for (final r in readings) r.point: r};
+    expect(byPoint[const PointRef(1, 0, 1)]!.value, 1.5);
+    final refused = byPoint[const PointRef(1, 0, 2)]!.error;
+    expect(refused, isA<BacnetProtocolException>());
+    expect((refused! as BacnetProtocolException).errorCode, 31);
+    expect(
+      byPoint[const PointRef(2, 0, 1)]!.error,
+      isA<BacnetTimeoutException>(),
+    );
+  });
+
+  test('Reports outstanding points at the deadline', () async {
+    stubDevice(1, const Duration(milliseconds: 5));
+    stubDevice(2, const Duration(seconds: 1));
+
+    final readings = await ScatterGatherReader(client).read([
+      const PointRef(1, 0, 1),
+      const PointRef(2, 0, 1),
+    ], deadline: const Duration(milliseconds: 50)).toList();
+
+    expect(readings.first.hasValue, isTrue);
+    expect(readings.last.point.deviceId, 2);
+    expect(readings.last.error, isA<BacnetTimeoutException>());
+    expect(readings.last.elapsed, lessThan(const Duration(seconds: 1)));
+  });
+}
@@ -0,0 +1,160 @@
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+import 'package:mocktail/mocktail.dart';
+
+class MockBacnetClient extends Mock implements BacnetClient {}
+
+void main() {
+  late MockBacnetClient client;
+  late TrendLogBackfill backfill;
+  const ai1 = BacnetObject(type: BacnetObjectType.analogInput, instance: 1);
+  final t0 = DateTime(2026, 3, 1, 12);
+
+  PropertyUpdate live(num minutes, {Object? error}) => PropertyUpdate(
+    deviceId: 1234,
+    objectIdentifier: ai1,
+    propertyIdentifier: BacnetPropertyId.presentValue,
+    value: error == null ? minutes.toDouble() : null,
+    timestamp: t0.add(Duration(seconds: (minutes * 60).round())),
+    source: UpdateSource.missingCovFallback,
+    error: error,
+  );
+
+  TrendLogEntry record(int minutes, int sequence) => TrendLogEntry(
+    timestamp: t0.add(Duration(minutes: minutes)),
+    value: minutes * 10.0,
+    status: 'OK',
+    sequenceNumber: sequence,
+  );
+
+  setUpAll(() {
+    registerFallbackValue(BacnetRequestPriority.interactive);
+  });
+
+  setUp(() {
+    client = MockBacnetClient();
+    backfill = TrendLogBackfill(client, minGap: const Duration(minutes: 1))
+      ..addSource(
+        deviceId: 1234,
+        object: ai1,
+        propertyId: BacnetPropertyId.presentValue,
+        trendLog: 7,
+      );
+  });
+
+  test('Backfills the outage by time, then by sequence', () async {
+    when(
+      () => client.readTrendLog(
+        1234,
+        7,
+        since: t0,
+        afterSequence: any(named: 'afterSequence'),
+        count: any(named: 'count'),
+        priority: any(named: 'priority'),
+      ),
+    ).thenAnswer(
+      (_) async => TrendLogData(
+        itemCount: 2,
+        totalRecords: 2,
+        entries: [record(1, 41), record(2, 42)],
+        moreItems: true,
+      ),
+    );
+    when(
+      () => client.readTrendLog(
+        1234,
+        7,
+        since: any(named: 'since'),
+        afterSequence: 42,
+        count: any(named: 'count'),
+        priority: any(named: 'priority'),
+      ),
+    ).thenAnswer(
+      (_) async => TrendLogData(
+        itemCount: 2,
+        totalRecords: 2,
+        entries: [record(3, 43), record(5, 44)],
+        moreItems: true,
+      ),
+    );
+
+    final updates = await backfill
+        .attach(
+          Stream.fromIterable([
+            live(0),
+            live(1, error: const BacnetTimeoutException('timed out')),
+            live(4),
+          ]),
+        )
+        .toList();
+
+    final filled = updates.where((u) => u.backfilled).toList();
+    expect(filled.map((u) => u.value), [10.0, 20.0, 30.0]);
+    expect(filled.first.timestamp, t0.add(const Duration(minutes: 1)));
+    expect(updates.where((u) => !u.backfilled), hasLength(3));
+    expect(backfill.gapsFilled, 1);
+    expect(backfill.recordsBackfilled, 3);
+  });
+
+  test('Ignores gaps without failed reads or shorter than minGap', () async {
+    final updates = await backfill
+        .attach(
+          Stream.fromIterable([
+            live(0),
+            live(10),
+            live(10.25, error: const BacnetTimeoutException('timed out')),
+            live(10.75),
+          ]),
+        )
+        .toList();
+
+    expect(updates, hasLength(4));
+    expect(backfill.gapsDetected, 0);
+    verifyNever(
+      () => client.readTrendLog(
+        any(),
+        any(),
+        since: any(named: 'since'),
+        afterSequence: any(named: 'afterSequence'),
+        count: any(named: 'count'),
+        priority: any(named: 'priority'),
+      ),
+    );
+  });
+
+  test('Discovers the logged point of each Trend Log', () async {
+    when(
+      () => client.readMultiple(1234, any(), priority: any(named: 'priority')),
+    ).thenAnswer(
+      (_) async => {
+        '20:1': {
+          BacnetPropertyId.logDeviceObjectProperty: [
+            (BacnetObjectType.analogValue << 22) | 3,
+            BacnetPropertyId.presentValue,
+          ],
+        },
+        '20:2': {
+          // Logs a point on another device
+          BacnetPropertyId.logDeviceObjectProperty: [
+            (BacnetObjectType.analogValue << 22) | 4,
+            BacnetPropertyId.presentValue,
+            (BacnetObjectType.device << 22) | 99,
+          ],
+        },
+        '20:3': {
+          BacnetPropertyId.logDeviceObjectProperty: const BacnetError(2, 32),
+        },
+      },
+    );
+
+    expect(await backfill.discover(1234, [1, 2, 3]), 1);
+    expect(
+      backfill.trendLogFor(
+        1234,
+        const BacnetObject(type: BacnetObjectType.analogValue, instance: 3),
+        BacnetPropertyId.presentValue,
+      ),
+      1,
+    );
+  });
+}
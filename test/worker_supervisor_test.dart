@@ -0,0 +1,199 @@
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:bacnet_plugin/src/native/worker_supervisor.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+void main() {
+  group('WorkerSupervisor', () {
+    test('Replays only the latest state', () {
+      final supervisor = WorkerSupervisor()
+        ..record(const RegisterFdrRequest(ip: '10.0.0.1'))
+        ..record(const AddDeviceBindingRequest(deviceId: 1, ip: '10.0.0.5'))
+        ..record(const AddDeviceBindingRequest(deviceId: 1, ip: '10.0.0.6'))
+        ..record(
+          const SubscribeCOVRequest(
+            deviceId: 1,
+            objectType: 0,
+            instance: 3,
+            trackingId: 7,
+          ),
+        )
+        ..record(
+          const SubscribeCOVRequest(deviceId: 1, objectType: 0, instance: 3),
+        )
+        ..record(const WhoIsRequest())
+        ..record(const SetPacketFilterRequest(BacnetPacketFilter.allowAll));
+
+      final plan = supervisor.replayPlan();
+      expect(plan, hasLength(3));
+      expect(plan[0], isA<RegisterFdrRequest>());
+      expect((plan[1] as AddDeviceBindingRequest).ip, '10.0.0.6');
+      final subscription = plan[2] as SubscribeCOVRequest;
+      expect(subscription.instance, 3);
+      expect(subscription.trackingId, isNull);
+    });
+
+    test('Drops cancelled and expired subscriptions', () {
+      var now = DateTime(2026);
+      final supervisor = WorkerSupervisor(clock: () => now)
+        ..record(
+          const SubscribeCOVRequest(deviceId: 1, objectType: 0, instance: 1),
+        )
+        ..record(
+          const SubscribeCOVRequest(
+            deviceId: 1,
+            objectType: 0,
+            instance: 2,
+            lifetime: 300,
+          ),
+        )
+        ..record(
+          const SubscribeCOVRequest(
+            deviceId: 1,
+            objectType: 0,
+            instance: 3,
+            lifetime: 0,
+          ),
+        )
+        ..record(
+          const SubscribeCOVRequest(
+            deviceId: 1,
+            objectType: 0,
+            instance: 1,
+            cancel: true,
+          ),
+        );
+
+      now = now.add(const Duration(seconds: 200));
+      var plan = supervisor.replayPlan().cast<SubscribeCOVRequest>();
+      expect([for (final r in plan) r.instance], [2, 3]);
+      expect(plan.first.lifetime, 100);
+      expect(plan.last.lifetime, 0);
+
+      now = now.add(const Duration(seconds: 100));
+      plan = supervisor.replayPlan().cast<SubscribeCOVRequest>();
+      expect(plan.single.instance, 3);
+    });
+
+    test('Restores bindings learned from I-Am', () {
+      final supervisor = WorkerSupervisor()
+        ..recordIAm(
+          const IAmResponse(
+            deviceId: 10,
+            net: 0,
+            mac: [192, 168, 1, 20, 0xBA, 0xC0],
+            len: 0,
+          ),
+        )
+        ..recordIAm(
+          const IAmResponse(
+            deviceId: 20,
+            net: 5,
+            mac: [192, 168, 1, 1, 0xBA, 0xC0],
+            len: 1,
+          ),
+        );
+
+      final plan = supervisor.replayPlan();
+      final local = plan[0] as AddDeviceBindingRequest;
+      expect(local.deviceId, 10);
+      expect(local.ip, '192.168.1.20');
+      expect(local.port, 47808);
+      final routed = plan[1] as WhoIsRequest;
+      expect(routed.lowLimit, 20);
+      expect(routed.highLimit, 20);
+    });
+
+    test('Reopens the write journal until it is closed', () {
+      const config = WriteJournalConfig(path: '/tmp/writes.journal');
+      final supervisor = WorkerSupervisor()
+        ..record(const OpenWriteJournalRequest(config, trackingId: 4))
+        ..record(const RegisterFdrRequest(ip: '10.0.0.1'));
+
+      final plan = supervisor.replayPlan();
+      final open = plan.first as OpenWriteJournalRequest;
+      expect(open.config, config);
+      expect(open.trackingId, isNull);
+
+      supervisor.record(const CloseWriteJournalRequest(trackingId: 5));
+      expect(supervisor.replayPlan().single, isA<RegisterFdrRequest>());
+    });
+
+    test('Replays the real-time profile first until it is cleared', () {
+      const profile = RealtimeProfile(cpu: 2);
+      final supervisor = WorkerSupervisor()
+        ..record(const RegisterFdrRequest(ip: '10.0.0.1'))
+        ..record(const SetRealtimeProfileRequest(profile));
+
+      final plan = supervisor.replayPlan();
+      expect((plan.first as SetRealtimeProfileRequest).profile, profile);
+
+      supervisor.record(const SetRealtimeProfileRequest(null));
+      expect(supervisor.replayPlan().single, isA<RegisterFdrRequest>());
+    });
+
+    test('Backs off and gives up on a crash loop', () {
+      var now = DateTime(2026);
+      final supervisor = WorkerSupervisor(maxRestarts: 3, clock: () => now);
+
+      expect(supervisor.onCrash('a'), Duration.zero);
+      expect(supervisor.onCrash('b'), WorkerSupervisor.backoff[1]);
+      expect(supervisor.onCrash('c'), WorkerSupervisor.backoff[2]);
+      expect(supervisor.onCrash('d'), isNull);
+      expect(supervisor.stats.gaveUp, isTrue);
+      expect(supervisor.stats.lastCause, 'd');
+
+      now = now.add(const Duration(minutes: 2));
+      expect(supervisor.onCrash('e'), Duration.zero);
+    });
+
+    test('Only reads are reissued', () {
+      expect(
+        WorkerSupervisor.isReissuable(
+          const ReadPropertyRequest(
+            trackingId: 1,
+            deviceId: 1,
+            objectType: 0,
+            instance: 1,
+            propertyId: 85,
+          ),
+        ),
+        isTrue,
+      );
+      expect(
+        WorkerSupervisor.isReissuable(
+          const WritePropertyRequest(
+            deviceId: 1,
+            objectType: 1,
+            instance: 1,
+            propertyId: 85,
+            value: 1.0,
+          ),
+        ),
+        isFalse,
+      );
+    });
+
+    test('Tracks recovery times', () {
+      final supervisor = WorkerSupervisor()
+        ..recordFailed(2)
+        ..recordRecovery(
+          const Duration(milliseconds: 80),
+          replayed: 4,
+          reissued: 3,
+        )
+        ..recordRecovery(
+          const Duration(milliseconds: 40),
+          replayed: 4,
+          reissued: 0,
+        );
+
+      final stats = supervisor.stats;
+      expect(stats.restarts, 2);
+      expect(stats.replayedRequests, 8);
+      expect(stats.reissuedRequests, 3);
+      expect(stats.failedRequests, 2);
+      expect(stats.lastRecovery, const Duration(milliseconds: 40));
+      expect(stats.maxRecovery, const Duration(milliseconds: 80));
+    });
+  });
+}
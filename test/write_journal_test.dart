@@ -0,0 +1,112 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:bacnet_plugin/bacnet_plugin.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+/// Builds a record the way `bacnet_plugin_journal_append` lays it out.
+Uint8List _record({
+  required int kind,
+  required int seconds,
+  required int millis,
+  required List<int> value,
+  int priority = 8,
+  int invokeId = 0,
+  int arrayIndex = 0xFFFFFFFF,
+}) {
+  final length = 32 + value.length + 4;
+  final data = ByteData(length)
+    ..setUint16(0, length)
+    ..setUint8(2, kind)
+    ..setUint8(3, priority)
+    ..setUint32(4, seconds)
+    ..setUint16(8, millis)
+    ..setUint8(10, invokeId)
+    ..setUint32(12, 4194303)
+    ..setUint16(16, 2)
+    ..setUint32(18, 1)
+    ..setUint32(22, 85)
+    ..setUint32(26, arrayIndex)
+    ..setUint16(30, value.length);
+  final bytes = data.buffer.asUint8List()..setAll(32, value);
+  data.setUint32(length - 4, WriteJournalReader.crc32(bytes, 0, length - 4));
+  return bytes;
+}
+
+Uint8List _file(List<Uint8List> records) => Uint8List.fromList([
+  ...ascii.encode('BPWJ'),
+  0, 1, 0, 32, // version 1, 32-byte record header
+  for (final record in records) ...record,
+]);
+
+void main() {
+  test('CRC-32 matches the IEEE check value', () {
+    expect(WriteJournalReader.crc32(ascii.encode('123456789')), 0xCBF43926);
+  });
+
+  test('Decodes records in order', () {
+    // Real 21.5 and Unsigned 3.
+    final journal = WriteJournalReader(
+      _file([
+        _record(
+          kind: 1,
+          seconds: 1700000000,
+          millis: 250,
+          value: [0x44, 0x41, 0xAC, 0x00, 0x00],
+        ),
+        _record(
+          kind: 2,
+          seconds: 1700000001,
+          millis: 5,
+          value: [0x21, 0x03],
+          invokeId: 17,
+          arrayIndex: 4,
+          priority: 0,
+        ),
+      ]),
+    );
+
+    expect(journal.records, hasLength(2));
+    final incoming = journal.records.first;
+    expect(incoming.kind, WriteJournalKind.incomingWrite);
+    expect(
+      incoming.time,
+      DateTime.fromMillisecondsSinceEpoch(1700000000250, isUtc: true),
+    );
+    expect(incoming.deviceId, 4194303);
+    expect(incoming.objectType, 2);
+    expect(incoming.instance, 1);
+    expect(incoming.propertyId, 85);
+    expect(incoming.arrayIndex, isNull);
+    expect(incoming.priority, 8);
+    expect(incoming.encodedValue, [0x44, 0x41, 0xAC, 0x00, 0x00]);
+
+    final outgoing = journal.records.last;
+    expect(outgoing.kind, WriteJournalKind.outgoingWrite);
+    expect(outgoing.invokeId, 17);
+    expect(outgoing.arrayIndex, 4);
+    expect(journal.validLength, _file([]).length + 41 + 38);
+  });
+
+  test('Stops at a torn or corrupted record', () {
+    final good = _record(kind: 1, seconds: 1, millis: 0, value: [0x21, 1]);
+    final torn = _record(kind: 1, seconds: 2, millis: 0, value: [0x21, 2]);
+    final file = _file([good, torn]);
+
+    final truncated = WriteJournalReader(
+      Uint8List.sublistView(file, 0, file.length - 3),
+    );
+    expect(truncated.records, hasLength(1));
+    expect(truncated.validLength, 8 + good.length);
+
+    file[file.length - 6] ^= 0xFF;
+    expect(WriteJournalReader(file).records, hasLength(1));
+  });
+
+  test('Rejects files that are not journals', () {
+    expect(
+      () => WriteJournalReader(Uint8List.fromList(ascii.encode('BPIMxxxx'))),
+      throwsFormatException,
+    );
+  });
+}